@@ -3,6 +3,9 @@ import hmac
 import json
 import mimetypes
 import os
+import re
+import struct
+import zlib
 from datetime import datetime, timezone
 from pathlib import Path
 from typing import Optional, Tuple
@@ -153,6 +156,119 @@ def _sha256_hex(path: Path) -> str:
             h.update(chunk)
     return h.hexdigest()
 
+def _compressed_path(target: Path) -> Path:
+    return target.with_name(target.name + ".zz")
+
+def _ensure_compressed(target: Path) -> Optional[Path]:
+    """Maintain a zlib-compressed sibling of the firmware image.
+
+    Nodes that understand the binary_url_zz manifest fields download roughly
+    half the bytes and inflate on the fly. The sibling is rebuilt whenever it
+    is missing or older than the image, and written atomically so a request
+    can never observe a half-compressed file.
+    """
+    comp = _compressed_path(target)
+    try:
+        t_stat = target.stat()
+        if comp.exists() and comp.stat().st_mtime >= t_stat.st_mtime:
+            return comp
+        tmp = comp.with_name(comp.name + ".tmp")
+        tmp.write_bytes(zlib.compress(target.read_bytes(), 9))
+        tmp.replace(comp)
+        return comp
+    except OSError:
+        return None
+
+DELTA_MAGIC = b"ULD1"
+_DELTA_ANCHOR = 16
+_VERSION_RE = re.compile(r"[A-Za-z0-9._-]+")
+
+
+def _build_delta(src: bytes, dst: bytes) -> bytes:
+    """Build a ULD1 patch that rewrites ``src`` into ``dst``.
+
+    The format is a flat opcode stream the node can apply while streaming:
+    COPY (0x00, src_offset, length) pulls unchanged ranges out of the
+    partition it is currently running from, ADD (0x01, length, bytes)
+    carries the bytes that actually changed, and 0xFF terminates. Matching
+    is greedy: every 16-byte-aligned window of the source is indexed, and
+    each hit is extended forward as far as the bytes agree. Firmware builds
+    keep most of the image byte-identical, so the result is dominated by a
+    handful of long COPY ops.
+    """
+    index: dict = {}
+    for off in range(0, len(src) - _DELTA_ANCHOR + 1, _DELTA_ANCHOR):
+        index.setdefault(src[off:off + _DELTA_ANCHOR], off)
+
+    out = bytearray(DELTA_MAGIC)
+    out += struct.pack("<II", len(dst), len(src))
+    literal = bytearray()
+
+    def flush_literal() -> None:
+        if literal:
+            out.append(0x01)
+            out.extend(struct.pack("<I", len(literal)))
+            out.extend(literal)
+            literal.clear()
+
+    pos = 0
+    while pos + _DELTA_ANCHOR <= len(dst):
+        src_off = index.get(dst[pos:pos + _DELTA_ANCHOR])
+        if src_off is None:
+            literal.append(dst[pos])
+            pos += 1
+            continue
+        length = _DELTA_ANCHOR
+        limit = min(len(dst) - pos, len(src) - src_off)
+        while length < limit and dst[pos + length] == src[src_off + length]:
+            length += 1
+        flush_literal()
+        out.append(0x00)
+        out += struct.pack("<II", src_off, length)
+        pos += length
+    literal += dst[pos:]
+    flush_literal()
+    out.append(0xFF)
+    return bytes(out)
+
+
+def _find_source_image(target: Path, from_version: str) -> Optional[Path]:
+    """Locate the versioned image a node reports it is running."""
+    for candidate in sorted(target.parent.glob(f"*_v{from_version}.bin")):
+        if candidate != target:
+            return candidate
+    return None
+
+
+def _ensure_delta(target: Path, from_version: str) -> Optional[Path]:
+    """Maintain a cached ULD1 patch from ``from_version`` to the image.
+
+    Rebuilt whenever it is missing or older than either input, written
+    atomically, and dropped entirely when the patch would not beat the full
+    image (the node falls back to a full download on 404).
+    """
+    if not _VERSION_RE.fullmatch(from_version):
+        return None
+    source = _find_source_image(target, from_version)
+    if source is None:
+        return None
+    patch = target.with_name(f"{target.name}.d-{from_version}")
+    try:
+        t_stat = target.stat()
+        s_stat = source.stat()
+        if patch.exists() and patch.stat().st_mtime >= max(t_stat.st_mtime, s_stat.st_mtime):
+            return patch
+        delta = _build_delta(source.read_bytes(), target.read_bytes())
+        if len(delta) >= t_stat.st_size:
+            return None
+        tmp = patch.with_name(patch.name + ".tmp")
+        tmp.write_bytes(delta)
+        tmp.replace(patch)
+        return patch
+    except OSError:
+        return None
+
+
 def _manifest_sig(body: dict) -> Optional[str]:
     secret = settings.MANIFEST_HMAC_SECRET
     if not secret:
@@ -196,6 +312,20 @@ def _build_manifest_response(device_id: str, download_id: Optional[str]) -> JSON
         if download_id:
             body["manifest_url_lan"] = f"{LAN_PUBLIC_BASE}/firmware/{download_id}/manifest"
 
+    comp = _ensure_compressed(target)
+    if comp is not None:
+        body["binary_url_zz"] = f"{settings.PUBLIC_BASE}/firmware/{exposed_id}/latest.bin.zz"
+        body["size_zz"] = comp.stat().st_size
+        if LAN_PUBLIC_BASE:
+            body["binary_url_zz_lan"] = f"{LAN_PUBLIC_BASE}/firmware/{exposed_id}/latest.bin.zz"
+
+    if any(p != target for p in target.parent.glob("*_v*.bin")):
+        # Older versioned images exist, so per-version delta patches can be
+        # built; the node appends its running version + ".bin" to the base.
+        body["delta_url_base"] = f"{settings.PUBLIC_BASE}/firmware/{exposed_id}/delta/"
+        if LAN_PUBLIC_BASE:
+            body["delta_url_base_lan"] = f"{LAN_PUBLIC_BASE}/firmware/{exposed_id}/delta/"
+
     sig = _manifest_sig(body)
     headers = {"Cache-Control": "no-store"}
     if sig:
@@ -298,3 +428,38 @@ def api_latest_bin(
     )
     target = _resolve_latest(resolved_device_id, resolved_download_id or download_id)
     return _serve_file(target, request)
+
+@router.get("/firmware/{download_id}/delta/{from_version}.bin")
+def api_delta_bin(
+    download_id: str,
+    from_version: str,
+    request: Request,
+    authorization: Optional[str] = Header(None),
+):
+    resolved_device_id, resolved_download_id, _ = _resolve_access_context(
+        authorization=authorization,
+        device_id=None,
+        download_id=download_id,
+    )
+    target = _resolve_latest(resolved_device_id, resolved_download_id or download_id)
+    patch = _ensure_delta(target, from_version)
+    if patch is None:
+        raise HTTPException(status_code=404, detail="No delta for this version")
+    return _serve_file(patch, request)
+
+@router.get("/firmware/{download_id}/latest.bin.zz")
+def api_latest_bin_zz(
+    download_id: str,
+    request: Request,
+    authorization: Optional[str] = Header(None),
+):
+    resolved_device_id, resolved_download_id, _ = _resolve_access_context(
+        authorization=authorization,
+        device_id=None,
+        download_id=download_id,
+    )
+    target = _resolve_latest(resolved_device_id, resolved_download_id or download_id)
+    comp = _ensure_compressed(target)
+    if comp is None:
+        raise HTTPException(status_code=404, detail="No compressed image available")
+    return _serve_file(comp, request)
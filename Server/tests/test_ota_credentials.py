@@ -3,6 +3,7 @@ from __future__ import annotations
 from copy import deepcopy
 import json
 import re
+import struct
 import sys
 from pathlib import Path
 
@@ -445,3 +446,49 @@ def test_pre_registered_node_provisioning(tmp_path, ota_environment, capsys):
         assert registration.provisioned_at is not None
 
     assert "Hardware metadata" in output
+
+
+def _apply_delta(src: bytes, patch: bytes) -> bytes:
+    """Reference applier for the ULD1 patch stream the node implements."""
+    assert patch[:4] == ota.DELTA_MAGIC
+    new_size, src_size = struct.unpack_from("<II", patch, 4)
+    assert src_size == len(src)
+    out = bytearray()
+    pos = 12
+    while True:
+        op = patch[pos]
+        pos += 1
+        if op == 0xFF:
+            break
+        if op == 0x00:
+            src_off, length = struct.unpack_from("<II", patch, pos)
+            pos += 8
+            out += src[src_off:src_off + length]
+        elif op == 0x01:
+            (length,) = struct.unpack_from("<I", patch, pos)
+            pos += 4
+            out += patch[pos:pos + length]
+            pos += length
+        else:  # pragma: no cover - malformed patch
+            raise AssertionError(f"unknown opcode {op:#x}")
+    assert pos == len(patch)
+    assert len(out) == new_size
+    return bytes(out)
+
+
+def test_build_delta_round_trip():
+    src = bytes(range(256)) * 64
+    # Mutate a small region and insert bytes so matches shift off alignment.
+    dst = src[:1000] + b"patched!" + src[1000:5000] + src[5100:]
+
+    patch = ota._build_delta(src, dst)
+    assert _apply_delta(src, patch) == dst
+    # Mostly-unchanged images should patch in far fewer bytes than the image.
+    assert len(patch) < len(dst) // 4
+
+
+def test_build_delta_handles_unrelated_images():
+    src = b"\x00" * 4096
+    dst = bytes((i * 37 + 11) % 251 for i in range(4096))
+    patch = ota._build_delta(src, dst)
+    assert _apply_delta(src, patch) == dst
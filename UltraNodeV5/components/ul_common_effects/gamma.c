@@ -1,23 +1,79 @@
 #include "ul_common_effects.h"
-#include <math.h>
-#include <stdbool.h>
+#include "sdkconfig.h"
 
-static uint8_t s_gamma_tbl[256];
-static bool s_gamma_init = false;
+// Both tables are baked at build time (the 2.2 exponent is fixed), so the
+// lookups carry no init branch -- ul_gamma8() sits inside the per-byte frame
+// loop and used to test a lazy-init flag on every call. Regenerate with:
+//   for i in 0..255: round((i/255)^2.2 * 255)   (4095 for the 12-bit table)
+//
+// Placement is configurable: const data normally lives in flash, and a
+// cache miss in the render loop stalls the pixel clock; UL_GAMMA_TABLE_DRAM
+// pins the 768 bytes in internal RAM instead.
+#if CONFIG_UL_GAMMA_TABLE_DRAM
+#include "esp_attr.h"
+#define UL_GAMMA_TBL_ATTR DRAM_ATTR
+#else
+#define UL_GAMMA_TBL_ATTR
+#endif
 
-static void init_gamma_table(void) {
-    for (int i = 0; i < 256; ++i) {
-        float f = (float)i / 255.0f;
-        float g = powf(f, 2.2f);
-        int out = (int)(g * 255.0f + 0.5f);
-        if (out < 0) out = 0;
-        if (out > 255) out = 255;
-        s_gamma_tbl[i] = (uint8_t)out;
-    }
-    s_gamma_init = true;
-}
+static UL_GAMMA_TBL_ATTR const uint8_t s_gamma_tbl[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3,
+    3, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6,
+    6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10,
+    11, 11, 11, 12, 12, 13, 13, 13, 14, 14, 15, 15,
+    16, 16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 22,
+    22, 23, 23, 24, 25, 25, 26, 26, 27, 28, 28, 29,
+    30, 30, 31, 32, 33, 33, 34, 35, 35, 36, 37, 38,
+    39, 39, 40, 41, 42, 43, 43, 44, 45, 46, 47, 48,
+    49, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
+    60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+    73, 74, 75, 76, 77, 78, 79, 81, 82, 83, 84, 85,
+    87, 88, 89, 90, 91, 93, 94, 95, 97, 98, 99, 100,
+    102, 103, 105, 106, 107, 109, 110, 111, 113, 114, 116, 117,
+    119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154,
+    156, 158, 159, 161, 163, 165, 166, 168, 170, 172, 173, 175,
+    177, 179, 181, 182, 184, 186, 188, 190, 192, 194, 196, 197,
+    199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246,
+    248, 251, 253, 255,
+};
+
+static UL_GAMMA_TBL_ATTR const uint16_t s_gamma12_tbl[256] = {
+    0, 0, 0, 0, 0, 1, 1, 2, 2, 3,
+    3, 4, 5, 6, 7, 8, 9, 11, 12, 14,
+    15, 17, 19, 21, 23, 25, 27, 29, 32, 34,
+    37, 40, 43, 46, 49, 52, 55, 59, 62, 66,
+    70, 73, 77, 82, 86, 90, 95, 99, 104, 109,
+    114, 119, 124, 129, 135, 140, 146, 152, 158, 164,
+    170, 176, 182, 189, 196, 202, 209, 216, 224, 231,
+    238, 246, 254, 261, 269, 277, 286, 294, 302, 311,
+    320, 328, 337, 347, 356, 365, 375, 384, 394, 404,
+    414, 424, 435, 445, 456, 467, 477, 488, 500, 511,
+    522, 534, 545, 557, 569, 581, 594, 606, 619, 631,
+    644, 657, 670, 683, 697, 710, 724, 738, 752, 766,
+    780, 794, 809, 823, 838, 853, 868, 884, 899, 914,
+    930, 946, 962, 978, 994, 1011, 1027, 1044, 1061, 1078,
+    1095, 1112, 1130, 1147, 1165, 1183, 1201, 1219, 1237, 1256,
+    1274, 1293, 1312, 1331, 1350, 1370, 1389, 1409, 1429, 1449,
+    1469, 1489, 1509, 1530, 1551, 1572, 1593, 1614, 1635, 1657,
+    1678, 1700, 1722, 1744, 1766, 1789, 1811, 1834, 1857, 1880,
+    1903, 1926, 1950, 1974, 1997, 2021, 2045, 2070, 2094, 2119,
+    2143, 2168, 2193, 2219, 2244, 2270, 2295, 2321, 2347, 2373,
+    2400, 2426, 2453, 2479, 2506, 2534, 2561, 2588, 2616, 2644,
+    2671, 2700, 2728, 2756, 2785, 2813, 2842, 2871, 2900, 2930,
+    2959, 2989, 3019, 3049, 3079, 3109, 3140, 3170, 3201, 3232,
+    3263, 3295, 3326, 3358, 3390, 3421, 3454, 3486, 3518, 3551,
+    3584, 3617, 3650, 3683, 3716, 3750, 3784, 3818, 3852, 3886,
+    3920, 3955, 3990, 4025, 4060, 4095,
+};
 
 uint8_t ul_gamma8(uint8_t x) {
-    if (!s_gamma_init) init_gamma_table();
     return s_gamma_tbl[x];
 }
+
+uint16_t ul_gamma12(uint8_t x) {
+    return s_gamma12_tbl[x];
+}
@@ -2,3 +2,22 @@
 #include <stdint.h>
 
 uint8_t ul_gamma8(uint8_t x);
+
+// Gamma mapped straight to a 12-bit LEDC duty. Correcting in 8 bits first
+// collapses the whole dim end of a ramp onto a handful of duty values; this
+// table keeps the extra resolution the timers already have.
+uint16_t ul_gamma12(uint8_t x);
+
+// Q15 sine from a shared 1024-entry table. The 16-bit phase spans one full
+// turn (65536 counts = 2*pi); the result is in [-32767, 32767]. Effects that
+// used to call sinf() per pixel accumulate an integer phase instead.
+int16_t ul_sin16(uint16_t phase);
+
+// Precomputed colour wheels: the 8-bit phase spans one full turn and the
+// return value points at the phase's packed RGB triple. Effects that used to
+// convert hue to RGB per pixel index these instead.
+// Classic three-sector wheel (red -> blue -> green -> red); the rainbow
+// palette.
+const uint8_t* ul_wheel8(uint8_t phase);
+// Six-sector full-saturation HSV sweep; the modern_rainbow palette.
+const uint8_t* ul_hsv8(uint8_t phase);
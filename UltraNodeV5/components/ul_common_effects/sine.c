@@ -0,0 +1,25 @@
+#include "ul_common_effects.h"
+#include <math.h>
+#include <stdbool.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SIN_TBL_SIZE 1024
+
+static int16_t s_sin_tbl[SIN_TBL_SIZE];
+static bool s_sin_init = false;
+
+static void init_sin_table(void) {
+    for (int i = 0; i < SIN_TBL_SIZE; ++i) {
+        float a = (float)i * (2.0f * (float)M_PI / (float)SIN_TBL_SIZE);
+        s_sin_tbl[i] = (int16_t)lroundf(sinf(a) * 32767.0f);
+    }
+    s_sin_init = true;
+}
+
+int16_t ul_sin16(uint16_t phase) {
+    if (!s_sin_init) init_sin_table();
+    return s_sin_tbl[phase >> 6];
+}
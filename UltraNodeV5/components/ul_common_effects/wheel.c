@@ -0,0 +1,74 @@
+#include "ul_common_effects.h"
+#include <stdbool.h>
+
+// Both wheels are pure functions of an 8-bit phase, so they are baked into
+// packed-RGB tables on first use (like the gamma tables) and the per-pixel
+// cost in the render loops drops to a phase addition plus one table read.
+
+static uint8_t s_wheel_tbl[256][3];
+static bool s_wheel_init = false;
+
+// Classic three-sector wheel: red -> blue -> green -> red, one channel
+// ramping down while the next ramps up. This is the rainbow palette; the
+// historical phase inversion is folded into the table.
+static void init_wheel_table(void) {
+    for (int i = 0; i < 256; ++i) {
+        uint8_t h = (uint8_t)(255 - i);
+        uint8_t* c = s_wheel_tbl[i];
+        if (h < 85) {
+            c[0] = 255 - h * 3;
+            c[1] = 0;
+            c[2] = h * 3;
+        } else if (h < 170) {
+            h -= 85;
+            c[0] = 0;
+            c[1] = h * 3;
+            c[2] = 255 - h * 3;
+        } else {
+            h -= 170;
+            c[0] = h * 3;
+            c[1] = 255 - h * 3;
+            c[2] = 0;
+        }
+    }
+    s_wheel_init = true;
+}
+
+const uint8_t* ul_wheel8(uint8_t phase) {
+    if (!s_wheel_init) init_wheel_table();
+    return s_wheel_tbl[phase];
+}
+
+static uint8_t s_hsv_tbl[256][3];
+static bool s_hsv_init = false;
+
+// Six-sector full-saturation, full-value HSV sweep, with the secondary
+// colours (yellow/cyan/magenta) peaking at the sector boundaries.
+static void init_hsv_table(void) {
+    for (int i = 0; i < 256; ++i) {
+        uint8_t h = (uint8_t)i;
+        uint8_t region = h / 43;
+        uint8_t remainder = (h - region * 43) * 6;
+
+        uint8_t v = 255;
+        uint8_t p = 0;
+        uint8_t q = (uint8_t)(255 - ((uint16_t)remainder * 255 >> 8));
+        uint8_t t = (uint8_t)((uint16_t)remainder * 255 >> 8);
+
+        uint8_t* c = s_hsv_tbl[i];
+        switch (region) {
+            case 0: c[0] = v; c[1] = t; c[2] = p; break;
+            case 1: c[0] = q; c[1] = v; c[2] = p; break;
+            case 2: c[0] = p; c[1] = v; c[2] = t; break;
+            case 3: c[0] = p; c[1] = q; c[2] = v; break;
+            case 4: c[0] = t; c[1] = p; c[2] = v; break;
+            default: c[0] = v; c[1] = p; c[2] = q; break;
+        }
+    }
+    s_hsv_init = true;
+}
+
+const uint8_t* ul_hsv8(uint8_t phase) {
+    if (!s_hsv_init) init_hsv_table();
+    return s_hsv_tbl[phase];
+}
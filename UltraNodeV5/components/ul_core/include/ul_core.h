@@ -27,6 +27,16 @@ void ul_core_register_time_sync_cb(ul_core_time_sync_cb_t cb, void *ctx);
 
 void ul_core_wifi_restart(void);
 
+// ---- Wi-Fi power policy ----
+// Record user-visible activity (an MQTT command, PIR motion). The radio
+// snaps to full power and stays there for the configured hold window so a
+// burst of interaction never waits on a modem-sleep listen interval.
+void ul_core_power_note_activity(void);
+// Reported by the animation scheduler: true when every white/RGB output is
+// latched static, letting the policy deepen modem sleep to the long listen
+// interval derived from CONFIG_UL_POWER_CMD_LATENCY_MS.
+void ul_core_power_set_animations_idle(bool idle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,7 +11,6 @@
 #include "freertos/event_groups.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
-#include "ul_task.h"
 #include "ul_wifi_credentials.h"
 #include <string.h>
 #include <time.h>
@@ -34,10 +33,22 @@ static esp_timer_handle_t s_reconnect_timer;
 static int s_backoff_ms = 1000;
 static SemaphoreHandle_t s_wifi_restart_mutex;
 
+// Fast-reconnect state. The BSSID/channel of the last association are
+// persisted so reconnects (including after a reboot) can attempt a directed
+// join first instead of paying for a full scan; after repeated failures the
+// pin is dropped and the normal scan path takes over (AP replaced, or the
+// node roamed out of range of the cached radio).
+#define WIFI_DIRECTED_JOIN_MAX_FAILS 2
+static wifi_config_t s_sta_cfg;
+static ul_wifi_ap_cache_t s_ap_cache;
+static bool s_ap_cache_valid;
+static bool s_directed_join;
+static int s_directed_fails;
+static bool s_immediate_retry_used;
+
 static ul_core_time_sync_cb_t s_time_sync_cb = NULL;
 static void *s_time_sync_ctx = NULL;
 
-static TaskHandle_t s_sntp_task;
 static esp_timer_handle_t s_sntp_retry_timer;
 static uint32_t s_sntp_retry_delay_ms = SNTP_RETRY_INITIAL_DELAY_MS;
 static uint32_t s_sntp_retry_attempts;
@@ -45,14 +56,14 @@ static uint64_t s_sntp_first_failure_us;
 static uint64_t s_sntp_last_failure_us;
 static portMUX_TYPE s_sntp_lock = portMUX_INITIALIZER_UNLOCKED;
 
-static BaseType_t ul_core_start_sntp_task(void);
-static void sntp_retry_timer_cb(void *arg);
+static void sntp_resync_timer_cb(void *arg);
 static void schedule_sntp_retry(uint32_t delay_ms);
 
 const char *ul_core_get_node_id(void) { return s_node_id; }
 
 static ul_core_conn_cb_t s_conn_cb = NULL;
 static void *s_conn_ctx = NULL;
+static esp_netif_t *s_sta_netif;
 
 void ul_core_register_connectivity_cb(ul_core_conn_cb_t cb, void *ctx) {
   s_conn_cb = cb;
@@ -87,24 +98,200 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
   if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
     s_backoff_ms = 1000;
     esp_wifi_connect();
+  } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+    wifi_event_sta_connected_t *event = (wifi_event_sta_connected_t *)event_data;
+    s_directed_fails = 0;
+    if (!s_ap_cache_valid ||
+        memcmp(s_ap_cache.bssid, event->bssid, sizeof(s_ap_cache.bssid)) != 0 ||
+        s_ap_cache.channel != event->channel) {
+      memcpy(s_ap_cache.bssid, event->bssid, sizeof(s_ap_cache.bssid));
+      s_ap_cache.channel = event->channel;
+      s_ap_cache_valid = true;
+      ul_wifi_ap_cache_save(&s_ap_cache);
+    }
   } else if (event_base == WIFI_EVENT &&
              event_id == WIFI_EVENT_STA_DISCONNECTED) {
     xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
     if (s_conn_cb)
       s_conn_cb(false, s_conn_ctx);
     xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
+    if (s_directed_join && ++s_directed_fails >= WIFI_DIRECTED_JOIN_MAX_FAILS) {
+      // The cached AP is not answering; drop the pin so the next attempt
+      // runs a full scan and can associate with whatever is actually there.
+      ESP_LOGW(TAG, "Directed join failed %d times; falling back to scan",
+               s_directed_fails);
+      s_directed_join = false;
+      s_sta_cfg.sta.bssid_set = false;
+      s_sta_cfg.sta.channel = 0;
+      esp_wifi_set_config(WIFI_IF_STA, &s_sta_cfg);
+    }
+    uint64_t delay_us = (uint64_t)s_backoff_ms * 1000;
+    if (!s_immediate_retry_used) {
+      // A momentary AP restart usually comes back within the beacon
+      // interval; one zero-backoff retry recovers those blips in hundreds
+      // of milliseconds before the exponential schedule engages.
+      s_immediate_retry_used = true;
+      delay_us = 0;
+    }
     esp_timer_stop(s_reconnect_timer);
-    esp_timer_start_once(s_reconnect_timer, s_backoff_ms * 1000);
+    esp_timer_start_once(s_reconnect_timer, delay_us);
   } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
     ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
     ESP_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
     s_backoff_ms = 1000;
+    s_immediate_retry_used = false;
     xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
     if (s_conn_cb)
       s_conn_cb(true, s_conn_ctx);
   }
 }
 
+// ---------------------------------------------------------------------------
+// Wi-Fi power policy
+//
+// Modem sleep trades command latency for radio duty cycle: the station only
+// listens for beacons, so a command published while asleep sits on the broker
+// until the next listen window. Three tiers keep that bounded:
+//   - full power for a hold window after any command or motion event, so a
+//     burst of interaction never pays the wakeup latency twice;
+//   - default DTIM modem sleep while any white/RGB animation is running (the
+//     LEDs dwarf what a longer listen interval would save);
+//   - a long listen interval, derived from the configured latency bound, once
+//     the animation scheduler reports every output static.
+// WS2812 strips render at a fixed rate and are not consulted; the latency
+// bound holds regardless of what the pixels are doing.
+
+#if CONFIG_UL_POWER_SAVE_ENABLE
+
+// Nominal AP beacon spacing used to turn the latency bound into a listen
+// interval; essentially every consumer AP beacons at 100 ms.
+#define POWER_BEACON_INTERVAL_MS 100
+
+static esp_timer_handle_t s_power_hold_timer;
+static bool s_power_wifi_up;
+static bool s_power_hold_active;
+static bool s_power_animations_idle;
+static int s_power_mode = -1; // last mode handed to esp_wifi_set_ps()
+
+static void power_apply(void) {
+  if (!s_power_wifi_up)
+    return;
+  wifi_ps_type_t mode;
+  if (s_power_hold_active)
+    mode = WIFI_PS_NONE;
+  else if (s_power_animations_idle)
+    mode = WIFI_PS_MAX_MODEM;
+  else
+    mode = WIFI_PS_MIN_MODEM;
+  if ((int)mode == s_power_mode)
+    return;
+  esp_err_t err = esp_wifi_set_ps(mode);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "esp_wifi_set_ps(%d) failed: %s", (int)mode,
+             esp_err_to_name(err));
+    return;
+  }
+  s_power_mode = (int)mode;
+  ESP_LOGD(TAG, "Power mode -> %s",
+           mode == WIFI_PS_NONE        ? "full"
+           : mode == WIFI_PS_MIN_MODEM ? "modem (DTIM)"
+                                       : "modem (long listen)");
+}
+
+static void power_hold_timer_cb(void *arg) {
+  (void)arg;
+  s_power_hold_active = false;
+  power_apply();
+}
+
+static void power_wifi_started(void) {
+  if (!s_power_hold_timer) {
+    const esp_timer_create_args_t hold_timer_args = {
+        .callback = &power_hold_timer_cb,
+        .name = "pwr_hold",
+    };
+    if (esp_timer_create(&hold_timer_args, &s_power_hold_timer) != ESP_OK) {
+      // Without the timer a hold would never expire; leave the policy at
+      // full power rather than risk sticking in modem sleep.
+      ESP_LOGW(TAG, "Failed to create power hold timer; staying at full power");
+    }
+  }
+  s_power_wifi_up = true;
+  s_power_mode = -1;
+  // The first connect, subscriptions and retained-state exchange run at
+  // full power; the hold timer re-engages modem sleep once the boot burst
+  // settles.
+  ul_core_power_note_activity();
+}
+
+static void power_wifi_stopped(void) {
+  s_power_wifi_up = false;
+  s_power_hold_active = false;
+  s_power_mode = -1;
+  if (s_power_hold_timer)
+    esp_timer_stop(s_power_hold_timer);
+}
+
+void ul_core_power_note_activity(void) {
+  s_power_hold_active = true;
+  if (s_power_hold_timer) {
+    esp_timer_stop(s_power_hold_timer);
+    esp_timer_start_once(s_power_hold_timer,
+                         (uint64_t)CONFIG_UL_POWER_ACTIVE_HOLD_S * 1000000ULL);
+  }
+  power_apply();
+}
+
+void ul_core_power_set_animations_idle(bool idle) {
+  if (idle == s_power_animations_idle)
+    return;
+  s_power_animations_idle = idle;
+  power_apply();
+}
+
+#else // !CONFIG_UL_POWER_SAVE_ENABLE
+
+static void power_wifi_started(void) {}
+static void power_wifi_stopped(void) {}
+void ul_core_power_note_activity(void) {}
+void ul_core_power_set_animations_idle(bool idle) { (void)idle; }
+
+#endif // CONFIG_UL_POWER_SAVE_ENABLE
+
+#if CONFIG_UL_STATIC_IP
+// Fixed addressing skips the DHCP exchange entirely: lwIP is usable the
+// moment the association completes, which removes the largest variable chunk
+// of the reconnect window on consumer routers. A malformed config falls back
+// to DHCP rather than leaving the node unreachable.
+static void apply_static_ip(esp_netif_t *netif) {
+  esp_netif_ip_info_t ip_info = {0};
+  if (esp_netif_str_to_ip4(CONFIG_UL_STATIC_IP_ADDR, &ip_info.ip) != ESP_OK ||
+      esp_netif_str_to_ip4(CONFIG_UL_STATIC_IP_GATEWAY, &ip_info.gw) !=
+          ESP_OK ||
+      esp_netif_str_to_ip4(CONFIG_UL_STATIC_IP_NETMASK, &ip_info.netmask) !=
+          ESP_OK) {
+    ESP_LOGE(TAG, "Invalid static IP configuration; falling back to DHCP");
+    return;
+  }
+  esp_netif_dhcpc_stop(netif);
+  esp_err_t err = esp_netif_set_ip_info(netif, &ip_info);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to apply static IP: %s", esp_err_to_name(err));
+    esp_netif_dhcpc_start(netif);
+    return;
+  }
+  esp_netif_dns_info_t dns = {0};
+  dns.ip.type = ESP_IPADDR_TYPE_V4;
+  if (esp_netif_str_to_ip4(CONFIG_UL_STATIC_IP_DNS, &dns.ip.u_addr.ip4) !=
+      ESP_OK) {
+    dns.ip.u_addr.ip4 = ip_info.gw; // unset or malformed: resolve via gateway
+  }
+  esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns);
+  ESP_LOGI(TAG, "Static IP " IPSTR " configured; DHCP disabled",
+           IP2STR(&ip_info.ip));
+}
+#endif // CONFIG_UL_STATIC_IP
+
 void ul_core_wifi_start(void) {
   EventGroupHandle_t event_group = xEventGroupCreate();
   if (!event_group) {
@@ -136,32 +323,62 @@ void ul_core_wifi_start(void) {
   };
   ESP_ERROR_CHECK(esp_timer_create(&reconnect_timer_args, &s_reconnect_timer));
 
-  esp_netif_create_default_wifi_sta();
+  s_sta_netif = esp_netif_create_default_wifi_sta();
   wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
   ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
+#if CONFIG_UL_STATIC_IP
+  apply_static_ip(s_sta_netif);
+#endif
+
   ul_wifi_credentials_t creds = {0};
   if (!ul_wifi_credentials_load(&creds)) {
     ESP_LOGE(TAG, "No stored Wi-Fi credentials; cannot start station");
     return;
   }
 
-  wifi_config_t sta_cfg = {0};
-  strlcpy((char *)sta_cfg.sta.ssid, creds.ssid, sizeof(sta_cfg.sta.ssid));
-  strlcpy((char *)sta_cfg.sta.password, creds.password, sizeof(sta_cfg.sta.password));
-  sta_cfg.sta.threshold.authmode =
+  memset(&s_sta_cfg, 0, sizeof(s_sta_cfg));
+  strlcpy((char *)s_sta_cfg.sta.ssid, creds.ssid, sizeof(s_sta_cfg.sta.ssid));
+  strlcpy((char *)s_sta_cfg.sta.password, creds.password, sizeof(s_sta_cfg.sta.password));
+  s_sta_cfg.sta.threshold.authmode =
       (creds.password[0] != '\0') ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
 
+#if CONFIG_UL_POWER_SAVE_ENABLE
+  // Listen interval for deep modem sleep, in beacon intervals. Only
+  // consulted under WIFI_PS_MAX_MODEM; derived from the latency bound so a
+  // command never waits longer than configured for a listen window.
+  s_sta_cfg.sta.listen_interval =
+      (CONFIG_UL_POWER_CMD_LATENCY_MS + POWER_BEACON_INTERVAL_MS - 1) /
+      POWER_BEACON_INTERVAL_MS;
+#endif
+
+  s_ap_cache_valid = ul_wifi_ap_cache_load(&s_ap_cache);
+  s_directed_join = s_ap_cache_valid;
+  s_directed_fails = 0;
+  s_immediate_retry_used = false;
+  if (s_directed_join) {
+    // Pin the first attempts to the last known AP so the join skips the
+    // scan entirely; the disconnect handler drops the pin if it fails.
+    memcpy(s_sta_cfg.sta.bssid, s_ap_cache.bssid, sizeof(s_sta_cfg.sta.bssid));
+    s_sta_cfg.sta.bssid_set = true;
+    s_sta_cfg.sta.channel = s_ap_cache.channel;
+    ESP_LOGI(TAG, "Attempting directed join on channel %u", s_ap_cache.channel);
+  }
+
   ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_START,
                                              &wifi_event_handler, NULL));
+  ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED,
+                                             &wifi_event_handler, NULL));
   ESP_ERROR_CHECK(esp_event_handler_register(
       WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &wifi_event_handler, NULL));
   ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
                                              &wifi_event_handler, NULL));
 
   ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-  ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &sta_cfg));
+  ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &s_sta_cfg));
   ESP_ERROR_CHECK(esp_wifi_start());
+
+  power_wifi_started();
 }
 
 bool ul_core_wait_for_ip(TickType_t timeout) {
@@ -195,6 +412,8 @@ bool ul_core_is_connected(void) {
 }
 
 void ul_core_wifi_stop(void) {
+  power_wifi_stopped();
+
   if (s_reconnect_timer) {
     esp_timer_stop(s_reconnect_timer);
     esp_timer_delete(s_reconnect_timer);
@@ -207,6 +426,8 @@ void ul_core_wifi_stop(void) {
 
   ESP_ERROR_CHECK(esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_START,
                                                &wifi_event_handler));
+  ESP_ERROR_CHECK(esp_event_handler_unregister(
+      WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &wifi_event_handler));
   ESP_ERROR_CHECK(esp_event_handler_unregister(
       WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &wifi_event_handler));
   ESP_ERROR_CHECK(esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP,
@@ -243,23 +464,103 @@ void ul_core_wifi_restart(void) {
   xSemaphoreGive(s_wifi_restart_mutex);
 }
 
-static void sntp_sync_task(void *arg) {
-  const TickType_t interval =
-      pdMS_TO_TICKS(CONFIG_UL_SNTP_SYNC_INTERVAL_S * 1000);
-  while (1) {
-    vTaskDelay(interval);
-    while (!ul_core_is_connected()) {
-      vTaskDelay(pdMS_TO_TICKS(1000));
-    }
-    esp_sntp_stop();
-    esp_err_t err = esp_netif_sntp_start();
-    if (err != ESP_OK) {
-      ESP_LOGW(TAG, "SNTP resync failed: %s", esp_err_to_name(err));
+// ---------------------------------------------------------------------------
+// Adaptive SNTP resync
+//
+// Steady-state resync is driven by the one-shot retry timer rather than a
+// dedicated task, saving a persistent stack on RAM-tight C3 nodes. Each
+// completed sync measures how far the local clock drifted since the
+// previous one and picks the next interval so the expected accumulated
+// drift stays near SNTP_DRIFT_TARGET_MS: stable crystals stretch toward
+// hours between radio wakeups, poor ones shrink toward the minimum.
+
+#define SNTP_RESYNC_MIN_INTERVAL_S 300
+#define SNTP_RESYNC_MAX_INTERVAL_S (24 * 3600)
+#define SNTP_DRIFT_TARGET_MS 50
+#define SNTP_OFFLINE_RETRY_MS 30000
+
+static uint64_t s_sntp_last_sync_epoch_us;
+static uint64_t s_sntp_last_sync_mono_us;
+static uint32_t s_sntp_interval_s = CONFIG_UL_SNTP_SYNC_INTERVAL_S;
+
+static void sntp_resync_timer_cb(void *arg) {
+  (void)arg;
+  if (!ul_core_is_connected()) {
+    schedule_sntp_retry(SNTP_OFFLINE_RETRY_MS);
+    return;
+  }
+  esp_sntp_stop();
+  esp_err_t err = esp_netif_sntp_start();
+  if (err != ESP_OK) {
+    uint64_t now_us = esp_timer_get_time();
+    uint32_t attempt;
+    uint32_t delay_ms;
+    portENTER_CRITICAL(&s_sntp_lock);
+    if (s_sntp_retry_attempts == 0)
+      s_sntp_first_failure_us = now_us;
+    if (s_sntp_retry_attempts < UINT32_MAX)
+      s_sntp_retry_attempts++;
+    attempt = s_sntp_retry_attempts;
+    s_sntp_last_failure_us = now_us;
+    delay_ms = s_sntp_retry_delay_ms;
+    if (s_sntp_retry_delay_ms < SNTP_RETRY_MAX_DELAY_MS) {
+      uint32_t next_delay = s_sntp_retry_delay_ms * 2;
+      if (next_delay > SNTP_RETRY_MAX_DELAY_MS)
+        next_delay = SNTP_RETRY_MAX_DELAY_MS;
+      s_sntp_retry_delay_ms = next_delay;
     }
+    portEXIT_CRITICAL(&s_sntp_lock);
+    ESP_LOGW(TAG, "SNTP resync failed (attempt %u): %s. Retrying in %u ms",
+             (unsigned)attempt, esp_err_to_name(err), (unsigned)delay_ms);
+    schedule_sntp_retry(delay_ms);
+    return;
   }
+  portENTER_CRITICAL(&s_sntp_lock);
+  s_sntp_retry_attempts = 0;
+  s_sntp_retry_delay_ms = SNTP_RETRY_INITIAL_DELAY_MS;
+  portEXIT_CRITICAL(&s_sntp_lock);
+  // If the server never answers, no sync notification fires; fall back to
+  // the current interval so the schedule cannot stall.
+  schedule_sntp_retry(s_sntp_interval_s * 1000);
 }
 
 static void sntp_time_sync_notification_cb(struct timeval *tv) {
+  uint64_t mono_us = (uint64_t)esp_timer_get_time();
+  uint64_t epoch_us =
+      (uint64_t)tv->tv_sec * 1000000ULL + (uint64_t)tv->tv_usec;
+  uint64_t prev_epoch_us;
+  uint64_t prev_mono_us;
+  portENTER_CRITICAL(&s_sntp_lock);
+  prev_epoch_us = s_sntp_last_sync_epoch_us;
+  prev_mono_us = s_sntp_last_sync_mono_us;
+  s_sntp_last_sync_epoch_us = epoch_us;
+  s_sntp_last_sync_mono_us = mono_us;
+  portEXIT_CRITICAL(&s_sntp_lock);
+
+  if (prev_epoch_us != 0 && mono_us > prev_mono_us) {
+    uint64_t elapsed_us = mono_us - prev_mono_us;
+    int64_t drift_us = (int64_t)(epoch_us - (prev_epoch_us + elapsed_us));
+    uint64_t drift_abs_us = (uint64_t)(drift_us < 0 ? -drift_us : drift_us);
+    uint32_t next_s;
+    if (drift_abs_us == 0) {
+      next_s = s_sntp_interval_s * 2;
+    } else {
+      // Interval at which the measured drift rate accumulates the target.
+      uint64_t next_us =
+          (uint64_t)SNTP_DRIFT_TARGET_MS * 1000ULL * elapsed_us / drift_abs_us;
+      next_s = (uint32_t)(next_us / 1000000ULL);
+    }
+    if (next_s < SNTP_RESYNC_MIN_INTERVAL_S)
+      next_s = SNTP_RESYNC_MIN_INTERVAL_S;
+    if (next_s > SNTP_RESYNC_MAX_INTERVAL_S)
+      next_s = SNTP_RESYNC_MAX_INTERVAL_S;
+    ESP_LOGI(TAG, "SNTP drift %lld us over %llu s; next resync in %u s",
+             (long long)drift_us, (unsigned long long)(elapsed_us / 1000000ULL),
+             (unsigned)next_s);
+    s_sntp_interval_s = next_s;
+    schedule_sntp_retry(next_s * 1000);
+  }
+
   if (s_time_sync_cb)
     s_time_sync_cb(s_time_sync_ctx);
 }
@@ -294,78 +595,25 @@ void ul_core_sntp_start(void) {
     s_time_sync_cb(s_time_sync_ctx);
   if (!s_sntp_retry_timer) {
     const esp_timer_create_args_t retry_args = {
-        .callback = &sntp_retry_timer_cb,
-        .name = "sntp_retry",
+        .callback = &sntp_resync_timer_cb,
+        .name = "sntp_resync",
     };
     esp_err_t timer_err = esp_timer_create(&retry_args, &s_sntp_retry_timer);
     if (timer_err != ESP_OK) {
-      ESP_LOGE(TAG, "Failed to create SNTP retry timer: %s",
+      ESP_LOGE(TAG, "Failed to create SNTP resync timer: %s",
                esp_err_to_name(timer_err));
     }
   }
 
   portENTER_CRITICAL(&s_sntp_lock);
   s_sntp_retry_delay_ms = SNTP_RETRY_INITIAL_DELAY_MS;
+  s_sntp_retry_attempts = 0;
+  s_sntp_first_failure_us = 0;
+  s_sntp_last_failure_us = 0;
   portEXIT_CRITICAL(&s_sntp_lock);
 
-  if (ul_core_start_sntp_task() != pdPASS) {
-    ESP_LOGW(TAG, "SNTP resync task creation deferred; retry scheduled");
-  }
-}
-
-static BaseType_t ul_core_start_sntp_task(void) {
-  TaskHandle_t existing;
-  portENTER_CRITICAL(&s_sntp_lock);
-  existing = s_sntp_task;
-  portEXIT_CRITICAL(&s_sntp_lock);
-  if (existing)
-    return pdPASS;
-
-  TaskHandle_t task_handle = NULL;
-  BaseType_t rc = ul_task_create(sntp_sync_task, "sntp_sync", 2048, NULL,
-                                 tskIDLE_PRIORITY, &task_handle, 0);
-  if (rc == pdPASS) {
-    portENTER_CRITICAL(&s_sntp_lock);
-    s_sntp_task = task_handle;
-    s_sntp_retry_attempts = 0;
-    s_sntp_first_failure_us = 0;
-    s_sntp_last_failure_us = 0;
-    s_sntp_retry_delay_ms = SNTP_RETRY_INITIAL_DELAY_MS;
-    portEXIT_CRITICAL(&s_sntp_lock);
-    if (s_sntp_retry_timer && esp_timer_is_active(s_sntp_retry_timer)) {
-      esp_timer_stop(s_sntp_retry_timer);
-    }
-    return rc;
-  }
-
-  uint64_t now_us = esp_timer_get_time();
-  uint32_t attempt;
-  uint32_t delay_ms;
-  portENTER_CRITICAL(&s_sntp_lock);
-  if (s_sntp_retry_attempts == 0)
-    s_sntp_first_failure_us = now_us;
-  if (s_sntp_retry_attempts < UINT32_MAX)
-    s_sntp_retry_attempts++;
-  attempt = s_sntp_retry_attempts;
-  s_sntp_last_failure_us = now_us;
-  delay_ms = s_sntp_retry_delay_ms;
-  if (s_sntp_retry_delay_ms < SNTP_RETRY_MAX_DELAY_MS) {
-    uint32_t next_delay = s_sntp_retry_delay_ms * 2;
-    if (next_delay > SNTP_RETRY_MAX_DELAY_MS)
-      next_delay = SNTP_RETRY_MAX_DELAY_MS;
-    s_sntp_retry_delay_ms = next_delay;
-  }
-  portEXIT_CRITICAL(&s_sntp_lock);
-
-  ESP_LOGE(TAG, "Failed to start SNTP resync task (attempt %u): %ld. Retrying in %u ms",
-           (unsigned)attempt, (long)rc, (unsigned)delay_ms);
-  schedule_sntp_retry(delay_ms);
-  return rc;
-}
-
-static void sntp_retry_timer_cb(void *arg) {
-  (void)arg;
-  ul_core_start_sntp_task();
+  schedule_sntp_retry(s_sntp_interval_s * 1000);
+  ESP_LOGI(TAG, "SNTP resync scheduled in %u s", (unsigned)s_sntp_interval_s);
 }
 
 static void schedule_sntp_retry(uint32_t delay_ms) {
@@ -384,11 +632,9 @@ static void schedule_sntp_retry(uint32_t delay_ms) {
 }
 
 bool ul_core_is_sntp_resync_active(void) {
-  bool active;
-  portENTER_CRITICAL(&s_sntp_lock);
-  active = s_sntp_task != NULL;
-  portEXIT_CRITICAL(&s_sntp_lock);
-  return active;
+  // The resync machinery is alive as long as its timer exists; failures of
+  // individual resync attempts are reported through the retry counters.
+  return s_sntp_retry_timer != NULL;
 }
 
 uint32_t ul_core_get_sntp_retry_attempts(void) {
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cJSON cJSON;
+
+// On-device time-of-day scheduler. Daily behavior (porch lights at dusk, a
+// 20% night mode) runs from cron-like entries the node evaluates locally
+// against the SNTP-synced clock, so routine scene changes survive broker
+// outages and never cross the network:
+//
+//   {"entries": [
+//     {"hour": 19, "minute": 30, "days": 127,
+//      "ws": [{"strip": 0, "effect": "solid", ...}]},
+//     {"hour": 23, "minute": 0,
+//      "white": [{"channel": 0, "brightness": 50}]}]}
+//
+// "days" is a bitmask, bit 0 = Sunday (matching tm_wday); omitted means every
+// day. The per-engine arrays use the scene/set entry schema and the applied
+// state is recorded through ul_state exactly as a server-sent scene would be,
+// so a reboot restores whatever the schedule last selected.
+
+// Parse a cron/set payload and replace the active schedule. An empty
+// "entries" array clears it. Returns false on a malformed payload. Does not
+// persist the payload; the MQTT route records the raw blob via ul_state.
+bool ul_cron_apply_json(cJSON* root);
+
+// Load the persisted schedule from ul_state and begin evaluating it. Called
+// once at boot after the engines are up; entries only fire after SNTP has
+// synced the clock.
+void ul_cron_start(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,216 @@
+#include "ul_cron.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "ul_sched.h"
+#include "ul_state.h"
+#include "ul_ws_engine.h"
+#include "ul_rgb_engine.h"
+#include "ul_white_engine.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Entries are evaluated from the shared animation scheduler. The step
+// callback sleeps until the next entry's minute (capped, so an SNTP clock
+// step never strands it mid-sleep) and portMAX_DELAY with no schedule, so
+// an unconfigured node pays nothing.
+
+#define UL_CRON_MAX_ENTRIES 16
+
+// Before the first SNTP sync the clock sits near the epoch; don't evaluate
+// entries against it, just poll until it looks like wall time.
+#define UL_CRON_MIN_VALID_EPOCH 1600000000  // 2020-09-13
+#define UL_CRON_UNSYNCED_RETRY_MS 30000
+
+// Longest single sleep. An SNTP resync can step the clock while we sleep;
+// re-checking every few minutes bounds how far a step can push an entry
+// past its minute, and the grace window below then still catches it.
+#define UL_CRON_MAX_SLEEP_MS (5 * 60 * 1000)
+#define UL_CRON_LATE_GRACE_MIN 10
+
+#define UL_CRON_ALL_DAYS 0x7f  // bit 0 = Sunday, matching tm_wday
+
+static const char* TAG = "ul_cron";
+
+typedef struct {
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t days;     // bitmask, bit 0 = Sunday
+    int last_fired;   // tm_yday * 1440 + minute-of-day, -1 = never
+    cJSON* actions;   // scene-shaped sections: {"ws":[...],"rgb":[...],...}
+} cron_entry_t;
+
+static cron_entry_t s_entries[UL_CRON_MAX_ENTRIES];
+static int s_entry_count = 0;
+static bool s_registered = false;  // sched slot stays claimed once taken
+static SemaphoreHandle_t s_lock = NULL;  // MQTT task vs. scheduler task
+
+static void free_entries(void) {
+    for (int i = 0; i < s_entry_count; ++i) {
+        cJSON_Delete(s_entries[i].actions);
+        s_entries[i].actions = NULL;
+    }
+    s_entry_count = 0;
+}
+
+// Persist one applied entry the same way a standalone set command would be,
+// so the strip comes back in the scheduled scene after a reboot.
+static void record_applied(cJSON* entry, const char* index_field,
+                           void (*record)(int, const char*, size_t)) {
+    int index = 0;
+    cJSON* jidx = cJSON_GetObjectItem(entry, index_field);
+    if (jidx && cJSON_IsNumber(jidx)) index = jidx->valueint;
+    char* json = cJSON_PrintUnformatted(entry);
+    if (json) {
+        record(index, json, strlen(json));
+        cJSON_free(json);
+    }
+}
+
+static void apply_section(cJSON* actions, const char* engine,
+                          const char* index_field, void (*apply)(cJSON*),
+                          void (*record)(int, const char*, size_t)) {
+    cJSON* sec = cJSON_GetObjectItem(actions, engine);
+    if (!cJSON_IsArray(sec)) return;
+    cJSON* entry;
+    cJSON_ArrayForEach(entry, sec) {
+        if (!cJSON_IsObject(entry)) continue;
+        apply(entry);
+        record_applied(entry, index_field, record);
+    }
+}
+
+static void fire_entry(cron_entry_t* e) {
+    ESP_LOGI(TAG, "Firing %02u:%02u entry", e->hour, e->minute);
+    apply_section(e->actions, "ws", "strip", ul_ws_apply_json,
+                  ul_state_record_ws);
+    apply_section(e->actions, "rgb", "strip", ul_rgb_apply_json,
+                  ul_state_record_rgb);
+    apply_section(e->actions, "white", "channel", ul_white_apply_json,
+                  ul_state_record_white);
+}
+
+static TickType_t cron_step(void* ctx) {
+    (void)ctx;
+    time_t now = time(NULL);
+    if (now < UL_CRON_MIN_VALID_EPOCH) {
+        return pdMS_TO_TICKS(UL_CRON_UNSYNCED_RETRY_MS);
+    }
+    struct tm tm;
+    localtime_r(&now, &tm);
+    int day_min = tm.tm_hour * 60 + tm.tm_min;
+
+    TickType_t wait = portMAX_DELAY;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int soonest_min = -1;
+    for (int i = 0; i < s_entry_count; ++i) {
+        cron_entry_t* e = &s_entries[i];
+        int e_min = (int)e->hour * 60 + (int)e->minute;
+
+        // Fire on the entry's minute, with a grace window so a capped sleep
+        // or a clock step landing us a little late doesn't skip the entry.
+        // The stamp keeps one firing per scheduled minute.
+        if ((e->days & (1u << tm.tm_wday)) && day_min >= e_min &&
+            day_min - e_min < UL_CRON_LATE_GRACE_MIN &&
+            e->last_fired != tm.tm_yday * 1440 + e_min) {
+            e->last_fired = tm.tm_yday * 1440 + e_min;
+            fire_entry(e);
+        }
+
+        // Minutes until this entry's next firing, scanning the week ahead.
+        for (int d = 0; d < 7; ++d) {
+            if (!(e->days & (1u << ((tm.tm_wday + d) % 7)))) continue;
+            int t = d * 1440 + e_min - day_min;
+            if (t <= 0) t += 7 * 1440;
+            if (soonest_min < 0 || t < soonest_min) soonest_min = t;
+        }
+    }
+    xSemaphoreGive(s_lock);
+
+    if (soonest_min > 0) {
+        int64_t ms = (int64_t)soonest_min * 60000 - (int64_t)tm.tm_sec * 1000;
+        if (ms < 1000) ms = 1000;
+        if (ms > UL_CRON_MAX_SLEEP_MS) ms = UL_CRON_MAX_SLEEP_MS;
+        wait = pdMS_TO_TICKS((uint32_t)ms);
+    }
+    return wait;
+}
+
+bool ul_cron_apply_json(cJSON* root) {
+    if (!root) return false;
+    cJSON* jentries = cJSON_GetObjectItem(root, "entries");
+    if (!cJSON_IsArray(jentries)) return false;
+
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+        if (!s_lock) return false;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    free_entries();
+
+    cJSON* jentry;
+    cJSON_ArrayForEach(jentry, jentries) {
+        if (!cJSON_IsObject(jentry)) continue;
+        cJSON* jh = cJSON_GetObjectItem(jentry, "hour");
+        cJSON* jm = cJSON_GetObjectItem(jentry, "minute");
+        if (!jh || !cJSON_IsNumber(jh) || jh->valueint < 0 ||
+            jh->valueint > 23 || !jm || !cJSON_IsNumber(jm) ||
+            jm->valueint < 0 || jm->valueint > 59) {
+            ESP_LOGW(TAG, "Dropping entry without a valid hour/minute");
+            continue;
+        }
+        if (s_entry_count >= UL_CRON_MAX_ENTRIES) {
+            ESP_LOGW(TAG, "Entry limit (%d) reached; dropping the rest",
+                     UL_CRON_MAX_ENTRIES);
+            break;
+        }
+        int days = UL_CRON_ALL_DAYS;
+        cJSON* jd = cJSON_GetObjectItem(jentry, "days");
+        if (jd && cJSON_IsNumber(jd)) days = jd->valueint & UL_CRON_ALL_DAYS;
+        cJSON* dup = cJSON_Duplicate(jentry, true);
+        if (!dup) {
+            ESP_LOGE(TAG, "Out of memory storing schedule");
+            break;
+        }
+        cron_entry_t* e = &s_entries[s_entry_count++];
+        e->hour = (uint8_t)jh->valueint;
+        e->minute = (uint8_t)jm->valueint;
+        e->days = (uint8_t)days;
+        e->last_fired = -1;
+        e->actions = dup;
+    }
+
+    bool have_entries = (s_entry_count > 0);
+    xSemaphoreGive(s_lock);
+
+    if (have_entries && !s_registered) {
+        s_registered = ul_sched_register(cron_step, NULL, "cron");
+        if (!s_registered) return false;
+    }
+    ul_sched_kick();  // re-plan the sleep around the new schedule
+    return true;
+}
+
+void ul_cron_start(void) {
+    char* payload = malloc(UL_STATE_MAX_JSON_LEN);
+    if (!payload) return;
+    if (ul_state_copy_cron(payload, UL_STATE_MAX_JSON_LEN)) {
+        cJSON* root = cJSON_Parse(payload);
+        if (root) {
+            if (ul_cron_apply_json(root)) {
+                ESP_LOGI(TAG, "Restored schedule with %d entries",
+                         s_entry_count);
+            }
+            cJSON_Delete(root);
+        } else {
+            ESP_LOGW(TAG, "Persisted schedule failed to parse; ignoring");
+        }
+    }
+    free(payload);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -12,10 +13,54 @@ typedef void (*ul_health_recovery_cb_t)(void *ctx);
 typedef struct {
   ul_health_recovery_cb_t request_wifi_recovery;
   ul_health_recovery_cb_t request_mqtt_recovery;
+  // Invoked once per monitor period so components can publish their
+  // telemetry counters. Optional.
+  ul_health_recovery_cb_t publish_metrics;
   void *ctx;
 } ul_health_config_t;
 
+// Per-capability heap sample taken once per monitor period. Largest-block
+// figures catch fragmentation that total-free numbers hide: a frame buffer
+// or TLS record allocation can fail while the totals still look healthy.
+typedef struct {
+  uint32_t internal_free;    // free bytes in the internal 8-bit heap
+  uint32_t internal_largest; // largest single internal allocation possible
+  uint32_t dma_largest;      // largest DMA-capable block
+  uint32_t spiram_free;      // zero on nodes without PSRAM
+  uint32_t spiram_largest;
+  uint32_t frag_strikes;     // consecutive checks below the block floor
+  // Dedicated mbedtls pool (zeros when UL_TLS_POOL is disabled). The
+  // low-water mark sizes the pool; fallbacks count TLS allocations that
+  // overflowed into the shared heap.
+  uint32_t tls_pool_free;
+  uint32_t tls_pool_min_free;
+  uint32_t tls_pool_largest;
+  uint32_t tls_fallbacks;
+} ul_health_heap_metrics_t;
+
+// Steady-state render health provider. The WS engine registers one at
+// start; the health task polls it once per monitor period. `overruns` is
+// the cumulative count of frames late by a full period, `degraded` the
+// number of strips currently paced below their configured frame rate.
+typedef void (*ul_health_render_stats_fn)(uint32_t *overruns, uint32_t *degraded);
+void ul_health_register_render_stats(ul_health_render_stats_fn fn);
+// Copy the most recent render sample (zeros until a provider reports).
+void ul_health_get_render_stats(uint32_t *overruns, uint32_t *degraded);
+
 void ul_health_start(const ul_health_config_t *config);
+// Copy the most recent heap sample. All zeros until the first monitor
+// period completes.
+void ul_health_get_heap_metrics(ul_health_heap_metrics_t *out);
+// Copy the most recent CPU utilization summary, e.g.
+// "idle=63,ws60fps=22,ul_mqtt=8" (idle share first, then the top consumers
+// over the last monitor period). Empty until two samples exist or when
+// CONFIG_UL_HEALTH_TASK_STATS is disabled.
+void ul_health_get_cpu_summary(char *out, size_t out_len);
+// Copy the most recent stack headroom summary from the ul_task registry,
+// e.g. "ws60fps=4832/6144,ul_state=2900/4096,pir=1500/2048" (the three
+// stacks with the most never-used bytes — the shrink candidates). Empty
+// until the first monitor period completes.
+void ul_health_get_stack_summary(char *out, size_t out_len);
 void ul_health_notify_connectivity(bool connected);
 void ul_health_notify_mqtt(bool connected);
 void ul_health_notify_time_sync(void);
@@ -1,15 +1,21 @@
 #include "ul_health.h"
 
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_timer.h"
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "ul_core.h"
 #include "ul_task.h"
+#include "ul_tls_pool.h"
+#include "ul_work.h"
 
 #include <inttypes.h>
 #include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define UL_HEALTH_MONITOR_PERIOD_MS (60 * 1000)
@@ -24,9 +30,14 @@
 #define UL_HEALTH_MQTT_MAX_RECOVERIES 6
 #define UL_HEALTH_HEAP_LOW_THRESHOLD (20 * 1024)
 #define UL_HEALTH_HEAP_LOW_STRIKES 5
+// Largest internal block below this means the next frame buffer or TLS
+// record allocation is at risk even when total free looks healthy.
+#define UL_HEALTH_FRAG_MIN_BLOCK (8 * 1024)
+#define UL_HEALTH_FRAG_STRIKES 5
 #define UL_HEALTH_TIME_SYNC_WARN_US (24ULL * 60ULL * 60ULL * 1000000ULL)
 #define UL_HEALTH_TIME_SYNC_ERROR_US (7ULL * 24ULL * 60ULL * 60ULL * 1000000ULL)
 #define UL_HEALTH_RGB_TASK_FAILURE_ESCALATE_ATTEMPTS 3
+#define UL_HEALTH_RENDER_DEGRADED_STRIKES 5
 
 static const char *TAG = "ul_health";
 
@@ -38,6 +49,7 @@ typedef struct {
   uint32_t wifi_recovery_attempts;
   uint32_t mqtt_recovery_attempts;
   uint32_t heap_low_strikes;
+  uint32_t frag_strikes;
   uint64_t wifi_last_change_us;
   uint64_t mqtt_last_change_us;
   uint64_t last_wifi_recovery_us;
@@ -50,6 +62,9 @@ typedef struct {
   uint32_t white_engine_failures;
   uint64_t white_first_failure_us;
   uint64_t white_last_failure_us;
+  uint32_t render_overruns; // cumulative, as last reported by the provider
+  uint32_t render_degraded; // strips below target FPS at the last sample
+  uint32_t render_degraded_strikes;
 } ul_health_state_t;
 
 static ul_health_state_t s_state;
@@ -65,6 +80,7 @@ static bool health_mark_wifi_recovery_attempt(uint64_t now_us, bool count_attemp
                                               uint32_t *attempt_out);
 static bool health_mark_mqtt_recovery_attempt(uint64_t now_us, uint32_t *attempt_out);
 static uint32_t health_update_heap_low(bool low);
+static uint32_t health_update_frag(bool fragmented);
 static void health_mark_metrics_logged(uint64_t now_us);
 static void health_time_sync_cb(void *ctx);
 
@@ -104,7 +120,8 @@ void ul_health_start(const ul_health_config_t *config) {
   ESP_LOGI(TAG, "Health monitor started (wifi %s)", wifi_now ? "up" : "down");
   ul_core_register_time_sync_cb(health_time_sync_cb, NULL);
 
-  if (ul_task_create(health_task, "ul_health", 4096, NULL, 4, &s_health_task, 0) != pdPASS) {
+  if (ul_task_create(health_task, "ul_health", 4096, NULL, 4, &s_health_task,
+                     UL_TASK_CORE_AUTO) != pdPASS) {
     ESP_LOGE(TAG, "Failed to start health task");
     portENTER_CRITICAL(&s_lock);
     memset(&s_state, 0, sizeof(s_state));
@@ -239,6 +256,48 @@ static void health_time_sync_cb(void *ctx) {
   ul_health_notify_time_sync();
 }
 
+static ul_health_render_stats_fn s_render_stats_fn;
+
+void ul_health_register_render_stats(ul_health_render_stats_fn fn) {
+  s_render_stats_fn = fn;
+}
+
+void ul_health_get_render_stats(uint32_t *overruns, uint32_t *degraded) {
+  portENTER_CRITICAL(&s_lock);
+  if (overruns)
+    *overruns = s_state.render_overruns;
+  if (degraded)
+    *degraded = s_state.render_degraded;
+  portEXIT_CRITICAL(&s_lock);
+}
+
+// Pull the latest render figures and run the degraded-strip strike logic.
+// Returns the overrun delta for this period through out parameters so the
+// caller can log it.
+static void health_check_render(uint32_t *overrun_delta_out,
+                                uint32_t *degraded_out, uint32_t *strikes_out) {
+  uint32_t overruns = 0;
+  uint32_t degraded = 0;
+  s_render_stats_fn(&overruns, &degraded);
+  uint32_t prev_overruns;
+  uint32_t strikes;
+  portENTER_CRITICAL(&s_lock);
+  prev_overruns = s_state.render_overruns;
+  s_state.render_overruns = overruns;
+  s_state.render_degraded = degraded;
+  if (degraded > 0) {
+    if (s_state.render_degraded_strikes < UINT32_MAX)
+      s_state.render_degraded_strikes++;
+  } else {
+    s_state.render_degraded_strikes = 0;
+  }
+  strikes = s_state.render_degraded_strikes;
+  portEXIT_CRITICAL(&s_lock);
+  *overrun_delta_out = overruns - prev_overruns;
+  *degraded_out = degraded;
+  *strikes_out = strikes;
+}
+
 static void health_take_snapshot(ul_health_state_t *state_out, ul_health_config_t *cfg_out) {
   portENTER_CRITICAL(&s_lock);
   *state_out = s_state;
@@ -260,6 +319,194 @@ static uint32_t health_update_heap_low(bool low) {
   return strikes;
 }
 
+static uint32_t health_update_frag(bool fragmented) {
+  uint32_t strikes;
+  portENTER_CRITICAL(&s_lock);
+  if (fragmented) {
+    if (s_state.frag_strikes < UINT32_MAX)
+      s_state.frag_strikes++;
+  } else {
+    s_state.frag_strikes = 0;
+  }
+  strikes = s_state.frag_strikes;
+  portEXIT_CRITICAL(&s_lock);
+  return strikes;
+}
+
+// ---------------------------------------------------------------------------
+// Per-task CPU sampling
+//
+// Runtime counters are sampled every monitor period and differenced against
+// the previous snapshot, so the percentages cover exactly one period and a
+// transient hog shows up in the cycle it happened. Counters and the total
+// are 32-bit microsecond values that wrap in ~71 minutes; unsigned
+// subtraction keeps the deltas correct as long as the period is shorter
+// than the wrap, which 60 s comfortably is. On dual-core parts each task is
+// measured against the same timebase, so the percentages sum toward 200.
+
+#if CONFIG_UL_HEALTH_TASK_STATS
+
+#define UL_HEALTH_TASK_STATS_MAX 24
+#define UL_HEALTH_CPU_TOP_N 3
+
+typedef struct {
+  TaskHandle_t handle;
+  uint32_t runtime;
+} task_runtime_t;
+
+static task_runtime_t s_prev_runtimes[UL_HEALTH_TASK_STATS_MAX];
+static UBaseType_t s_prev_runtime_count;
+static uint32_t s_prev_total_runtime;
+static char s_cpu_summary[64];
+
+static bool prev_runtime_lookup(TaskHandle_t handle, uint32_t *out_runtime) {
+  for (UBaseType_t i = 0; i < s_prev_runtime_count; ++i) {
+    if (s_prev_runtimes[i].handle == handle) {
+      *out_runtime = s_prev_runtimes[i].runtime;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void health_sample_cpu(void) {
+  TaskStatus_t *status = malloc(sizeof(TaskStatus_t) * UL_HEALTH_TASK_STATS_MAX);
+  if (!status)
+    return;
+  uint32_t total = 0;
+  UBaseType_t n = uxTaskGetSystemState(status, UL_HEALTH_TASK_STATS_MAX, &total);
+  uint32_t total_delta = total - s_prev_total_runtime;
+  if (n > 0 && s_prev_total_runtime != 0 && total_delta > 0) {
+    const char *top_name[UL_HEALTH_CPU_TOP_N] = {0};
+    uint32_t top_pct[UL_HEALTH_CPU_TOP_N] = {0};
+    uint32_t idle_pct = 0;
+    for (UBaseType_t i = 0; i < n; ++i) {
+      uint32_t prev;
+      if (!prev_runtime_lookup(status[i].xHandle, &prev))
+        continue; // new since last sample; counted next cycle
+      uint32_t delta = status[i].ulRunTimeCounter - prev;
+      uint32_t pct = (uint32_t)(((uint64_t)delta * 100ULL) / total_delta);
+      if (strncmp(status[i].pcTaskName, "IDLE", 4) == 0) {
+        idle_pct += pct;
+        continue;
+      }
+      for (int slot = 0; slot < UL_HEALTH_CPU_TOP_N; ++slot) {
+        if (pct > top_pct[slot]) {
+          for (int k = UL_HEALTH_CPU_TOP_N - 1; k > slot; --k) {
+            top_pct[k] = top_pct[k - 1];
+            top_name[k] = top_name[k - 1];
+          }
+          top_pct[slot] = pct;
+          top_name[slot] = status[i].pcTaskName;
+          break;
+        }
+      }
+    }
+    char summary[sizeof(s_cpu_summary)];
+    int off = snprintf(summary, sizeof(summary), "idle=%u", idle_pct);
+    for (int slot = 0; slot < UL_HEALTH_CPU_TOP_N && top_name[slot]; ++slot) {
+      if (off >= (int)sizeof(summary))
+        break;
+      off += snprintf(summary + off, sizeof(summary) - off, ",%s=%u",
+                      top_name[slot], top_pct[slot]);
+    }
+    portENTER_CRITICAL(&s_lock);
+    strlcpy(s_cpu_summary, summary, sizeof(s_cpu_summary));
+    portEXIT_CRITICAL(&s_lock);
+  }
+  for (UBaseType_t i = 0; i < n; ++i) {
+    s_prev_runtimes[i].handle = status[i].xHandle;
+    s_prev_runtimes[i].runtime = status[i].ulRunTimeCounter;
+  }
+  s_prev_runtime_count = n;
+  s_prev_total_runtime = total;
+  free(status);
+}
+
+#endif // CONFIG_UL_HEALTH_TASK_STATS
+
+void ul_health_get_cpu_summary(char *out, size_t out_len) {
+  if (!out || out_len == 0)
+    return;
+#if CONFIG_UL_HEALTH_TASK_STATS
+  portENTER_CRITICAL(&s_lock);
+  strlcpy(out, s_cpu_summary, out_len);
+  portEXIT_CRITICAL(&s_lock);
+#else
+  out[0] = '\0';
+#endif
+}
+
+// Stack headroom summary from the ul_task registry: the three most
+// over-provisioned stacks as "name=hwm/depth" (bytes never used vs. bytes
+// allocated) — the shrink candidates. A task that dips under the low-water
+// threshold gets a warning instead; that one needs growing, not shrinking.
+#define UL_HEALTH_STACK_TOP_N 3
+#define UL_HEALTH_STACK_LOW_BYTES 256
+
+static char s_stack_summary[96];
+
+static void health_sample_stacks(void) {
+  ul_task_stack_info_t info[16];
+  size_t n = ul_task_sample_stacks(info, sizeof(info) / sizeof(info[0]));
+  if (n == 0)
+    return;
+  const ul_task_stack_info_t *top[UL_HEALTH_STACK_TOP_N] = {0};
+  for (size_t i = 0; i < n; ++i) {
+    if (info[i].stack_hwm_bytes < UL_HEALTH_STACK_LOW_BYTES) {
+      ESP_LOGW(TAG, "Task %s stack low: %u of %u bytes never used",
+               info[i].name, (unsigned)info[i].stack_hwm_bytes,
+               (unsigned)info[i].stack_depth);
+    }
+    for (int slot = 0; slot < UL_HEALTH_STACK_TOP_N; ++slot) {
+      if (!top[slot] || info[i].stack_hwm_bytes > top[slot]->stack_hwm_bytes) {
+        for (int k = UL_HEALTH_STACK_TOP_N - 1; k > slot; --k)
+          top[k] = top[k - 1];
+        top[slot] = &info[i];
+        break;
+      }
+    }
+  }
+  char summary[sizeof(s_stack_summary)];
+  summary[0] = '\0';
+  int off = 0;
+  for (int slot = 0; slot < UL_HEALTH_STACK_TOP_N && top[slot]; ++slot) {
+    if (off >= (int)sizeof(summary))
+      break;
+    off += snprintf(summary + off, sizeof(summary) - off, "%s%s=%u/%u",
+                    off ? "," : "", top[slot]->name,
+                    (unsigned)top[slot]->stack_hwm_bytes,
+                    (unsigned)top[slot]->stack_depth);
+  }
+  portENTER_CRITICAL(&s_lock);
+  strlcpy(s_stack_summary, summary, sizeof(s_stack_summary));
+  portEXIT_CRITICAL(&s_lock);
+}
+
+void ul_health_get_stack_summary(char *out, size_t out_len) {
+  if (!out || out_len == 0)
+    return;
+  portENTER_CRITICAL(&s_lock);
+  strlcpy(out, s_stack_summary, out_len);
+  portEXIT_CRITICAL(&s_lock);
+}
+
+static ul_health_heap_metrics_t s_heap_metrics;
+
+static void health_store_heap_metrics(const ul_health_heap_metrics_t *metrics) {
+  portENTER_CRITICAL(&s_lock);
+  s_heap_metrics = *metrics;
+  portEXIT_CRITICAL(&s_lock);
+}
+
+void ul_health_get_heap_metrics(ul_health_heap_metrics_t *out) {
+  if (!out)
+    return;
+  portENTER_CRITICAL(&s_lock);
+  *out = s_heap_metrics;
+  portEXIT_CRITICAL(&s_lock);
+}
+
 static void health_mark_metrics_logged(uint64_t now_us) {
   portENTER_CRITICAL(&s_lock);
   s_state.last_metrics_log_us = now_us;
@@ -305,7 +552,8 @@ static bool health_mark_mqtt_recovery_attempt(uint64_t now_us, uint32_t *attempt
 }
 
 static void log_metrics(const ul_health_state_t *state, uint64_t now_us,
-                        size_t free_heap, size_t min_heap) {
+                        size_t free_heap, size_t min_heap,
+                        const ul_health_heap_metrics_t *heap) {
   unsigned long long uptime_s = now_us / 1000000ULL;
   unsigned long long wifi_offline_s = state->wifi_connected
                                           ? 0ULL
@@ -317,12 +565,30 @@ static void log_metrics(const ul_health_state_t *state, uint64_t now_us,
                                         ? (now_us - state->last_time_sync_us) / 1000000ULL
                                         : uptime_s;
   ESP_LOGI(TAG,
-           "Uptime=%llus heap=%u(min=%u) wifi=%s offline=%llus attempts=%u mqtt=%s offline=%llus attempts=%u last_sync=%llus",
+           "Uptime=%llus heap=%u(min=%u largest=%u dma=%u spiram=%u/%u) render_overruns=%u degraded=%u wifi=%s offline=%llus attempts=%u mqtt=%s offline=%llus attempts=%u last_sync=%llus",
            uptime_s, (unsigned)free_heap, (unsigned)min_heap,
+           (unsigned)heap->internal_largest, (unsigned)heap->dma_largest,
+           (unsigned)heap->spiram_largest, (unsigned)heap->spiram_free,
+           (unsigned)state->render_overruns, (unsigned)state->render_degraded,
            state->wifi_connected ? "up" : "down", wifi_offline_s,
            (unsigned)state->wifi_recovery_attempts,
            state->mqtt_connected ? "up" : "down", mqtt_offline_s,
            (unsigned)state->mqtt_recovery_attempts, since_sync_s);
+#if CONFIG_UL_HEALTH_TASK_STATS
+  char cpu[sizeof(s_cpu_summary)];
+  ul_health_get_cpu_summary(cpu, sizeof(cpu));
+  if (cpu[0] != '\0')
+    ESP_LOGI(TAG, "CPU %s", cpu);
+#endif
+  char stacks[sizeof(s_stack_summary)];
+  ul_health_get_stack_summary(stacks, sizeof(stacks));
+  uint32_t work_armed = 0;
+  uint32_t work_run = 0;
+  ul_work_get_stats(&work_armed, &work_run);
+  if (stacks[0] != '\0')
+    ESP_LOGI(TAG, "Stack headroom %s (tasks=%u work_armed=%u work_run=%u)",
+             stacks, (unsigned)ul_task_created_total(), (unsigned)work_armed,
+             (unsigned)work_run);
 }
 
 static void health_task(void *arg) {
@@ -340,11 +606,61 @@ static void health_task(void *arg) {
     size_t free_heap = esp_get_free_heap_size();
     size_t min_heap = esp_get_minimum_free_heap_size();
 
+    // Total free heap misses the fielded failure mode: fragmentation, where
+    // a frame buffer or TLS record allocation fails while the totals still
+    // look fine. Sample per-capability free and largest-block figures too.
+    multi_heap_info_t info;
+    ul_health_heap_metrics_t heap = {0};
+    heap_caps_get_info(&info, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    heap.internal_free = info.total_free_bytes;
+    heap.internal_largest = info.largest_free_block;
+    heap_caps_get_info(&info, MALLOC_CAP_DMA);
+    heap.dma_largest = info.largest_free_block;
+#if CONFIG_UL_HAS_PSRAM
+    heap_caps_get_info(&info, MALLOC_CAP_SPIRAM);
+    heap.spiram_free = info.total_free_bytes;
+    heap.spiram_largest = info.largest_free_block;
+#endif
+    bool fragmented = heap.internal_largest < UL_HEALTH_FRAG_MIN_BLOCK;
+    heap.frag_strikes = health_update_frag(fragmented);
+    ul_tls_pool_stats_t tls;
+    ul_tls_pool_get_stats(&tls);
+    heap.tls_pool_free = tls.free_bytes;
+    heap.tls_pool_min_free = tls.min_free_bytes;
+    heap.tls_pool_largest = tls.largest_free_block;
+    heap.tls_fallbacks = tls.fallbacks;
+    health_store_heap_metrics(&heap);
+
+#if CONFIG_UL_HEALTH_TASK_STATS
+    health_sample_cpu();
+#endif
+    health_sample_stacks();
+
+    // Steady-state render health: a strip silently pacing below its target
+    // frame rate is degraded service even though nothing "failed". Escalate
+    // once it has persisted, and surface overruns as they accumulate.
+    if (s_render_stats_fn) {
+      uint32_t overrun_delta, degraded, strikes;
+      health_check_render(&overrun_delta, &degraded, &strikes);
+      if (degraded > 0 && strikes == UL_HEALTH_RENDER_DEGRADED_STRIKES) {
+        ESP_LOGE(TAG,
+                 "%u strip(s) below target FPS for %u consecutive checks "
+                 "(overruns +%u this period)",
+                 degraded, strikes, overrun_delta);
+      } else if (overrun_delta > 0) {
+        ESP_LOGW(TAG, "Render overruns +%u this period (degraded strips=%u)",
+                 overrun_delta, degraded);
+      }
+    }
+
     if (now_us - snapshot.last_metrics_log_us >= UL_HEALTH_LOG_INTERVAL_US) {
-      log_metrics(&snapshot, now_us, free_heap, min_heap);
+      log_metrics(&snapshot, now_us, free_heap, min_heap, &heap);
       health_mark_metrics_logged(now_us);
     }
 
+    if (cfg.publish_metrics)
+      cfg.publish_metrics(cfg.ctx);
+
     bool heap_low = min_heap < UL_HEALTH_HEAP_LOW_THRESHOLD;
     uint32_t heap_strikes = health_update_heap_low(heap_low);
     if (heap_low && heap_strikes >= UL_HEALTH_HEAP_LOW_STRIKES) {
@@ -353,6 +669,15 @@ static void health_task(void *arg) {
       esp_restart();
     }
 
+    if (fragmented && heap.frag_strikes >= UL_HEALTH_FRAG_STRIKES) {
+      ESP_LOGE(TAG,
+               "Internal heap fragmented for %u consecutive checks "
+               "(largest=%u free=%u). Rebooting.",
+               heap.frag_strikes, (unsigned)heap.internal_largest,
+               (unsigned)heap.internal_free);
+      esp_restart();
+    }
+
     if (!snapshot.wifi_connected) {
       uint64_t offline_us = now_us - snapshot.wifi_last_change_us;
       if (offline_us >= UL_HEALTH_WIFI_RECOVERY_DELAY_US) {
@@ -2,6 +2,7 @@
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -16,7 +17,27 @@ void ul_mqtt_publish_status_now(void);
 // Publish a motion event for a specific sensor. The event is published on
 // topic "ul/<node>/evt/<sensor>/motion" with the given state string.
 void ul_mqtt_publish_motion(const char *sensor, const char *state);
+// Batched variant: one publish on the same topic covering every sensor index
+// set in sensor_mask, so simultaneous triggers cost one message instead of N.
+// The payload keeps the "state" field and adds "sensors":[indexes].
+void ul_mqtt_publish_motion_batch(const char *sensor, const char *state,
+                                  uint32_t sensor_mask);
+// Run the locally persisted motion rule (restore lights, re-arm the hold
+// fade) without waiting on the broker. ul_pir calls this on each motion edge
+// before the telemetry publish; no-op while the rule is disabled.
+void ul_mqtt_motion_local_trigger(void);
 void ul_mqtt_publish_ota_event(const char *status, const char *detail);
+// Announce this node as an OTA seeder on the shared retained "ul/ota/seed"
+// topic. Called by ul_ota after each connect while it has an image to serve.
+void ul_mqtt_publish_ota_seed(const char *url, const char *sha256_hex,
+                              size_t size);
+// Publish the hot-path telemetry counters on "ul/<node>/evt/metrics". Called
+// periodically by the health task; counters are monotonic so consumers diff
+// successive reports for rates.
+void ul_mqtt_publish_metrics(void);
+// Publish a pre-rendered boot timing report on "ul/<node>/evt/boot". Sent
+// once per boot, after the first MQTT connect.
+void ul_mqtt_publish_boot_report(const char *json_payload);
 bool ul_mqtt_is_ready(void);
 bool ul_mqtt_is_connected(void);
 bool ul_mqtt_wait_for_ready(TickType_t timeout_ticks);
@@ -25,6 +46,12 @@ bool ul_mqtt_wait_for_ready(TickType_t timeout_ticks);
 // the suffix of a normal command topic (e.g. "ws/set").
 void ul_mqtt_run_local(const char *path, const char *json);
 
+// Inject a command from a non-broker transport into the same dispatch queue
+// the broker path uses, with the same per-target coalescing and single-task
+// serialization. The path is a command topic suffix (e.g. "ws/set"); the data
+// is copied, so the caller's buffer may be reused immediately.
+void ul_mqtt_submit_local(const char *path, const char *data, int data_len);
+
 #ifdef __cplusplus
 }
 #endif
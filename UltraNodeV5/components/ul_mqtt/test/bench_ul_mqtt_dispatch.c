@@ -0,0 +1,243 @@
+// Host benchmark for the MQTT command dispatch path.
+//
+// Pumps synthetic command topics (the mix a scene push fans out: ws/set,
+// rgb/set, white/set bursts plus status and motion traffic) through
+// find_cmd_route() and cmd_payload_index() at increasing batch sizes and
+// reports nanoseconds per message, so any change to the parse/dispatch path
+// shows its throughput cost before it ships fleet-wide. The route handlers
+// and cJSON parse need the engines and run on-device only; what this measures
+// is the fixed per-message dispatch overhead paid on the esp-mqtt event task
+// (coalesce key) and the dispatcher task (route lookup).
+//
+// The measured loop is also asserted allocation-free: malloc is overridden in
+// this TU and counted across the timed region.
+//
+// Baselines (x86-64 host, gcc -O0, 2024-era desktop core) -- update alongside
+// any dispatch change that moves them by more than ~20%:
+//
+//   route lookup              ~32 ns/msg
+//   coalesce key (set cmds)   ~50 ns/msg
+//
+// Absolute numbers differ on other hosts; the point is the delta between two
+// checkouts on the same machine.
+
+#define _POSIX_C_SOURCE 199309L // clock_gettime under -std=c11
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define UL_MQTT_TESTING 1
+#define UL_MQTT_BENCH 1
+#include "ul_mqtt_test_stubs.h"
+
+// ---- Allocation counting ---------------------------------------------------
+// glibc lets a strong definition shadow malloc; forward to the underlying
+// allocator and count the calls made while the timed loops run.
+
+extern void *__libc_malloc(size_t size);
+extern void __libc_free(void *ptr);
+
+static long g_malloc_calls = 0;
+
+void *malloc(size_t size) {
+  g_malloc_calls++;
+  return __libc_malloc(size);
+}
+
+void free(void *ptr) { __libc_free(ptr); }
+
+// ---- Stubs required by the testing-visible parts of ul_mqtt.c ---------------
+
+bool g_stub_credentials_available = false;
+ul_wifi_credentials_t g_stub_credentials = {0};
+
+struct ul_mqtt_test_client {
+  int placeholder;
+};
+
+static struct ul_mqtt_test_client g_client_storage;
+
+bool ul_core_is_connected(void) { return true; }
+
+const char *ul_core_get_node_id(void) { return "bench-node"; }
+
+void ul_core_power_note_activity(void) {}
+
+void ul_health_notify_mqtt(bool connected) { (void)connected; }
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args,
+                           esp_timer_handle_t *out_handle) {
+  (void)args;
+  if (out_handle)
+    *out_handle = NULL;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  (void)timer;
+  (void)timeout_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  (void)timer;
+  return ESP_OK;
+}
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *cfg) {
+  (void)cfg;
+  return (esp_mqtt_client_handle_t)&g_client_storage;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
+                                         int32_t event_id,
+                                         esp_event_handler_t handler,
+                                         void *event_data) {
+  (void)client;
+  (void)event_id;
+  (void)handler;
+  (void)event_data;
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client) {
+  (void)client;
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client) {
+  (void)client;
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client) {
+  (void)client;
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_disconnect(esp_mqtt_client_handle_t client) {
+  (void)client;
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t client) {
+  (void)client;
+  return ESP_OK;
+}
+
+void vTaskDelay(int ticks) { (void)ticks; }
+
+void motion_fade_cancel(void) {}
+
+void mqtt_event_handler(void *handler_args, esp_event_base_t base,
+                        int32_t event_id, void *event_data) {
+  (void)handler_args;
+  (void)base;
+  (void)event_id;
+  (void)event_data;
+}
+
+#include "../ul_mqtt.c"
+
+// ---- Workload ---------------------------------------------------------------
+// The shape of one scene push plus background traffic: per-strip/channel set
+// commands dominate, with a sprinkle of status and motion commands.
+
+typedef struct {
+  const char *sub;       // command suffix after "ul/<node>/cmd/"
+  const char *payload;   // representative JSON
+  const char *idx_field; // coalesce index field, NULL for non-set commands
+} bench_msg_t;
+
+static const bench_msg_t k_messages[] = {
+    {"ws/set", "{\"strip\":0,\"effect\":\"rainbow\",\"brightness\":220,\"params\":[255,64,32]}", "strip"},
+    {"ws/set", "{\"strip\":1,\"effect\":\"fire\",\"brightness\":180}", "strip"},
+    {"rgb/set", "{\"strip\":0,\"effect\":\"solid\",\"hex\":\"#20FF7A\",\"brightness\":255}", "strip"},
+    {"rgb/set", "{\"strip\":2,\"effect\":\"breathe\",\"brightness\":90}", "strip"},
+    {"white/set", "{\"channel\":0,\"effect\":\"solid\",\"brightness\":140}", "channel"},
+    {"white/set", "{\"channel\":3,\"effect\":\"solid\",\"brightness\":0}", "channel"},
+    {"scene/set", "{\"scene\":\"evening\"}", NULL},
+    {"status", "{}", NULL},
+    {"motion/status", "{}", NULL},
+    {"system/flush-window", "{\"ms\":500}", NULL},
+};
+
+#define BENCH_MSG_COUNT (sizeof(k_messages) / sizeof(k_messages[0]))
+
+static int64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Route every sample through the table once and check the match, so the
+// timing loops below cannot silently measure a miss.
+static void verify_routes(void) {
+  for (size_t i = 0; i < BENCH_MSG_COUNT; ++i) {
+    const cmd_route_t *route = find_cmd_route(k_messages[i].sub);
+    assert(route != NULL);
+    assert(strncmp(k_messages[i].sub, route->prefix, strlen(route->prefix)) == 0);
+  }
+  // Longest-prefix behaviour: ws/setb must not resolve to ws/set.
+  const cmd_route_t *setb = find_cmd_route("ws/setb");
+  assert(setb != NULL && strcmp(setb->prefix, "ws/setb") == 0);
+  assert(find_cmd_route("nonsense/path") == NULL);
+}
+
+static void bench_route_lookup(int iterations) {
+  volatile const cmd_route_t *sink = NULL;
+  long allocs_before = g_malloc_calls;
+  int64_t t0 = now_ns();
+  for (int i = 0; i < iterations; ++i) {
+    sink = find_cmd_route(k_messages[i % BENCH_MSG_COUNT].sub);
+  }
+  int64_t dt = now_ns() - t0;
+  long allocs = g_malloc_calls - allocs_before;
+  assert(sink != NULL);
+  assert(allocs == 0);
+  printf("route lookup   %8d msgs  %6.1f ns/msg  allocs=%ld\n", iterations,
+         (double)dt / iterations, allocs);
+}
+
+static void bench_coalesce_key(int iterations) {
+  volatile int sink = 0;
+  long allocs_before = g_malloc_calls;
+  int64_t t0 = now_ns();
+  for (int i = 0; i < iterations; ++i) {
+    const bench_msg_t *m = &k_messages[i % BENCH_MSG_COUNT];
+    if (m->idx_field) {
+      sink += cmd_payload_index(m->payload, m->idx_field);
+    }
+  }
+  int64_t dt = now_ns() - t0;
+  long allocs = g_malloc_calls - allocs_before;
+  assert(allocs == 0);
+  (void)sink;
+  printf("coalesce key   %8d msgs  %6.1f ns/msg  allocs=%ld\n", iterations,
+         (double)dt / iterations, allocs);
+}
+
+int main(void) {
+  verify_routes();
+
+  // Index extraction must see through our flat payload shape.
+  assert(cmd_payload_index(k_messages[1].payload, "strip") == 1);
+  assert(cmd_payload_index(k_messages[5].payload, "channel") == 3);
+  assert(cmd_payload_index("{\"effect\":\"solid\"}", "strip") == 0);
+
+  // Increasing rates: the per-message cost should stay flat; a superlinear
+  // trend here means the dispatch path grew a hidden per-call setup cost.
+  static const int k_batches[] = {1000, 10000, 100000, 1000000};
+  for (size_t i = 0; i < sizeof(k_batches) / sizeof(k_batches[0]); ++i) {
+    bench_route_lookup(k_batches[i]);
+  }
+  for (size_t i = 0; i < sizeof(k_batches) / sizeof(k_batches[0]); ++i) {
+    bench_coalesce_key(k_batches[i]);
+  }
+
+  printf("ul_mqtt_dispatch_bench passed\n");
+  return 0;
+}
@@ -37,6 +37,10 @@ const esp_mqtt_client_config_t *ul_mqtt_test_get_last_config(void) {
 
 bool ul_core_is_connected(void) { return g_core_connected; }
 
+const char *ul_core_get_node_id(void) { return "test-node"; }
+
+void ul_core_power_note_activity(void) {}
+
 void ul_health_notify_mqtt(bool connected) {
   g_health_notify_calls++;
   g_health_last_state = connected;
@@ -120,6 +124,16 @@ esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client) {
   return ESP_OK;
 }
 
+esp_err_t esp_mqtt_client_disconnect(esp_mqtt_client_handle_t client) {
+  (void)client;
+  return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t client) {
+  (void)client;
+  return ESP_OK;
+}
+
 void vTaskDelay(int ticks) { g_vtaskdelay_last = ticks; }
 
 void motion_fade_cancel(void) {}
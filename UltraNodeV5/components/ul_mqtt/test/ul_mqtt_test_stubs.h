@@ -93,6 +93,7 @@ typedef struct {
   } broker;
   struct {
     const char *username;
+    const char *client_id;
     struct {
       const char *password;
       const char *certificate;
@@ -101,6 +102,9 @@ typedef struct {
       size_t key_len;
     } authentication;
   } credentials;
+  struct {
+    bool disable_clean_session;
+  } session;
   struct {
     int priority;
     int stack_size;
@@ -120,6 +124,8 @@ esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
 esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
 esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client);
 esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_disconnect(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t client);
 
 typedef struct {
   char ssid[33];
@@ -144,6 +150,8 @@ static inline bool ul_wifi_credentials_load(ul_wifi_credentials_t *out) {
 }
 
 bool ul_core_is_connected(void);
+const char *ul_core_get_node_id(void);
+void ul_core_power_note_activity(void);
 void ul_health_notify_mqtt(bool connected);
 
 typedef uint32_t TickType_t;
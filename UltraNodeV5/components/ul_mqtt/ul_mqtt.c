@@ -21,14 +21,20 @@
 #include "ul_white_engine.h"
 #include "ul_ws_engine.h"
 #include "ul_rgb_engine.h"
+#include "ul_timeline.h"
+#include "ul_cron.h"
 #include "nvs_flash.h"
+#include "ul_task.h"
+#include "ul_work.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "freertos/event_groups.h"
 #endif
 
 #include <ctype.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -80,7 +86,36 @@ static QueueHandle_t s_publish_ack_queue = NULL;
 static esp_timer_handle_t s_retry_timer = NULL;
 static bool s_retry_pending = false;
 
-#define UL_WS_MAX_STRIPS 2
+// ---- Hot-path telemetry counters --------------------------------------------
+// Monotonic counters bumped with relaxed atomic adds, so the command and
+// publish paths pay one increment and no formatting. The health task drains
+// them onto ul/<node>/evt/metrics via ul_mqtt_publish_metrics(); the server
+// graphs rates by differencing successive reports, so nothing resets here.
+typedef struct {
+  atomic_uint_fast32_t cmds_processed; // commands routed and executed
+  atomic_uint_fast32_t cmds_unknown;   // no route matched the topic
+  atomic_uint_fast32_t cmds_dropped;   // queue full, oversized or no memory
+  atomic_uint_fast32_t cmds_coalesced; // superseded by a newer set command
+  atomic_uint_fast32_t parse_failures; // JSON payload rejected
+  atomic_uint_fast32_t ack_timeouts;   // publish acknowledgment wait expired
+  atomic_uint_fast32_t publish_drops;  // per-topic in-flight cap shed a publish
+  atomic_uint_fast32_t connects;       // MQTT_EVENT_CONNECTED seen
+  atomic_uint_fast32_t disconnects;
+  atomic_uint_fast32_t start_failures; // lifetime total, unlike the
+                                       // consecutive count that resets above
+  atomic_uint_fast32_t cmd_queue_hwm;  // deepest command queue backlog seen
+} mqtt_metrics_t;
+
+static mqtt_metrics_t s_metrics;
+
+#define METRIC_INC(field)                                                      \
+  atomic_fetch_add_explicit(&s_metrics.field, 1, memory_order_relaxed)
+
+// Everything from here to the end of mqtt_event_handler() needs the real
+// engine/cJSON/state surface; the host retry test provides its own
+// motion_fade_cancel() and mqtt_event_handler() stubs instead.
+#ifndef UL_MQTT_TESTING
+#define UL_WS_MAX_STRIPS 8
 #define UL_RGB_MAX_STRIPS 4
 #define UL_WHITE_MAX_CHANNELS 4
 
@@ -92,21 +127,20 @@ static uint8_t s_white_saved_bri[UL_WHITE_MAX_CHANNELS];
 static bool s_white_saved_valid[UL_WHITE_MAX_CHANNELS];
 static bool s_lights_dimmed = false;
 
+// The ramps themselves run inside the engines (ul_*_set_brightness_ramp);
+// this only tracks which channels were told to fade so cancellation can
+// freeze exactly those.
 typedef struct {
   bool active;
-  int total_steps;
-  int current_step;
-  uint64_t interval_us;
-  uint8_t ws_initial_bri[UL_WS_MAX_STRIPS];
   bool ws_active[UL_WS_MAX_STRIPS];
-  uint8_t rgb_initial_bri[UL_RGB_MAX_STRIPS];
   bool rgb_active[UL_RGB_MAX_STRIPS];
-  uint8_t white_initial_bri[UL_WHITE_MAX_CHANNELS];
   bool white_active[UL_WHITE_MAX_CHANNELS];
 } motion_fade_state_t;
 
 static motion_fade_state_t s_motion_fade = {0};
-static esp_timer_handle_t s_motion_fade_timer = NULL;
+
+// Status snapshot cache invalidation (defined with the cache below).
+static void invalidate_status_all(void);
 
 static bool pir_task_compiled(void) {
 #if defined(CONFIG_UL_PIR_ENABLED) && CONFIG_UL_PIR_ENABLED
@@ -179,6 +213,7 @@ static void dim_all_lights(void) {
   }
 
   s_lights_dimmed = true;
+  invalidate_status_all();
 }
 
 static void restore_all_lights(void) {
@@ -207,10 +242,9 @@ static void restore_all_lights(void) {
   }
 
   s_lights_dimmed = false;
+  invalidate_status_all();
 }
 
-static void motion_fade_apply_level(int step);
-
 static bool motion_fade_snapshot_channels(void) {
   bool any = false;
 
@@ -221,7 +255,6 @@ static bool motion_fade_snapshot_channels(void) {
   for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
     ul_ws_strip_status_t st;
     if (ul_ws_get_status(i, &st) && st.enabled && st.brightness > 0) {
-      s_motion_fade.ws_initial_bri[i] = st.brightness;
       s_motion_fade.ws_active[i] = true;
       any = true;
     }
@@ -230,7 +263,6 @@ static bool motion_fade_snapshot_channels(void) {
   for (int i = 0; i < UL_RGB_MAX_STRIPS; ++i) {
     ul_rgb_strip_status_t st;
     if (ul_rgb_get_status(i, &st) && st.enabled && st.brightness > 0) {
-      s_motion_fade.rgb_initial_bri[i] = st.brightness;
       s_motion_fade.rgb_active[i] = true;
       any = true;
     }
@@ -239,7 +271,6 @@ static bool motion_fade_snapshot_channels(void) {
   for (int i = 0; i < UL_WHITE_MAX_CHANNELS; ++i) {
     ul_white_ch_status_t st;
     if (ul_white_get_status(i, &st) && st.enabled && st.brightness > 0) {
-      s_motion_fade.white_initial_bri[i] = st.brightness;
       s_motion_fade.white_active[i] = true;
       any = true;
     }
@@ -248,113 +279,55 @@ static bool motion_fade_snapshot_channels(void) {
   return any;
 }
 
-static void motion_fade_stop_timer(void) {
-  if (s_motion_fade_timer) {
-    esp_timer_stop(s_motion_fade_timer);
-  }
-}
-
+// Freeze every channel the fade touched at its live (mid-ramp) brightness;
+// a plain set_brightness cancels the engine-side ramp in place.
 static void motion_fade_cancel(void) {
-  motion_fade_stop_timer();
-  s_motion_fade.active = false;
-  s_motion_fade.total_steps = 0;
-  s_motion_fade.current_step = 0;
-  s_motion_fade.interval_us = 0;
-}
-
-static void motion_fade_apply_level(int step) {
-  int steps = s_motion_fade.total_steps;
-  if (steps <= 0)
-    steps = 1;
-
-  int remaining = steps - step;
-  if (remaining < 0)
-    remaining = 0;
-
-  for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
-    if (!s_motion_fade.ws_active[i])
-      continue;
-    int start = s_motion_fade.ws_initial_bri[i];
-    int value = 0;
-    if (remaining > 0)
-      value = (start * remaining + steps - 1) / steps;
-    ul_ws_set_brightness(i, (uint8_t)value);
-  }
-
-  for (int i = 0; i < UL_RGB_MAX_STRIPS; ++i) {
-    if (!s_motion_fade.rgb_active[i])
-      continue;
-    int start = s_motion_fade.rgb_initial_bri[i];
-    int value = 0;
-    if (remaining > 0)
-      value = (start * remaining + steps - 1) / steps;
-    ul_rgb_set_brightness(i, (uint8_t)value);
-  }
-
-  for (int i = 0; i < UL_WHITE_MAX_CHANNELS; ++i) {
-    if (!s_motion_fade.white_active[i])
-      continue;
-    int start = s_motion_fade.white_initial_bri[i];
-    int value = 0;
-    if (remaining > 0)
-      value = (start * remaining + steps - 1) / steps;
-    ul_white_set_brightness(i, (uint8_t)value);
-  }
-}
-
-static void motion_fade_timer_cb(void *arg) {
-  if (!s_motion_fade.active)
-    return;
-
-  s_motion_fade.current_step++;
-  motion_fade_apply_level(s_motion_fade.current_step);
-
-  if (s_motion_fade.current_step >= s_motion_fade.total_steps) {
-    motion_fade_cancel();
+  if (s_motion_fade.active) {
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+      ul_ws_strip_status_t st;
+      if (s_motion_fade.ws_active[i] && ul_ws_get_status(i, &st))
+        ul_ws_set_brightness(i, st.brightness);
+    }
+    for (int i = 0; i < UL_RGB_MAX_STRIPS; ++i) {
+      ul_rgb_strip_status_t st;
+      if (s_motion_fade.rgb_active[i] && ul_rgb_get_status(i, &st))
+        ul_rgb_set_brightness(i, st.brightness);
+    }
+    for (int i = 0; i < UL_WHITE_MAX_CHANNELS; ++i) {
+      ul_white_ch_status_t st;
+      if (s_motion_fade.white_active[i] && ul_white_get_status(i, &st))
+        ul_white_set_brightness(i, st.brightness);
+    }
   }
+  s_motion_fade.active = false;
 }
 
-static void motion_fade_start(int duration_ms, int steps) {
+// The brightness ramps themselves run inside the engines, per-frame smooth;
+// this only tells each lit channel to fade to zero over the duration.
+static void motion_fade_start(int duration_ms) {
   motion_fade_cancel();
 
   if (!motion_fade_snapshot_channels())
     return;
 
-  if (steps <= 0)
-    steps = 8;
   if (duration_ms <= 0)
     duration_ms = 2000;
 
-  uint64_t interval_us = ((uint64_t)duration_ms * 1000ULL) / steps;
-  if (interval_us == 0)
-    interval_us = 1000;
-
-  s_motion_fade.total_steps = steps;
-  s_motion_fade.current_step = 0;
-  s_motion_fade.interval_us = interval_us;
-  s_motion_fade.active = true;
-
-  motion_fade_apply_level(0);
-
-  if (!s_motion_fade_timer) {
-    const esp_timer_create_args_t args = {
-        .callback = &motion_fade_timer_cb,
-        .name = "motion_fade",
-    };
-    esp_err_t err = esp_timer_create(&args, &s_motion_fade_timer);
-    if (err != ESP_OK) {
-      ESP_LOGE(TAG, "Failed to create motion fade timer: %s", esp_err_to_name(err));
-      s_motion_fade.active = false;
-      return;
-    }
+  for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+    if (s_motion_fade.ws_active[i])
+      ul_ws_set_brightness_ramp(i, 0, duration_ms);
   }
-
-  esp_err_t start_err = esp_timer_start_periodic(s_motion_fade_timer, interval_us);
-  if (start_err != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to start motion fade timer: %s", esp_err_to_name(start_err));
-    s_motion_fade.active = false;
-    return;
+  for (int i = 0; i < UL_RGB_MAX_STRIPS; ++i) {
+    if (s_motion_fade.rgb_active[i])
+      ul_rgb_set_brightness_ramp(i, 0, duration_ms);
+  }
+  for (int i = 0; i < UL_WHITE_MAX_CHANNELS; ++i) {
+    if (s_motion_fade.white_active[i])
+      ul_white_set_brightness_ramp(i, 0, duration_ms);
   }
+
+  s_motion_fade.active = true;
+  invalidate_status_all();
 }
 
 static void motion_fade_immediate_off(void) {
@@ -374,6 +347,154 @@ static void motion_fade_immediate_off(void) {
     if (s_motion_fade.white_active[i])
       ul_white_set_brightness(i, 0);
   }
+  invalidate_status_all();
+}
+
+// ---- Local motion -> light fast path ----
+// Motion handling normally round-trips through the broker: ul_pir publishes,
+// the server decides, and a command comes back — two network hops plus server
+// processing, and nothing at all when the broker is unreachable. The local
+// rule short-circuits that: on a PIR edge the node restores whatever the rule
+// previously faded out, then re-arms a hold timer that fades the same
+// channels back down. The motion event is still published for telemetry and
+// server commands land on top as usual. Configured via "motion/local",
+// persisted through ul_state so the rule survives reboots and outages alike.
+
+#define MOTION_LOCAL_HOLD_DEFAULT_S 60
+#define MOTION_LOCAL_FADE_DEFAULT_MS 2000
+
+typedef struct {
+  bool enabled;
+  uint32_t hold_s;
+  uint32_t fade_ms;
+  bool dimmed; // the rule (not the broker) faded the lights out
+  uint8_t ws_bri[UL_WS_MAX_STRIPS];
+  bool ws_valid[UL_WS_MAX_STRIPS];
+  uint8_t rgb_bri[UL_RGB_MAX_STRIPS];
+  bool rgb_valid[UL_RGB_MAX_STRIPS];
+  uint8_t white_bri[UL_WHITE_MAX_CHANNELS];
+  bool white_valid[UL_WHITE_MAX_CHANNELS];
+} motion_local_state_t;
+
+static motion_local_state_t s_motion_local = {
+    .hold_s = MOTION_LOCAL_HOLD_DEFAULT_S,
+    .fade_ms = MOTION_LOCAL_FADE_DEFAULT_MS,
+};
+static ul_work_job_t s_motion_local_job;
+static bool s_motion_local_loaded = false;
+
+static void motion_local_apply_config(cJSON *root) {
+  cJSON *jen = cJSON_GetObjectItem(root, "enabled");
+  s_motion_local.enabled = cJSON_IsBool(jen) && cJSON_IsTrue(jen);
+  cJSON *jhold = cJSON_GetObjectItem(root, "hold_s");
+  s_motion_local.hold_s =
+      (jhold && cJSON_IsNumber(jhold) && jhold->valueint > 0)
+          ? (uint32_t)jhold->valueint
+          : MOTION_LOCAL_HOLD_DEFAULT_S;
+  cJSON *jfade = cJSON_GetObjectItem(root, "fade_ms");
+  s_motion_local.fade_ms =
+      (jfade && cJSON_IsNumber(jfade) && jfade->valueint > 0)
+          ? (uint32_t)jfade->valueint
+          : MOTION_LOCAL_FADE_DEFAULT_MS;
+}
+
+static void motion_local_hold_expired(void *arg);
+
+// Lazy so a PIR edge before the broker ever connects still sees the rule.
+static void motion_local_ensure_loaded(void) {
+  if (s_motion_local_loaded)
+    return;
+  s_motion_local_loaded = true;
+  ul_work_job_init(&s_motion_local_job, motion_local_hold_expired, NULL, 1);
+  char buffer[128];
+  if (!ul_state_copy_motion(buffer, sizeof(buffer)))
+    return;
+  cJSON *root = cJSON_Parse(buffer);
+  if (!root)
+    return;
+  motion_local_apply_config(root);
+  cJSON_Delete(root);
+}
+
+// Hold expired: snapshot every lit channel and ramp it to zero. Mirrors
+// dim_all_lights()/restore_all_lights() but keeps its own bookkeeping so a
+// broker reconnect cannot undo what the rule faded out.
+static void motion_local_hold_expired(void *arg) {
+  (void)arg;
+  bool any = false;
+  for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+    ul_ws_strip_status_t st;
+    s_motion_local.ws_valid[i] = false;
+    if (ul_ws_get_status(i, &st) && st.enabled && st.brightness > 0) {
+      s_motion_local.ws_bri[i] = st.brightness;
+      s_motion_local.ws_valid[i] = true;
+      ul_ws_set_brightness_ramp(i, 0, (int)s_motion_local.fade_ms);
+      any = true;
+    }
+  }
+  for (int i = 0; i < UL_RGB_MAX_STRIPS; ++i) {
+    ul_rgb_strip_status_t st;
+    s_motion_local.rgb_valid[i] = false;
+    if (ul_rgb_get_status(i, &st) && st.enabled && st.brightness > 0) {
+      s_motion_local.rgb_bri[i] = st.brightness;
+      s_motion_local.rgb_valid[i] = true;
+      ul_rgb_set_brightness_ramp(i, 0, (int)s_motion_local.fade_ms);
+      any = true;
+    }
+  }
+  for (int i = 0; i < UL_WHITE_MAX_CHANNELS; ++i) {
+    ul_white_ch_status_t st;
+    s_motion_local.white_valid[i] = false;
+    if (ul_white_get_status(i, &st) && st.enabled && st.brightness > 0) {
+      s_motion_local.white_bri[i] = st.brightness;
+      s_motion_local.white_valid[i] = true;
+      ul_white_set_brightness_ramp(i, 0, (int)s_motion_local.fade_ms);
+      any = true;
+    }
+  }
+  if (any) {
+    s_motion_local.dimmed = true;
+    invalidate_status_all();
+  }
+}
+
+void ul_mqtt_motion_local_trigger(void) {
+  motion_local_ensure_loaded();
+  if (!s_motion_local.enabled)
+    return;
+
+  // Disarm the hold job before touching the snapshot arrays so the expiry
+  // callback cannot interleave with the restore below.
+  ul_work_cancel(&s_motion_local_job);
+
+  motion_fade_cancel();
+  if (s_motion_local.dimmed) {
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+      if (s_motion_local.ws_valid[i]) {
+        ul_ws_set_brightness(i, s_motion_local.ws_bri[i]);
+        s_motion_local.ws_valid[i] = false;
+      }
+    }
+    for (int i = 0; i < UL_RGB_MAX_STRIPS; ++i) {
+      if (s_motion_local.rgb_valid[i]) {
+        ul_rgb_set_brightness(i, s_motion_local.rgb_bri[i]);
+        s_motion_local.rgb_valid[i] = false;
+      }
+    }
+    for (int i = 0; i < UL_WHITE_MAX_CHANNELS; ++i) {
+      if (s_motion_local.white_valid[i]) {
+        ul_white_set_brightness(i, s_motion_local.white_bri[i]);
+        s_motion_local.white_valid[i] = false;
+      }
+    }
+    s_motion_local.dimmed = false;
+    invalidate_status_all();
+  }
+
+  if (ul_work_schedule(&s_motion_local_job, s_motion_local.hold_s * 1000U) !=
+      ESP_OK) {
+    ESP_LOGW(TAG, "Failed to schedule motion hold job");
+  }
 }
 
 static void handle_system_wipe_nvs(void) {
@@ -431,11 +552,114 @@ static void override_index_from_path(cJSON *root, const char *sub,
 }
 
 // Helper to publish JSON
+// ---- Async publish tracking -------------------------------------------------
+// Publishes are handed to the client task with esp_mqtt_client_enqueue(), so
+// producers (pir_task, the engines, the health task) never touch the socket
+// and never block on a congested broker. PUBACKs are matched against a small
+// table keyed by msg_id; entries that outlive the ack timeout are counted
+// into the telemetry metrics when the table is next touched instead of
+// stalling anyone. A per-topic cap on outstanding messages sheds load at the
+// producer once the broker stops keeping up.
+#define UL_MQTT_ACK_TABLE_LEN 16
+#define UL_MQTT_ACK_TOPIC_LIMIT 4
+
+typedef struct {
+  int msg_id; // 0 = free slot
+  uint32_t topic_hash;
+  int64_t enqueued_us;
+} publish_track_t;
+
+static publish_track_t s_publish_track[UL_MQTT_ACK_TABLE_LEN];
+static portMUX_TYPE s_publish_track_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t topic_hash32(const char *topic) {
+  // FNV-1a; topics are short and collisions only make the cap stricter.
+  uint32_t h = 2166136261u;
+  while (*topic) {
+    h ^= (uint8_t)*topic++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static void publish_track_sweep_locked(int64_t now_us) {
+  for (int i = 0; i < UL_MQTT_ACK_TABLE_LEN; ++i) {
+    if (s_publish_track[i].msg_id != 0 &&
+        now_us - s_publish_track[i].enqueued_us >
+            (int64_t)UL_MQTT_PUBLISH_ACK_TIMEOUT_MS * 1000) {
+      s_publish_track[i].msg_id = 0;
+      METRIC_INC(ack_timeouts);
+    }
+  }
+}
+
+// Returns false when the topic already has the maximum number of
+// unacknowledged messages in flight.
+static bool publish_track_reserve(uint32_t topic_hash) {
+  bool ok = true;
+  portENTER_CRITICAL(&s_publish_track_lock);
+  publish_track_sweep_locked(esp_timer_get_time());
+  int outstanding = 0;
+  for (int i = 0; i < UL_MQTT_ACK_TABLE_LEN; ++i) {
+    if (s_publish_track[i].msg_id != 0 &&
+        s_publish_track[i].topic_hash == topic_hash)
+      outstanding++;
+  }
+  if (outstanding >= UL_MQTT_ACK_TOPIC_LIMIT)
+    ok = false;
+  portEXIT_CRITICAL(&s_publish_track_lock);
+  return ok;
+}
+
+static void publish_track_add(uint32_t topic_hash, int msg_id) {
+  portENTER_CRITICAL(&s_publish_track_lock);
+  for (int i = 0; i < UL_MQTT_ACK_TABLE_LEN; ++i) {
+    if (s_publish_track[i].msg_id == 0) {
+      s_publish_track[i].msg_id = msg_id;
+      s_publish_track[i].topic_hash = topic_hash;
+      s_publish_track[i].enqueued_us = esp_timer_get_time();
+      break;
+    }
+  }
+  // Table full: the message goes out untracked, which only loosens the cap.
+  portEXIT_CRITICAL(&s_publish_track_lock);
+}
+
+static void publish_track_complete(int msg_id) {
+  portENTER_CRITICAL(&s_publish_track_lock);
+  for (int i = 0; i < UL_MQTT_ACK_TABLE_LEN; ++i) {
+    if (s_publish_track[i].msg_id == msg_id) {
+      s_publish_track[i].msg_id = 0;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&s_publish_track_lock);
+}
+
+static void publish_track_reset(void) {
+  portENTER_CRITICAL(&s_publish_track_lock);
+  for (int i = 0; i < UL_MQTT_ACK_TABLE_LEN; ++i)
+    s_publish_track[i].msg_id = 0;
+  portEXIT_CRITICAL(&s_publish_track_lock);
+}
+
 static int publish_json(const char *topic, const char *json) {
 
   if (!s_client || !ul_core_is_connected() || !json)
     return -1;
-  return esp_mqtt_client_publish(s_client, topic, json, 0, 1, 0);
+  uint32_t hash = topic_hash32(topic);
+  if (!publish_track_reserve(hash)) {
+    METRIC_INC(publish_drops);
+    ESP_LOGW(TAG, "Shedding publish to %s; %d unacknowledged in flight", topic,
+             UL_MQTT_ACK_TOPIC_LIMIT);
+    return -1;
+  }
+  // Enqueue instead of publish: the client task owns the socket write, so the
+  // caller returns as soon as the message is in the outbox.
+  int msg_id = esp_mqtt_client_enqueue(s_client, topic, json, 0, 1, 0, true);
+  if (msg_id > 0)
+    publish_track_add(hash, msg_id);
+  return msg_id;
 }
 
 #ifndef UL_MQTT_TESTING
@@ -458,8 +682,10 @@ static bool wait_for_publish_ack(int msg_id, uint32_t timeout_ms) {
     TickType_t now = xTaskGetTickCount();
     TickType_t remaining = (deadline > now) ? (deadline - now) : 0;
     int ack_id = 0;
-    if (xQueueReceive(s_publish_ack_queue, &ack_id, remaining) != pdTRUE)
+    if (xQueueReceive(s_publish_ack_queue, &ack_id, remaining) != pdTRUE) {
+      METRIC_INC(ack_timeouts);
       return false;
+    }
     if (ack_id == msg_id)
       return true;
   }
@@ -489,98 +715,186 @@ static cJSON *load_params_from_state(bool (*copy_fn)(int, char *, size_t),
   return dup;
 }
 
-// Build and publish status JSON snapshot
-static void publish_status_snapshot(void) {
-  char topic[128];
-  char saved_payload[UL_STATE_MAX_JSON_LEN];
-  snprintf(topic, sizeof(topic), "ul/%s/evt/status", ul_core_get_node_id());
-  cJSON *root = cJSON_CreateObject();
-  cJSON_AddStringToObject(root, "event", "snapshot");
-  cJSON_AddStringToObject(root, "node", ul_core_get_node_id());
-  cJSON_AddBoolToObject(root, "pir_enabled", pir_task_compiled());
+// ---- Status snapshot cache --------------------------------------------------
+// The snapshot used to be rebuilt from scratch — a cJSON tree across every
+// strip and channel — on each publish. The tree is now kept alive between
+// publishes with a dirty flag per section; command handlers invalidate only
+// the section they touched, and publishing reserializes the cached tree into
+// a reused static buffer. A publish with no dirty sections costs one
+// preallocated print and no tree construction.
+
+#define UL_MQTT_STATUS_BUF_LEN 4096
+
+static cJSON *s_status_cache = NULL;
+static bool s_status_ws_dirty = true;
+static bool s_status_rgb_dirty = true;
+static bool s_status_white_dirty = true;
+static char s_status_buf[UL_MQTT_STATUS_BUF_LEN];
+
+static void invalidate_status_ws(void) { s_status_ws_dirty = true; }
+static void invalidate_status_rgb(void) { s_status_rgb_dirty = true; }
+static void invalidate_status_white(void) { s_status_white_dirty = true; }
+
+static void invalidate_status_all(void) {
+  s_status_ws_dirty = true;
+  s_status_rgb_dirty = true;
+  s_status_white_dirty = true;
+}
 
-  // uptime
-  cJSON_AddNumberToObject(root, "uptime_s", esp_timer_get_time() / 1000000);
+static cJSON *build_ws_entry(int i) {
+  ul_ws_strip_status_t st;
+  if (!ul_ws_get_status(i, &st))
+    return NULL;
+  char saved_payload[UL_STATE_MAX_JSON_LEN];
+  cJSON *o = cJSON_CreateObject();
+  cJSON_AddNumberToObject(o, "strip", i);
+  cJSON_AddBoolToObject(o, "enabled", st.enabled);
+  cJSON_AddStringToObject(o, "effect", st.effect);
+  cJSON_AddNumberToObject(o, "brightness", st.brightness);
+  cJSON *params_array = load_params_from_state(ul_state_copy_ws, i,
+                                               saved_payload,
+                                               sizeof(saved_payload));
+  if (params_array)
+    cJSON_AddItemToObject(o, "params", params_array);
+  cJSON_AddNumberToObject(o, "pixels", st.pixels);
+  cJSON_AddNumberToObject(o, "gpio", st.gpio);
+  cJSON_AddNumberToObject(o, "fps", st.fps);
+  cJSON_AddNumberToObject(o, "render_us_min", st.render_us_min);
+  cJSON_AddNumberToObject(o, "render_us_avg", st.render_us_avg);
+  cJSON_AddNumberToObject(o, "render_us_max", st.render_us_max);
+  cJSON_AddNumberToObject(o, "tx_us", st.tx_us);
+  cJSON_AddNumberToObject(o, "overruns", st.overruns);
+  cJSON_AddNumberToObject(o, "power_clamps", st.power_clamps);
+  cJSON_AddBoolToObject(o, "frames_internal", st.frames_internal);
+  cJSON_AddNumberToObject(o, "segments", st.segments);
+  cJSON_AddNumberToObject(o, "scale", st.render_scale);
+  cJSON *col =
+      cJSON_CreateIntArray((int[]){st.color[0], st.color[1], st.color[2]}, 3);
+  cJSON_AddItemToObject(o, "color", col);
+  return o;
+}
 
-  // WS strips
+static cJSON *build_ws_section(void) {
   cJSON *jws = cJSON_CreateArray();
-  for (int i = 0; i < 2; i++) {
-    ul_ws_strip_status_t st;
-    if (ul_ws_get_status(i, &st)) {
-      cJSON *o = cJSON_CreateObject();
-      cJSON_AddNumberToObject(o, "strip", i);
-      cJSON_AddBoolToObject(o, "enabled", st.enabled);
-      cJSON_AddStringToObject(o, "effect", st.effect);
-      cJSON_AddNumberToObject(o, "brightness", st.brightness);
-      cJSON *params_array =
-          load_params_from_state(ul_state_copy_ws, i, saved_payload,
-                                 sizeof(saved_payload));
-      if (params_array)
-        cJSON_AddItemToObject(o, "params", params_array);
-      cJSON_AddNumberToObject(o, "pixels", st.pixels);
-      cJSON_AddNumberToObject(o, "gpio", st.gpio);
-      cJSON_AddNumberToObject(o, "fps", st.fps);
-      cJSON *col = cJSON_CreateIntArray(
-          (int[]){st.color[0], st.color[1], st.color[2]}, 3);
-      cJSON_AddItemToObject(o, "color", col);
+  for (int i = 0; i < UL_WS_MAX_STRIPS; i++) {
+    cJSON *o = build_ws_entry(i);
+    if (o)
       cJSON_AddItemToArray(jws, o);
-    }
   }
-  cJSON_AddItemToObject(root, "ws", jws);
+  return jws;
+}
+
+static cJSON *build_rgb_entry(int i) {
+  ul_rgb_strip_status_t st;
+  if (!ul_rgb_get_status(i, &st))
+    return NULL;
+  char saved_payload[UL_STATE_MAX_JSON_LEN];
+  cJSON *o = cJSON_CreateObject();
+  cJSON_AddNumberToObject(o, "strip", i);
+  cJSON_AddBoolToObject(o, "enabled", st.enabled);
+  cJSON_AddStringToObject(o, "effect", st.effect);
+  cJSON_AddNumberToObject(o, "brightness", st.brightness);
+  cJSON *params_array = load_params_from_state(ul_state_copy_rgb, i,
+                                               saved_payload,
+                                               sizeof(saved_payload));
+  if (params_array)
+    cJSON_AddItemToObject(o, "params", params_array);
+  cJSON_AddNumberToObject(o, "pwm_hz", st.pwm_hz);
+  cJSON *channels = cJSON_CreateArray();
+  for (int c = 0; c < 3; ++c) {
+    cJSON *ch = cJSON_CreateObject();
+    cJSON_AddNumberToObject(ch, "gpio", st.channel[c].gpio);
+    cJSON_AddNumberToObject(ch, "ledc_ch", st.channel[c].ledc_ch);
+    cJSON_AddNumberToObject(ch, "mode", st.channel[c].ledc_mode);
+    cJSON_AddItemToArray(channels, ch);
+  }
+  cJSON_AddItemToObject(o, "channels", channels);
+  int color[3] = {st.color[0], st.color[1], st.color[2]};
+  cJSON_AddItemToObject(o, "color", cJSON_CreateIntArray(color, 3));
+  return o;
+}
 
-  // RGB strips
+static cJSON *build_rgb_section(void) {
   cJSON *jrgb = cJSON_CreateArray();
   for (int i = 0; i < 4; i++) {
-    ul_rgb_strip_status_t st;
-    if (ul_rgb_get_status(i, &st)) {
-      cJSON *o = cJSON_CreateObject();
-      cJSON_AddNumberToObject(o, "strip", i);
-      cJSON_AddBoolToObject(o, "enabled", st.enabled);
-      cJSON_AddStringToObject(o, "effect", st.effect);
-      cJSON_AddNumberToObject(o, "brightness", st.brightness);
-      cJSON *params_array =
-          load_params_from_state(ul_state_copy_rgb, i, saved_payload,
-                                 sizeof(saved_payload));
-      if (params_array)
-        cJSON_AddItemToObject(o, "params", params_array);
-      cJSON_AddNumberToObject(o, "pwm_hz", st.pwm_hz);
-      cJSON *channels = cJSON_CreateArray();
-      for (int c = 0; c < 3; ++c) {
-        cJSON *ch = cJSON_CreateObject();
-        cJSON_AddNumberToObject(ch, "gpio", st.channel[c].gpio);
-        cJSON_AddNumberToObject(ch, "ledc_ch", st.channel[c].ledc_ch);
-        cJSON_AddNumberToObject(ch, "mode", st.channel[c].ledc_mode);
-        cJSON_AddItemToArray(channels, ch);
-      }
-      cJSON_AddItemToObject(o, "channels", channels);
-      int color[3] = {st.color[0], st.color[1], st.color[2]};
-      cJSON_AddItemToObject(o, "color", cJSON_CreateIntArray(color, 3));
+    cJSON *o = build_rgb_entry(i);
+    if (o)
       cJSON_AddItemToArray(jrgb, o);
-    }
   }
-  cJSON_AddItemToObject(root, "rgb", jrgb);
+  return jrgb;
+}
 
-  // White channels
+static cJSON *build_white_entry(int i) {
+  ul_white_ch_status_t st;
+  if (!ul_white_get_status(i, &st))
+    return NULL;
+  char saved_payload[UL_STATE_MAX_JSON_LEN];
+  cJSON *o = cJSON_CreateObject();
+  cJSON_AddNumberToObject(o, "channel", i);
+  cJSON_AddBoolToObject(o, "enabled", st.enabled);
+  cJSON_AddStringToObject(o, "effect", st.effect);
+  cJSON_AddNumberToObject(o, "brightness", st.brightness);
+  cJSON *params_array = load_params_from_state(ul_state_copy_white, i,
+                                               saved_payload,
+                                               sizeof(saved_payload));
+  if (params_array)
+    cJSON_AddItemToObject(o, "params", params_array);
+  cJSON_AddNumberToObject(o, "gpio", st.gpio);
+  cJSON_AddNumberToObject(o, "pwm_hz", st.pwm_hz);
+  return o;
+}
+
+static cJSON *build_white_section(void) {
   cJSON *jw = cJSON_CreateArray();
   for (int i = 0; i < 4; i++) {
-    ul_white_ch_status_t st;
-    if (ul_white_get_status(i, &st)) {
-      cJSON *o = cJSON_CreateObject();
-      cJSON_AddNumberToObject(o, "channel", i);
-      cJSON_AddBoolToObject(o, "enabled", st.enabled);
-      cJSON_AddStringToObject(o, "effect", st.effect);
-      cJSON_AddNumberToObject(o, "brightness", st.brightness);
-      cJSON *params_array =
-          load_params_from_state(ul_state_copy_white, i, saved_payload,
-                                 sizeof(saved_payload));
-      if (params_array)
-        cJSON_AddItemToObject(o, "params", params_array);
-      cJSON_AddNumberToObject(o, "gpio", st.gpio);
-      cJSON_AddNumberToObject(o, "pwm_hz", st.pwm_hz);
+    cJSON *o = build_white_entry(i);
+    if (o)
       cJSON_AddItemToArray(jw, o);
-    }
   }
-  cJSON_AddItemToObject(root, "white", jw);
+  return jw;
+}
+
+// Small post-command event on evt/status/delta carrying just the touched
+// strip, so the broker is not fanning out the whole snapshot for a one-byte
+// brightness change. Consumers that miss deltas resync from the snapshot,
+// which stays reserved for cmd/status and reconnects.
+static void publish_status_delta(const char *section, cJSON *entry) {
+  if (!entry)
+    return;
+  char topic[128];
+  snprintf(topic, sizeof(topic), "ul/%s/evt/status/delta",
+           ul_core_get_node_id());
+  cJSON *root = cJSON_CreateObject();
+  if (!root) {
+    cJSON_Delete(entry);
+    return;
+  }
+  cJSON_AddStringToObject(root, "event", "delta");
+  cJSON_AddStringToObject(root, "node", ul_core_get_node_id());
+  cJSON *arr = cJSON_CreateArray();
+  cJSON_AddItemToArray(arr, entry);
+  cJSON_AddItemToObject(root, section, arr);
+  char *json = cJSON_PrintUnformatted(root);
+  if (json) {
+    publish_json(topic, json);
+    cJSON_free(json);
+  }
+  cJSON_Delete(root);
+}
+
+static bool ensure_status_cache(void) {
+  if (s_status_cache)
+    return true;
+  cJSON *root = cJSON_CreateObject();
+  if (!root)
+    return false;
+  cJSON_AddStringToObject(root, "event", "snapshot");
+  cJSON_AddStringToObject(root, "node", ul_core_get_node_id());
+  cJSON_AddBoolToObject(root, "pir_enabled", pir_task_compiled());
+  cJSON_AddNumberToObject(root, "uptime_s", 0);
+  cJSON_AddItemToObject(root, "ws", cJSON_CreateArray());
+  cJSON_AddItemToObject(root, "rgb", cJSON_CreateArray());
+  cJSON_AddItemToObject(root, "white", cJSON_CreateArray());
 
   // *Debugging only- download_id is secret
   // OTA (static fields from Kconfig)
@@ -588,31 +902,318 @@ static void publish_status_snapshot(void) {
   //cJSON_AddStringToObject(jota, "manifest_url", CONFIG_UL_OTA_MANIFEST_URL);
   //cJSON_AddItemToObject(root, "ota", jota);
 
-  char *json = cJSON_PrintUnformatted(root);
-  publish_json(topic, json);
-  cJSON_free(json);
-  cJSON_Delete(root);
+  s_status_cache = root;
+  invalidate_status_all();
+  return true;
 }
 
-void ul_mqtt_publish_status(void) {
+// Trailing-edge coalescing for snapshot publishes: callers that refresh the
+// snapshot as a side effect of a command request one via
+// schedule_status_snapshot(), and a one-shot timer fires once the burst has
+// quieted down (the UL_STATE_FLUSH_DELAY_US pattern from ul_state.c). On top
+// of that, a hard minimum interval between snapshots caps the steady-state
+// publish rate; a request arriving inside the window is deferred, never lost.
+#define UL_MQTT_STATUS_DEBOUNCE_US (200ULL * 1000ULL)
+#define UL_MQTT_STATUS_MIN_INTERVAL_US (1000ULL * 1000ULL)
+
+static esp_timer_handle_t s_status_timer = NULL;
+static int64_t s_last_snapshot_us = 0;
+
+static void publish_status_snapshot(void);
+
+static void status_snapshot_timer_cb(void *arg) {
+  (void)arg;
+  publish_status_snapshot();
+}
+
+static void schedule_status_snapshot(void) {
+  if (!s_status_timer) {
+    const esp_timer_create_args_t args = {
+        .callback = &status_snapshot_timer_cb,
+        .name = "ul_mqtt_status",
+    };
+    esp_err_t err = esp_timer_create(&args, &s_status_timer);
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "Failed to create status publish timer (%d); publishing inline",
+               (int)err);
+      publish_status_snapshot();
+      return;
+    }
+  }
+
+  uint64_t delay_us = UL_MQTT_STATUS_DEBOUNCE_US;
+  int64_t since_last = esp_timer_get_time() - s_last_snapshot_us;
+  if (since_last < (int64_t)UL_MQTT_STATUS_MIN_INTERVAL_US) {
+    uint64_t until_allowed =
+        UL_MQTT_STATUS_MIN_INTERVAL_US - (uint64_t)since_last;
+    if (until_allowed > delay_us)
+      delay_us = until_allowed;
+  }
+
+  esp_err_t err = esp_timer_stop(s_status_timer);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+    ESP_LOGW(TAG, "Failed to stop status publish timer (%d)", (int)err);
+  }
+  err = esp_timer_start_once(s_status_timer, delay_us);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to arm status publish timer (%d)", (int)err);
+  }
+}
+
+// Publish the status snapshot, rebuilding only the sections marked dirty
+// since the last publish.
+static void publish_status_snapshot(void) {
   char topic[128];
   snprintf(topic, sizeof(topic), "ul/%s/evt/status", ul_core_get_node_id());
-  cJSON *root = cJSON_CreateObject();
-  if (!root)
+  if (!ensure_status_cache())
     return;
-  cJSON_AddStringToObject(root, "status", "ok");
 
-  wifi_ap_record_t ap_info = {0};
-  if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-    cJSON_AddNumberToObject(root, "signal_dbi", ap_info.rssi);
+  // A direct publish satisfies any pending scheduled one and counts toward
+  // the rate cap either way.
+  if (s_status_timer)
+    esp_timer_stop(s_status_timer);
+  s_last_snapshot_us = esp_timer_get_time();
+
+  if (s_status_ws_dirty) {
+    cJSON_ReplaceItemInObject(s_status_cache, "ws", build_ws_section());
+    s_status_ws_dirty = false;
+  }
+  if (s_status_rgb_dirty) {
+    cJSON_ReplaceItemInObject(s_status_cache, "rgb", build_rgb_section());
+    s_status_rgb_dirty = false;
   }
+  if (s_status_white_dirty) {
+    cJSON_ReplaceItemInObject(s_status_cache, "white", build_white_section());
+    s_status_white_dirty = false;
+  }
+  cJSON *uptime = cJSON_GetObjectItem(s_status_cache, "uptime_s");
+  if (uptime)
+    cJSON_SetNumberValue(uptime, esp_timer_get_time() / 1000000);
 
-  char *json = cJSON_PrintUnformatted(root);
-  if (json) {
-    publish_json(topic, json);
-    cJSON_free(json);
+  if (cJSON_PrintPreallocated(s_status_cache, s_status_buf,
+                              sizeof(s_status_buf), 0)) {
+    publish_json(topic, s_status_buf);
+  } else {
+    // Document outgrew the static buffer; fall back to a heap print rather
+    // than drop the snapshot.
+    char *json = cJSON_PrintUnformatted(s_status_cache);
+    if (json) {
+      publish_json(topic, json);
+      cJSON_free(json);
+    }
   }
-  cJSON_Delete(root);
+}
+
+// ---- Packed binary status ---------------------------------------------------
+// Parallel compact form of the snapshot for fleet-scale polling: the same
+// state the JSON cache carries, serialized as a versioned packed struct and
+// published on evt/status/bin. The server opts in per poll by sending
+// {"format":"bin"} on cmd/status, so consumers that only speak JSON never see
+// it. Encoding is a row of struct stores into a static buffer — no tree walk,
+// no formatting.
+//
+// All integers are little-endian (native here). The header carries the three
+// record sizes, so fields can be appended to a record without breaking older
+// parsers; anything more invasive bumps the version byte.
+
+#define UL_STATUS_BIN_MAGIC 0x4255 // "UB"
+#define UL_STATUS_BIN_VERSION 1
+#define UL_STATUS_BIN_EFFECT_LEN 16
+
+typedef struct __attribute__((packed)) {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t pir_enabled;
+  uint32_t uptime_s;
+  uint8_t ws_count;
+  uint8_t rgb_count;
+  uint8_t white_count;
+  uint8_t ws_record_len;
+  uint8_t rgb_record_len;
+  uint8_t white_record_len;
+  uint16_t reserved;
+  // Metrics registry, same counters and order as evt/metrics.
+  uint32_t cmds_processed;
+  uint32_t cmds_unknown;
+  uint32_t cmds_dropped;
+  uint32_t cmds_coalesced;
+  uint32_t parse_failures;
+  uint32_t ack_timeouts;
+  uint32_t publish_drops;
+  uint32_t connects;
+  uint32_t disconnects;
+  uint32_t start_failures;
+  uint32_t cmd_queue_hwm;
+} ul_status_bin_hdr_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t strip;
+  uint8_t enabled;
+  uint8_t brightness;
+  uint8_t segments;
+  uint16_t pixels;
+  int16_t gpio;
+  uint16_t fps;
+  uint8_t color[3];
+  uint8_t frames_internal;
+  uint32_t render_us_min;
+  uint32_t render_us_avg;
+  uint32_t render_us_max;
+  uint32_t tx_us;
+  uint32_t overruns;
+  uint32_t power_clamps;
+  char effect[UL_STATUS_BIN_EFFECT_LEN]; // NUL-padded, may be truncated
+  uint8_t render_scale;
+} ul_status_bin_ws_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t strip;
+  uint8_t enabled;
+  uint8_t brightness;
+  uint8_t color[3];
+  uint16_t reserved;
+  uint32_t pwm_hz;
+  int16_t gpio[3];
+  uint8_t ledc_ch[3];
+  uint8_t ledc_mode[3];
+  char effect[UL_STATUS_BIN_EFFECT_LEN];
+} ul_status_bin_rgb_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t channel;
+  uint8_t enabled;
+  uint8_t brightness;
+  uint8_t reserved;
+  int16_t gpio;
+  uint16_t reserved2;
+  uint32_t pwm_hz;
+  char effect[UL_STATUS_BIN_EFFECT_LEN];
+} ul_status_bin_white_t;
+
+#define UL_STATUS_BIN_METRIC(field)                                            \
+  (uint32_t)atomic_load_explicit(&s_metrics.field, memory_order_relaxed)
+
+static void publish_status_binary(void) {
+  // Dispatch-task only, like the JSON print buffer.
+  static uint8_t buf[sizeof(ul_status_bin_hdr_t) +
+                     UL_WS_MAX_STRIPS * sizeof(ul_status_bin_ws_t) +
+                     UL_RGB_MAX_STRIPS * sizeof(ul_status_bin_rgb_t) +
+                     UL_WHITE_MAX_CHANNELS * sizeof(ul_status_bin_white_t)];
+  ul_status_bin_hdr_t hdr = {
+      .magic = UL_STATUS_BIN_MAGIC,
+      .version = UL_STATUS_BIN_VERSION,
+      .pir_enabled = pir_task_compiled(),
+      .uptime_s = (uint32_t)(esp_timer_get_time() / 1000000),
+      .ws_record_len = sizeof(ul_status_bin_ws_t),
+      .rgb_record_len = sizeof(ul_status_bin_rgb_t),
+      .white_record_len = sizeof(ul_status_bin_white_t),
+      .cmds_processed = UL_STATUS_BIN_METRIC(cmds_processed),
+      .cmds_unknown = UL_STATUS_BIN_METRIC(cmds_unknown),
+      .cmds_dropped = UL_STATUS_BIN_METRIC(cmds_dropped),
+      .cmds_coalesced = UL_STATUS_BIN_METRIC(cmds_coalesced),
+      .parse_failures = UL_STATUS_BIN_METRIC(parse_failures),
+      .ack_timeouts = UL_STATUS_BIN_METRIC(ack_timeouts),
+      .publish_drops = UL_STATUS_BIN_METRIC(publish_drops),
+      .connects = UL_STATUS_BIN_METRIC(connects),
+      .disconnects = UL_STATUS_BIN_METRIC(disconnects),
+      .start_failures = UL_STATUS_BIN_METRIC(start_failures),
+      .cmd_queue_hwm = UL_STATUS_BIN_METRIC(cmd_queue_hwm),
+  };
+  size_t off = sizeof(hdr);
+
+  for (int i = 0; i < UL_WS_MAX_STRIPS; i++) {
+    ul_ws_strip_status_t st;
+    if (!ul_ws_get_status(i, &st))
+      continue;
+    ul_status_bin_ws_t rec = {
+        .strip = (uint8_t)i,
+        .enabled = st.enabled,
+        .brightness = st.brightness,
+        .segments = (uint8_t)st.segments,
+        .pixels = (uint16_t)st.pixels,
+        .gpio = (int16_t)st.gpio,
+        .fps = (uint16_t)st.fps,
+        .color = {st.color[0], st.color[1], st.color[2]},
+        .frames_internal = st.frames_internal,
+        .render_us_min = st.render_us_min,
+        .render_us_avg = st.render_us_avg,
+        .render_us_max = st.render_us_max,
+        .tx_us = st.tx_us,
+        .overruns = st.overruns,
+        .power_clamps = st.power_clamps,
+        .render_scale = st.render_scale,
+    };
+    strncpy(rec.effect, st.effect, sizeof(rec.effect) - 1);
+    memcpy(buf + off, &rec, sizeof(rec));
+    off += sizeof(rec);
+    hdr.ws_count++;
+  }
+
+  for (int i = 0; i < UL_RGB_MAX_STRIPS; i++) {
+    ul_rgb_strip_status_t st;
+    if (!ul_rgb_get_status(i, &st))
+      continue;
+    ul_status_bin_rgb_t rec = {
+        .strip = (uint8_t)i,
+        .enabled = st.enabled,
+        .brightness = st.brightness,
+        .color = {st.color[0], st.color[1], st.color[2]},
+        .pwm_hz = (uint32_t)st.pwm_hz,
+    };
+    for (int c = 0; c < 3; ++c) {
+      rec.gpio[c] = (int16_t)st.channel[c].gpio;
+      rec.ledc_ch[c] = (uint8_t)st.channel[c].ledc_ch;
+      rec.ledc_mode[c] = (uint8_t)st.channel[c].ledc_mode;
+    }
+    strncpy(rec.effect, st.effect, sizeof(rec.effect) - 1);
+    memcpy(buf + off, &rec, sizeof(rec));
+    off += sizeof(rec);
+    hdr.rgb_count++;
+  }
+
+  for (int i = 0; i < UL_WHITE_MAX_CHANNELS; i++) {
+    ul_white_ch_status_t st;
+    if (!ul_white_get_status(i, &st))
+      continue;
+    ul_status_bin_white_t rec = {
+        .channel = (uint8_t)i,
+        .enabled = st.enabled,
+        .brightness = st.brightness,
+        .gpio = (int16_t)st.gpio,
+        .pwm_hz = (uint32_t)st.pwm_hz,
+    };
+    strncpy(rec.effect, st.effect, sizeof(rec.effect) - 1);
+    memcpy(buf + off, &rec, sizeof(rec));
+    off += sizeof(rec);
+    hdr.white_count++;
+  }
+
+  memcpy(buf, &hdr, sizeof(hdr));
+
+  if (!s_client || !ul_core_is_connected())
+    return;
+  char topic[128];
+  snprintf(topic, sizeof(topic), "ul/%s/evt/status/bin",
+           ul_core_get_node_id());
+  // qos0 and untracked: the snapshot is poll-driven, a lost one is simply
+  // re-requested on the next cycle.
+  esp_mqtt_client_enqueue(s_client, topic, (const char *)buf, (int)off, 0, 0,
+                          true);
+}
+
+void ul_mqtt_publish_status(void) {
+  char topic[128];
+  char payload[64];
+  snprintf(topic, sizeof(topic), "ul/%s/evt/status", ul_core_get_node_id());
+
+  wifi_ap_record_t ap_info = {0};
+  if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+    snprintf(payload, sizeof(payload), "{\"status\":\"ok\",\"signal_dbi\":%d}",
+             ap_info.rssi);
+  } else {
+    snprintf(payload, sizeof(payload), "{\"status\":\"ok\"}");
+  }
+  publish_json(topic, payload);
 }
 
 // Publish confirmation for ws/set including echo of effect parameters
@@ -704,20 +1305,40 @@ void ul_mqtt_publish_motion(const char *sensor, const char *state) {
   publish_json(topic, payload);
 }
 
+void ul_mqtt_publish_motion_batch(const char *sensor, const char *state,
+                                  uint32_t sensor_mask) {
+  char topic[128];
+  char payload[96];
+  char list[40];
+  size_t off = 0;
+  for (unsigned i = 0; i < 32 && off + 4 < sizeof(list); ++i) {
+    if (sensor_mask & (1u << i)) {
+      off += (size_t)snprintf(list + off, sizeof(list) - off, "%s%u",
+                              off ? "," : "", i);
+    }
+  }
+  list[off < sizeof(list) ? off : sizeof(list) - 1] = '\0';
+  snprintf(topic, sizeof(topic), "ul/%s/evt/%s/motion", ul_core_get_node_id(),
+           sensor);
+  snprintf(payload, sizeof(payload), "{\"state\":\"%s\",\"sensors\":[%s]}",
+           state, list);
+  publish_json(topic, payload);
+}
+
 void ul_mqtt_publish_ota_event(const char *status, const char *detail) {
   char topic[128];
+  char payload[256];
   snprintf(topic, sizeof(topic), "ul/%s/evt/ota", ul_core_get_node_id());
-  cJSON *root = cJSON_CreateObject();
-  cJSON_AddStringToObject(root, "status", status);
-  if (detail)
-    cJSON_AddStringToObject(root, "detail", detail);
-  int msg_id = -1;
-  char *json = cJSON_PrintUnformatted(root);
-  if (json) {
-    msg_id = publish_json(topic, json);
-    cJSON_free(json);
+  // Fields are internal tokens (state names, esp_err names, manifest URLs,
+  // versions) that never contain characters needing JSON escaping, so the
+  // payload is formatted directly like the motion event above it.
+  if (detail) {
+    snprintf(payload, sizeof(payload), "{\"status\":\"%s\",\"detail\":\"%s\"}",
+             status, detail);
+  } else {
+    snprintf(payload, sizeof(payload), "{\"status\":\"%s\"}", status);
   }
-  cJSON_Delete(root);
+  int msg_id = publish_json(topic, payload);
 #ifndef UL_MQTT_TESTING
   if (msg_id >= 0 && status && strcmp(status, "success") == 0) {
     if (!wait_for_publish_ack(msg_id, UL_MQTT_PUBLISH_ACK_TIMEOUT_MS)) {
@@ -729,16 +1350,109 @@ void ul_mqtt_publish_ota_event(const char *status, const char *detail) {
 #endif
 }
 
+void ul_mqtt_publish_ota_seed(const char *url, const char *sha256_hex,
+                              size_t size) {
+  if (!s_client || !url || !url[0] || !sha256_hex)
+    return;
+  char payload[256];
+  // Same reasoning as the OTA event above: every field is an internal token
+  // (node id, our own URL, hex digest), so no JSON escaping is needed.
+  snprintf(payload, sizeof(payload),
+           "{\"node\":\"%s\",\"url\":\"%s\",\"sha256\":\"%s\",\"size\":%u}",
+           ul_core_get_node_id(), url, sha256_hex, (unsigned)size);
+  // Retained, so a node that starts its check later still finds the seeder
+  // without waiting for the seeder's next announcement.
+  esp_mqtt_client_enqueue(s_client, "ul/ota/seed", payload, 0, 0, 1, true);
+}
+
+void ul_mqtt_publish_boot_report(const char *json_payload) {
+  if (!json_payload || !json_payload[0])
+    return;
+  char topic[128];
+  snprintf(topic, sizeof(topic), "ul/%s/evt/boot", ul_core_get_node_id());
+  publish_json(topic, json_payload);
+}
+
 static void publish_motion_status(void) {
   char topic[128];
+  char payload[112];
   snprintf(topic, sizeof(topic), "ul/%s/evt/motion/status",
            ul_core_get_node_id());
-  cJSON *root = cJSON_CreateObject();
-  cJSON_AddBoolToObject(root, "pir_enabled", pir_task_compiled());
-  char *json = cJSON_PrintUnformatted(root);
-  publish_json(topic, json);
-  cJSON_free(json);
-  cJSON_Delete(root);
+  motion_local_ensure_loaded();
+  snprintf(payload, sizeof(payload),
+           "{\"pir_enabled\":%s,\"local\":{\"enabled\":%s,\"hold_s\":%u,"
+           "\"fade_ms\":%u}}",
+           pir_task_compiled() ? "true" : "false",
+           s_motion_local.enabled ? "true" : "false",
+           (unsigned)s_motion_local.hold_s, (unsigned)s_motion_local.fade_ms);
+  publish_json(topic, payload);
+}
+
+void ul_mqtt_publish_metrics(void) {
+  char topic[128];
+  char payload[800];
+  snprintf(topic, sizeof(topic), "ul/%s/evt/metrics", ul_core_get_node_id());
+  ul_state_metrics_t state;
+  ul_state_get_metrics(&state);
+  ul_health_heap_metrics_t heap;
+  ul_health_get_heap_metrics(&heap);
+  char cpu[64];
+  ul_health_get_cpu_summary(cpu, sizeof(cpu));
+  uint32_t ws_overruns = 0;
+  uint32_t ws_degraded = 0;
+  ul_health_get_render_stats(&ws_overruns, &ws_degraded);
+  char stacks[96];
+  ul_health_get_stack_summary(stacks, sizeof(stacks));
+  // Fixed-shape integer payload, formatted directly like the motion and OTA
+  // events above. All values are monotonic except cmd_queue_hwm, flush_ms
+  // (the configured persistence window, echoed for tuning) and the heap
+  // figures, which are the health task's latest per-capability sample.
+  snprintf(payload, sizeof(payload),
+           "{\"event\":\"metrics\",\"cmds\":%u,\"unknown\":%u,\"dropped\":%u,"
+           "\"coalesced\":%u,\"parse_fail\":%u,\"ack_timeouts\":%u,"
+           "\"publish_drops\":%u,\"connects\":%u,\"disconnects\":%u,"
+           "\"start_failures\":%u,\"cmd_queue_hwm\":%u,"
+           "\"state_writes\":%u,\"state_deduped\":%u,\"state_coalesced\":%u,"
+           "\"flush_ms\":%u,\"heap_free\":%u,\"heap_largest\":%u,"
+           "\"dma_largest\":%u,\"spiram_free\":%u,\"spiram_largest\":%u,"
+           "\"frag_strikes\":%u,\"tls_pool_free\":%u,\"tls_pool_min_free\":%u,"
+           "\"tls_fallbacks\":%u,\"cpu\":\"%s\",\"stacks\":\"%s\","
+           "\"tasks_created\":%u,\"ws_overruns\":%u,"
+           "\"ws_degraded\":%u,\"uptime_s\":%llu}",
+           (unsigned)atomic_load_explicit(&s_metrics.cmds_processed,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.cmds_unknown,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.cmds_dropped,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.cmds_coalesced,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.parse_failures,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.ack_timeouts,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.publish_drops,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.connects,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.disconnects,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.start_failures,
+                                          memory_order_relaxed),
+           (unsigned)atomic_load_explicit(&s_metrics.cmd_queue_hwm,
+                                          memory_order_relaxed),
+           (unsigned)state.writes_issued, (unsigned)state.writes_deduped,
+           (unsigned)state.writes_coalesced,
+           (unsigned)ul_state_get_flush_delay_ms(),
+           (unsigned)heap.internal_free, (unsigned)heap.internal_largest,
+           (unsigned)heap.dma_largest, (unsigned)heap.spiram_free,
+           (unsigned)heap.spiram_largest, (unsigned)heap.frag_strikes,
+           (unsigned)heap.tls_pool_free, (unsigned)heap.tls_pool_min_free,
+           (unsigned)heap.tls_fallbacks, cpu,
+           stacks, (unsigned)ul_task_created_total(),
+           (unsigned)ws_overruns, (unsigned)ws_degraded,
+           (unsigned long long)(esp_timer_get_time() / 1000000LL));
+  publish_json(topic, payload);
 }
 
 static bool handle_cmd_ws_set(cJSON *root, int *out_strip) {
@@ -755,101 +1469,641 @@ static bool handle_cmd_ws_set(cJSON *root, int *out_strip) {
   if (jeffect && cJSON_IsString(jeffect))
     effect = jeffect->valuestring;
 
-  cJSON *params = cJSON_GetObjectItem(root, "params");
+  cJSON *params = cJSON_GetObjectItem(root, "params");
+
+  ul_ws_apply_json(root);
+  invalidate_status_ws();
+
+  bool ok = false;
+  if (effect) {
+    ul_ws_strip_status_t st;
+    if (ul_ws_get_status(strip, &st)) {
+      ok = strcmp(st.effect, effect) == 0;
+    }
+  }
+
+  publish_ws_ack(strip, effect, params, ok);
+  publish_status_delta("ws", build_ws_entry(strip));
+  return (!effect || ok);
+}
+
+static bool handle_cmd_rgb_set(cJSON *root, int *out_strip) {
+  int strip = 0;
+  cJSON *jstrip = cJSON_GetObjectItem(root, "strip");
+  if (jstrip && cJSON_IsNumber(jstrip))
+    strip = jstrip->valueint;
+
+  if (out_strip)
+    *out_strip = strip;
+
+  int brightness = 255;
+  cJSON *jbri = cJSON_GetObjectItem(root, "brightness");
+  if (jbri && cJSON_IsNumber(jbri))
+    brightness = jbri->valueint;
+
+  const char *effect = NULL;
+  cJSON *jeffect = cJSON_GetObjectItem(root, "effect");
+  if (jeffect && cJSON_IsString(jeffect))
+    effect = jeffect->valuestring;
+
+  cJSON *params = cJSON_GetObjectItem(root, "params");
+
+  ul_rgb_apply_json(root);
+  invalidate_status_rgb();
+
+  bool ok = false;
+  if (effect) {
+    ul_rgb_strip_status_t st;
+    if (ul_rgb_get_status(strip, &st)) {
+      ok = strcmp(st.effect, effect) == 0;
+    }
+  }
+
+  publish_rgb_ack(strip, effect, params, brightness, ok);
+  publish_status_delta("rgb", build_rgb_entry(strip));
+  return (!effect || ok);
+}
+
+static bool handle_cmd_white_set(cJSON *root, int *out_channel) {
+  int channel = 0;
+  cJSON *jch = cJSON_GetObjectItem(root, "channel");
+  if (jch && cJSON_IsNumber(jch))
+    channel = jch->valueint;
+
+  if (out_channel)
+    *out_channel = channel;
+
+  int brightness = 255;
+  cJSON *jbri = cJSON_GetObjectItem(root, "brightness");
+  if (jbri && cJSON_IsNumber(jbri))
+    brightness = jbri->valueint;
+
+  const char *effect = NULL;
+  cJSON *jeffect = cJSON_GetObjectItem(root, "effect");
+  if (jeffect && cJSON_IsString(jeffect))
+    effect = jeffect->valuestring;
+
+  cJSON *params = cJSON_GetObjectItem(root, "params");
+
+  ul_white_apply_json(root);
+  invalidate_status_white();
+
+  ul_white_ch_status_t st;
+  bool have_status = ul_white_get_status(channel, &st);
+  if (have_status)
+    brightness = st.brightness;
+
+  bool ok = have_status;
+  if (effect && have_status)
+    ok = strcmp(st.effect, effect) == 0;
+
+  publish_white_ack(channel, effect, params, brightness, ok);
+  publish_status_delta("white", build_white_entry(channel));
+
+  return (!effect || ok);
+}
+// ---- Binary set command (cmd/ws/setb) ---------------------------------------
+// High-frequency control (live colour scrubbing, music-reactive dashboards)
+// pays for a full cJSON parse per message on the JSON path. The sibling
+// cmd/ws/setb topic carries a fixed-layout packed struct instead: one memcpy,
+// zero allocation. The format is versioned so the layout can grow; JSON
+// ws/set remains the compatible path for everything else (effect switching,
+// params, acks). Binary sets are deliberately not recorded to ul_state —
+// a scrub burst would only wear flash with values that are stale in seconds.
+//
+// Wire layout, 7 bytes, little-endian:
+//   [0] version   (UL_WS_SETB_VERSION)
+//   [1] strip
+//   [2] flags     (bit0: apply brightness, bit1: apply solid RGB)
+//   [3] brightness
+//   [4..6] r, g, b
+
+#define UL_WS_SETB_VERSION 1
+#define UL_WS_SETB_FLAG_BRIGHTNESS 0x01
+#define UL_WS_SETB_FLAG_COLOR 0x02
+
+typedef struct __attribute__((packed)) {
+  uint8_t version;
+  uint8_t strip;
+  uint8_t flags;
+  uint8_t brightness;
+  uint8_t rgb[3];
+} ul_ws_setb_cmd_t;
+
+static void handle_cmd_ws_setb(const char *data, int data_len) {
+  ul_ws_setb_cmd_t cmd;
+  if (!data || data_len < (int)sizeof(cmd)) {
+    ESP_LOGW(TAG, "Short ws/setb payload (%d bytes)", data_len);
+    return;
+  }
+  memcpy(&cmd, data, sizeof(cmd));
+  if (cmd.version != UL_WS_SETB_VERSION) {
+    ESP_LOGW(TAG, "Unsupported ws/setb version %u", cmd.version);
+    return;
+  }
+  if (cmd.flags & UL_WS_SETB_FLAG_BRIGHTNESS)
+    ul_ws_set_brightness(cmd.strip, cmd.brightness);
+  if (cmd.flags & UL_WS_SETB_FLAG_COLOR)
+    ul_ws_set_solid_rgb(cmd.strip, cmd.rgb[0], cmd.rgb[1], cmd.rgb[2]);
+  invalidate_status_ws();
+}
+
+#endif // !UL_MQTT_TESTING
+
+// ---- Command routing ---------------------------------------------------------
+// The old dispatch was a starts_with() chain; every message walked it top to
+// bottom and each new command family lengthened the hot path. Routes now live
+// in one table, sorted by suffix, and are matched by a longest-prefix binary
+// search after the node prefix has been stripped once. New families (binary
+// topics, future group commands) are one table row.
+//
+// The table and lookup compile in the host dispatch benchmark too (with NULL
+// handlers, since those need the engines), so lookup cost is measured against
+// the real prefix set.
+
+#if !defined(UL_MQTT_TESTING) || defined(UL_MQTT_BENCH)
+
+#ifdef UL_MQTT_TESTING
+typedef struct cJSON cJSON; // opaque on the host; handlers never run there
+#define UL_MQTT_ROUTE_FN(fn) NULL
+#else
+#define UL_MQTT_ROUTE_FN(fn) fn
+#endif
+
+typedef void (*cmd_route_fn)(const char *sub, cJSON *root, const char *data,
+                             int data_len);
+
+typedef struct {
+  const char *prefix; // command suffix after "ul/<node>/cmd/"
+  bool json;          // parse the payload before dispatch
+  cmd_route_fn fn;
+} cmd_route_t;
+
+#endif // !UL_MQTT_TESTING || UL_MQTT_BENCH
+
+#ifndef UL_MQTT_TESTING
+
+static void route_ws_set(const char *sub, cJSON *root, const char *data,
+                         int data_len) {
+  motion_fade_cancel();
+  ul_timeline_stop();
+  override_index_from_path(root, sub, "ws/set", "strip");
+  int strip = 0;
+  if (handle_cmd_ws_set(root, &strip) && data && data_len > 0) {
+    ul_state_record_ws(strip, data, data_len);
+  }
+}
+
+static void route_ws_setb(const char *sub, cJSON *root, const char *data,
+                          int data_len) {
+  (void)sub;
+  (void)root;
+  motion_fade_cancel();
+  ul_timeline_stop();
+  handle_cmd_ws_setb(data, data_len);
+}
+
+static void route_rgb_set(const char *sub, cJSON *root, const char *data,
+                          int data_len) {
+  motion_fade_cancel();
+  ul_timeline_stop();
+  override_index_from_path(root, sub, "rgb/set", "strip");
+  int strip = 0;
+  if (handle_cmd_rgb_set(root, &strip) && data && data_len > 0) {
+    ul_state_record_rgb(strip, data, data_len);
+  }
+}
+
+static void route_white_set(const char *sub, cJSON *root, const char *data,
+                            int data_len) {
+  motion_fade_cancel();
+  ul_timeline_stop();
+  override_index_from_path(root, sub, "white/set", "channel");
+  int channel = 0;
+  if (handle_cmd_white_set(root, &channel) && data && data_len > 0) {
+    ul_state_record_white(channel, data, data_len);
+  }
+}
+
+static void route_ota_check(const char *sub, cJSON *root, const char *data,
+                            int data_len) {
+  (void)sub;
+  (void)data;
+  (void)data_len;
+  ul_mqtt_publish_status();
+  const char *manifest_url_override = NULL;
+  const cJSON *manifest_url_json =
+      root ? cJSON_GetObjectItem(root, "manifest_url") : NULL;
+  if (cJSON_IsString(manifest_url_json) && manifest_url_json->valuestring &&
+      manifest_url_json->valuestring[0]) {
+    manifest_url_override = manifest_url_json->valuestring;
+  }
+  // {"force": false} marks a routine fleet sweep: the check then rides the
+  // conditional-fetch and jitter path. Absent means forced, as before.
+  bool force = true;
+  const cJSON *force_json = root ? cJSON_GetObjectItem(root, "force") : NULL;
+  if (cJSON_IsBool(force_json)) {
+    force = cJSON_IsTrue(force_json);
+  }
+  ul_ota_check_now(force, manifest_url_override);
+  schedule_status_snapshot();
+}
+
+// Persist one scene entry the same way a standalone set command would be,
+// so the strip comes back in the scene after a reboot.
+static void scene_record_entry(cJSON *entry, const char *index_field,
+                               void (*record)(int, const char *, size_t)) {
+  int index = 0;
+  cJSON *jidx = cJSON_GetObjectItem(entry, index_field);
+  if (jidx && cJSON_IsNumber(jidx))
+    index = jidx->valueint;
+  char *json = cJSON_PrintUnformatted(entry);
+  if (json) {
+    record(index, json, strlen(json));
+    cJSON_free(json);
+  }
+}
 
-  ul_ws_apply_json(root);
+// scene/set: one message for the whole node. The payload carries per-engine
+// arrays of the same objects ws/set, rgb/set and white/set take:
+//   {"ws":[{"strip":0,"effect":...}, ...],
+//    "rgb":[...], "white":[{"channel":0,...}]}
+// Everything is applied from one parse pass and answered with a single
+// status snapshot instead of one ack per strip.
+static void route_scene_set(const char *sub, cJSON *root, const char *data,
+                            int data_len) {
+  (void)sub;
+  (void)data;
+  (void)data_len;
+  motion_fade_cancel();
+  ul_timeline_stop();
+
+  cJSON *entry;
+  cJSON *sec = cJSON_GetObjectItem(root, "ws");
+  if (cJSON_IsArray(sec)) {
+    cJSON_ArrayForEach(entry, sec) {
+      if (!cJSON_IsObject(entry))
+        continue;
+      ul_ws_apply_json(entry);
+      scene_record_entry(entry, "strip", ul_state_record_ws);
+    }
+    invalidate_status_ws();
+  }
 
-  bool ok = false;
-  if (effect) {
-    ul_ws_strip_status_t st;
-    if (ul_ws_get_status(strip, &st)) {
-      ok = strcmp(st.effect, effect) == 0;
+  sec = cJSON_GetObjectItem(root, "rgb");
+  if (cJSON_IsArray(sec)) {
+    cJSON_ArrayForEach(entry, sec) {
+      if (!cJSON_IsObject(entry))
+        continue;
+      ul_rgb_apply_json(entry);
+      scene_record_entry(entry, "strip", ul_state_record_rgb);
     }
+    invalidate_status_rgb();
   }
 
-  publish_ws_ack(strip, effect, params, ok);
-  return (!effect || ok);
+  sec = cJSON_GetObjectItem(root, "white");
+  if (cJSON_IsArray(sec)) {
+    cJSON_ArrayForEach(entry, sec) {
+      if (!cJSON_IsObject(entry))
+        continue;
+      ul_white_apply_json(entry);
+      scene_record_entry(entry, "channel", ul_state_record_white);
+    }
+    invalidate_status_white();
+  }
+
+  schedule_status_snapshot();
 }
 
-static bool handle_cmd_rgb_set(cJSON *root, int *out_strip) {
-  int strip = 0;
-  cJSON *jstrip = cJSON_GetObjectItem(root, "strip");
-  if (jstrip && cJSON_IsNumber(jstrip))
-    strip = jstrip->valueint;
+// cron/set: replace the on-device time-of-day schedule. The raw payload is
+// persisted through ul_state so the schedule survives reboots; entries fire
+// locally against the SNTP clock with no broker involvement.
+static void route_cron_set(const char *sub, cJSON *root, const char *data,
+                           int data_len) {
+  (void)sub;
+  if (!ul_cron_apply_json(root)) {
+    ESP_LOGW(TAG, "Rejected cron/set payload");
+    return;
+  }
+  if (data && data_len > 0)
+    ul_state_record_cron(data, (size_t)data_len);
+}
 
-  if (out_strip)
-    *out_strip = strip;
+// timeline/set: a batch of keyframes the node stores and plays back locally,
+// so a choreographed sequence costs one message instead of one per step. The
+// payload is parsed by ul_timeline_apply_json(); nothing is persisted — a
+// reboot mid-playback restores the last recorded per-strip set commands
+// instead of resuming the choreography.
+static void route_timeline_set(const char *sub, cJSON *root, const char *data,
+                               int data_len) {
+  (void)sub;
+  (void)data;
+  (void)data_len;
+  motion_fade_cancel();
+  if (!ul_timeline_apply_json(root)) {
+    ESP_LOGW(TAG, "Rejected timeline/set payload");
+  }
+}
 
-  int brightness = 255;
-  cJSON *jbri = cJSON_GetObjectItem(root, "brightness");
-  if (jbri && cJSON_IsNumber(jbri))
-    brightness = jbri->valueint;
+static void route_motion_local(const char *sub, cJSON *root, const char *data,
+                               int data_len) {
+  (void)sub;
+  motion_local_ensure_loaded();
+  motion_local_apply_config(root);
+  if (!s_motion_local.enabled)
+    ul_work_cancel(&s_motion_local_job);
+  if (data && data_len > 0)
+    ul_state_record_motion(data, (size_t)data_len);
+  publish_motion_status();
+}
 
-  const char *effect = NULL;
-  cJSON *jeffect = cJSON_GetObjectItem(root, "effect");
-  if (jeffect && cJSON_IsString(jeffect))
-    effect = jeffect->valuestring;
+static void route_motion_off(const char *sub, cJSON *root, const char *data,
+                             int data_len) {
+  (void)sub;
+  (void)data;
+  (void)data_len;
+  int duration_ms = 2000;
+  int steps = 255;
+  cJSON *fade = cJSON_GetObjectItem(root, "fade");
+  if (fade && cJSON_IsObject(fade)) {
+    cJSON *dur = cJSON_GetObjectItem(fade, "duration_ms");
+    if (dur && cJSON_IsNumber(dur))
+      duration_ms = dur->valueint;
+    cJSON *jsteps = cJSON_GetObjectItem(fade, "steps");
+    if (jsteps && cJSON_IsNumber(jsteps))
+      steps = jsteps->valueint;
+  }
+  // "steps" only gates immediate-off for old callers; the ramps are
+  // per-frame smooth inside the engines now.
+  if (duration_ms <= 0 || steps <= 0) {
+    motion_fade_immediate_off();
+  } else {
+    motion_fade_start(duration_ms);
+  }
+}
 
-  cJSON *params = cJSON_GetObjectItem(root, "params");
+static void route_motion_on(const char *sub, cJSON *root, const char *data,
+                            int data_len) {
+  (void)sub;
+  (void)root;
+  (void)data;
+  (void)data_len;
+  motion_fade_cancel();
+}
 
-  ul_rgb_apply_json(root);
+static void route_motion_status(const char *sub, cJSON *root, const char *data,
+                                int data_len) {
+  (void)sub;
+  (void)root;
+  (void)data;
+  (void)data_len;
+  publish_motion_status();
+}
 
-  bool ok = false;
-  if (effect) {
-    ul_rgb_strip_status_t st;
-    if (ul_rgb_get_status(strip, &st)) {
-      ok = strcmp(st.effect, effect) == 0;
+static void route_status(const char *sub, cJSON *root, const char *data,
+                         int data_len) {
+  (void)sub;
+  (void)data;
+  (void)data_len;
+  cJSON *fmt = root ? cJSON_GetObjectItem(root, "format") : NULL;
+  if (fmt && cJSON_IsString(fmt) && strcmp(fmt->valuestring, "bin") == 0) {
+    publish_status_binary();
+    return;
+  }
+  ul_mqtt_publish_status_now();
+}
+
+// Runs on the command dispatcher task, so a benchmark stalls queued commands
+// for its duration but never the esp-mqtt client task. Frame count is capped
+// to keep that stall in the low hundreds of milliseconds.
+static void route_system_benchmark(const char *sub, cJSON *root,
+                                   const char *data, int data_len) {
+  (void)sub;
+  (void)data;
+  (void)data_len;
+  int frames = 16;
+  cJSON *jframes = cJSON_GetObjectItem(root, "frames");
+  if (jframes && cJSON_IsNumber(jframes))
+    frames = jframes->valueint;
+  if (frames < 1)
+    frames = 1;
+  if (frames > 64)
+    frames = 64;
+
+  ul_ws_benchmark_result_t results[12];
+  int pixels = 0;
+  uint32_t lut_us = 0;
+  int count = ul_ws_benchmark(frames, results,
+                              (int)(sizeof(results) / sizeof(results[0])),
+                              &pixels, &lut_us);
+
+  // Last measured wire time of the first enabled strip: set_pixels push plus
+  // the queued DMA transaction, as timed on the live hardware.
+  uint32_t tx_us = 0;
+  for (int i = 0; i < 8; ++i) {
+    ul_ws_strip_status_t st;
+    if (ul_ws_get_status(i, &st) && st.enabled) {
+      tx_us = st.tx_us;
+      break;
     }
   }
 
-  publish_rgb_ack(strip, effect, params, brightness, ok);
-  return (!effect || ok);
+  cJSON *evt = cJSON_CreateObject();
+  if (!evt)
+    return;
+  cJSON_AddNumberToObject(evt, "frames", frames);
+  cJSON_AddNumberToObject(evt, "pixels", pixels);
+  cJSON_AddNumberToObject(evt, "lut_us", lut_us);
+  cJSON_AddNumberToObject(evt, "tx_us", tx_us);
+  cJSON *list = cJSON_AddArrayToObject(evt, "effects");
+  for (int i = 0; i < count && list; ++i) {
+    cJSON *entry = cJSON_CreateObject();
+    if (!entry)
+      break;
+    cJSON_AddStringToObject(entry, "name", results[i].name);
+    cJSON_AddNumberToObject(entry, "avg_us", results[i].avg_us);
+    cJSON_AddNumberToObject(entry, "max_us", results[i].max_us);
+    cJSON_AddItemToArray(list, entry);
+  }
+  char topic[128];
+  snprintf(topic, sizeof(topic), "ul/%s/evt/benchmark", ul_core_get_node_id());
+  char *json = cJSON_PrintUnformatted(evt);
+  publish_json(topic, json);
+  cJSON_free(json);
+  cJSON_Delete(evt);
 }
 
-static bool handle_cmd_white_set(cJSON *root, int *out_channel) {
-  int channel = 0;
-  cJSON *jch = cJSON_GetObjectItem(root, "channel");
-  if (jch && cJSON_IsNumber(jch))
-    channel = jch->valueint;
+static void route_system_flush_window(const char *sub, cJSON *root,
+                                      const char *data, int data_len) {
+  (void)sub;
+  (void)data;
+  (void)data_len;
+  cJSON *jms = cJSON_GetObjectItem(root, "ms");
+  if (!jms || !cJSON_IsNumber(jms)) {
+    ESP_LOGW(TAG, "flush-window command missing \"ms\"");
+    return;
+  }
+  if (jms->valueint < 0)
+    return;
+  ul_state_set_flush_delay_ms((uint32_t)jms->valueint);
+}
 
-  if (out_channel)
-    *out_channel = channel;
+static void route_system_wipe_nvs(const char *sub, cJSON *root,
+                                  const char *data, int data_len) {
+  (void)sub;
+  (void)root;
+  (void)data;
+  (void)data_len;
+  handle_system_wipe_nvs();
+}
 
-  int brightness = 255;
-  cJSON *jbri = cJSON_GetObjectItem(root, "brightness");
-  if (jbri && cJSON_IsNumber(jbri))
-    brightness = jbri->valueint;
+#endif // !UL_MQTT_TESTING
+
+#if !defined(UL_MQTT_TESTING) || defined(UL_MQTT_BENCH)
+
+// Sorted by prefix; find_cmd_route() depends on the order.
+static const cmd_route_t s_cmd_routes[] = {
+    {"cron/set", true, UL_MQTT_ROUTE_FN(route_cron_set)},
+    {"motion/local", true, UL_MQTT_ROUTE_FN(route_motion_local)},
+    {"motion/off", true, UL_MQTT_ROUTE_FN(route_motion_off)},
+    {"motion/on", true, UL_MQTT_ROUTE_FN(route_motion_on)},
+    {"motion/status", true, UL_MQTT_ROUTE_FN(route_motion_status)},
+    {"ota/check", true, UL_MQTT_ROUTE_FN(route_ota_check)},
+    {"rgb/set", true, UL_MQTT_ROUTE_FN(route_rgb_set)},
+    {"scene/set", true, UL_MQTT_ROUTE_FN(route_scene_set)},
+    {"status", true, UL_MQTT_ROUTE_FN(route_status)},
+    {"system/benchmark", true, UL_MQTT_ROUTE_FN(route_system_benchmark)},
+    {"system/flush-window", true, UL_MQTT_ROUTE_FN(route_system_flush_window)},
+    {"system/wipe-nvs", true, UL_MQTT_ROUTE_FN(route_system_wipe_nvs)},
+    {"timeline/set", true, UL_MQTT_ROUTE_FN(route_timeline_set)},
+    {"white/set", true, UL_MQTT_ROUTE_FN(route_white_set)},
+    {"ws/set", true, UL_MQTT_ROUTE_FN(route_ws_set)},
+    {"ws/setb", false, UL_MQTT_ROUTE_FN(route_ws_setb)},
+};
+
+// Longest-prefix binary search. A route that extends another ("ws/setb"
+// after "ws/set") sorts after it, so the search keeps moving right on a
+// prefix hit and the last hit is the longest match.
+static const cmd_route_t *find_cmd_route(const char *sub) {
+  int lo = 0;
+  int hi = (int)(sizeof(s_cmd_routes) / sizeof(s_cmd_routes[0])) - 1;
+  const cmd_route_t *best = NULL;
+  while (lo <= hi) {
+    int mid = lo + (hi - lo) / 2;
+    int c = strncmp(sub, s_cmd_routes[mid].prefix,
+                    strlen(s_cmd_routes[mid].prefix));
+    if (c == 0) {
+      best = &s_cmd_routes[mid];
+      lo = mid + 1;
+    } else if (c < 0) {
+      hi = mid - 1;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return best;
+}
 
-  const char *effect = NULL;
-  cJSON *jeffect = cJSON_GetObjectItem(root, "effect");
-  if (jeffect && cJSON_IsString(jeffect))
-    effect = jeffect->valuestring;
+#endif // !UL_MQTT_TESTING || UL_MQTT_BENCH
 
-  cJSON *params = cJSON_GetObjectItem(root, "params");
+#ifndef UL_MQTT_TESTING
 
-  ul_white_apply_json(root);
+// ---- cJSON message arena ----------------------------------------------------
+// cJSON_Parse drives dozens of small mallocs and frees per command, straight
+// into the general heap between TLS and lwIP allocations -- our top
+// fragmentation source in heap traces. The parse tree for an incoming
+// command instead comes from a fixed bump arena: armed for the parse itself,
+// sealed before the handler runs (so anything a handler builds that outlives
+// the message -- the status cache, printed snapshots -- still goes to the
+// heap), and reclaimed wholesale when the next message arms it again.
+// Allocations from other tasks (OTA manifest parse, boot-time restore) pass
+// through to the heap untouched, so the global hooks are safe to install.
+
+#define UL_MQTT_JSON_ARENA_BYTES 4096 // > 3x UL_STATE_MAX_JSON_LEN of parse nodes
+
+static TaskHandle_t s_cmd_dispatch_task;
+
+static uint8_t s_json_arena[UL_MQTT_JSON_ARENA_BYTES];
+static size_t s_json_arena_used = 0;
+static bool s_json_arena_active = false; // armed only around the parse
+static uint32_t s_json_arena_spills = 0; // allocations that overflowed to heap
+
+static void *json_arena_malloc(size_t size) {
+  if (s_json_arena_active &&
+      xTaskGetCurrentTaskHandle() == s_cmd_dispatch_task) {
+    size_t aligned = (size + 7) & ~(size_t)7;
+    if (s_json_arena_used + aligned <= sizeof(s_json_arena)) {
+      void *p = &s_json_arena[s_json_arena_used];
+      s_json_arena_used += aligned;
+      return p;
+    }
+    // Oversized command: spill to the heap rather than failing the parse.
+    s_json_arena_spills++;
+    ESP_LOGD(TAG, "JSON arena full (%u spills)", (unsigned)s_json_arena_spills);
+  }
+  return malloc(size);
+}
 
-  ul_white_ch_status_t st;
-  bool have_status = ul_white_get_status(channel, &st);
-  if (have_status)
-    brightness = st.brightness;
+static void json_arena_free(void *ptr) {
+  uint8_t *p = (uint8_t *)ptr;
+  if (p >= s_json_arena && p < s_json_arena + sizeof(s_json_arena))
+    return; // arena memory is reclaimed wholesale, never freed piecemeal
+  free(ptr);
+}
 
-  bool ok = have_status;
-  if (effect && have_status)
-    ok = strcmp(st.effect, effect) == 0;
+// Arm the arena for one message's parse. Only the dispatcher task uses it;
+// the inline fallback path and every other cJSON caller stay on the heap.
+static bool json_arena_begin(void) {
+  if (xTaskGetCurrentTaskHandle() != s_cmd_dispatch_task)
+    return false;
+  s_json_arena_used = 0;
+  s_json_arena_active = true;
+  return true;
+}
 
-  publish_white_ack(channel, effect, params, brightness, ok);
+// Close the allocation window. The parse tree stays readable until the next
+// json_arena_begin(); nodes a handler attaches to it afterwards come from the
+// heap and are released normally by cJSON_Delete.
+static void json_arena_seal(void) { s_json_arena_active = false; }
 
-  return (!effect || ok);
+#ifndef UL_MQTT_TESTING
+// Peer OTA seed announcements arrive on the shared retained ul/ota/seed
+// topic rather than under a node's cmd tree. Remember the newest one from
+// someone else; ul_ota consults it when a matching manifest shows up.
+static void handle_seed_announcement(const char *data, int data_len) {
+  cJSON *root = cJSON_ParseWithLength(data, data_len);
+  if (!root)
+    return;
+  const cJSON *node = cJSON_GetObjectItemCaseSensitive(root, "node");
+  const cJSON *url = cJSON_GetObjectItemCaseSensitive(root, "url");
+  const cJSON *sha = cJSON_GetObjectItemCaseSensitive(root, "sha256");
+  const cJSON *size = cJSON_GetObjectItemCaseSensitive(root, "size");
+  if (cJSON_IsString(node) && node->valuestring &&
+      strcmp(node->valuestring, ul_core_get_node_id()) != 0 &&
+      cJSON_IsString(url) && url->valuestring && cJSON_IsString(sha) &&
+      sha->valuestring && cJSON_IsNumber(size) && size->valuedouble > 0) {
+    ul_ota_note_seed(url->valuestring, sha->valuestring,
+                     (size_t)size->valuedouble);
+  }
+  cJSON_Delete(root);
 }
-static void on_message(esp_mqtt_event_handle_t event) {
+#endif
+
+static void on_message(const char *topic, int tlen, const char *data,
+                       int data_len) {
   // topic expected: ul/<node>/cmd/...
   char node[64] = {0};
-  const char *topic = event->topic;
-  int tlen = event->topic_len;
   if (!topic || tlen <= 0)
     return;
 
+#ifndef UL_MQTT_TESTING
+  // The one subscription outside our own cmd tree.
+  if (tlen == 11 && strncmp(topic, "ul/ota/seed", 11) == 0) {
+    handle_seed_announcement(data, data_len);
+    return;
+  }
+#endif
+
   // Extract node id segment
   // pattern: "ul/xxxx/cmd/..."
   const char *p = memchr(topic, '/', tlen);
@@ -873,86 +2127,475 @@ static void on_message(esp_mqtt_event_handle_t event) {
   // Grab command path after "ul/<node>/"
   const char *cmdroot = slash2 + 1;
   int cmdlen = (topic + tlen) - cmdroot;
+  if (cmdlen < 4 || strncmp(cmdroot, "cmd/", 4) != 0)
+    return;
+  const char *sub = cmdroot + 4;
 
-  // Parse JSON
-  cJSON *root = cJSON_ParseWithLength(event->data, event->data_len);
-  if (!root) {
-    ESP_LOGW(TAG, "Invalid JSON payload");
+  // Any command addressed to us counts as activity: the radio is already
+  // awake (this publish just arrived), so this re-arms full power for the
+  // follow-up burst instead of letting modem sleep stretch a scene push.
+  ul_core_power_note_activity();
+
+  const cmd_route_t *route = find_cmd_route(sub);
+  if (!route) {
+    METRIC_INC(cmds_unknown);
+    ESP_LOGW(TAG, "Unknown cmd path: %.*s", cmdlen, cmdroot);
     return;
   }
 
-  if (cmdlen >= 3 && strncmp(cmdroot, "cmd", 3) == 0) {
-    const char *sub = cmdroot + 4; // skip "cmd/"
-    if (starts_with(sub, "ws/set")) {
-      motion_fade_cancel();
-      override_index_from_path(root, sub, "ws/set", "strip");
-      int strip = 0;
-      bool applied = handle_cmd_ws_set(root, &strip);
-      if (applied) {
-        if (event->data && event->data_len > 0) {
-          ul_state_record_ws(strip, event->data, event->data_len);
-        }
-      }
-    } else if (starts_with(sub, "rgb/set")) {
-      motion_fade_cancel();
-      override_index_from_path(root, sub, "rgb/set", "strip");
-      int strip = 0;
-      bool applied = handle_cmd_rgb_set(root, &strip);
-      if (applied) {
-        if (event->data && event->data_len > 0) {
-          ul_state_record_rgb(strip, event->data, event->data_len);
-        }
-      }
-    } else if (starts_with(sub, "ota/check")) {
-      ul_mqtt_publish_status();
-      const char *manifest_url_override = NULL;
-      const cJSON *manifest_url_json = root ? cJSON_GetObjectItem(root, "manifest_url") : NULL;
-      if (cJSON_IsString(manifest_url_json) && manifest_url_json->valuestring && manifest_url_json->valuestring[0]) {
-        manifest_url_override = manifest_url_json->valuestring;
-      }
-      ul_ota_check_now(true, manifest_url_override);
-      publish_status_snapshot();
+  // Binary routes carry no JSON; everything else is parsed once here, into
+  // the bump arena when this runs on the dispatcher task.
+  cJSON *root = NULL;
+  if (route->json) {
+    json_arena_begin();
+    root = cJSON_ParseWithLength(data, data_len);
+    json_arena_seal();
+    if (!root) {
+      METRIC_INC(parse_failures);
+      ESP_LOGW(TAG, "Invalid JSON payload");
+      return;
     }
-    else if (starts_with(sub, "white/set")) {
-      motion_fade_cancel();
-      override_index_from_path(root, sub, "white/set", "channel");
-      int channel = 0;
-      bool applied = handle_cmd_white_set(root, &channel);
-      if (applied) {
-        if (event->data && event->data_len > 0) {
-          ul_state_record_white(channel, event->data, event->data_len);
-        }
-      }
-    } else if (starts_with(sub, "motion/off")) {
-      int duration_ms = 2000;
-      int steps = 255;
-      cJSON *fade = cJSON_GetObjectItem(root, "fade");
-      if (fade && cJSON_IsObject(fade)) {
-        cJSON *dur = cJSON_GetObjectItem(fade, "duration_ms");
-        if (dur && cJSON_IsNumber(dur))
-          duration_ms = dur->valueint;
-        cJSON *jsteps = cJSON_GetObjectItem(fade, "steps");
-        if (jsteps && cJSON_IsNumber(jsteps))
-          steps = jsteps->valueint;
-      }
-      if (duration_ms <= 0 || steps <= 0) {
-        motion_fade_immediate_off();
-      } else {
-        motion_fade_start(duration_ms, steps);
-      }
-    } else if (starts_with(sub, "motion/on")) {
-      motion_fade_cancel();
-    } else if (starts_with(sub, "motion/status")) {
-      publish_motion_status();
-    } else if (starts_with(sub, "system/wipe-nvs")) {
-      handle_system_wipe_nvs();
-    } else if (starts_with(sub, "status")) {
-      ul_mqtt_publish_status_now();
-    } else {
-      ESP_LOGW(TAG, "Unknown cmd path: %.*s", cmdlen, cmdroot);
+  }
+  route->fn(sub, root, data, data_len);
+  METRIC_INC(cmds_processed);
+  if (root)
+    cJSON_Delete(root);
+}
+
+// ---- Command dispatch queue -------------------------------------------------
+// Incoming publishes are copied off the esp-mqtt event task and handled by a
+// dedicated dispatcher, so JSON parsing and strip updates never delay the
+// client task's keepalive/ACK handling. Scene pushes fan out 8-12 commands
+// per node; processing them inline was enough to trigger spurious broker
+// disconnects.
+
+#define UL_MQTT_CMD_QUEUE_LENGTH 16
+// The priority lane carries only small control payloads, so it stays short.
+#define UL_MQTT_CMD_HI_QUEUE_LENGTH 8
+#define UL_MQTT_CMD_MAX_TOPIC_LEN 128
+
+// ---- Large-publish reassembly ----
+// esp-mqtt delivers publishes larger than its internal RX buffer as a series
+// of MQTT_EVENT_DATA chunks (topic only on the first, then offset/total
+// bookkeeping). Scene and timeline payloads exceed the buffer routinely, so
+// chunked publishes are reassembled into a small pool of preallocated
+// max-payload buffers and handed to the dispatcher in place — no per-message
+// heap allocation, no copy, bounded memory. The client task processes one
+// inbound packet at a time, so at most one reassembly is ever in flight; the
+// extra pool buffers let the dispatcher still own a completed payload while
+// the next large publish streams in.
+typedef struct mqtt_rx_buf {
+  atomic_bool in_use; // claimed by the event task, released after dispatch
+  int msg_id;
+  char topic[UL_MQTT_CMD_MAX_TOPIC_LEN];
+  int topic_len;
+  int total_len;
+  int filled;
+  char data[CONFIG_UL_MQTT_REASM_BUF_SIZE];
+} mqtt_rx_buf_t;
+
+static mqtt_rx_buf_t s_rx_pool[CONFIG_UL_MQTT_REASM_BUFFERS];
+static mqtt_rx_buf_t *s_rx_cur = NULL; // reassembly in flight on the event task
+
+typedef struct {
+  char topic[UL_MQTT_CMD_MAX_TOPIC_LEN];
+  int topic_len;
+  char *payload; // NUL-terminated; heap copy or rx_buf->data, never both
+  int payload_len;
+  int coalesce_key;       // (type, index) for set commands, CMD_KEY_NONE otherwise
+  mqtt_rx_buf_t *rx_buf;  // set when payload lives in the reassembly pool
+} mqtt_cmd_t;
+
+static mqtt_rx_buf_t *rx_buf_claim(void) {
+  for (int i = 0; i < CONFIG_UL_MQTT_REASM_BUFFERS; ++i) {
+    bool expected = false;
+    if (atomic_compare_exchange_strong_explicit(&s_rx_pool[i].in_use,
+                                                &expected, true,
+                                                memory_order_acquire,
+                                                memory_order_relaxed))
+      return &s_rx_pool[i];
+  }
+  return NULL;
+}
+
+static void rx_buf_release(mqtt_rx_buf_t *buf) {
+  atomic_store_explicit(&buf->in_use, false, memory_order_release);
+}
+
+// Queue entries own their payload either as a heap copy (small commands) or
+// as a claimed pool buffer (reassembled large commands); every drop/consume
+// path releases through here.
+static void cmd_release_payload(mqtt_cmd_t *cmd) {
+  if (cmd->rx_buf)
+    rx_buf_release(cmd->rx_buf);
+  else
+    free(cmd->payload);
+}
+
+// Two lanes, one dispatcher: commands a person is waiting on (motion
+// restores, off/brightness tweaks) go to the priority lane, which is drained
+// before the bulk lane touches scene pushes and params-heavy configuration.
+// Worst-case latency for the commands users notice stays independent of bulk
+// traffic. The counting semaphore is signalled once per enqueued command; the
+// dispatcher blocks on it and then polls both lanes, priority first.
+// Coalesced drops leave surplus signals behind, costing one empty wakeup each.
+static QueueHandle_t s_cmd_queue = NULL;    // bulk lane
+static QueueHandle_t s_cmd_queue_hi = NULL; // priority lane
+static SemaphoreHandle_t s_cmd_ready_sem = NULL;
+static TaskHandle_t s_cmd_dispatch_task = NULL;
+
+// Last-writer-wins coalescing: a dashboard slider drag delivers dozens of
+// set commands per second for one strip. A newer set command supersedes any
+// older queued one with the same (command type, strip/channel index), so the
+// dispatcher applies at most one per strip per drain and slider drags no
+// longer starve concurrent animations.
+
+#define CMD_KEY_NONE (-1)
+
+#endif // !UL_MQTT_TESTING
+
+#if !defined(UL_MQTT_TESTING) || defined(UL_MQTT_BENCH)
+
+// Cheap index lookup for set commands whose topic path carries no index:
+// find the first "<field>": <number> in our own flat command payloads
+// without a full JSON parse on the event task.
+static int cmd_payload_index(const char *payload, const char *field) {
+  if (!payload)
+    return 0;
+  char quoted[16];
+  snprintf(quoted, sizeof(quoted), "\"%s\"", field);
+  const char *p = strstr(payload, quoted);
+  if (!p)
+    return 0;
+  p = strchr(p + strlen(quoted), ':');
+  if (!p)
+    return 0;
+  return (int)strtol(p + 1, NULL, 10);
+}
+
+#endif // !UL_MQTT_TESTING || UL_MQTT_BENCH
+
+#ifndef UL_MQTT_TESTING
+
+static int cmd_coalesce_key(const mqtt_cmd_t *cmd) {
+  // Locate the command path after "ul/<node>/cmd/".
+  const char *slash = strchr(cmd->topic, '/');
+  if (!slash)
+    return CMD_KEY_NONE;
+  slash = strchr(slash + 1, '/');
+  if (!slash || strncmp(slash + 1, "cmd/", 4) != 0)
+    return CMD_KEY_NONE;
+  const char *sub = slash + 5;
+
+  int type;
+  const char *rest;
+  if (starts_with(sub, "ws/set")) {
+    type = 0;
+    rest = sub + strlen("ws/set");
+  } else if (starts_with(sub, "rgb/set")) {
+    type = 1;
+    rest = sub + strlen("rgb/set");
+  } else if (starts_with(sub, "white/set")) {
+    type = 2;
+    rest = sub + strlen("white/set");
+  } else {
+    return CMD_KEY_NONE;
+  }
+
+  if (type == 0 && rest[0] == 'b') {
+    // Binary ws/setb: the strip index is the second payload byte. Shares the
+    // ws key space so a newer binary set supersedes a queued JSON one too.
+    if (!cmd->payload || cmd->payload_len < 2)
+      return CMD_KEY_NONE;
+    return (uint8_t)cmd->payload[1];
+  }
+
+  int index;
+  if (rest[0] == '/') {
+    char *end;
+    long v = strtol(rest + 1, &end, 10);
+    if (end <= rest + 1)
+      return CMD_KEY_NONE;
+    index = (int)v;
+  } else {
+    index = cmd_payload_index(cmd->payload, type == 2 ? "channel" : "strip");
+  }
+  if (index < 0 || index > 0xFF)
+    return CMD_KEY_NONE;
+  return (type << 8) | index;
+}
+
+// Lane classification. motion/* commands and small set payloads (off,
+// brightness, effect picks) are what a person is physically waiting on; set
+// payloads carrying "params" or "segments" are exactly the bulk configuration
+// the priority lane exists to bypass. Runs on the esp-mqtt event task, so it
+// is a bounded substring scan, never a parse. Binary ws/setb payloads have no
+// quoted keys and land in the priority lane, which suits their use.
+static bool cmd_is_priority(const mqtt_cmd_t *cmd) {
+  const char *slash = strchr(cmd->topic, '/');
+  if (slash)
+    slash = strchr(slash + 1, '/');
+  if (!slash || strncmp(slash + 1, "cmd/", 4) != 0)
+    return false;
+  const char *sub = slash + 5;
+  if (starts_with(sub, "motion/"))
+    return true;
+  if (starts_with(sub, "ws/set") || starts_with(sub, "rgb/set") ||
+      starts_with(sub, "white/set")) {
+    return !cmd->payload || (strstr(cmd->payload, "\"params\"") == NULL &&
+                             strstr(cmd->payload, "\"segments\"") == NULL);
+  }
+  return false;
+}
+
+// Pull every waiting entry once and re-queue the ones that survive; the
+// dispatcher draining concurrently is harmless, it just processes entries a
+// little earlier. Order of the survivors is preserved.
+static void drop_superseded_in(QueueHandle_t queue, int key) {
+  UBaseType_t waiting = uxQueueMessagesWaiting(queue);
+  for (UBaseType_t i = 0; i < waiting; ++i) {
+    mqtt_cmd_t queued;
+    if (xQueueReceive(queue, &queued, 0) != pdTRUE)
+      break;
+    if (queued.coalesce_key == key) {
+      METRIC_INC(cmds_coalesced);
+      ESP_LOGD(TAG, "Coalesced stale command %.*s", queued.topic_len,
+               queued.topic);
+      cmd_release_payload(&queued);
+      continue;
+    }
+    if (xQueueSend(queue, &queued, 0) != pdTRUE) {
+      // Cannot happen after the receive above freed a slot; drop defensively
+      // rather than block the event task.
+      cmd_release_payload(&queued);
     }
   }
-  cJSON_Delete(root);
+}
+
+// A newer set command supersedes an older one for the same target in either
+// lane: a small "off" rightly kills a queued params-heavy set of the same
+// strip, and vice versa.
+static void drop_superseded_cmds(int key) {
+  if (key == CMD_KEY_NONE)
+    return;
+  drop_superseded_in(s_cmd_queue_hi, key);
+  drop_superseded_in(s_cmd_queue, key);
+}
+
+static void cmd_dispatch_task(void *arg) {
+  (void)arg;
+  while (1) {
+    if (xSemaphoreTake(s_cmd_ready_sem, portMAX_DELAY) != pdTRUE)
+      continue;
+    mqtt_cmd_t cmd;
+    if (xQueueReceive(s_cmd_queue_hi, &cmd, 0) != pdTRUE &&
+        xQueueReceive(s_cmd_queue, &cmd, 0) != pdTRUE)
+      continue; // surplus signal left behind by a coalesced drop
+    on_message(cmd.topic, cmd.topic_len, cmd.payload, cmd.payload_len);
+    cmd_release_payload(&cmd);
+  }
+}
+
+static bool ensure_cmd_dispatcher(void) {
+  if (s_cmd_dispatch_task)
+    return true;
+  if (!s_cmd_queue) {
+    s_cmd_queue = xQueueCreate(UL_MQTT_CMD_QUEUE_LENGTH, sizeof(mqtt_cmd_t));
+    if (!s_cmd_queue)
+      return false;
+  }
+  if (!s_cmd_queue_hi) {
+    s_cmd_queue_hi =
+        xQueueCreate(UL_MQTT_CMD_HI_QUEUE_LENGTH, sizeof(mqtt_cmd_t));
+    if (!s_cmd_queue_hi)
+      return false;
+  }
+  if (!s_cmd_ready_sem) {
+    // Max count covers both lanes full; a give lost to saturation is safe
+    // because the pending signals already cover every queued entry.
+    s_cmd_ready_sem = xSemaphoreCreateCounting(
+        UL_MQTT_CMD_QUEUE_LENGTH + UL_MQTT_CMD_HI_QUEUE_LENGTH, 0);
+    if (!s_cmd_ready_sem)
+      return false;
+  }
+  // Route all cJSON allocations through the arena-aware hooks before the
+  // dispatcher can parse its first message. Callers outside the dispatch
+  // window fall through to the heap inside the hooks themselves.
+  static bool s_json_hooks_installed = false;
+  if (!s_json_hooks_installed) {
+    cJSON_Hooks hooks = {
+        .malloc_fn = json_arena_malloc,
+        .free_fn = json_arena_free,
+    };
+    cJSON_InitHooks(&hooks);
+    s_json_hooks_installed = true;
+  }
+  // Just below the esp-mqtt client task's priority and on the network core,
+  // so keepalive traffic always preempts command processing.
+  BaseType_t rc = ul_task_create(cmd_dispatch_task, "mqtt_cmd", 6144, NULL, 4,
+                                 &s_cmd_dispatch_task, 0);
+  if (rc != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create MQTT command dispatcher task (%ld)",
+             (long)rc);
+    s_cmd_dispatch_task = NULL;
+    return false;
+  }
+  return true;
+}
+
+// Move a command into the dispatch queue with last-writer-wins coalescing.
+// Small commands get a heap payload copy; reassembled ones pass their pool
+// buffer through (`rx_buf` non-NULL, `data` pointing at its contents), and
+// the queue entry takes ownership either way. Callers have already ensured
+// the dispatcher exists.
+static void enqueue_cmd(const char *topic, int topic_len, const char *data,
+                        int data_len, mqtt_rx_buf_t *rx_buf) {
+  mqtt_cmd_t cmd = {0};
+  memcpy(cmd.topic, topic, topic_len);
+  cmd.topic_len = topic_len;
+  if (rx_buf) {
+    cmd.rx_buf = rx_buf;
+    cmd.payload = rx_buf->data;
+    cmd.payload_len = data_len;
+  } else if (data && data_len > 0) {
+    cmd.payload = malloc((size_t)data_len + 1);
+    if (!cmd.payload) {
+      METRIC_INC(cmds_dropped);
+      ESP_LOGW(TAG, "Dropping command; no memory for %d byte payload",
+               data_len);
+      return;
+    }
+    memcpy(cmd.payload, data, data_len);
+    cmd.payload[data_len] = '\0';
+    cmd.payload_len = data_len;
+  }
+  cmd.coalesce_key = cmd_coalesce_key(&cmd);
+  drop_superseded_cmds(cmd.coalesce_key);
+
+  // A full priority lane overflows into the bulk lane rather than dropping:
+  // late beats lost for an off or motion command.
+  QueueHandle_t lane = cmd_is_priority(&cmd) ? s_cmd_queue_hi : s_cmd_queue;
+  if (xQueueSend(lane, &cmd, 0) != pdTRUE &&
+      (lane == s_cmd_queue || xQueueSend(s_cmd_queue, &cmd, 0) != pdTRUE)) {
+    METRIC_INC(cmds_dropped);
+    ESP_LOGW(TAG, "Command queue full; dropping %.*s", cmd.topic_len,
+             cmd.topic);
+    cmd_release_payload(&cmd);
+    return;
+  }
+  xSemaphoreGive(s_cmd_ready_sem);
+
+  uint_fast32_t depth =
+      (uint_fast32_t)(uxQueueMessagesWaiting(s_cmd_queue) +
+                      uxQueueMessagesWaiting(s_cmd_queue_hi));
+  uint_fast32_t seen =
+      atomic_load_explicit(&s_metrics.cmd_queue_hwm, memory_order_relaxed);
+  while (depth > seen &&
+         !atomic_compare_exchange_weak_explicit(&s_metrics.cmd_queue_hwm,
+                                                &seen, depth,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+  }
+}
+
+static void enqueue_message(esp_mqtt_event_handle_t event) {
+  if (!event->topic || event->topic_len <= 0)
+    return;
+  if (event->topic_len >= UL_MQTT_CMD_MAX_TOPIC_LEN) {
+    METRIC_INC(cmds_dropped);
+    ESP_LOGW(TAG, "Dropping command with oversized topic (%d bytes)",
+             event->topic_len);
+    return;
+  }
+  if (!ensure_cmd_dispatcher()) {
+    // No dispatcher available; better to handle inline than drop the command.
+    on_message(event->topic, event->topic_len, event->data, event->data_len);
+    return;
+  }
+  enqueue_cmd(event->topic, event->topic_len, event->data, event->data_len,
+              NULL);
+}
+
+// Reassemble a chunked publish into a pool buffer. Chunks of one message
+// arrive in order on the event task with the topic only on the first;
+// interleaving is impossible because the client task parses one packet at a
+// time. Messages that exceed the pool buffer, or arrive while every buffer
+// is owned by queued commands, are dropped whole (the skip state swallows
+// their remaining chunks).
+static void reassemble_chunk(esp_mqtt_event_handle_t event) {
+  if (event->current_data_offset == 0) {
+    if (s_rx_cur) { // previous reassembly never completed; reclaim it
+      rx_buf_release(s_rx_cur);
+      s_rx_cur = NULL;
+    }
+    if (!event->topic || event->topic_len <= 0 ||
+        event->topic_len >= UL_MQTT_CMD_MAX_TOPIC_LEN)
+      return;
+    if (event->total_data_len >= CONFIG_UL_MQTT_REASM_BUF_SIZE) {
+      METRIC_INC(cmds_dropped);
+      ESP_LOGW(TAG, "Dropping %d byte publish on %.*s (reassembly buffer is %d)",
+               event->total_data_len, event->topic_len, event->topic,
+               CONFIG_UL_MQTT_REASM_BUF_SIZE);
+      return;
+    }
+    mqtt_rx_buf_t *buf = rx_buf_claim();
+    if (!buf) {
+      METRIC_INC(cmds_dropped);
+      ESP_LOGW(TAG, "Dropping %d byte publish on %.*s; reassembly pool busy",
+               event->total_data_len, event->topic_len, event->topic);
+      return;
+    }
+    memcpy(buf->topic, event->topic, event->topic_len);
+    buf->topic_len = event->topic_len;
+    buf->msg_id = event->msg_id;
+    buf->total_len = event->total_data_len;
+    buf->filled = 0;
+    s_rx_cur = buf;
+  }
+  mqtt_rx_buf_t *buf = s_rx_cur;
+  if (!buf)
+    return; // first chunk was dropped; swallow the rest
+  if (event->msg_id != buf->msg_id ||
+      event->current_data_offset != buf->filled ||
+      buf->filled + event->data_len > buf->total_len) {
+    // Should not happen given in-order delivery; abandon rather than hand a
+    // torn payload to the dispatcher.
+    ESP_LOGW(TAG, "Chunk sequence broken on %.*s; dropping publish",
+             buf->topic_len, buf->topic);
+    METRIC_INC(cmds_dropped);
+    rx_buf_release(buf);
+    s_rx_cur = NULL;
+    return;
+  }
+  memcpy(buf->data + buf->filled, event->data, event->data_len);
+  buf->filled += event->data_len;
+  if (buf->filled < buf->total_len)
+    return;
+  buf->data[buf->filled] = '\0';
+  s_rx_cur = NULL;
+  if (!ensure_cmd_dispatcher()) {
+    on_message(buf->topic, buf->topic_len, buf->data, buf->filled);
+    rx_buf_release(buf);
+    return;
+  }
+  enqueue_cmd(buf->topic, buf->topic_len, buf->data, buf->filled, buf);
+}
+
+void ul_mqtt_submit_local(const char *path, const char *data, int data_len) {
+  if (!path || !path[0])
+    return;
+  // Synthesize our own command topic so routing, coalescing and the metrics
+  // treat the command exactly like one that came through the broker.
+  char topic[UL_MQTT_CMD_MAX_TOPIC_LEN];
+  int tlen = snprintf(topic, sizeof(topic), "ul/%s/cmd/%s",
+                      ul_core_get_node_id(), path);
+  if (tlen <= 0 || tlen >= (int)sizeof(topic))
+    return;
+  if (!ensure_cmd_dispatcher()) {
+    on_message(topic, tlen, data, data_len);
+    return;
+  }
+  enqueue_cmd(topic, tlen, data, data_len, NULL);
 }
 
 static void publish_account_credentials_if_secure(void) {
@@ -985,36 +2628,89 @@ static void publish_account_credentials_if_secure(void) {
   }
 }
 
+// Outstanding SUBSCRIBE from the current connection; UL_MQTT_READY_BIT is
+// held back until its SUBACK arrives, so "ready" means commandable, not
+// merely connected.
+static int s_cmd_sub_msg_id = -1;
+
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
                                int32_t event_id, void *event_data) {
   esp_mqtt_event_handle_t event = event_data;
   switch (event->event_id) {
   case MQTT_EVENT_CONNECTED: {
     ESP_LOGI(TAG, "MQTT connected");
+    METRIC_INC(connects);
     s_ready = true;
     s_consecutive_start_failures = 0;
     s_restart_on_next_retry = false;
 #ifndef UL_MQTT_TESTING
     EventGroupHandle_t group = mqtt_state_event_group();
-    if (group)
-      xEventGroupSetBits(group, UL_MQTT_READY_BIT);
     if (s_publish_ack_queue)
       xQueueReset(s_publish_ack_queue);
+    publish_track_reset();
 #endif
     ul_health_notify_mqtt(true);
     restore_all_lights();
+    bool awaiting_suback = false;
     if (ul_core_is_connected()) {
-      char topic[128];
-      snprintf(topic, sizeof(topic), "ul/%s/cmd/#", ul_core_get_node_id());
-      esp_mqtt_client_subscribe(s_client, topic, 1);
-      esp_mqtt_client_subscribe(s_client, "ul/+/cmd/#", 0);
+      // session_present on the CONNACK means the broker resumed our
+      // persistent session and the command subscriptions are already live;
+      // only a fresh session pays the SUBSCRIBE round trip.
+      if (event->session_present) {
+        ESP_LOGI(TAG, "Broker resumed session; subscriptions intact");
+      } else {
+        char topic[128];
+        snprintf(topic, sizeof(topic), "ul/%s/cmd/#", ul_core_get_node_id());
+        // All filters ride one SUBSCRIBE packet, so reconnect-to-commandable
+        // costs a single SUBACK round trip no matter how many command
+        // families get added.
+        esp_mqtt_topic_t filters[] = {
+            {.filter = topic, .qos = 1},
+            {.filter = "ul/+/cmd/#", .qos = 0},
+            {.filter = "ul/ota/seed", .qos = 0},
+        };
+        s_cmd_sub_msg_id = esp_mqtt_client_subscribe_multiple(
+            s_client, filters, sizeof(filters) / sizeof(filters[0]));
+        if (s_cmd_sub_msg_id < 0) {
+          // Outbox refused the packet; report ready anyway (matching the old
+          // fire-and-forget behaviour) rather than wedging the node.
+          ESP_LOGE(TAG, "Subscribe failed (%d)", s_cmd_sub_msg_id);
+          s_cmd_sub_msg_id = -1;
+        } else {
+          awaiting_suback = true;
+        }
+      }
     }
+#ifndef UL_MQTT_TESTING
+    if (group && !awaiting_suback)
+      xEventGroupSetBits(group, UL_MQTT_READY_BIT);
+#else
+    (void)awaiting_suback;
+#endif
+    // Re-announce on every connect: the retained copy goes stale when our
+    // IP changes, and announcing is one small enqueued publish.
+    ul_ota_seed_announce();
     publish_account_credentials_if_secure();
+    // Peers may have missed deltas while we were away; resync them with one
+    // full snapshot.
+    ul_mqtt_publish_status_now();
     break;
   }
+  case MQTT_EVENT_SUBSCRIBED:
+    if (event->msg_id == s_cmd_sub_msg_id) {
+      s_cmd_sub_msg_id = -1;
+      ESP_LOGI(TAG, "Command subscriptions acknowledged");
+#ifndef UL_MQTT_TESTING
+      EventGroupHandle_t group = mqtt_state_event_group();
+      if (group)
+        xEventGroupSetBits(group, UL_MQTT_READY_BIT);
+#endif
+    }
+    break;
 #ifndef UL_MQTT_TESTING
   case MQTT_EVENT_PUBLISHED: {
     ESP_LOGD(TAG, "MQTT published msg_id=%d", event->msg_id);
+    publish_track_complete(event->msg_id);
     if (s_publish_ack_queue) {
       int msg_id = event->msg_id;
       if (xQueueSend(s_publish_ack_queue, &msg_id, 0) != pdTRUE) {
@@ -1035,7 +2731,9 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
 #endif
   case MQTT_EVENT_DISCONNECTED:
     ESP_LOGW(TAG, "MQTT disconnected");
+    METRIC_INC(disconnects);
     s_ready = false;
+    s_cmd_sub_msg_id = -1;
     s_account_credentials_sent = false;
     ul_health_notify_mqtt(false);
     dim_all_lights();
@@ -1045,10 +2743,18 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
       xEventGroupClearBits(group, UL_MQTT_READY_BIT);
     if (s_publish_ack_queue)
       xQueueReset(s_publish_ack_queue);
+    publish_track_reset();
+    if (s_rx_cur) { // half-assembled publish dies with the connection
+      rx_buf_release(s_rx_cur);
+      s_rx_cur = NULL;
+    }
 #endif
     break;
   case MQTT_EVENT_DATA:
-    on_message(event);
+    if (event->data_len < event->total_data_len)
+      reassemble_chunk(event);
+    else
+      enqueue_message(event);
     break;
   case MQTT_EVENT_ERROR: {
     esp_mqtt_error_codes_t *err = event->error_handle;
@@ -1069,6 +2775,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
     break;
   }
 }
+#endif // !UL_MQTT_TESTING
 
 static void cancel_mqtt_retry(void) {
   if (!s_retry_timer)
@@ -1086,6 +2793,7 @@ void ul_mqtt_start(void);
 void ul_mqtt_restart(void);
 
 static void note_mqtt_start_failure(void) {
+  METRIC_INC(start_failures);
   if (s_consecutive_start_failures < UINT32_MAX)
     s_consecutive_start_failures++;
   if (!s_restart_on_next_retry &&
@@ -1207,11 +2915,34 @@ void ul_mqtt_start(void) {
       .broker.address.uri = mqtt_uri,
       .task.priority = 5,
       .task.stack_size = 6144,
+      // Persistent session: the broker keeps our QoS1 command subscriptions
+      // across blips, so a reconnect is commandable straight off the CONNACK
+      // instead of after a fresh round of SUBSCRIBE round-trips.
+      .session.disable_clean_session = true,
   };
 
   // We now just use simple username/password authentication
   cfg.credentials.username = CONFIG_UL_MQTT_USER;
   cfg.credentials.authentication.password = CONFIG_UL_MQTT_PASS;
+  // A session is persisted against the client id, so pin it to the node id
+  // rather than the library's default.
+  cfg.credentials.client_id = ul_core_get_node_id();
+
+  // Attach the provisioned client certificate/key when present so brokers
+  // enforcing mutual TLS accept the connection. The buffers must outlive the
+  // client, hence the static copy.
+  static ul_wifi_credentials_t s_mqtt_creds;
+  if (ul_wifi_credentials_load(&s_mqtt_creds) &&
+      s_mqtt_creds.mqtt_client_cert_len > 0 &&
+      s_mqtt_creds.mqtt_client_key_len > 0) {
+    cfg.credentials.authentication.certificate =
+        (const char *)s_mqtt_creds.mqtt_client_cert;
+    cfg.credentials.authentication.certificate_len =
+        s_mqtt_creds.mqtt_client_cert_len;
+    cfg.credentials.authentication.key =
+        (const char *)s_mqtt_creds.mqtt_client_key;
+    cfg.credentials.authentication.key_len = s_mqtt_creds.mqtt_client_key_len;
+  }
 
   if (CONFIG_UL_MQTT_CONNECT_TIMEOUT_MS > 0)
     cfg.network.timeout_ms = CONFIG_UL_MQTT_CONNECT_TIMEOUT_MS;
@@ -1225,7 +2956,14 @@ void ul_mqtt_start(void) {
     return;
   }
 
-  esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
+  esp_err_t reg_err =
+      esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
+  if (reg_err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to register MQTT event handler (%d)", (int)reg_err);
+    esp_mqtt_client_destroy(client);
+    note_mqtt_start_failure();
+    return;
+  }
 
   s_client = client;
   esp_err_t start_err = esp_mqtt_client_start(s_client);
@@ -1260,6 +2998,17 @@ void ul_mqtt_stop(void) {
 }
 
 void ul_mqtt_restart(void) {
+  // Prefer reconnecting the existing client: its esp-tls context holds the
+  // TLS session ticket from the last connection, so the new handshake is
+  // symmetric resumption instead of a full asymmetric exchange. Tearing the
+  // client down (below) discards the ticket and pays the full handshake.
+  if (s_client && ul_core_is_connected()) {
+    ESP_LOGW(TAG, "Reconnecting MQTT client");
+    esp_mqtt_client_disconnect(s_client);
+    if (esp_mqtt_client_reconnect(s_client) == ESP_OK)
+      return;
+    ESP_LOGW(TAG, "Reconnect failed; rebuilding MQTT client");
+  }
   ESP_LOGW(TAG, "Restarting MQTT client");
   bool had_client = s_client != NULL;
   ul_mqtt_stop();
@@ -1282,11 +3031,11 @@ bool ul_mqtt_wait_for_ready(TickType_t timeout_ticks) {
   (void)timeout_ticks;
   return s_ready;
 #else
-  if (s_ready)
-    return true;
+  // No s_ready shortcut: the bit lags the connection by one SUBACK round
+  // trip, and "ready" promises the command subscriptions are live.
   EventGroupHandle_t group = mqtt_state_event_group();
   if (!group)
-    return false;
+    return s_ready;
   EventBits_t bits =
       xEventGroupWaitBits(group, UL_MQTT_READY_BIT, pdFALSE, pdFALSE, timeout_ticks);
   return (bits & UL_MQTT_READY_BIT) != 0;
@@ -1294,7 +3043,12 @@ bool ul_mqtt_wait_for_ready(TickType_t timeout_ticks) {
 }
 
 #ifndef UL_MQTT_TESTING
-void ul_mqtt_publish_status_now(void) { publish_status_snapshot(); }
+void ul_mqtt_publish_status_now(void) {
+  // An explicit status request is the debugging path: rebuild everything so
+  // the live instrumentation counters (fps, render times) are current.
+  invalidate_status_all();
+  publish_status_snapshot();
+}
 
 void ul_mqtt_run_local(const char *path, const char *json) {
   if (!path || !json)
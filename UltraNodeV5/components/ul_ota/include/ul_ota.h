@@ -6,11 +6,23 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 // Triggered via MQTT: ul/<node_id>/cmd/ota/check
 // manifest_url_override: if non-NULL and non-empty, use this URL instead of
 // the compiled-in CONFIG_UL_OTA_MANIFEST_URL.
 void ul_ota_check_now(bool force, const char *manifest_url_override);
 
+// LAN peer seeding. A node that completed an update serves the verified
+// image from its running partition over HTTP (CONFIG_UL_OTA_SEED) and
+// announces it on the shared ul/ota/seed MQTT topic; updating peers whose
+// manifest digest matches pull from the peer instead of the WAN.
+// ul_ota_seed_start() is called once from app_main; the others are called
+// by ul_mqtt on connect and on announcement arrival respectively.
+void ul_ota_seed_start(void);
+void ul_ota_seed_announce(void);
+void ul_ota_note_seed(const char *url, const char *sha256_hex, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
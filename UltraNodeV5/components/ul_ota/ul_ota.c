@@ -2,75 +2,69 @@
 #include "ul_ota.h"
 #include "esp_https_ota.h"
 #include "esp_http_client.h"
+#include "esp_app_desc.h"
 #include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
 #include "esp_tls.h"
+#include "mbedtls/sha256.h"
+#include "rom/miniz.h"
 #include "ul_core.h"
 #include "ul_mqtt.h"
+#include "ul_task.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
-#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include "cJSON.h"
+#include "esp_random.h"
+#include "nvs.h"
 #include "esp_crt_bundle.h"
 #include "mbedtls/x509_crt.h"
 
 static const char* TAG = "ul_ota";
 
+// Manifests are small (<2 KB in practice); accumulating the response in a
+// static buffer with a hard cap keeps the update check off the general heap
+// entirely, so it still works on long-uptime nodes whose heap is too
+// fragmented for a doubling realloc chain — exactly the nodes that most need
+// the update. Anything larger than the cap is rejected as malformed.
+#define UL_OTA_MANIFEST_MAX_LEN 2048
+
 typedef struct {
-    char *data;
+    char data[UL_OTA_MANIFEST_MAX_LEN];
     size_t len;
-    size_t cap;
-    bool failed;
-} http_buffer_t;
+    bool overflow;
+} manifest_buffer_t;
+
+// Checks are serialized through the MQTT command task, so one static buffer
+// suffices.
+static manifest_buffer_t s_manifest_buf;
+
+#define UL_OTA_URL_MAX_LEN 256
 
 typedef struct {
-    char *binary_url;
-    char *binary_url_lan;
-    char *version;
-    char *sha256_hex;
-    char *sig;
+    char binary_url[UL_OTA_URL_MAX_LEN];
+    char binary_url_lan[UL_OTA_URL_MAX_LEN];
+    // Optional zlib-compressed variant of the same image; size/sha256_hex
+    // above always describe the decompressed binary.
+    char binary_url_zz[UL_OTA_URL_MAX_LEN];
+    char binary_url_zz_lan[UL_OTA_URL_MAX_LEN];
+    size_t size_zz;
+    // Optional base for per-source-version delta patches; the node appends
+    // its own running version plus ".bin" to form the patch URL.
+    char delta_url_base[UL_OTA_URL_MAX_LEN];
+    char delta_url_base_lan[UL_OTA_URL_MAX_LEN];
+    char version[32];
+    char sha256_hex[65];
+    char sig[160];
     size_t size;
 } ul_ota_manifest_t;
 
-static void http_buffer_free(http_buffer_t *buffer)
-{
-    if (!buffer) {
-        return;
-    }
-    free(buffer->data);
-    buffer->data = NULL;
-    buffer->len = 0;
-    buffer->cap = 0;
-    buffer->failed = false;
-}
-
-static bool http_buffer_reserve(http_buffer_t *buffer, size_t needed)
-{
-    if (needed <= buffer->cap) {
-        return true;
-    }
-
-    size_t new_cap = buffer->cap ? buffer->cap : 256;
-    while (new_cap < needed) {
-        if (new_cap > SIZE_MAX / 2) {
-            buffer->failed = true;
-            return false;
-        }
-        new_cap *= 2;
-    }
-
-    char *tmp = realloc(buffer->data, new_cap);
-    if (!tmp) {
-        buffer->failed = true;
-        return false;
-    }
-
-    buffer->data = tmp;
-    buffer->cap = new_cap;
-    return true;
-}
-
 static char *dup_string(const char *src)
 {
     if (!src) {
@@ -318,31 +312,103 @@ static char *ul_resolve_relative_url(const esp_http_client_config_t *cfg, const
     return full_url;
 }
 
-static void ul_ota_manifest_free(ul_ota_manifest_t *manifest)
+// Copies a JSON string field into a fixed-size destination. Returns false
+// (and clears the destination) when the field is absent, not a string, empty,
+// or too long for the slot.
+static bool copy_manifest_field(char *dst, size_t dst_len, const cJSON *item)
+{
+    dst[0] = '\0';
+    if (!cJSON_IsString(item) || !item->valuestring || !item->valuestring[0]) {
+        return false;
+    }
+    size_t len = strlen(item->valuestring);
+    if (len >= dst_len) {
+        return false;
+    }
+    memcpy(dst, item->valuestring, len + 1);
+    return true;
+}
+
+// Manifest validators for conditional fetches. An unchanged manifest then
+// costs a 304 with no body and no JSON parse. The NVS copy keeps 304s
+// working across reboots; the RAM copy is loaded once and refreshed when a
+// 200 carries new validator headers.
+#define UL_OTA_NVS_NAMESPACE "ulota"
+#define UL_OTA_ETAG_MAX 80
+#define UL_OTA_LASTMOD_MAX 40
+
+static char s_manifest_etag[UL_OTA_ETAG_MAX];
+static char s_manifest_lastmod[UL_OTA_LASTMOD_MAX];
+static bool s_validators_loaded;
+// Captured from the in-flight response by the event handler.
+static char s_rx_etag[UL_OTA_ETAG_MAX];
+static char s_rx_lastmod[UL_OTA_LASTMOD_MAX];
+
+static void manifest_validators_load(void)
 {
-    if (!manifest) {
+    if (s_validators_loaded) {
         return;
     }
-    free(manifest->binary_url);
-    free(manifest->binary_url_lan);
-    free(manifest->version);
-    free(manifest->sha256_hex);
-    free(manifest->sig);
-    memset(manifest, 0, sizeof(*manifest));
+    s_validators_loaded = true;
+    nvs_handle_t handle;
+    if (nvs_open(UL_OTA_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    size_t len = sizeof(s_manifest_etag);
+    if (nvs_get_str(handle, "etag", s_manifest_etag, &len) != ESP_OK) {
+        s_manifest_etag[0] = '\0';
+    }
+    len = sizeof(s_manifest_lastmod);
+    if (nvs_get_str(handle, "lastmod", s_manifest_lastmod, &len) != ESP_OK) {
+        s_manifest_lastmod[0] = '\0';
+    }
+    nvs_close(handle);
+}
+
+static void manifest_validators_store(void)
+{
+    manifest_validators_load(); // seed the comparison after a forced check
+    if (strcmp(s_rx_etag, s_manifest_etag) == 0 &&
+        strcmp(s_rx_lastmod, s_manifest_lastmod) == 0) {
+        return; // unchanged; spare the flash write
+    }
+    strlcpy(s_manifest_etag, s_rx_etag, sizeof(s_manifest_etag));
+    strlcpy(s_manifest_lastmod, s_rx_lastmod, sizeof(s_manifest_lastmod));
+    nvs_handle_t handle;
+    if (nvs_open(UL_OTA_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    nvs_set_str(handle, "etag", s_manifest_etag);
+    nvs_set_str(handle, "lastmod", s_manifest_lastmod);
+    nvs_commit(handle);
+    nvs_close(handle);
 }
 
 static esp_err_t manifest_http_event_handler(esp_http_client_event_t *evt)
 {
-    http_buffer_t *buffer = evt->user_data;
+    manifest_buffer_t *buffer = evt->user_data;
 
     switch (evt->event_id) {
+        case HTTP_EVENT_ON_HEADER:
+            if (evt->header_key && evt->header_value) {
+                if (strcasecmp(evt->header_key, "ETag") == 0) {
+                    strlcpy(s_rx_etag, evt->header_value, sizeof(s_rx_etag));
+                } else if (strcasecmp(evt->header_key, "Last-Modified") == 0) {
+                    strlcpy(s_rx_lastmod, evt->header_value,
+                            sizeof(s_rx_lastmod));
+                }
+            }
+            break;
         case HTTP_EVENT_ON_DATA:
             if (!buffer || !evt->data || evt->data_len <= 0) {
                 break;
             }
-            if (!http_buffer_reserve(buffer, buffer->len + evt->data_len + 1)) {
-                buffer->failed = true;
-                ESP_LOGE(TAG, "Failed to grow manifest buffer");
+            if (buffer->len + (size_t)evt->data_len + 1 > sizeof(buffer->data)) {
+                if (!buffer->overflow) {
+                    ESP_LOGE(TAG, "Manifest exceeds %u byte cap",
+                             (unsigned)sizeof(buffer->data));
+                }
+                buffer->overflow = true;
                 return ESP_FAIL;
             }
             memcpy(buffer->data + buffer->len, evt->data, evt->data_len);
@@ -356,30 +422,87 @@ static esp_err_t manifest_http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
+#if CONFIG_UL_OTA_MANIFEST_KEEPALIVE
+// Persistent manifest client. Routine "no update available" checks reuse the
+// client, its parsed trust context and — when the server honours keep-alive —
+// the live TLS connection, instead of rebuilding the whole stack cold every
+// period. The handler/user_data wired in at init are the same statics every
+// check, so reuse never re-points them. An override URL or any transport
+// error drops the cached client and the next check starts cold.
+static esp_http_client_handle_t s_manifest_client;
+static char s_manifest_client_url[UL_OTA_URL_MAX_LEN];
+#endif
+
 static esp_err_t ul_ota_fetch_manifest(const esp_http_client_config_t *base_cfg,
-                                       ul_ota_manifest_t *out_manifest)
+                                       ul_ota_manifest_t *out_manifest,
+                                       bool conditional, bool *not_modified)
 {
     if (!base_cfg || !out_manifest) {
         return ESP_ERR_INVALID_ARG;
     }
 
     *out_manifest = (ul_ota_manifest_t){0};
-    http_buffer_t buffer = {0};
+    if (not_modified) {
+        *not_modified = false;
+    }
+    s_manifest_buf.len = 0;
+    s_manifest_buf.overflow = false;
+    s_rx_etag[0] = '\0';
+    s_rx_lastmod[0] = '\0';
 
     esp_http_client_config_t cfg = *base_cfg;
     cfg.event_handler = manifest_http_event_handler;
-    cfg.user_data = &buffer;
-
+    cfg.user_data = &s_manifest_buf;
+
+#if CONFIG_UL_OTA_MANIFEST_KEEPALIVE
+    cfg.keep_alive_enable = true;
+    esp_http_client_handle_t client = NULL;
+    if (s_manifest_client) {
+        if (cfg.url && strcmp(s_manifest_client_url, cfg.url) == 0) {
+            client = s_manifest_client;
+        } else {
+            esp_http_client_cleanup(s_manifest_client);
+            s_manifest_client = NULL;
+        }
+    }
+    if (!client) {
+        client = esp_http_client_init(&cfg);
+        if (!client) {
+            ESP_LOGE(TAG, "Failed to init HTTP client for manifest");
+            return ESP_ERR_NO_MEM;
+        }
+        s_manifest_client = client;
+        strlcpy(s_manifest_client_url, cfg.url ? cfg.url : "",
+                sizeof(s_manifest_client_url));
+    }
+#else
     esp_http_client_handle_t client = esp_http_client_init(&cfg);
     if (!client) {
         ESP_LOGE(TAG, "Failed to init HTTP client for manifest");
         return ESP_ERR_NO_MEM;
     }
+#endif
 
     if (strlen(CONFIG_UL_OTA_BEARER_TOKEN)) {
         esp_http_client_set_header(client, "Authorization", "Bearer " CONFIG_UL_OTA_BEARER_TOKEN);
     }
 
+    // Headers stick to a kept-alive client, so clear the validators before
+    // optionally re-adding them — a forced check must fetch unconditionally.
+    esp_http_client_delete_header(client, "If-None-Match");
+    esp_http_client_delete_header(client, "If-Modified-Since");
+    if (conditional) {
+        manifest_validators_load();
+        if (s_manifest_etag[0]) {
+            esp_http_client_set_header(client, "If-None-Match",
+                                       s_manifest_etag);
+        }
+        if (s_manifest_lastmod[0]) {
+            esp_http_client_set_header(client, "If-Modified-Since",
+                                       s_manifest_lastmod);
+        }
+    }
+
     esp_err_t err = esp_http_client_perform(client);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Manifest download failed: %s", esp_err_to_name(err));
@@ -387,25 +510,32 @@ static esp_err_t ul_ota_fetch_manifest(const esp_http_client_config_t *base_cfg,
     }
 
     int status = esp_http_client_get_status_code(client);
+    if (conditional && status == 304) {
+        // Unchanged since last check: no body, nothing to parse.
+        if (not_modified) {
+            *not_modified = true;
+        }
+        goto cleanup;
+    }
     if (status != 200) {
         ESP_LOGE(TAG, "Manifest HTTP status %d", status);
         err = ESP_ERR_INVALID_RESPONSE;
         goto cleanup;
     }
 
-    if (buffer.failed) {
-        ESP_LOGE(TAG, "Manifest buffer allocation failed");
-        err = ESP_ERR_NO_MEM;
+    if (s_manifest_buf.overflow) {
+        ESP_LOGE(TAG, "Manifest over size cap; refusing to parse");
+        err = ESP_ERR_INVALID_RESPONSE;
         goto cleanup;
     }
 
-    if (!buffer.data || buffer.len == 0) {
+    if (s_manifest_buf.len == 0) {
         ESP_LOGE(TAG, "Empty manifest response");
         err = ESP_ERR_INVALID_RESPONSE;
         goto cleanup;
     }
 
-    cJSON *root = cJSON_ParseWithLength(buffer.data, buffer.len);
+    cJSON *root = cJSON_ParseWithLength(s_manifest_buf.data, s_manifest_buf.len);
     if (!root) {
         ESP_LOGE(TAG, "Failed to parse manifest JSON");
         err = ESP_ERR_INVALID_RESPONSE;
@@ -413,44 +543,48 @@ static esp_err_t ul_ota_fetch_manifest(const esp_http_client_config_t *base_cfg,
     }
 
     const cJSON *binary_url = cJSON_GetObjectItemCaseSensitive(root, "binary_url");
-    if (!cJSON_IsString(binary_url) || !binary_url->valuestring || !binary_url->valuestring[0]) {
-        ESP_LOGE(TAG, "Manifest missing binary_url");
+    if (!copy_manifest_field(out_manifest->binary_url,
+                             sizeof(out_manifest->binary_url), binary_url)) {
+        ESP_LOGE(TAG, "Manifest missing or oversized binary_url");
         cJSON_Delete(root);
         err = ESP_ERR_INVALID_RESPONSE;
         goto cleanup;
     }
 
-    out_manifest->binary_url = dup_string(binary_url->valuestring);
-    if (!out_manifest->binary_url) {
-        cJSON_Delete(root);
-        err = ESP_ERR_NO_MEM;
-        goto cleanup;
-    }
-
     const cJSON *binary_url_lan = cJSON_GetObjectItemCaseSensitive(root, "binary_url_lan");
-    if (cJSON_IsString(binary_url_lan) && binary_url_lan->valuestring && binary_url_lan->valuestring[0]) {
-        out_manifest->binary_url_lan = dup_string(binary_url_lan->valuestring);
-        if (!out_manifest->binary_url_lan) {
-            cJSON_Delete(root);
-            err = ESP_ERR_NO_MEM;
-            goto cleanup;
-        }
-    }
-
-    const cJSON *version = cJSON_GetObjectItemCaseSensitive(root, "version");
-    if (cJSON_IsString(version) && version->valuestring) {
-        out_manifest->version = dup_string(version->valuestring);
+    if (cJSON_IsString(binary_url_lan) &&
+        !copy_manifest_field(out_manifest->binary_url_lan,
+                             sizeof(out_manifest->binary_url_lan),
+                             binary_url_lan)) {
+        // Fall back to binary_url rather than failing the whole check.
+        ESP_LOGW(TAG, "Ignoring oversized binary_url_lan");
     }
 
-    const cJSON *sha = cJSON_GetObjectItemCaseSensitive(root, "sha256_hex");
-    if (cJSON_IsString(sha) && sha->valuestring && sha->valuestring[0]) {
-        out_manifest->sha256_hex = dup_string(sha->valuestring);
+    copy_manifest_field(out_manifest->binary_url_zz,
+                        sizeof(out_manifest->binary_url_zz),
+                        cJSON_GetObjectItemCaseSensitive(root, "binary_url_zz"));
+    copy_manifest_field(out_manifest->binary_url_zz_lan,
+                        sizeof(out_manifest->binary_url_zz_lan),
+                        cJSON_GetObjectItemCaseSensitive(root, "binary_url_zz_lan"));
+    const cJSON *size_zz = cJSON_GetObjectItemCaseSensitive(root, "size_zz");
+    if (cJSON_IsNumber(size_zz) && size_zz->valuedouble >= 0) {
+        out_manifest->size_zz = (size_t)size_zz->valuedouble;
     }
 
-    const cJSON *sig = cJSON_GetObjectItemCaseSensitive(root, "sig");
-    if (cJSON_IsString(sig) && sig->valuestring && sig->valuestring[0]) {
-        out_manifest->sig = dup_string(sig->valuestring);
-    }
+    copy_manifest_field(out_manifest->delta_url_base,
+                        sizeof(out_manifest->delta_url_base),
+                        cJSON_GetObjectItemCaseSensitive(root, "delta_url_base"));
+    copy_manifest_field(out_manifest->delta_url_base_lan,
+                        sizeof(out_manifest->delta_url_base_lan),
+                        cJSON_GetObjectItemCaseSensitive(root, "delta_url_base_lan"));
+
+    copy_manifest_field(out_manifest->version, sizeof(out_manifest->version),
+                        cJSON_GetObjectItemCaseSensitive(root, "version"));
+    copy_manifest_field(out_manifest->sha256_hex,
+                        sizeof(out_manifest->sha256_hex),
+                        cJSON_GetObjectItemCaseSensitive(root, "sha256_hex"));
+    copy_manifest_field(out_manifest->sig, sizeof(out_manifest->sig),
+                        cJSON_GetObjectItemCaseSensitive(root, "sig"));
 
     const cJSON *size = cJSON_GetObjectItemCaseSensitive(root, "size");
     if (cJSON_IsNumber(size) && size->valuedouble >= 0) {
@@ -459,12 +593,26 @@ static esp_err_t ul_ota_fetch_manifest(const esp_http_client_config_t *base_cfg,
 
     cJSON_Delete(root);
 
+    // Remember this manifest's validators so the next routine check can ask
+    // "changed since?" instead of re-downloading.
+    if (s_rx_etag[0] || s_rx_lastmod[0]) {
+        manifest_validators_store();
+    }
+
 cleanup:
+#if CONFIG_UL_OTA_MANIFEST_KEEPALIVE
+    if (err != ESP_OK) {
+        // A failed perform can leave the connection or TLS state wedged;
+        // rebuild cold on the next check.
+        esp_http_client_cleanup(client);
+        s_manifest_client = NULL;
+    }
+#else
     esp_http_client_cleanup(client);
-    http_buffer_free(&buffer);
+#endif
 
     if (err != ESP_OK) {
-        ul_ota_manifest_free(out_manifest);
+        memset(out_manifest, 0, sizeof(*out_manifest));
     }
 
     return err;
@@ -547,6 +695,995 @@ static esp_err_t _ota_http_client_init_cb(esp_http_client_handle_t client)
     return ESP_OK;
 }
 
+// ---------------------------------------------------------------------------
+// Resumable image download
+//
+// esp_https_ota restarts from byte zero after any interruption, which on
+// weak-RSSI nodes turns one large image into several full downloads. When
+// the manifest carries both size and sha256_hex the image is staged manually
+// instead: chunks go straight to the update partition, the byte offset
+// survives a failed attempt, and the next check requests only the remainder
+// with an HTTP Range header. The finished partition is verified against the
+// manifest digest before it becomes bootable. The bookkeeping lives in RAM;
+// a reboot simply falls back to a fresh download.
+
+// Two ping-pong buffers: one receives decrypted TLS data while the writer
+// task programs the other into flash, so the TCP window keeps moving during
+// the multi-millisecond flash program of each chunk. Size is tunable via
+// Kconfig.
+#define UL_OTA_PIPE_BUF_LEN (CONFIG_UL_OTA_DOWNLOAD_BUF_KB * 1024)
+#define UL_OTA_PIPE_STOP 0xFF
+
+typedef struct {
+    const esp_partition_t *part;
+    size_t offset;       // decompressed bytes staged so far
+    size_t comp_offset;  // compressed bytes consumed (compressed streams)
+    size_t image_size;   // expected decompressed total, from the manifest
+    size_t comp_size;    // compressed total; 0 for uncompressed downloads
+    char sha256_hex[65]; // image identity; any mismatch discards the stage
+    // Rolling digest of the staged (decompressed) bytes, fed by the writer
+    // as each chunk lands, so the happy path needs no full-partition
+    // read-back to verify. Trustworthy only while sha_offset == offset;
+    // (size_t)-1 marks it poisoned, which drops us back to the read-back
+    // verify. Survives attempts within one boot exactly like the offsets.
+    mbedtls_sha256_context sha_ctx;
+    size_t sha_offset;
+} ota_resume_t;
+
+static ota_resume_t s_resume;
+
+static void stage_digest_restart(void)
+{
+    mbedtls_sha256_free(&s_resume.sha_ctx);
+    mbedtls_sha256_init(&s_resume.sha_ctx);
+    if (mbedtls_sha256_starts(&s_resume.sha_ctx, 0) != 0) {
+        s_resume.sha_offset = (size_t)-1;
+    } else {
+        s_resume.sha_offset = 0;
+    }
+}
+
+// Called with the staged chunk just before s_resume.offset advances past
+// it, so the in-step check is simply offset equality.
+static void stage_digest_update(const uint8_t *data, size_t len)
+{
+    if (s_resume.sha_offset != s_resume.offset) {
+        return; // poisoned or out of step; read-back verify will cover it
+    }
+    if (mbedtls_sha256_update(&s_resume.sha_ctx, data, len) != 0) {
+        s_resume.sha_offset = (size_t)-1;
+        return;
+    }
+    s_resume.sha_offset += len;
+}
+
+// Shared by the download and verify loops; OTA checks are serialized through
+// the MQTT command task.
+static uint8_t s_pipe_buf[2][UL_OTA_PIPE_BUF_LEN];
+
+// Download pipeline shared between the HTTP reader (the calling task) and
+// the flash writer task. Buffer indexes flow reader -> fill -> writer ->
+// done -> reader; the writer owns all s_resume offset updates while the
+// pipeline runs, so a failure leaves the offsets exactly at the last staged
+// byte.
+typedef struct {
+    const esp_partition_t *part;
+    size_t comp_size;
+    QueueHandle_t fill;
+    QueueHandle_t done;
+    size_t len[2];
+    bool last[2];
+    volatile esp_err_t err;
+} ota_pipe_t;
+
+static ota_pipe_t s_pipe;
+
+// Streaming inflate state for compressed images. The ROM tinfl decompressor
+// and its 32 KB dictionary persist across attempts within one boot, which is
+// what lets a compressed download resume mid-stream: the dictionary holds
+// exactly the output window tinfl needs to continue.
+static tinfl_decompressor s_inflator;
+static uint8_t s_inflate_dict[TINFL_LZ_DICT_SIZE];
+static size_t s_inflate_dict_ofs;
+
+static bool resume_matches(const ul_ota_manifest_t *manifest,
+                           const esp_partition_t *part, size_t comp_size)
+{
+    size_t progress = comp_size ? s_resume.comp_offset : s_resume.offset;
+    return s_resume.part == part && progress > 0 &&
+           s_resume.image_size == manifest->size &&
+           s_resume.comp_size == comp_size &&
+           strcmp(s_resume.sha256_hex, manifest->sha256_hex) == 0;
+}
+
+// Feeds a chunk of the compressed stream through tinfl and stages whatever
+// output it produces. Output always lands at the dictionary write cursor so
+// the sliding window stays coherent for back-references.
+static esp_err_t inflate_and_stage(const esp_partition_t *part,
+                                   const uint8_t *in, size_t in_len,
+                                   bool last_input)
+{
+    size_t in_ofs = 0;
+    while (true) {
+        size_t in_bytes = in_len - in_ofs;
+        size_t out_bytes = TINFL_LZ_DICT_SIZE - s_inflate_dict_ofs;
+        tinfl_status st = tinfl_decompress(
+            &s_inflator, in + in_ofs, &in_bytes, s_inflate_dict,
+            s_inflate_dict + s_inflate_dict_ofs, &out_bytes,
+            TINFL_FLAG_PARSE_ZLIB_HEADER |
+                (last_input ? 0 : TINFL_FLAG_HAS_MORE_INPUT));
+        in_ofs += in_bytes;
+        if (out_bytes > 0) {
+            if (s_resume.offset + out_bytes > s_resume.image_size) {
+                ESP_LOGE(TAG, "Decompressed stream exceeds manifest size");
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            esp_err_t err =
+                esp_partition_write(part, s_resume.offset,
+                                    s_inflate_dict + s_inflate_dict_ofs,
+                                    out_bytes);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Partition write failed at offset %u: %s",
+                         (unsigned)s_resume.offset, esp_err_to_name(err));
+                return err;
+            }
+            stage_digest_update(s_inflate_dict + s_inflate_dict_ofs, out_bytes);
+            s_resume.offset += out_bytes;
+            s_inflate_dict_ofs =
+                (s_inflate_dict_ofs + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+        if (st == TINFL_STATUS_DONE) {
+            return ESP_OK;
+        }
+        if (st == TINFL_STATUS_NEEDS_MORE_INPUT) {
+            if (in_ofs >= in_len) {
+                return ESP_OK; // next HTTP chunk continues the stream
+            }
+            continue;
+        }
+        if (st == TINFL_STATUS_HAS_MORE_OUTPUT) {
+            continue; // dictionary wrapped; drain the rest of this chunk
+        }
+        ESP_LOGE(TAG, "Decompression failed (%d)", (int)st);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+}
+
+static bool hex_digest_equal(const unsigned char digest[32], const char *hex)
+{
+    static const char lut[] = "0123456789abcdef";
+    for (int i = 0; i < 32; ++i) {
+        char a = hex[2 * i];
+        char b = hex[2 * i + 1];
+        if (a >= 'A' && a <= 'F') a += 'a' - 'A';
+        if (b >= 'A' && b <= 'F') b += 'a' - 'A';
+        if (a != lut[digest[i] >> 4] || b != lut[digest[i] & 0xf]) {
+            return false;
+        }
+    }
+    return hex[64] == '\0';
+}
+
+static esp_err_t verify_staged_image(const esp_partition_t *part,
+                                     size_t image_size, const char *sha256_hex)
+{
+    unsigned char digest[32];
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    if (mbedtls_sha256_starts(&ctx, 0) != 0) {
+        mbedtls_sha256_free(&ctx);
+        return ESP_FAIL;
+    }
+
+    esp_err_t err = ESP_OK;
+    size_t pos = 0;
+    while (pos < image_size) {
+        size_t n = image_size - pos;
+        if (n > sizeof(s_pipe_buf[0])) {
+            n = sizeof(s_pipe_buf[0]);
+        }
+        err = esp_partition_read(part, pos, s_pipe_buf[0], n);
+        if (err != ESP_OK) {
+            break;
+        }
+        if (mbedtls_sha256_update(&ctx, s_pipe_buf[0], n) != 0) {
+            err = ESP_FAIL;
+            break;
+        }
+        pos += n;
+    }
+    if (err == ESP_OK && mbedtls_sha256_finish(&ctx, digest) != 0) {
+        err = ESP_FAIL;
+    }
+    mbedtls_sha256_free(&ctx);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return hex_digest_equal(digest, sha256_hex) ? ESP_OK
+                                                : ESP_ERR_OTA_VALIDATE_FAILED;
+}
+
+// Flash side of the download pipeline. Programs (or inflates and programs)
+// each handed-off buffer while the reader refills the other one, then
+// recycles the index through the done queue. The writer owns all s_resume
+// offset advances while the pipeline runs.
+static void ota_writer_task(void *arg)
+{
+    ota_pipe_t *pipe = arg;
+    uint8_t idx;
+    while (xQueueReceive(pipe->fill, &idx, portMAX_DELAY) == pdTRUE) {
+        if (idx == UL_OTA_PIPE_STOP) {
+            break;
+        }
+        if (pipe->err == ESP_OK) {
+            esp_err_t err;
+            if (pipe->comp_size) {
+                err = inflate_and_stage(pipe->part, s_pipe_buf[idx],
+                                        pipe->len[idx], pipe->last[idx]);
+                if (err == ESP_OK) {
+                    s_resume.comp_offset += pipe->len[idx];
+                } else {
+                    // The partition holds bytes from a broken stream; make
+                    // the next attempt start clean.
+                    s_resume.offset = 0;
+                    s_resume.comp_offset = 0;
+                }
+            } else {
+                err = esp_partition_write(pipe->part, s_resume.offset,
+                                          s_pipe_buf[idx], pipe->len[idx]);
+                if (err == ESP_OK) {
+                    stage_digest_update(s_pipe_buf[idx], pipe->len[idx]);
+                    s_resume.offset += pipe->len[idx];
+                } else {
+                    ESP_LOGE(TAG, "Partition write failed at offset %u: %s",
+                             (unsigned)s_resume.offset, esp_err_to_name(err));
+                }
+            }
+            if (err != ESP_OK) {
+                pipe->err = err;
+            }
+        }
+        xQueueSend(pipe->done, &idx, portMAX_DELAY);
+    }
+    // Echo the stop token so the reader knows every buffer is flushed.
+    idx = UL_OTA_PIPE_STOP;
+    xQueueSend(pipe->done, &idx, portMAX_DELAY);
+    ul_task_forget(NULL);
+    vTaskDelete(NULL);
+}
+
+static bool ota_pipe_start(const esp_partition_t *part, size_t comp_size)
+{
+    s_pipe.part = part;
+    s_pipe.comp_size = comp_size;
+    s_pipe.err = ESP_OK;
+    // Depth 3 leaves room for the stop token with both buffers in flight.
+    s_pipe.fill = xQueueCreate(3, sizeof(uint8_t));
+    s_pipe.done = xQueueCreate(3, sizeof(uint8_t));
+    if (!s_pipe.fill || !s_pipe.done) {
+        goto fail;
+    }
+    for (uint8_t i = 0; i < 2; ++i) {
+        xQueueSend(s_pipe.done, &i, 0);
+    }
+    if (ul_task_create(ota_writer_task, "ota_write", 4096, &s_pipe, 5, NULL,
+                       UL_TASK_CORE_AUTO) != pdPASS) {
+        goto fail;
+    }
+    return true;
+
+fail:
+    if (s_pipe.fill) {
+        vQueueDelete(s_pipe.fill);
+        s_pipe.fill = NULL;
+    }
+    if (s_pipe.done) {
+        vQueueDelete(s_pipe.done);
+        s_pipe.done = NULL;
+    }
+    return false;
+}
+
+// Joins the writer task and tears down the queues. Returns the first error
+// the writer hit, if any.
+static esp_err_t ota_pipe_finish(void)
+{
+    uint8_t idx = UL_OTA_PIPE_STOP;
+    xQueueSend(s_pipe.fill, &idx, portMAX_DELAY);
+    do {
+        xQueueReceive(s_pipe.done, &idx, portMAX_DELAY);
+    } while (idx != UL_OTA_PIPE_STOP);
+    vQueueDelete(s_pipe.fill);
+    vQueueDelete(s_pipe.done);
+    s_pipe.fill = NULL;
+    s_pipe.done = NULL;
+    return s_pipe.err;
+}
+
+// Lightweight reachability probe: a HEAD request with a timeout well under
+// the download timeout, so a dead LAN mirror costs a few seconds instead of
+// a full TLS/download timeout before the WAN fallback kicks in.
+#define UL_OTA_PROBE_TIMEOUT_MS 3000
+
+static bool probe_url(const esp_http_client_config_t *base_cfg, const char *url)
+{
+    esp_http_client_config_t cfg = *base_cfg;
+    cfg.url = url;
+    cfg.method = HTTP_METHOD_HEAD;
+    cfg.timeout_ms = UL_OTA_PROBE_TIMEOUT_MS;
+    cfg.event_handler = NULL;
+    cfg.user_data = NULL;
+
+    esp_http_client_handle_t client = esp_http_client_init(&cfg);
+    if (!client) {
+        return false;
+    }
+    if (strlen(CONFIG_UL_OTA_BEARER_TOKEN)) {
+        esp_http_client_set_header(client, "Authorization",
+                                   "Bearer " CONFIG_UL_OTA_BEARER_TOKEN);
+    }
+    esp_err_t err = esp_http_client_perform(client);
+    int status = esp_http_client_get_status_code(client);
+    esp_http_client_cleanup(client);
+    return err == ESP_OK && status == 200;
+}
+
+// ---------------------------------------------------------------------------
+// LAN peer seeding
+//
+// A site of N identical nodes otherwise pulls the same release over the WAN
+// N times. A node that completes an update records the image identity, and
+// after the post-update boot serves the running partition over plain HTTP
+// while announcing {url, sha256, size} on the shared retained ul/ota/seed
+// topic. Updating peers whose manifest digest matches try the peer before
+// the configured URLs; range resume and sha256 verification work unchanged
+// because the peer serves byte-identical content.
+
+#if CONFIG_UL_OTA_SEED
+#include "esp_http_server.h"
+#include "esp_netif.h"
+#endif
+
+// Latest matching announcement heard from a peer. Both the announcement
+// handler and ul_ota_check_now run on the MQTT command dispatch task, so no
+// locking is needed.
+static char s_peer_url[UL_OTA_URL_MAX_LEN];
+static char s_peer_sha[65];
+static size_t s_peer_size;
+
+void ul_ota_note_seed(const char *url, const char *sha256_hex, size_t size)
+{
+    if (!url || !sha256_hex || strlen(sha256_hex) != 64 || size == 0 ||
+        strlen(url) >= sizeof(s_peer_url)) {
+        return;
+    }
+    strlcpy(s_peer_url, url, sizeof(s_peer_url));
+    strlcpy(s_peer_sha, sha256_hex, sizeof(s_peer_sha));
+    s_peer_size = size;
+}
+
+#if CONFIG_UL_OTA_SEED
+
+#define UL_OTA_SEED_CHUNK 4096
+
+// Identity of the image this node serves: set once at boot when the NVS
+// record from the last completed update matches the running partition.
+static size_t s_seed_size;
+static char s_seed_sha[65];
+static httpd_handle_t s_seed_httpd;
+
+// Persist what was just staged so the post-reboot boot knows the running
+// partition holds a verified image it can seed.
+static void seed_record_staged(const esp_partition_t *part, size_t size,
+                               const char *sha256_hex)
+{
+    nvs_handle_t handle;
+    if (nvs_open(UL_OTA_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    nvs_set_u32(handle, "seed_part", part->address);
+    nvs_set_u32(handle, "seed_size", (uint32_t)size);
+    nvs_set_str(handle, "seed_sha", sha256_hex);
+    nvs_commit(handle);
+    nvs_close(handle);
+}
+
+// Answers the probe_url() HEAD a peer sends before committing a download.
+static esp_err_t seed_head_handler(httpd_req_t *req)
+{
+    return httpd_resp_send(req, NULL, 0);
+}
+
+static esp_err_t seed_image_handler(httpd_req_t *req)
+{
+    const esp_partition_t *part = esp_ota_get_running_partition();
+    size_t start = 0;
+    char range[40];
+    char range_hdr[64];
+    if (httpd_req_get_hdr_value_str(req, "Range", range, sizeof(range)) ==
+        ESP_OK) {
+        unsigned from = 0;
+        if (sscanf(range, "bytes=%u-", &from) != 1 || from >= s_seed_size) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                       "bad range");
+        }
+        start = from;
+    }
+    httpd_resp_set_type(req, "application/octet-stream");
+    if (start > 0) {
+        // A 206 tells the resuming peer its Range was honored; answering
+        // 200 would make it restart the stage from scratch.
+        httpd_resp_set_status(req, "206 Partial Content");
+        snprintf(range_hdr, sizeof(range_hdr), "bytes %u-%u/%u",
+                 (unsigned)start, (unsigned)(s_seed_size - 1),
+                 (unsigned)s_seed_size);
+        httpd_resp_set_hdr(req, "Content-Range", range_hdr);
+    }
+
+    uint8_t *buf = malloc(UL_OTA_SEED_CHUNK);
+    if (!buf) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
+                                   "alloc failed");
+    }
+    esp_err_t err = ESP_OK;
+    size_t pos = start;
+    while (pos < s_seed_size) {
+        size_t n = s_seed_size - pos;
+        if (n > UL_OTA_SEED_CHUNK) {
+            n = UL_OTA_SEED_CHUNK;
+        }
+        err = esp_partition_read(part, pos, buf, n);
+        if (err == ESP_OK) {
+            err = httpd_resp_send_chunk(req, (const char *)buf, n);
+        }
+        if (err != ESP_OK) {
+            break; // peer went away mid-transfer; it resumes via Range
+        }
+        pos += n;
+    }
+    free(buf);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+void ul_ota_seed_start(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(UL_OTA_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    uint32_t part_addr = 0;
+    uint32_t size = 0;
+    size_t len = sizeof(s_seed_sha);
+    bool have = nvs_get_u32(handle, "seed_part", &part_addr) == ESP_OK &&
+                nvs_get_u32(handle, "seed_size", &size) == ESP_OK &&
+                nvs_get_str(handle, "seed_sha", s_seed_sha, &len) == ESP_OK;
+    nvs_close(handle);
+    if (!have || size == 0 || strlen(s_seed_sha) != 64) {
+        return; // never updated over the air; nothing verified to serve
+    }
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (!running || running->address != part_addr) {
+        // Rolled back or reflashed since the record was written; it no
+        // longer describes what this node is running.
+        return;
+    }
+    s_seed_size = size;
+
+    httpd_config_t cfg = HTTPD_DEFAULT_CONFIG();
+    cfg.server_port = CONFIG_UL_OTA_SEED_PORT;
+    cfg.max_open_sockets = 3;
+    if (httpd_start(&s_seed_httpd, &cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start OTA seed server");
+        s_seed_size = 0;
+        return;
+    }
+    httpd_uri_t image = {.uri = "/ota/image",
+                         .method = HTTP_GET,
+                         .handler = seed_image_handler,
+                         .user_ctx = NULL};
+    httpd_uri_t head = {.uri = "/ota/image",
+                        .method = HTTP_HEAD,
+                        .handler = seed_head_handler,
+                        .user_ctx = NULL};
+    httpd_register_uri_handler(s_seed_httpd, &image);
+    httpd_register_uri_handler(s_seed_httpd, &head);
+    ESP_LOGI(TAG, "Seeding OTA image (%u bytes) on port %d",
+             (unsigned)s_seed_size, CONFIG_UL_OTA_SEED_PORT);
+}
+
+void ul_ota_seed_announce(void)
+{
+    if (!s_seed_httpd || s_seed_size == 0) {
+        return;
+    }
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t ip;
+    if (!netif || esp_netif_get_ip_info(netif, &ip) != ESP_OK ||
+        ip.ip.addr == 0) {
+        return;
+    }
+    char url[64];
+    snprintf(url, sizeof(url), "http://" IPSTR ":%d/ota/image",
+             IP2STR(&ip.ip), CONFIG_UL_OTA_SEED_PORT);
+    ul_mqtt_publish_ota_seed(url, s_seed_sha, s_seed_size);
+}
+
+#else // CONFIG_UL_OTA_SEED
+
+void ul_ota_seed_start(void) {}
+void ul_ota_seed_announce(void) {}
+
+#endif // CONFIG_UL_OTA_SEED
+
+// ---------------------------------------------------------------------------
+// Delta patches
+//
+// Most releases change a small fraction of the image, so the server can
+// publish a patch keyed by the version the node is currently running ("ULD1"
+// format): COPY ops pull unchanged byte ranges out of the running partition,
+// ADD ops carry the bytes that actually changed. The reconstructed image is
+// verified against the manifest digest exactly like a full download, and any
+// failure falls back to the full image.
+
+#define UL_OTA_DELTA_MAGIC "ULD1"
+#define UL_OTA_DELTA_OP_COPY 0x00
+#define UL_OTA_DELTA_OP_ADD 0x01
+#define UL_OTA_DELTA_OP_END 0xFF
+
+static uint32_t read_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static esp_err_t ota_read_exact(esp_http_client_handle_t client, uint8_t *buf,
+                                size_t len)
+{
+    size_t got = 0;
+    while (got < len) {
+        int n = esp_http_client_read(client, (char *)buf + got,
+                                     (int)(len - got));
+        if (n < 0) {
+            return ESP_FAIL;
+        }
+        if (n == 0) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        got += (size_t)n;
+    }
+    return ESP_OK;
+}
+
+// Streams a delta patch and reconstructs the new image in the update
+// partition, copying unchanged ranges from the running partition. Patches
+// are a few tens of kilobytes, so there is no resume bookkeeping: a failed
+// attempt simply falls back to the full download.
+static esp_err_t ota_download_delta(const esp_http_client_config_t *base_cfg,
+                                    const ul_ota_manifest_t *manifest,
+                                    const char *url)
+{
+    const esp_partition_t *part = esp_ota_get_next_update_partition(NULL);
+    const esp_partition_t *src = esp_ota_get_running_partition();
+    if (!part || !src) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (manifest->size > part->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_http_client_config_t cfg = *base_cfg;
+    cfg.url = url;
+    cfg.event_handler = NULL;
+    cfg.user_data = NULL;
+
+    esp_http_client_handle_t client = esp_http_client_init(&cfg);
+    if (!client) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (strlen(CONFIG_UL_OTA_BEARER_TOKEN)) {
+        esp_http_client_set_header(client, "Authorization",
+                                   "Bearer " CONFIG_UL_OTA_BEARER_TOKEN);
+    }
+
+    // Every op's output passes through RAM before it is programmed, so the
+    // image digest accumulates during reconstruction and verification needs
+    // no read-back pass afterwards.
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    bool sha_ok = mbedtls_sha256_starts(&sha, 0) == 0;
+
+    esp_err_t err = esp_http_client_open(client, 0);
+    if (err != ESP_OK) {
+        mbedtls_sha256_free(&sha);
+        esp_http_client_cleanup(client);
+        return err;
+    }
+    esp_http_client_fetch_headers(client);
+    int status = esp_http_client_get_status_code(client);
+    if (status == 404) {
+        ESP_LOGI(TAG, "No delta for running version; using full image");
+        err = ESP_ERR_NOT_FOUND;
+        goto out;
+    }
+    if (status != 200) {
+        ESP_LOGE(TAG, "Delta download HTTP status %d", status);
+        err = ESP_ERR_INVALID_RESPONSE;
+        goto out;
+    }
+
+    uint8_t header[12];
+    err = ota_read_exact(client, header, sizeof(header));
+    if (err != ESP_OK) {
+        goto out;
+    }
+    if (memcmp(header, UL_OTA_DELTA_MAGIC, 4) != 0 ||
+        read_le32(header + 4) != manifest->size ||
+        read_le32(header + 8) > src->size) {
+        ESP_LOGE(TAG, "Delta header does not match manifest");
+        err = ESP_ERR_INVALID_RESPONSE;
+        goto out;
+    }
+    size_t src_size = read_le32(header + 8);
+
+    // The reconstruction reuses the partition any partially staged full
+    // download lives in, so that stage is gone either way.
+    s_resume.offset = 0;
+    s_resume.comp_offset = 0;
+    err = esp_partition_erase_range(part, 0, part->size);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to erase update partition: %s",
+                 esp_err_to_name(err));
+        goto out;
+    }
+
+    size_t out_ofs = 0;
+    bool done = false;
+    while (!done) {
+        uint8_t op;
+        err = ota_read_exact(client, &op, 1);
+        if (err != ESP_OK) {
+            goto out;
+        }
+        switch (op) {
+        case UL_OTA_DELTA_OP_COPY: {
+            uint8_t hdr[8];
+            err = ota_read_exact(client, hdr, sizeof(hdr));
+            if (err != ESP_OK) {
+                goto out;
+            }
+            size_t src_ofs = read_le32(hdr);
+            size_t len = read_le32(hdr + 4);
+            if (src_ofs + len > src_size || out_ofs + len > manifest->size) {
+                err = ESP_ERR_INVALID_RESPONSE;
+                goto out;
+            }
+            while (len > 0) {
+                size_t n = len > sizeof(s_pipe_buf[0]) ? sizeof(s_pipe_buf[0])
+                                                       : len;
+                err = esp_partition_read(src, src_ofs, s_pipe_buf[0], n);
+                if (err == ESP_OK) {
+                    err = esp_partition_write(part, out_ofs, s_pipe_buf[0], n);
+                }
+                if (err != ESP_OK) {
+                    goto out;
+                }
+                if (sha_ok &&
+                    mbedtls_sha256_update(&sha, s_pipe_buf[0], n) != 0) {
+                    sha_ok = false;
+                }
+                src_ofs += n;
+                out_ofs += n;
+                len -= n;
+            }
+            break;
+        }
+        case UL_OTA_DELTA_OP_ADD: {
+            uint8_t hdr[4];
+            err = ota_read_exact(client, hdr, sizeof(hdr));
+            if (err != ESP_OK) {
+                goto out;
+            }
+            size_t len = read_le32(hdr);
+            if (out_ofs + len > manifest->size) {
+                err = ESP_ERR_INVALID_RESPONSE;
+                goto out;
+            }
+            while (len > 0) {
+                size_t n = len > sizeof(s_pipe_buf[0]) ? sizeof(s_pipe_buf[0])
+                                                       : len;
+                err = ota_read_exact(client, s_pipe_buf[0], n);
+                if (err == ESP_OK) {
+                    err = esp_partition_write(part, out_ofs, s_pipe_buf[0], n);
+                }
+                if (err != ESP_OK) {
+                    goto out;
+                }
+                if (sha_ok &&
+                    mbedtls_sha256_update(&sha, s_pipe_buf[0], n) != 0) {
+                    sha_ok = false;
+                }
+                out_ofs += n;
+                len -= n;
+            }
+            break;
+        }
+        case UL_OTA_DELTA_OP_END:
+            done = true;
+            break;
+        default:
+            ESP_LOGE(TAG, "Unknown delta opcode 0x%02x", op);
+            err = ESP_ERR_INVALID_RESPONSE;
+            goto out;
+        }
+    }
+
+    if (out_ofs != manifest->size) {
+        ESP_LOGE(TAG, "Delta produced %u bytes, expected %u",
+                 (unsigned)out_ofs, (unsigned)manifest->size);
+        err = ESP_ERR_INVALID_RESPONSE;
+        goto out;
+    }
+
+    if (sha_ok) {
+        unsigned char digest[32];
+        err = (mbedtls_sha256_finish(&sha, digest) == 0 &&
+               hex_digest_equal(digest, manifest->sha256_hex))
+                  ? ESP_OK
+                  : ESP_ERR_OTA_VALIDATE_FAILED;
+    } else {
+        // A hash update failed mid-stream; fall back to the read-back pass.
+        err = verify_staged_image(part, manifest->size, manifest->sha256_hex);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Delta-built image failed sha256 verification");
+        goto out;
+    }
+    err = esp_ota_set_boot_partition(part);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set boot partition: %s", esp_err_to_name(err));
+    }
+#if CONFIG_UL_OTA_SEED
+    else {
+        seed_record_staged(part, manifest->size, manifest->sha256_hex);
+    }
+#endif
+
+out:
+    mbedtls_sha256_free(&sha);
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    return err;
+}
+
+// Downloads (optionally zlib-compressed) image bytes into the update
+// partition, resuming from the last staged offset when possible. comp_size
+// is the compressed stream length, or 0 when url points at the raw image.
+static esp_err_t ota_download_ranged(const esp_http_client_config_t *base_cfg,
+                                     const ul_ota_manifest_t *manifest,
+                                     const char *url, size_t comp_size)
+{
+    const esp_partition_t *part = esp_ota_get_next_update_partition(NULL);
+    if (!part) {
+        ESP_LOGE(TAG, "No update partition available");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (manifest->size > part->size) {
+        ESP_LOGE(TAG, "Image (%u bytes) exceeds update partition (%u)",
+                 (unsigned)manifest->size, (unsigned)part->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err;
+    if (!resume_matches(manifest, part, comp_size)) {
+        // New image (or nothing staged): erase once up front, then stage
+        // chunks at increasing offsets so an aborted attempt keeps its
+        // progress instead of forcing a re-erase.
+        err = esp_partition_erase_range(part, 0, part->size);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to erase update partition: %s",
+                     esp_err_to_name(err));
+            return err;
+        }
+        s_resume.part = part;
+        s_resume.offset = 0;
+        s_resume.comp_offset = 0;
+        s_resume.image_size = manifest->size;
+        s_resume.comp_size = comp_size;
+        memcpy(s_resume.sha256_hex, manifest->sha256_hex,
+               sizeof(s_resume.sha256_hex));
+        tinfl_init(&s_inflator);
+        s_inflate_dict_ofs = 0;
+        stage_digest_restart();
+    } else {
+        ESP_LOGI(TAG, "Resuming OTA download at %u of %u bytes",
+                 (unsigned)(comp_size ? s_resume.comp_offset : s_resume.offset),
+                 (unsigned)(comp_size ? comp_size : s_resume.image_size));
+    }
+
+    // Range offsets and the completion condition are in stream bytes, which
+    // for compressed images are not partition bytes.
+    size_t fetch_total = comp_size ? comp_size : s_resume.image_size;
+
+    esp_http_client_config_t cfg = *base_cfg;
+    cfg.url = url;
+    cfg.event_handler = NULL;
+    cfg.user_data = NULL;
+
+    esp_http_client_handle_t client = esp_http_client_init(&cfg);
+    if (!client) {
+        ESP_LOGE(TAG, "Failed to init HTTP client for OTA download");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (strlen(CONFIG_UL_OTA_BEARER_TOKEN)) {
+        esp_http_client_set_header(client, "Authorization",
+                                   "Bearer " CONFIG_UL_OTA_BEARER_TOKEN);
+    }
+    size_t range_start = comp_size ? s_resume.comp_offset : s_resume.offset;
+    if (range_start > 0) {
+        char range[40];
+        snprintf(range, sizeof(range), "bytes=%u-", (unsigned)range_start);
+        esp_http_client_set_header(client, "Range", range);
+    }
+
+    err = esp_http_client_open(client, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open OTA connection: %s", esp_err_to_name(err));
+        esp_http_client_cleanup(client);
+        return err;
+    }
+    esp_http_client_fetch_headers(client);
+    int status = esp_http_client_get_status_code(client);
+    if (range_start > 0 && status == 200) {
+        // Server ignored the range request and is sending the full body;
+        // the already-programmed region must be erased before rewriting.
+        ESP_LOGW(TAG, "Server ignored Range header; restarting from zero");
+        err = esp_partition_erase_range(part, 0, part->size);
+        if (err != ESP_OK) {
+            goto out;
+        }
+        s_resume.offset = 0;
+        s_resume.comp_offset = 0;
+        tinfl_init(&s_inflator);
+        s_inflate_dict_ofs = 0;
+        stage_digest_restart();
+    } else if (status != 200 && status != 206) {
+        ESP_LOGE(TAG, "OTA download HTTP status %d", status);
+        err = ESP_ERR_INVALID_RESPONSE;
+        goto out;
+    }
+
+    if (!ota_pipe_start(part, comp_size)) {
+        ESP_LOGE(TAG, "Failed to start OTA write pipeline");
+        err = ESP_ERR_NO_MEM;
+        goto out;
+    }
+
+    // Ping-pong download: fill one buffer from the TLS stream while the
+    // writer task flushes the other to flash.
+    size_t fetched = comp_size ? s_resume.comp_offset : s_resume.offset;
+    while (fetched < fetch_total) {
+        uint8_t idx;
+        xQueueReceive(s_pipe.done, &idx, portMAX_DELAY);
+        if (s_pipe.err != ESP_OK) {
+            break; // the writer already logged and recorded the failure
+        }
+        size_t want = fetch_total - fetched;
+        if (want > UL_OTA_PIPE_BUF_LEN) {
+            want = UL_OTA_PIPE_BUF_LEN;
+        }
+        int n = esp_http_client_read(client, (char *)s_pipe_buf[idx],
+                                     (int)want);
+        if (n < 0) {
+            ESP_LOGE(TAG, "OTA read failed at offset %u", (unsigned)fetched);
+            err = ESP_FAIL;
+            break;
+        }
+        if (n == 0) {
+            ESP_LOGW(TAG, "OTA stream ended %u bytes short; will resume",
+                     (unsigned)(fetch_total - fetched));
+            err = ESP_ERR_INVALID_RESPONSE;
+            break;
+        }
+        s_pipe.len[idx] = (size_t)n;
+        s_pipe.last[idx] = comp_size && (fetched + (size_t)n == fetch_total);
+        xQueueSend(s_pipe.fill, &idx, portMAX_DELAY);
+        fetched += (size_t)n;
+    }
+
+    esp_err_t pipe_err = ota_pipe_finish();
+    if (err == ESP_OK) {
+        err = pipe_err;
+    }
+    if (err != ESP_OK) {
+        goto out;
+    }
+
+    if (comp_size && s_resume.offset != s_resume.image_size) {
+        ESP_LOGE(TAG, "Decompressed %u bytes, expected %u",
+                 (unsigned)s_resume.offset, (unsigned)s_resume.image_size);
+        err = ESP_ERR_INVALID_RESPONSE;
+        s_resume.offset = 0;
+        s_resume.comp_offset = 0;
+        goto out;
+    }
+
+    // The writer hashed every staged chunk as it landed, so the normal case
+    // finishes verification here without re-reading the partition. Only a
+    // digest that fell out of step (poisoned context) pays for the full
+    // flash read-back.
+    if (s_resume.sha_offset == s_resume.image_size) {
+        unsigned char digest[32];
+        int rc = mbedtls_sha256_finish(&s_resume.sha_ctx, digest);
+        s_resume.sha_offset = (size_t)-1; // finish consumed the context
+        err = (rc == 0 && hex_digest_equal(digest, s_resume.sha256_hex))
+                  ? ESP_OK
+                  : ESP_ERR_OTA_VALIDATE_FAILED;
+    } else {
+        err = verify_staged_image(part, s_resume.image_size,
+                                  s_resume.sha256_hex);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Staged image failed sha256 verification");
+        // Bad bytes are on flash; never resume into a corrupt image.
+        s_resume.offset = 0;
+        s_resume.comp_offset = 0;
+        goto out;
+    }
+
+    err = esp_ota_set_boot_partition(part);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set boot partition: %s", esp_err_to_name(err));
+        s_resume.offset = 0;
+        s_resume.comp_offset = 0;
+        goto out;
+    }
+#if CONFIG_UL_OTA_SEED
+    seed_record_staged(part, s_resume.image_size, s_resume.sha256_hex);
+#endif
+    s_resume.offset = 0; // staged image is live; nothing left to resume
+    s_resume.comp_offset = 0;
+
+out:
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    return err;
+}
+
+// Persisted per-node random jitter for routine checks. Identically
+// configured nodes otherwise check on aligned schedules and hit the
+// manifest server in synchronized waves; a stable random offset per node
+// flattens the load curve, and persisting the draw keeps each node in the
+// same slot across reboots. The raw draw is stored so changing the jitter
+// window rescales it instead of re-rolling.
+static uint32_t check_jitter_ms(void)
+{
+#if CONFIG_UL_OTA_CHECK_JITTER_S > 0
+    static uint32_t s_jitter_draw;
+    static bool s_jitter_loaded;
+    if (!s_jitter_loaded) {
+        s_jitter_loaded = true;
+        nvs_handle_t handle;
+        if (nvs_open(UL_OTA_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+            if (nvs_get_u32(handle, "jitter", &s_jitter_draw) != ESP_OK) {
+                s_jitter_draw = esp_random();
+                nvs_set_u32(handle, "jitter", s_jitter_draw);
+                nvs_commit(handle);
+            }
+            nvs_close(handle);
+        } else {
+            s_jitter_draw = esp_random(); // unpersisted fallback
+        }
+    }
+    return s_jitter_draw % ((uint32_t)CONFIG_UL_OTA_CHECK_JITTER_S * 1000u);
+#else
+    return 0;
+#endif
+}
+
 void ul_ota_check_now(bool force, const char *manifest_url_override)
 {
     if (!ul_core_is_connected()) {
@@ -554,6 +1691,19 @@ void ul_ota_check_now(bool force, const char *manifest_url_override)
         ul_mqtt_publish_ota_event("skipped", "network_down");
         return;
     }
+    if (!force) {
+        uint32_t jitter_ms = check_jitter_ms();
+        if (jitter_ms > 0) {
+            ESP_LOGI(TAG, "Delaying routine OTA check by %u ms jitter",
+                     (unsigned)jitter_ms);
+            vTaskDelay(pdMS_TO_TICKS(jitter_ms));
+            if (!ul_core_is_connected()) {
+                ESP_LOGW(TAG, "Network dropped during jitter delay");
+                ul_mqtt_publish_ota_event("skipped", "network_down");
+                return;
+            }
+        }
+    }
     const char *manifest_url = (manifest_url_override && manifest_url_override[0])
         ? manifest_url_override
         : CONFIG_UL_OTA_MANIFEST_URL;
@@ -575,28 +1725,36 @@ void ul_ota_check_now(bool force, const char *manifest_url_override)
         http_cfg.common_name = CONFIG_UL_OTA_COMMON_NAME;
     }
 
-    ul_ota_manifest_t manifest = {0};
-    bool have_manifest = false;
+    static ul_ota_manifest_t manifest;
+    memset(&manifest, 0, sizeof(manifest));
     const char *ota_url = NULL;
     char *resolved_ota_url = NULL;
 
-    esp_err_t err = ul_ota_fetch_manifest(&http_cfg, &manifest);
+    // Routine checks are conditional: an unchanged manifest answers 304
+    // with no body. A forced check always fetches fresh.
+    bool not_modified = false;
+    esp_err_t err = ul_ota_fetch_manifest(&http_cfg, &manifest, !force,
+                                          &not_modified);
     if (err != ESP_OK) {
         ul_mqtt_publish_ota_event("manifest_fail", esp_err_to_name(err));
         ESP_LOGE(TAG, "Failed to fetch OTA manifest: %s", esp_err_to_name(err));
         log_ota_error_hint(err, NULL);
         goto cleanup;
     }
-    have_manifest = true;
+    if (not_modified) {
+        ESP_LOGI(TAG, "Manifest unchanged since last check");
+        ul_mqtt_publish_ota_event("manifest_unchanged", manifest_url);
+        goto cleanup;
+    }
 
-    if (manifest.binary_url_lan && strlen(CONFIG_UL_OTA_SERVER_HOST)) {
+    if (manifest.binary_url_lan[0] && strlen(CONFIG_UL_OTA_SERVER_HOST)) {
         ota_url = manifest.binary_url_lan;
         ESP_LOGI(TAG, "Using LAN OTA URL from manifest");
     } else {
         ota_url = manifest.binary_url;
     }
 
-    if (!ota_url) {
+    if (!ota_url[0]) {
         ul_mqtt_publish_ota_event("manifest_fail", "missing_binary_url");
         ESP_LOGE(TAG, "Manifest did not provide a binary_url");
         err = ESP_ERR_INVALID_RESPONSE;
@@ -611,8 +1769,8 @@ void ul_ota_check_now(bool force, const char *manifest_url_override)
         goto cleanup;
     }
 
-    const char *manifest_version = manifest.version ? manifest.version : "unknown";
-    const char *manifest_sha = manifest.sha256_hex ? manifest.sha256_hex : "n/a";
+    const char *manifest_version = manifest.version[0] ? manifest.version : "unknown";
+    const char *manifest_sha = manifest.sha256_hex[0] ? manifest.sha256_hex : "n/a";
     if (manifest.size > 0) {
         ESP_LOGI(TAG, "Manifest version=%s size=%zu sha256=%s",
                  manifest_version,
@@ -626,6 +1784,151 @@ void ul_ota_check_now(bool force, const char *manifest_url_override)
     ESP_LOGI(TAG, "OTA image URL: %s", resolved_ota_url);
     ul_mqtt_publish_ota_event("manifest_ok", resolved_ota_url);
 
+    if (manifest.size > 0 && manifest.sha256_hex[0]) {
+        // A patch keyed by the running version beats any full download by an
+        // order of magnitude; try it first and fall back on any failure.
+        const esp_app_desc_t *app_desc = esp_app_get_description();
+        if (manifest.delta_url_base[0] && manifest.version[0] &&
+            app_desc->version[0] &&
+            strcmp(manifest.version, app_desc->version) != 0) {
+            const char *delta_base = manifest.delta_url_base;
+            if (manifest.delta_url_base_lan[0] && strlen(CONFIG_UL_OTA_SERVER_HOST)) {
+                delta_base = manifest.delta_url_base_lan;
+            }
+            char delta_rel[UL_OTA_URL_MAX_LEN + sizeof(app_desc->version) + 4];
+            snprintf(delta_rel, sizeof(delta_rel), "%s%s.bin", delta_base,
+                     app_desc->version);
+            char *delta_url = ul_resolve_relative_url(&http_cfg, delta_rel);
+            if (delta_url) {
+                ESP_LOGI(TAG, "Trying delta update from version %s",
+                         app_desc->version);
+                ul_mqtt_publish_ota_event("begin", "delta");
+                err = ota_download_delta(&http_cfg, &manifest, delta_url);
+                free(delta_url);
+                if (err == ESP_OK) {
+                    ul_mqtt_publish_ota_event("success", manifest.version);
+                    ESP_LOGI(TAG, "Delta OTA successful (version %s)",
+                             manifest.version);
+                    free(resolved_ota_url);
+                    resolved_ota_url = NULL;
+
+                    ESP_LOGI(TAG, "Rebooting after OTA");
+                    esp_restart();
+                }
+                ESP_LOGW(TAG, "Delta update failed (%s); falling back to full image",
+                         esp_err_to_name(err));
+            }
+        }
+
+        // A LAN peer that already holds this exact image beats both the
+        // compressed WAN download and a mirror; the digest match guarantees
+        // the staged bytes verify identically, so range resume against a
+        // peer needs nothing special.
+        if (s_peer_url[0] && s_peer_size == manifest.size &&
+            strcmp(s_peer_sha, manifest.sha256_hex) == 0) {
+            if (!probe_url(&http_cfg, s_peer_url)) {
+                ESP_LOGW(TAG, "Seeding peer unresponsive; forgetting it");
+                s_peer_url[0] = '\0';
+            } else {
+                ESP_LOGI(TAG, "Downloading from LAN peer: %s", s_peer_url);
+                ul_mqtt_publish_ota_event("begin", "peer");
+                err = ota_download_ranged(&http_cfg, &manifest, s_peer_url, 0);
+                if (err == ESP_OK) {
+                    ul_mqtt_publish_ota_event(
+                        "success", manifest.version[0] ? manifest.version : NULL);
+                    ESP_LOGI(TAG, "OTA from LAN peer successful");
+                    free(resolved_ota_url);
+                    resolved_ota_url = NULL;
+
+                    ESP_LOGI(TAG, "Rebooting after OTA");
+                    esp_restart();
+                }
+                // The staged offset survives, so an uncompressed fallback
+                // resumes at the remainder (the compressed variant restarts
+                // its own stage). Forget the peer so the next check does
+                // not retry a seeder that just failed us.
+                ESP_LOGW(TAG, "Peer download failed (%s); using configured URLs",
+                         esp_err_to_name(err));
+                s_peer_url[0] = '\0';
+            }
+        }
+
+        // Size and digest are enough to stage the image resumably; a blip
+        // mid-download costs only the remainder on the next check.
+        char *resolved_primary = NULL; // owned; when NULL use resolved_ota_url
+        char *resolved_alt = NULL;     // owned alternate-host URL, may be NULL
+        const char *dl_url = resolved_ota_url;
+        const char *alt_url = NULL;
+        size_t comp_size = 0;
+        bool prefer_lan = (ota_url == manifest.binary_url_lan);
+
+        if (manifest.size_zz > 0 && manifest.binary_url_zz[0]) {
+            const char *zz_url = manifest.binary_url_zz;
+            const char *zz_alt = NULL;
+            if (manifest.binary_url_zz_lan[0] && strlen(CONFIG_UL_OTA_SERVER_HOST)) {
+                zz_url = manifest.binary_url_zz_lan;
+                zz_alt = manifest.binary_url_zz;
+            }
+            resolved_primary = ul_resolve_relative_url(&http_cfg, zz_url);
+            if (resolved_primary) {
+                dl_url = resolved_primary;
+                comp_size = manifest.size_zz;
+                if (zz_alt) {
+                    resolved_alt = ul_resolve_relative_url(&http_cfg, zz_alt);
+                }
+                ESP_LOGI(TAG, "Using compressed image (%u of %u bytes)",
+                         (unsigned)manifest.size_zz, (unsigned)manifest.size);
+            } else {
+                ESP_LOGW(TAG, "Failed to resolve compressed URL; using full image");
+            }
+        }
+        if (!resolved_primary && prefer_lan) {
+            resolved_alt = ul_resolve_relative_url(&http_cfg, manifest.binary_url);
+        }
+        alt_url = resolved_alt;
+
+        // Probe the preferred host before committing the download to it. A
+        // LAN mirror that is down or wedged costs one short HEAD timeout
+        // here rather than the full download timeout mid-transfer.
+        if (alt_url && !probe_url(&http_cfg, dl_url)) {
+            ESP_LOGW(TAG, "Preferred OTA host unresponsive; starting on fallback");
+            const char *swap = dl_url;
+            dl_url = alt_url;
+            alt_url = swap;
+        }
+
+        ul_mqtt_publish_ota_event("begin", NULL);
+        err = ota_download_ranged(&http_cfg, &manifest, dl_url, comp_size);
+        if (err != ESP_OK && alt_url) {
+            // The staged offset survives the failure, so the other host only
+            // transfers the remainder.
+            ESP_LOGW(TAG, "OTA download failed (%s); failing over to other host",
+                     esp_err_to_name(err));
+            err = ota_download_ranged(&http_cfg, &manifest, alt_url, comp_size);
+        }
+        free(resolved_primary);
+        free(resolved_alt);
+        if (err == ESP_OK) {
+            ul_mqtt_publish_ota_event("success", manifest.version[0] ? manifest.version : NULL);
+            if (manifest.version[0]) {
+                ESP_LOGI(TAG, "OTA successful (version %s)", manifest.version);
+            } else {
+                ESP_LOGI(TAG, "OTA successful");
+            }
+            free(resolved_ota_url);
+            resolved_ota_url = NULL;
+
+            ESP_LOGI(TAG, "Rebooting after OTA");
+            esp_restart();
+        }
+        ul_mqtt_publish_ota_event("perform_fail", esp_err_to_name(err));
+        ESP_LOGE(TAG, "OTA download failed: %s", esp_err_to_name(err));
+        log_ota_error_hint(err, NULL);
+        goto cleanup;
+    }
+
+    // Without size and sha256_hex in the manifest there is nothing to verify
+    // a partial stage against; fall back to the one-shot esp_https_ota flow.
     esp_http_client_config_t ota_http_cfg = http_cfg;
     ota_http_cfg.url = resolved_ota_url;
 
@@ -646,16 +1949,12 @@ void ul_ota_check_now(bool force, const char *manifest_url_override)
         }
         if (err == ESP_OK && esp_https_ota_is_complete_data_received(handle)) {
             if (esp_https_ota_finish(handle) == ESP_OK) {
-                ul_mqtt_publish_ota_event("success", manifest.version ? manifest.version : NULL);
-                if (manifest.version) {
+                ul_mqtt_publish_ota_event("success", manifest.version[0] ? manifest.version : NULL);
+                if (manifest.version[0]) {
                     ESP_LOGI(TAG, "OTA successful (version %s)", manifest.version);
                 } else {
                     ESP_LOGI(TAG, "OTA successful");
                 }
-                if (have_manifest) {
-                    ul_ota_manifest_free(&manifest);
-                    have_manifest = false;
-                }
                 free(resolved_ota_url);
                 resolved_ota_url = NULL;
 
@@ -681,9 +1980,5 @@ void ul_ota_check_now(bool force, const char *manifest_url_override)
 
 cleanup:
     free(resolved_ota_url);
-
-    if (have_manifest) {
-        ul_ota_manifest_free(&manifest);
-    }
 }
 
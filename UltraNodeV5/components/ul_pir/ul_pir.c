@@ -1,57 +1,150 @@
 #include "ul_pir.h"
 #include "sdkconfig.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "ul_core.h"
 #include "ul_mqtt.h"
 #include "esp_log.h"
 #include "ul_task.h"
 
 static const char *TAG = "ul_pir";
+
+// Short settle after the first edge so sensors tripped by the same person
+// land in one batched publish instead of N back-to-back messages.
+#define PIR_BATCH_WINDOW_MS 20
+
+typedef struct {
+  gpio_num_t gpio;
+  int64_t last_publish_us; // per-sensor debounce state, task-owned
+  volatile int64_t isr_us; // first unconsumed edge timestamp, ISR-owned
+} pir_sensor_t;
+
+static pir_sensor_t s_sensors[] = {
+    {.gpio = CONFIG_UL_PIR_GPIO},
+#if defined(CONFIG_UL_PIR1_ENABLED) && CONFIG_UL_PIR1_ENABLED
+    {.gpio = CONFIG_UL_PIR1_GPIO},
+#endif
+#if defined(CONFIG_UL_PIR2_ENABLED) && CONFIG_UL_PIR2_ENABLED
+    {.gpio = CONFIG_UL_PIR2_GPIO},
+#endif
+};
+#define PIR_SENSOR_COUNT (sizeof(s_sensors) / sizeof(s_sensors[0]))
+
 static TaskHandle_t s_pir_task = NULL;
-static int64_t s_last_publish_us = 0;
+static bool s_isr_added = false;
+
+// Runs in ISR context: grab the timestamp here so the rate limit is measured
+// from the actual edge, not from whenever the task gets scheduled. Only the
+// first edge since the last drain is kept; repeats within a batch add nothing.
+static void IRAM_ATTR pir_isr(void *arg) {
+  pir_sensor_t *s = (pir_sensor_t *)arg;
+  if (s->isr_us == 0) {
+    s->isr_us = esp_timer_get_time();
+  }
+  BaseType_t hp_woken = pdFALSE;
+  if (s_pir_task) {
+    vTaskNotifyGiveFromISR(s_pir_task, &hp_woken);
+  }
+  if (hp_woken == pdTRUE) {
+    portYIELD_FROM_ISR();
+  }
+}
 
 static void pir_task(void *arg) {
-    gpio_config_t cfg = {
-        .pin_bit_mask = 1ULL << CONFIG_UL_PIR_GPIO,
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    gpio_config(&cfg);
-
-    const int64_t min_interval_us = (int64_t)CONFIG_UL_PIR_EVENT_MIN_INTERVAL_S * 1000000LL;
-    while (1) {
-        int64_t now = esp_timer_get_time();
-
-        if (now - s_last_publish_us < min_interval_us) {
-            int64_t remain_ms = (min_interval_us - (now - s_last_publish_us)) / 1000;
-            vTaskDelay(pdMS_TO_TICKS(remain_ms));
-            continue;
-        }
-
-        if (gpio_get_level(CONFIG_UL_PIR_GPIO)) {
-            ESP_LOGD(TAG, "PIR motion detected");
-            ul_mqtt_publish_motion("pir", "MOTION_DETECTED");
-            s_last_publish_us = now;
-            continue;
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(CONFIG_UL_PIR_POLL_MS));
+  (void)arg;
+  uint64_t pin_mask = 0;
+  for (size_t i = 0; i < PIR_SENSOR_COUNT; ++i) {
+    pin_mask |= 1ULL << s_sensors[i].gpio;
+  }
+  gpio_config_t cfg = {
+      .pin_bit_mask = pin_mask,
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_DISABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_POSEDGE
+  };
+  gpio_config(&cfg);
+
+  // Other components may have installed the service already; that's fine.
+  esp_err_t err = gpio_install_isr_service(0);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+    ESP_LOGE(TAG, "ISR service install failed: %s", esp_err_to_name(err));
+    s_pir_task = NULL;
+    ul_task_forget(NULL);
+    vTaskDelete(NULL);
+    return;
+  }
+  for (size_t i = 0; i < PIR_SENSOR_COUNT; ++i) {
+    err = gpio_isr_handler_add(s_sensors[i].gpio, pir_isr, &s_sensors[i]);
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "ISR handler add failed for GPIO %d: %s",
+               (int)s_sensors[i].gpio, esp_err_to_name(err));
+      while (i > 0) {
+        gpio_isr_handler_remove(s_sensors[--i].gpio);
+      }
+      s_pir_task = NULL;
+      ul_task_forget(NULL);
+      vTaskDelete(NULL);
+      return;
+    }
+  }
+  s_isr_added = true;
+
+  const int64_t min_interval_us = (int64_t)CONFIG_UL_PIR_EVENT_MIN_INTERVAL_S * 1000000LL;
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    vTaskDelay(pdMS_TO_TICKS(PIR_BATCH_WINDOW_MS));
+    // Edges that landed during the window already rang the doorbell; absorb
+    // those notifications so the next wake means a fresh batch.
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    uint32_t mask = 0;
+    for (size_t i = 0; i < PIR_SENSOR_COUNT; ++i) {
+      pir_sensor_t *s = &s_sensors[i];
+      int64_t edge_us = s->isr_us;
+      if (edge_us == 0)
+        continue;
+      s->isr_us = 0;
+      // Edges inside the per-sensor window are dropped, same suppression
+      // the old poll loop applied.
+      if (edge_us - s->last_publish_us < min_interval_us)
+        continue;
+      s->last_publish_us = edge_us;
+      mask |= 1u << i;
     }
+    if (mask == 0)
+      continue;
+
+    ESP_LOGD(TAG, "PIR motion detected (sensors 0x%x)", (unsigned)mask);
+    // Motion means someone is about to issue commands; exit modem
+    // sleep before the publish so the response path is at full power.
+    ul_core_power_note_activity();
+    // Local rule first: lights react from this task in microseconds; the
+    // broker round trip below is telemetry, not the control path.
+    ul_mqtt_motion_local_trigger();
+    ul_mqtt_publish_motion_batch("pir", "MOTION_DETECTED", mask);
+  }
 }
 
 void ul_pir_start(void) {
-    if (!s_pir_task) {
-        ul_task_create(pir_task, "pir", 2048, NULL, 5, &s_pir_task, 0);
-    }
+  if (!s_pir_task) {
+    ul_task_create(pir_task, "pir", 2048, NULL, 5, &s_pir_task, 0);
+  }
 }
 
 void ul_pir_stop(void) {
-    if (s_pir_task) {
-        vTaskDelete(s_pir_task);
-        s_pir_task = NULL;
+  if (s_isr_added) {
+    for (size_t i = 0; i < PIR_SENSOR_COUNT; ++i) {
+      gpio_isr_handler_remove(s_sensors[i].gpio);
     }
+    s_isr_added = false;
+  }
+  if (s_pir_task) {
+    ul_task_forget(s_pir_task);
+    vTaskDelete(s_pir_task);
+    s_pir_task = NULL;
+  }
 }
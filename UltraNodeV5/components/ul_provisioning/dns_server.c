@@ -1,13 +1,27 @@
 #include "dns_server.h"
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include "lwip/inet.h"
-#include "lwip/sockets.h"
-#include <errno.h>
+#include "lwip/ip_addr.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
 #include <stdlib.h>
 #include <string.h>
 
+// Event-driven captive-portal DNS. The responder used to run a dedicated
+// task blocking in recvfrom() for the whole provisioning session; on the
+// raw lwIP UDP API the tcpip thread delivers each query straight to a
+// callback instead, so the component holds no task, no stack and no socket
+// of its own — just the PCB and one reused staging buffer. Provisioning is
+// the point where C3 nodes run closest to heap exhaustion, so the ~3 KB
+// task stack matters more here than anywhere else.
+
+// Largest query we answer. Anything bigger than a plain question section is
+// not a captive-portal probe; the 16 bytes of headroom hold the answer
+// record appended below.
+#define DNS_MAX_QUERY_LEN 512
+#define DNS_ANSWER_LEN 16
+
 typedef struct dns_header {
   uint16_t id;
   uint16_t flags;
@@ -18,91 +32,111 @@ typedef struct dns_header {
 } __attribute__((packed)) dns_header_t;
 
 struct dns_server_handle_t {
-  int sock;
-  TaskHandle_t task;
+  struct udp_pcb *pcb;
   uint32_t ip_addr;
-  bool running;
+  uint8_t response[DNS_MAX_QUERY_LEN + DNS_ANSWER_LEN];
 };
 
+// Raw-API PCB calls must run on (or locked against) the tcpip thread;
+// tcpip_api_call() handles either locking configuration.
+typedef struct {
+  struct tcpip_api_call_data call;
+  dns_server_handle_t *handle;
+} dns_api_msg_t;
+
 static const char *TAG = "ul_dns";
 
-static void dns_server_task(void *arg) {
+// Runs in the tcpip thread for every datagram on port 53. Copies the query
+// into the handle's reused buffer, rewrites it into a response answering the
+// first question with our AP address, and sends it back.
+static void dns_recv_cb(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                        const ip_addr_t *addr, u16_t port) {
   dns_server_handle_t *handle = (dns_server_handle_t *)arg;
-  const uint32_t ip_addr = handle->ip_addr;
-
-  while (handle->running) {
-    uint8_t buffer[512];
-    struct sockaddr_in source = {0};
-    socklen_t socklen = sizeof(source);
-    int len = recvfrom(handle->sock, buffer, sizeof(buffer), 0,
-                       (struct sockaddr *)&source, &socklen);
-    if (len < (int)sizeof(dns_header_t)) {
-      if (len < 0) {
-        int err = errno;
-        if (err == EINTR) {
-          continue;
-        }
-        ESP_LOGW(TAG, "recvfrom error: %d", err);
-      }
-      continue;
-    }
+  if (!p)
+    return;
 
-    dns_header_t *header = (dns_header_t *)buffer;
-    uint16_t qdcount = ntohs(header->qdcount);
-    if (qdcount == 0) {
-      continue;
-    }
+  int len = (int)p->tot_len;
+  if (len < (int)sizeof(dns_header_t) || len > DNS_MAX_QUERY_LEN) {
+    pbuf_free(p);
+    return;
+  }
+  uint8_t *response = handle->response;
+  pbuf_copy_partial(p, response, (u16_t)len, 0);
+  pbuf_free(p);
 
-    // Prepare response by copying query
-    uint8_t response[512];
-    memcpy(response, buffer, len);
-    dns_header_t *resp_header = (dns_header_t *)response;
-    resp_header->flags = htons(0x8180); // Standard query response, no error
-    resp_header->ancount = htons(1);
-    resp_header->nscount = 0;
-    resp_header->arcount = 0;
-
-    int offset = sizeof(dns_header_t);
-    // Skip questions to find answer location
-    for (uint16_t i = 0; i < qdcount; ++i) {
-      while (offset < len && response[offset] != 0) {
-        offset += response[offset] + 1;
-      }
-      offset += 5; // zero byte + type + class
-      if (offset > len) {
-        offset = len;
-        break;
-      }
-    }
+  dns_header_t *header = (dns_header_t *)response;
+  uint16_t qdcount = ntohs(header->qdcount);
+  if (qdcount == 0)
+    return;
 
-    if (offset + 16 > (int)sizeof(response)) {
-      continue;
+  header->flags = htons(0x8180); // Standard query response, no error
+  header->ancount = htons(1);
+  header->nscount = 0;
+  header->arcount = 0;
+
+  int offset = sizeof(dns_header_t);
+  // Skip questions to find answer location
+  for (uint16_t i = 0; i < qdcount; ++i) {
+    while (offset < len && response[offset] != 0) {
+      offset += response[offset] + 1;
+    }
+    offset += 5; // zero byte + type + class
+    if (offset > len) {
+      offset = len;
+      break;
     }
+  }
+
+  // Append a single A record answer referencing the first question
+  const uint32_t ip_addr_host = handle->ip_addr;
+  response[offset++] = 0xC0;
+  response[offset++] = 0x0C; // pointer to first question name (offset 12)
+  response[offset++] = 0x00;
+  response[offset++] = 0x01; // type A
+  response[offset++] = 0x00;
+  response[offset++] = 0x01; // class IN
+  response[offset++] = 0x00;
+  response[offset++] = 0x00;
+  response[offset++] = 0x00;
+  response[offset++] = 0x3C; // TTL 60s
+  response[offset++] = 0x00;
+  response[offset++] = 0x04; // data length
+
+  response[offset++] = (ip_addr_host >> 24) & 0xFF;
+  response[offset++] = (ip_addr_host >> 16) & 0xFF;
+  response[offset++] = (ip_addr_host >> 8) & 0xFF;
+  response[offset++] = ip_addr_host & 0xFF;
+
+  struct pbuf *resp = pbuf_alloc(PBUF_TRANSPORT, (u16_t)offset, PBUF_RAM);
+  if (!resp)
+    return;
+  pbuf_take(resp, response, (u16_t)offset);
+  udp_sendto(pcb, resp, addr, port);
+  pbuf_free(resp);
+}
 
-    // Append a single A record answer referencing the first question
-    response[offset++] = 0xC0;
-    response[offset++] = 0x0C; // pointer to first question name (offset 12)
-    response[offset++] = 0x00;
-    response[offset++] = 0x01; // type A
-    response[offset++] = 0x00;
-    response[offset++] = 0x01; // class IN
-    response[offset++] = 0x00;
-    response[offset++] = 0x00;
-    response[offset++] = 0x00;
-    response[offset++] = 0x3C; // TTL 60s
-    response[offset++] = 0x00;
-    response[offset++] = 0x04; // data length
-
-    response[offset++] = (ip_addr >> 24) & 0xFF;
-    response[offset++] = (ip_addr >> 16) & 0xFF;
-    response[offset++] = (ip_addr >> 8) & 0xFF;
-    response[offset++] = ip_addr & 0xFF;
-
-    int resp_len = offset;
-    sendto(handle->sock, response, resp_len, 0, (struct sockaddr *)&source, socklen);
+static err_t dns_server_do_start(struct tcpip_api_call_data *call) {
+  dns_api_msg_t *msg = (dns_api_msg_t *)call;
+  struct udp_pcb *pcb = udp_new();
+  if (!pcb)
+    return ERR_MEM;
+  err_t err = udp_bind(pcb, IP_ADDR_ANY, 53);
+  if (err != ERR_OK) {
+    udp_remove(pcb);
+    return err;
   }
+  udp_recv(pcb, dns_recv_cb, msg->handle);
+  msg->handle->pcb = pcb;
+  return ERR_OK;
+}
 
-  vTaskDelete(NULL);
+static err_t dns_server_do_stop(struct tcpip_api_call_data *call) {
+  dns_api_msg_t *msg = (dns_api_msg_t *)call;
+  if (msg->handle->pcb) {
+    udp_remove(msg->handle->pcb);
+    msg->handle->pcb = NULL;
+  }
+  return ERR_OK;
 }
 
 esp_err_t ul_dns_server_start(uint32_t ip_addr, dns_server_handle_t **out_handle) {
@@ -110,39 +144,17 @@ esp_err_t ul_dns_server_start(uint32_t ip_addr, dns_server_handle_t **out_handle
     return ESP_ERR_INVALID_ARG;
   *out_handle = NULL;
 
-  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-  if (sock < 0) {
-    ESP_LOGE(TAG, "Failed to create DNS socket: %d", errno);
-    return ESP_FAIL;
-  }
-
-  struct sockaddr_in addr = {0};
-  addr.sin_family = AF_INET;
-  addr.sin_port = htons(53);
-  addr.sin_addr.s_addr = htonl(INADDR_ANY);
-
-  if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-    ESP_LOGE(TAG, "Failed to bind DNS socket: %d", errno);
-    close(sock);
-    return ESP_FAIL;
-  }
-
   dns_server_handle_t *handle = calloc(1, sizeof(*handle));
-  if (!handle) {
-    close(sock);
+  if (!handle)
     return ESP_ERR_NO_MEM;
-  }
-
-  handle->sock = sock;
   handle->ip_addr = ip_addr;
-  handle->running = true;
 
-  BaseType_t created = xTaskCreate(dns_server_task, "dns", 3072, handle, 3, &handle->task);
-  if (created != pdPASS) {
-    ESP_LOGE(TAG, "Failed to create DNS task");
-    close(sock);
+  dns_api_msg_t msg = {.handle = handle};
+  err_t err = tcpip_api_call(dns_server_do_start, &msg.call);
+  if (err != ERR_OK) {
+    ESP_LOGE(TAG, "Failed to bind DNS responder: %d", (int)err);
     free(handle);
-    return ESP_ERR_NO_MEM;
+    return ESP_FAIL;
   }
 
   *out_handle = handle;
@@ -152,12 +164,9 @@ esp_err_t ul_dns_server_start(uint32_t ip_addr, dns_server_handle_t **out_handle
 void ul_dns_server_stop(dns_server_handle_t *handle) {
   if (!handle)
     return;
-  handle->running = false;
-  if (handle->sock >= 0) {
-    shutdown(handle->sock, SHUT_RDWR);
-    close(handle->sock);
-    handle->sock = -1;
-  }
-  vTaskDelay(pdMS_TO_TICKS(10));
+  // Detaching the PCB inside the tcpip thread guarantees no callback is in
+  // flight once this returns, so the handle is safe to free.
+  dns_api_msg_t msg = {.handle = handle};
+  tcpip_api_call(dns_server_do_stop, &msg.call);
   free(handle);
 }
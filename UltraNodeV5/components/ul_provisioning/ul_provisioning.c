@@ -46,17 +46,23 @@ static esp_netif_t *s_sta_netif;
 static portal_state_t s_state = PROV_STATE_IDLE;
 static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
 static char s_status_ip[16];
+static char s_status_reason[20]; // failure cause streamed to the portal page
 static bool s_wifi_started;
 static bool s_wifi_initialised;
 static bool s_handlers_registered;
 static portMUX_TYPE s_scan_lock = portMUX_INITIALIZER_UNLOCKED;
 
 #define MAX_SCAN_RESULTS 32
+#define SCAN_REFRESH_INTERVAL_MS (15 * 1000)
 static wifi_ap_record_t s_last_scan_results[MAX_SCAN_RESULTS];
 static size_t s_last_scan_count;
+static esp_timer_handle_t s_scan_refresh_timer;
+static bool s_scan_in_flight;
 
 extern const uint8_t portal_index_html_start[] asm("_binary_portal_index_html_start");
 extern const uint8_t portal_index_html_end[] asm("_binary_portal_index_html_end");
+extern const uint8_t portal_index_gz_start[] asm("_binary_portal_index_html_gz_start");
+extern const uint8_t portal_index_gz_end[] asm("_binary_portal_index_html_gz_end");
 
 static const char *state_to_string(portal_state_t state) {
   switch (state) {
@@ -87,6 +93,17 @@ static void set_state(portal_state_t state) {
   if (state != PROV_STATE_SUCCESS) {
     s_status_ip[0] = '\0';
   }
+  if (state != PROV_STATE_FAILED) {
+    s_status_reason[0] = '\0';
+  }
+  taskEXIT_CRITICAL(&s_state_lock);
+}
+
+static void set_state_failed(const char *reason) {
+  taskENTER_CRITICAL(&s_state_lock);
+  s_state = PROV_STATE_FAILED;
+  s_status_ip[0] = '\0';
+  strlcpy(s_status_reason, reason ? reason : "", sizeof(s_status_reason));
   taskEXIT_CRITICAL(&s_state_lock);
 }
 
@@ -108,10 +125,27 @@ static void reset_idle_timer(void) {
   esp_timer_start_once(s_idle_timer, (uint64_t)s_config.inactivity_timeout_ms * 1000ULL);
 }
 
+static bool client_accepts_gzip(httpd_req_t *req) {
+  char encodings[64];
+  if (httpd_req_get_hdr_value_str(req, "Accept-Encoding", encodings,
+                                  sizeof(encodings)) != ESP_OK) {
+    return false;
+  }
+  return strstr(encodings, "gzip") != NULL;
+}
+
 static esp_err_t send_index_html(httpd_req_t *req) {
   reset_idle_timer();
-  const size_t len = portal_index_html_end - portal_index_html_start;
   httpd_resp_set_type(req, "text/html");
+  // Phones fetch the portal over the slow SoftAP link; the precompressed
+  // copy is about a third of the bytes. Probe clients that do not advertise
+  // gzip support get the plain page.
+  if (client_accepts_gzip(req)) {
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    const size_t gz_len = portal_index_gz_end - portal_index_gz_start;
+    return httpd_resp_send(req, (const char *)portal_index_gz_start, gz_len);
+  }
+  const size_t len = portal_index_html_end - portal_index_html_start;
   return httpd_resp_send(req, (const char *)portal_index_html_start, len);
 }
 
@@ -210,6 +244,92 @@ static bool lookup_authmode_for_ssid(const char *ssid, wifi_auth_mode_t *out_mod
   return found;
 }
 
+// Background scan cache. A blocking scan from the picker held the UI for the
+// full scan duration (3-4 s under SoftAP coexistence), so a scan is kicked as
+// soon as the portal starts and refreshed in the background; /api/scan serves
+// whatever is cached and never blocks.
+
+static void start_background_scan(void) {
+  if (s_scan_in_flight)
+    return;
+  portal_state_t state;
+  taskENTER_CRITICAL(&s_state_lock);
+  state = s_state;
+  taskEXIT_CRITICAL(&s_state_lock);
+  if (state == PROV_STATE_CONNECTING || state == PROV_STATE_IDLE)
+    return; // coexistence airtime is better spent on the join attempt
+  wifi_scan_config_t scan_cfg = {
+      .show_hidden = false,
+      .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+  };
+  s_scan_in_flight = true;
+  esp_err_t err = esp_wifi_scan_start(&scan_cfg, false);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Background scan failed to start: %s", esp_err_to_name(err));
+    s_scan_in_flight = false;
+  }
+}
+
+static void scan_refresh_timer_cb(void *arg) {
+  (void)arg;
+  start_background_scan();
+}
+
+static void scan_done_handler(void *arg, esp_event_base_t event_base,
+                              int32_t event_id, void *event_data) {
+  (void)arg;
+  (void)event_base;
+  (void)event_id;
+  (void)event_data;
+  s_scan_in_flight = false;
+  uint16_t num = 0;
+  esp_wifi_scan_get_ap_num(&num);
+  wifi_ap_record_t *records = NULL;
+  if (num > 0) {
+    records = calloc(num, sizeof(*records));
+    if (!records) {
+      ESP_LOGW(TAG, "Failed to allocate scan record buffer");
+      // Drain the driver's result list so the next scan starts clean.
+      wifi_ap_record_t dummy;
+      uint16_t one = 1;
+      esp_wifi_scan_get_ap_records(&one, &dummy);
+    }
+  }
+  if (records && esp_wifi_scan_get_ap_records(&num, records) == ESP_OK) {
+    // Deduplicate by SSID in place, keeping the strongest response, so a
+    // multi-AP network shows once with a representative RSSI/authmode.
+    uint16_t unique = 0;
+    for (uint16_t i = 0; i < num; ++i) {
+      if (records[i].ssid[0] == '\0')
+        continue;
+      bool seen = false;
+      for (uint16_t j = 0; j < unique; ++j) {
+        if (strncmp((const char *)records[j].ssid, (const char *)records[i].ssid,
+                    sizeof(records[j].ssid)) == 0) {
+          if (records[i].rssi > records[j].rssi)
+            records[j] = records[i];
+          seen = true;
+          break;
+        }
+      }
+      if (!seen)
+        records[unique++] = records[i];
+    }
+    if (unique > MAX_SCAN_RESULTS)
+      unique = MAX_SCAN_RESULTS;
+    taskENTER_CRITICAL(&s_scan_lock);
+    memcpy(s_last_scan_results, records, unique * sizeof(*records));
+    s_last_scan_count = unique;
+    taskEXIT_CRITICAL(&s_scan_lock);
+  }
+  free(records);
+  if (s_scan_refresh_timer) {
+    esp_timer_stop(s_scan_refresh_timer);
+    esp_timer_start_once(s_scan_refresh_timer,
+                         (uint64_t)SCAN_REFRESH_INTERVAL_MS * 1000ULL);
+  }
+}
+
 static void append_hotspot_headers(httpd_req_t *req) {
   httpd_resp_set_hdr(req, "Cache-Control", "no-cache, no-store, must-revalidate");
 }
@@ -228,9 +348,11 @@ static esp_err_t status_handler(httpd_req_t *req) {
   reset_idle_timer();
   portal_state_t state;
   char ip_copy[sizeof(s_status_ip)];
+  char reason_copy[sizeof(s_status_reason)];
   taskENTER_CRITICAL(&s_state_lock);
   state = s_state;
   strlcpy(ip_copy, s_status_ip, sizeof(ip_copy));
+  strlcpy(reason_copy, s_status_reason, sizeof(reason_copy));
   taskEXIT_CRITICAL(&s_state_lock);
 
   cJSON *root = cJSON_CreateObject();
@@ -238,6 +360,9 @@ static esp_err_t status_handler(httpd_req_t *req) {
   if (state == PROV_STATE_SUCCESS && ip_copy[0] != '\0') {
     cJSON_AddStringToObject(root, "ip", ip_copy);
   }
+  if (state == PROV_STATE_FAILED && reason_copy[0] != '\0') {
+    cJSON_AddStringToObject(root, "reason", reason_copy);
+  }
   char *json = cJSON_PrintUnformatted(root);
   cJSON_Delete(root);
   if (!json)
@@ -250,50 +375,23 @@ static esp_err_t status_handler(httpd_req_t *req) {
 
 static esp_err_t scan_handler(httpd_req_t *req) {
   reset_idle_timer();
-  wifi_scan_config_t scan_cfg = {
-      .show_hidden = false,
-      .scan_type = WIFI_SCAN_TYPE_ACTIVE,
-  };
-  esp_err_t err = esp_wifi_scan_start(&scan_cfg, true);
-  if (err != ESP_OK) {
-    ESP_LOGW(TAG, "Scan failed: %s", esp_err_to_name(err));
-    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "scan failed");
+  // Serve straight from the background cache so the picker renders
+  // instantly; the refresh kicked below keeps a reopened picker current.
+  wifi_ap_record_t *records = calloc(MAX_SCAN_RESULTS, sizeof(*records));
+  if (!records) {
+    ESP_LOGE(TAG, "Failed to allocate scan record buffer");
+    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "alloc failed");
   }
-
-  uint16_t num = 0;
-  esp_wifi_scan_get_ap_num(&num);
-  if (num > MAX_SCAN_RESULTS)
-    num = MAX_SCAN_RESULTS;
-  wifi_ap_record_t *records = NULL;
-  if (num > 0) {
-    records = calloc(num, sizeof(*records));
-    if (!records) {
-      ESP_LOGE(TAG, "Failed to allocate scan record buffer");
-      return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "alloc failed");
-    }
-  }
-  wifi_ap_record_t dummy = {0};
-  wifi_ap_record_t *record_buf = records ? records : &dummy;
-  esp_err_t rec_err = esp_wifi_scan_get_ap_records(&num, record_buf);
-  if (rec_err != ESP_OK) {
-    ESP_LOGW(TAG, "Failed to get scan results: %s", esp_err_to_name(rec_err));
-    free(records);
-    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "scan failed");
-  }
-
   taskENTER_CRITICAL(&s_scan_lock);
-  if (num > 0) {
-    memcpy(s_last_scan_results, record_buf, num * sizeof(*record_buf));
-    s_last_scan_count = num;
-  } else {
-    s_last_scan_count = 0;
-  }
+  uint16_t num = (uint16_t)s_last_scan_count;
+  memcpy(records, s_last_scan_results, num * sizeof(*records));
   taskEXIT_CRITICAL(&s_scan_lock);
+  start_background_scan();
 
   cJSON *root = cJSON_CreateObject();
   cJSON *arr = cJSON_AddArrayToObject(root, "aps");
   for (uint16_t i = 0; i < num; ++i) {
-    const wifi_ap_record_t *rec = &record_buf[i];
+    const wifi_ap_record_t *rec = &records[i];
     cJSON *item = cJSON_CreateObject();
     char ssid[33];
     memcpy(ssid, rec->ssid, sizeof(rec->ssid));
@@ -363,6 +461,12 @@ static void begin_connect(const char *ssid, const char *password, bool requires_
   (void)requires_username;
 #endif
   sta_cfg.sta.threshold.authmode = threshold;
+  // Pause background scanning while the join attempt runs; the cached list
+  // keeps serving the picker and scanning resumes if the attempt fails.
+  if (s_scan_refresh_timer)
+    esp_timer_stop(s_scan_refresh_timer);
+  esp_wifi_scan_stop();
+  s_scan_in_flight = false;
   esp_wifi_disconnect();
   esp_err_t err = esp_wifi_set_mode(WIFI_MODE_APSTA);
   if (err != ESP_OK) {
@@ -566,12 +670,42 @@ static void idle_timer_cb(void *arg) {
   ul_provisioning_stop();
 }
 
+// Translate the driver's disconnect reason into the coarse categories the
+// portal page can act on: a wrong password and an out-of-range SSID need
+// different fixes from the installer.
+static const char *disconnect_reason_string(uint8_t reason) {
+  switch (reason) {
+  case WIFI_REASON_NO_AP_FOUND:
+    return "not_found";
+  case WIFI_REASON_AUTH_FAIL:
+  case WIFI_REASON_AUTH_EXPIRE:
+  case WIFI_REASON_MIC_FAILURE:
+  case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+  case WIFI_REASON_HANDSHAKE_TIMEOUT:
+    return "bad_password";
+  default:
+    return "disconnected";
+  }
+}
+
 static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id,
                                void *event_data) {
   (void)arg;
   if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-    ESP_LOGW(TAG, "Station disconnected during provisioning");
-    set_state(PROV_STATE_FAILED);
+    portal_state_t state;
+    taskENTER_CRITICAL(&s_state_lock);
+    state = s_state;
+    taskEXIT_CRITICAL(&s_state_lock);
+    if (state != PROV_STATE_CONNECTING)
+      return; // stray event outside a join attempt; keep the portal state
+    wifi_event_sta_disconnected_t *event =
+        (wifi_event_sta_disconnected_t *)event_data;
+    uint8_t reason = event ? event->reason : 0;
+    ESP_LOGW(TAG, "Join attempt failed (reason=%u)", reason);
+    set_state_failed(disconnect_reason_string(reason));
+    // The failed attempt froze background scanning; resume it so the picker
+    // stays current while the installer fixes the credentials.
+    start_background_scan();
   }
 }
 
@@ -699,8 +833,29 @@ esp_err_t ul_provisioning_start(const ul_provisioning_config_t *cfg) {
     ESP_LOGE(TAG, "Failed to register IP handler: %s", esp_err_to_name(err));
     goto fail;
   }
+  err = esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, scan_done_handler, NULL);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to register scan handler: %s", esp_err_to_name(err));
+    goto fail;
+  }
   s_handlers_registered = true;
 
+  if (!s_scan_refresh_timer) {
+    const esp_timer_create_args_t scan_timer_args = {
+        .callback = scan_refresh_timer_cb,
+        .name = "prov_scan",
+    };
+    esp_err_t timer_err = esp_timer_create(&scan_timer_args, &s_scan_refresh_timer);
+    if (timer_err != ESP_OK) {
+      // Not fatal: without the timer the cache still refreshes every time
+      // the picker is opened.
+      ESP_LOGW(TAG, "Failed to create scan refresh timer: %s", esp_err_to_name(timer_err));
+    }
+  }
+  // Warm the SSID cache right away so the picker has results by the time
+  // the installer's phone renders the portal.
+  start_background_scan();
+
   esp_netif_ip_info_t ip_info;
   err = esp_netif_get_ip_info(s_ap_netif, &ip_info);
   if (err != ESP_OK) {
@@ -718,6 +873,11 @@ esp_err_t ul_provisioning_start(const ul_provisioning_config_t *cfg) {
   http_cfg.server_port = 80;
   http_cfg.stack_size = 8192;
   http_cfg.uri_match_fn = httpd_uri_match_wildcard;
+  // Keep-alive lets the phone reuse one connection across the page, scan and
+  // provision calls instead of paying TCP setup per request on the SoftAP
+  // link. Captive-portal probes open a flood of extra connections, so recycle
+  // the least-recently-used socket rather than refusing new ones.
+  http_cfg.lru_purge_enable = true;
   err = httpd_start(&s_httpd, &http_cfg);
   if (err != ESP_OK) {
     ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(err));
@@ -781,9 +941,15 @@ void ul_provisioning_stop(void) {
     s_dns_handle = NULL;
   }
 
+  if (s_scan_refresh_timer) {
+    esp_timer_stop(s_scan_refresh_timer);
+  }
+  s_scan_in_flight = false;
+
   if (s_handlers_registered) {
     esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, wifi_event_handler);
     esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, ip_event_handler);
+    esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, scan_done_handler);
     s_handlers_registered = false;
   }
 
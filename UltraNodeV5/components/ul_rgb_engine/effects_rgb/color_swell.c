@@ -86,4 +86,29 @@ void rgb_color_swell_render(int strip, uint8_t out_rgb[3], int frame_idx) {
     out_rgb[2] = (uint8_t)((s_color[strip][2] * value) / 255);
 }
 
+// The whole swell is one linear ramp from black to the configured colour over
+// 255 steps, then a hold – exactly what the LEDC fade hardware runs on its
+// own. Report the remainder of the ramp (or the hold) as a single segment so
+// the engine never has to step us in software.
+bool rgb_color_swell_plan_fade(int strip, int frame_idx, rgb_fade_segment_t* seg) {
+    ensure_initialized();
+    if (!valid_strip(strip) || !seg) return false;
+
+    seg->target_rgb[0] = s_color[strip][0];
+    seg->target_rgb[1] = s_color[strip][1];
+    seg->target_rgb[2] = s_color[strip][2];
+
+    int refresh_hz = CONFIG_UL_RGB_SMOOTH_HZ;
+    if (refresh_hz <= 0) {
+        seg->duration_ms = 0;
+        return true;
+    }
+    int64_t elapsed_us = frame_idx > 0
+        ? ((int64_t)frame_idx * 1000000LL) / refresh_hz : 0;
+    int64_t total_us = 255LL * COLOR_SWELL_STEP_INTERVAL_US;
+    seg->duration_ms = elapsed_us >= total_us
+        ? 0 : (uint32_t)((total_us - elapsed_us) / 1000);
+    return true;
+}
+
 #endif
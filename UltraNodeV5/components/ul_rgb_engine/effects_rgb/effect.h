@@ -1,14 +1,33 @@
 #pragma once
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef struct cJSON cJSON;
 
+// One linear ramp the LEDC fade engine can run in hardware: reach
+// target_rgb after duration_ms. duration_ms == 0 means "jump to target and
+// hold until something changes".
+typedef struct {
+    uint8_t target_rgb[3];
+    uint32_t duration_ms;
+} rgb_fade_segment_t;
+
 typedef struct {
     const char* name;
     void (*init)(void);
     void (*render)(int strip, uint8_t out_rgb[3], int frame_idx);
     void (*apply_params)(int strip, const cJSON* params);
+    // Optional. Describe the effect's output from frame_idx onward as a fade
+    // segment. When this returns true the engine programs the ramp into the
+    // LEDC fade hardware and sleeps until the segment boundary instead of
+    // stepping render() every tick. Return false (or leave NULL) to be
+    // stepped in software.
+    bool (*plan_fade)(int strip, int frame_idx, rgb_fade_segment_t* seg);
+    // Optional. Frames after frame_idx until the software-rendered output can
+    // next differ; -1 means never (the engine then latches the last render
+    // and blocks until an external state change wakes it). Leave NULL for
+    // effects that animate every frame.
+    int (*next_change)(int strip, int frame_idx);
 } rgb_effect_t;
 
 const rgb_effect_t* ul_rgb_get_effects(int* count);
-int ul_rgb_effect_current_strip(void);
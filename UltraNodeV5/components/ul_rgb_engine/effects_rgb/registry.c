@@ -7,13 +7,17 @@
 void rgb_solid_init(void);
 void rgb_solid_render(int strip, uint8_t out_rgb[3], int frame_idx);
 void rgb_solid_apply_params(int strip, const cJSON* params);
+int rgb_solid_next_change(int strip, int frame_idx);
 void rgb_color_swell_init(void);
 void rgb_color_swell_render(int strip, uint8_t out_rgb[3], int frame_idx);
 void rgb_color_swell_apply_params(int strip, const cJSON* params);
+bool rgb_color_swell_plan_fade(int strip, int frame_idx, rgb_fade_segment_t* seg);
 
 static const rgb_effect_t effects[] = {
-    {"solid", rgb_solid_init, rgb_solid_render, rgb_solid_apply_params},
-    {"color_swell", rgb_color_swell_init, rgb_color_swell_render, rgb_color_swell_apply_params},
+    {"solid", rgb_solid_init, rgb_solid_render, rgb_solid_apply_params, NULL,
+     rgb_solid_next_change},
+    {"color_swell", rgb_color_swell_init, rgb_color_swell_render, rgb_color_swell_apply_params,
+     rgb_color_swell_plan_fade, NULL},
 };
 
 const rgb_effect_t* ul_rgb_get_effects(int* count) {
@@ -33,4 +33,12 @@ void rgb_solid_render(int strip, uint8_t out_rgb[3], int frame_idx) {
     out_rgb[2] = b;
 }
 
+// Solid only moves when the colour is changed externally, which wakes the
+// engine task anyway.
+int rgb_solid_next_change(int strip, int frame_idx) {
+    (void)strip;
+    (void)frame_idx;
+    return -1;
+}
+
 #endif
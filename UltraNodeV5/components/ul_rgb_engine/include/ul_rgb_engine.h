@@ -10,7 +10,8 @@ void ul_rgb_engine_stop(void);
 void ul_rgb_apply_json(cJSON* root);
 
 bool ul_rgb_set_effect(int strip, const char* name);
-bool ul_rgb_set_brightness(int strip, uint8_t bri);
+bool ul_rgb_set_brightness(int strip, uint8_t bri); // cancels a running ramp
+bool ul_rgb_set_brightness_ramp(int strip, uint8_t target, int duration_ms);
 void ul_rgb_set_solid_rgb(int strip, uint8_t r, uint8_t g, uint8_t b);
 void ul_rgb_get_solid_rgb(int strip, uint8_t* r, uint8_t* g, uint8_t* b);
 
@@ -5,8 +5,6 @@
 
 #include <string.h>
 
-int ul_rgb_effect_current_strip(void) { return -1; }
-
 void ul_rgb_engine_start(void) {}
 
 void ul_rgb_engine_stop(void) {}
@@ -25,6 +23,13 @@ bool ul_rgb_set_brightness(int strip, uint8_t bri) {
     return false;
 }
 
+bool ul_rgb_set_brightness_ramp(int strip, uint8_t target, int duration_ms) {
+    (void)strip;
+    (void)target;
+    (void)duration_ms;
+    return false;
+}
+
 void ul_rgb_set_solid_rgb(int strip, uint8_t r, uint8_t g, uint8_t b) {
     (void)strip;
     (void)r;
@@ -53,12 +58,15 @@ bool ul_rgb_get_status(int strip, ul_rgb_strip_status_t* out) {
 #include "freertos/task.h"
 #include "driver/ledc.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "string.h"
 #include "cJSON.h"
 #include "ul_health.h"
-#include "ul_task.h"
+#include "ul_sched.h"
 #include "ul_common_effects.h"
+#include "ul_state.h"
 #include "effects_rgb/effect.h"
+#include <stdlib.h>
 
 static const char* TAG = "ul_rgb";
 
@@ -78,14 +86,30 @@ typedef struct {
     int frame_idx;
     uint8_t solid_color[3];
     uint8_t last_color[3];
+    uint8_t last_brightness;   // brightness at the last committed frame
+    bool last_valid;           // last_color/last_brightness reflect the output
+    uint8_t dither_err[3];     // fractional duty carried between frames
+    bool fade_active;          // LEDC hardware fade running towards fade_end_tick
+    bool hold;                 // output is static (hardware hold or static
+                               // software effect); nothing to step until a
+                               // state change wakes the task
+    TickType_t fade_end_tick;
+    // Brightness ramp: while active, brightness is re-derived from wall time
+    // each pass and the strip renders at frame rate (no hold, no hardware
+    // fade segments) until the target lands.
+    bool bri_ramp_active;
+    uint8_t bri_ramp_from;
+    uint8_t bri_ramp_target;
+    int64_t bri_ramp_start_us;
+    int bri_ramp_duration_ms;
 } rgb_strip_t;
 
 static rgb_strip_t s_strips[4];
 static int s_strip_count = 0;
-static TaskHandle_t s_rgb_task = NULL;
-static int s_current_strip = 0;
+static bool s_rgb_registered = false;
+static bool s_fade_installed = false;
 
-int ul_rgb_effect_current_strip(void) { return s_current_strip; }
+static void invalidate_fade(rgb_strip_t* s);
 
 static ledc_mode_t decode_mode(int mode_cfg) {
 #if defined(LEDC_HIGH_SPEED_MODE)
@@ -152,6 +176,9 @@ void ul_rgb_set_solid_rgb(int strip, uint8_t r, uint8_t g, uint8_t b) {
     s->solid_color[0] = r;
     s->solid_color[1] = g;
     s->solid_color[2] = b;
+    // A latched solid strip must re-render with the new colour.
+    invalidate_fade(s);
+    ul_sched_kick();
 }
 
 void ul_rgb_get_solid_rgb(int strip, uint8_t* r, uint8_t* g, uint8_t* b) {
@@ -196,50 +223,223 @@ static void strip_init(int idx,
     ESP_LOGI(TAG, "RGB strip %d enabled (R=%d,G=%d,B=%d)", idx, r_gpio, g_gpio, b_gpio);
 }
 
-static void set_channel_value(rgb_channel_t* ch, uint8_t value) {
+// Duties are computed in Q12.8: the full 12-bit timer resolution plus eight
+// fractional bits. The fraction is temporally dithered by set_channel_duty so
+// dim ramps move in sub-duty steps instead of the visible 16-duty jumps an
+// 8-bit-derived value produces.
+
+// Resolve a Q12.8 duty to a timer value. `err` accumulates the bottom eight
+// bits so successive frames dither the fraction (integer only, one add per
+// channel); pass NULL to round instead, for values that are about to sit
+// still.
+static uint32_t dither_duty(uint32_t duty_q8, uint8_t* err) {
+    uint32_t acc = duty_q8 + (err ? *err : 128u);
+    uint32_t duty = acc >> 8;
+    if (err) *err = (uint8_t)(acc & 0xFFu);
+    if (duty > 4095u) duty = 4095u;
+    return duty;
+}
+
+static void set_channel_duty(rgb_channel_t* ch, uint32_t duty_q8, uint8_t* err) {
     if (!ch->configured) return;
-    int duty = (value * ((1 << 12) - 1)) / 255;
-    ledc_set_duty(ch->mode, ch->channel, duty);
+    uint32_t duty = dither_duty(duty_q8, err);
+    ledc_set_duty(ch->mode, ch->channel, (int)duty);
     ledc_update_duty(ch->mode, ch->channel);
 }
 
-static void rgb_task(void* arg) {
-    (void)arg;
+static void set_channel_fade(rgb_channel_t* ch, uint32_t duty_q8, uint32_t duration_ms) {
+    if (!ch->configured) return;
+    uint32_t duty = (duty_q8 + 128u) >> 8;
+    if (duty > 4095u) duty = 4095u;
+    ledc_set_fade_with_time(ch->mode, ch->channel, (int)duty, (int)duration_ms);
+    ledc_fade_start(ch->mode, ch->channel, LEDC_FADE_NO_WAIT);
+}
+
+// Drop any fade segment or hold so the next task pass re-plans from current
+// state.
+static void invalidate_fade(rgb_strip_t* s) {
+    s->fade_active = false;
+    s->hold = false;
+    s->last_valid = false;
+}
+
+// Scale an effect colour to a Q12.8 duty: gamma straight into the 12-bit
+// domain, then brightness, keeping the sub-duty fraction for dithering. For
+// hardware fades only the segment endpoint is corrected – the fade engine
+// interpolates duty linearly, which is visually close enough over the slow
+// ramps the effects emit.
+static uint32_t channel_duty_q8(const rgb_strip_t* s, uint8_t colour) {
+#if CONFIG_UL_GAMMA_ENABLE
+    uint32_t duty_q8 = (uint32_t)ul_gamma12(colour) << 8;
+#else
+    uint32_t duty_q8 = ((uint32_t)colour * 4095u * 256u) / 255u;
+#endif
+    return (uint32_t)(((uint64_t)duty_q8 * s->brightness) / 255u);
+}
+
+// Stage all three duties first, then latch them back-to-back, so a frame's
+// colour presents (near) atomically instead of tearing R then G then B, and
+// the register writes run in two tight passes per strip.
+static void commit_strip_duties(rgb_strip_t* s, const uint8_t rgb[3]) {
+    uint32_t duty[3];
+    for (int c = 0; c < 3; ++c) {
+        duty[c] = dither_duty(channel_duty_q8(s, rgb[c]), &s->dither_err[c]);
+    }
+    for (int c = 0; c < 3; ++c) {
+        if (s->channel[c].configured) {
+            ledc_set_duty(s->channel[c].mode, s->channel[c].channel, (int)duty[c]);
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        if (s->channel[c].configured) {
+            ledc_update_duty(s->channel[c].mode, s->channel[c].channel);
+        }
+    }
+}
+
+// One scheduler pass over all strips: plan hardware fade segments, step
+// software effects, and report the soonest tick we need to run again.
+static TickType_t rgb_step(void* ctx) {
+    (void)ctx;
     TickType_t period_ticks = pdMS_TO_TICKS(1000) / CONFIG_UL_RGB_SMOOTH_HZ;
     if (period_ticks == 0) period_ticks = 1;
-    TickType_t last_wake = xTaskGetTickCount();
 
-    int n = 0;
-    ul_rgb_get_effects(&n); // ensure table linked
-
-    while (1) {
-        for (int i = 0; i < 4; ++i) {
-            rgb_strip_t* s = get_strip(i);
-            if (!s) continue;
-            s_current_strip = i;
-            uint8_t rgb[3] = {0, 0, 0};
-            if (s->eff && s->eff->render) {
-                s->eff->render(i, rgb, s->frame_idx++);
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = portMAX_DELAY;
+
+    for (int i = 0; i < 4; ++i) {
+        rgb_strip_t* s = get_strip(i);
+        if (!s) continue;
+
+        // Advance an active brightness ramp from wall time. The changed
+        // brightness falls through the elision check below, so every pass
+        // during the ramp commits a fresh (dithered) duty.
+        bool ramping = false;
+        if (s->bri_ramp_active) {
+            int64_t elapsed = esp_timer_get_time() - s->bri_ramp_start_us;
+            int64_t dur_us = (int64_t)s->bri_ramp_duration_ms * 1000;
+            if (elapsed >= dur_us) {
+                s->brightness = s->bri_ramp_target;
+                s->bri_ramp_active = false;
+            } else {
+                int delta = (int)s->bri_ramp_target - (int)s->bri_ramp_from;
+                s->brightness = (uint8_t)((int)s->bri_ramp_from +
+                                          (delta * elapsed) / dur_us);
+                ramping = true;
             }
-            memcpy(s->last_color, rgb, sizeof(rgb));
-#if CONFIG_UL_GAMMA_ENABLE
-            for (int c = 0; c < 3; ++c) {
-                rgb[c] = ul_gamma8(rgb[c]);
+        }
+
+        if (s->fade_active) {
+            TickType_t remaining = s->fade_end_tick - now;
+            if ((int32_t)remaining > 0) {
+                // Hardware is still ramping; check back at the boundary.
+                if (remaining < wait) wait = remaining;
+                continue;
             }
-#endif
+            s->fade_active = false;
+        }
+
+        rgb_fade_segment_t seg;
+        if (!s->hold && !ramping && s->eff && s->eff->plan_fade &&
+            s->eff->plan_fade(i, s->frame_idx, &seg)) {
+            memcpy(s->last_color, seg.target_rgb, sizeof(s->last_color));
+            s->last_brightness = s->brightness;
+            s->last_valid = true;
             for (int c = 0; c < 3; ++c) {
-                uint8_t value = (uint8_t)((rgb[c] * s->brightness) / 255);
-                set_channel_value(&s->channel[c], value);
+                uint32_t duty_q8 = channel_duty_q8(s, seg.target_rgb[c]);
+                if (seg.duration_ms > 0) {
+                    set_channel_fade(&s->channel[c], duty_q8, seg.duration_ms);
+                } else {
+                    set_channel_duty(&s->channel[c], duty_q8, NULL);
+                }
             }
+            if (seg.duration_ms > 0) {
+                TickType_t fade_ticks = pdMS_TO_TICKS(seg.duration_ms);
+                if (fade_ticks == 0) fade_ticks = 1;
+                s->fade_active = true;
+                s->fade_end_tick = now + fade_ticks;
+                // Keep frame_idx tracking wall time so re-planning after
+                // the boundary resumes from the right spot.
+                s->frame_idx += (int)(((int64_t)seg.duration_ms *
+                                       CONFIG_UL_RGB_SMOOTH_HZ) / 1000);
+                if (fade_ticks < wait) wait = fade_ticks;
+            } else {
+                // Static hold: the duty is latched in hardware and only
+                // an external state change can move it.
+                s->hold = true;
+            }
+            continue;
+        }
+        if (s->hold) continue;
+
+        int frame = s->frame_idx++;
+        uint8_t rgb[3] = {0, 0, 0};
+        if (s->eff && s->eff->render) {
+            s->eff->render(i, rgb, frame);
+        }
+        // Skip the peripheral writes entirely when the frame resolves to
+        // the colour already latched.
+        if (!s->last_valid || s->brightness != s->last_brightness ||
+            memcmp(rgb, s->last_color, sizeof(rgb)) != 0) {
+            memcpy(s->last_color, rgb, sizeof(rgb));
+            s->last_brightness = s->brightness;
+            s->last_valid = true;
+            commit_strip_duties(s, rgb);
+        }
+
+        // Effects that know their output is static (or quiet for a
+        // while) let the task skip the wakeups in between. A ramp keeps
+        // the strip at frame rate regardless until the target lands.
+        int next = (s->eff && s->eff->next_change)
+            ? s->eff->next_change(i, frame) : 1;
+        if (ramping && (next < 0 || next > 1)) next = 1;
+        if (next < 0) {
+            s->hold = true;
+            continue;
         }
-        vTaskDelayUntil(&last_wake, period_ticks);
+        if (next > 1) {
+            s->frame_idx = frame + next;
+            TickType_t quiet = (TickType_t)next * period_ticks;
+            if (quiet < wait) wait = quiet;
+        } else if (period_ticks < wait) {
+            wait = period_ticks;
+        }
+    }
+
+    // The dispatcher sleeps until this deadline; a state change
+    // (effect/brightness/params) kicks it awake early.
+    return wait;
+}
+
+// Replay the last persisted command for each enabled strip so output resumes
+// where it left off before the power cycle. ul_state_init() prefetched the
+// payloads into RAM, so the boot path only pays for the JSON parses. The
+// "strip" field is pinned to the slot index because the original command may
+// have carried the index only in the topic path.
+static void rgb_restore_saved_state(void) {
+    char* payload = malloc(UL_STATE_MAX_JSON_LEN);
+    if (!payload) return;
+    for (int i = 0; i < 4; ++i) {
+        if (!s_strips[i].enabled) continue;
+        if (!ul_state_copy_rgb(i, payload, UL_STATE_MAX_JSON_LEN)) continue;
+        cJSON* root = cJSON_Parse(payload);
+        if (!root) continue;
+        cJSON* jstrip = cJSON_GetObjectItem(root, "strip");
+        if (!jstrip) {
+            cJSON_AddNumberToObject(root, "strip", i);
+        } else {
+            jstrip->valueint = i;
+            jstrip->valuedouble = (double)i;
+        }
+        ul_rgb_apply_json(root);
+        cJSON_Delete(root);
     }
+    free(payload);
 }
 
 void ul_rgb_engine_start(void) {
     memset(s_strips, 0, sizeof(s_strips));
     s_strip_count = 0;
-    s_current_strip = 0;
 
 #if CONFIG_UL_RGB0_ENABLED
     strip_init(0, true, CONFIG_UL_RGB0_PWM_HZ, CONFIG_UL_RGB0_LEDC_MODE,
@@ -267,21 +467,23 @@ void ul_rgb_engine_start(void) {
 #endif
 
     if (s_strip_count > 0) {
-        TaskHandle_t task = NULL;
-        BaseType_t rc = ul_task_create(rgb_task, "rgb_smooth", 4096, NULL, 23,
-                                       &task, 1);
-        if (rc != pdPASS) {
-            ESP_LOGE(TAG, "Failed to create RGB smoothing task (%ld)",
-                     (long)rc);
+        if (!s_fade_installed) {
+            // One-time fade service for the hardware ramps; survives
+            // engine restarts.
+            ledc_fade_func_install(0);
+            s_fade_installed = true;
+        }
+        if (!ul_sched_register(rgb_step, NULL, "rgb")) {
+            ESP_LOGE(TAG, "Failed to register RGB engine with scheduler");
             ul_health_notify_rgb_engine_failure();
             ul_rgb_engine_stop();
             memset(s_strips, 0, sizeof(s_strips));
             s_strip_count = 0;
-            s_rgb_task = NULL;
             return;
         }
-        s_rgb_task = task;
+        s_rgb_registered = true;
         ul_health_notify_rgb_engine_ok();
+        rgb_restore_saved_state();
     } else {
         ESP_LOGI(TAG, "RGB engine started with no enabled strips");
         ul_health_notify_rgb_engine_ok();
@@ -289,14 +491,15 @@ void ul_rgb_engine_start(void) {
 }
 
 void ul_rgb_engine_stop(void) {
-    if (s_rgb_task) {
-        vTaskDelete(s_rgb_task);
-        s_rgb_task = NULL;
+    if (s_rgb_registered) {
+        ul_sched_unregister(rgb_step, NULL);
+        s_rgb_registered = false;
     }
     for (int i = 0; i < 4; ++i) {
         if (!s_strips[i].enabled) continue;
+        invalidate_fade(&s_strips[i]);
         for (int c = 0; c < 3; ++c) {
-            set_channel_value(&s_strips[i].channel[c], 0);
+            set_channel_duty(&s_strips[i].channel[c], 0, NULL);
         }
         s_strips[i].enabled = false;
     }
@@ -311,13 +514,34 @@ bool ul_rgb_set_effect(int strip, const char* name) {
     s->eff = eff;
     s->frame_idx = 0;
     if (s->eff && s->eff->init) s->eff->init();
+    invalidate_fade(s);
+    ul_sched_kick();
     return true;
 }
 
 bool ul_rgb_set_brightness(int strip, uint8_t bri) {
     rgb_strip_t* s = get_strip(strip);
     if (!s) return false;
+    s->bri_ramp_active = false;
     s->brightness = bri;
+    invalidate_fade(s);
+    ul_sched_kick();
+    return true;
+}
+
+bool ul_rgb_set_brightness_ramp(int strip, uint8_t target, int duration_ms) {
+    rgb_strip_t* s = get_strip(strip);
+    if (!s) return false;
+    if (duration_ms <= 0 || s->brightness == target) {
+        return ul_rgb_set_brightness(strip, target);
+    }
+    s->bri_ramp_from = s->brightness;
+    s->bri_ramp_target = target;
+    s->bri_ramp_start_us = esp_timer_get_time();
+    s->bri_ramp_duration_ms = duration_ms;
+    s->bri_ramp_active = true;
+    invalidate_fade(s);
+    ul_sched_kick();
     return true;
 }
 
@@ -350,6 +574,8 @@ void ul_rgb_apply_json(cJSON* root) {
         rgb_strip_t* s = get_strip(strip);
         if (s && s->eff && s->eff->apply_params) {
             s->eff->apply_params(strip, jparams);
+            invalidate_fade(s);
+            ul_sched_kick();
         }
     }
 }
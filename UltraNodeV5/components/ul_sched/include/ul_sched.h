@@ -0,0 +1,34 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Shared low-rate animation scheduler. The RGB and white engines used to run
+// one FreeRTOS task each doing the same shape of work (step slow analytic
+// effects, write LEDC duties, sleep until the next deadline); registering
+// with this dispatcher collapses them into a single task and stack.
+
+// One pass of a client's work. Returns how many ticks may elapse before the
+// client needs another pass; portMAX_DELAY means "idle until ul_sched_kick()".
+// Clients must tolerate being stepped early — any registrant's deadline or a
+// kick wakes the dispatcher, which then steps every client.
+typedef TickType_t (*ul_sched_step_fn)(void* ctx);
+
+// Register a client and (on first use) start the dispatcher task. Returns
+// false when no slot is free or the task cannot be created.
+bool ul_sched_register(ul_sched_step_fn step, void* ctx, const char* name);
+
+// Remove a previously registered client. The dispatcher task keeps running;
+// with no clients it just sleeps until the next registration.
+void ul_sched_unregister(ul_sched_step_fn step, void* ctx);
+
+// Wake the dispatcher early after a state change so clients re-plan now
+// instead of at their previously reported deadline.
+void ul_sched_kick(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+#include "ul_sched.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "ul_core.h"
+#include "ul_task.h"
+
+// Enough for the RGB and white engines, the timeline and cron players, plus
+// headroom; bump if another low-rate client appears.
+#define UL_SCHED_MAX_CLIENTS 6
+
+static const char* TAG = "ul_sched";
+
+typedef struct {
+    ul_sched_step_fn step;  // NULL marks a free slot
+    void* ctx;
+    const char* name;
+} sched_client_t;
+
+static sched_client_t s_clients[UL_SCHED_MAX_CLIENTS];
+static TaskHandle_t s_sched_task = NULL;
+static bool s_all_idle = false;
+
+static void sched_task(void* arg) {
+    (void)arg;
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        for (int i = 0; i < UL_SCHED_MAX_CLIENTS; ++i) {
+            if (!s_clients[i].step) continue;
+            TickType_t w = s_clients[i].step(s_clients[i].ctx);
+            if (w < wait) wait = w;
+        }
+        // An indefinite sleep means every client latched its output; tell
+        // the power policy so the radio can deepen its sleep until a state
+        // change kicks us awake.
+        bool idle = (wait == portMAX_DELAY);
+        if (idle != s_all_idle) {
+            s_all_idle = idle;
+            ul_core_power_set_animations_idle(idle);
+        }
+        // Sleep until the soonest client deadline; a kick wakes us early.
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+bool ul_sched_register(ul_sched_step_fn step, void* ctx, const char* name) {
+    if (!step) return false;
+
+    int slot = -1;
+    for (int i = 0; i < UL_SCHED_MAX_CLIENTS; ++i) {
+        if (!s_clients[i].step) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        ESP_LOGE(TAG, "No free scheduler slot for %s", name ? name : "?");
+        return false;
+    }
+
+    if (!s_sched_task) {
+        // Same priority/core as the tasks this dispatcher replaces: below
+        // the pixel refresh task, pinned off the network core when there
+        // are two.
+        BaseType_t rc = ul_task_create(sched_task, "ul_sched", 4096, NULL, 23,
+                                       &s_sched_task, 1);
+        if (rc != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create scheduler task (%ld)", (long)rc);
+            s_sched_task = NULL;
+            return false;
+        }
+    }
+
+    s_clients[slot].ctx = ctx;
+    s_clients[slot].name = name;
+    s_clients[slot].step = step;
+    // Step the new client promptly rather than at the old sleep deadline.
+    ul_sched_kick();
+    return true;
+}
+
+void ul_sched_unregister(ul_sched_step_fn step, void* ctx) {
+    for (int i = 0; i < UL_SCHED_MAX_CLIENTS; ++i) {
+        if (s_clients[i].step == step && s_clients[i].ctx == ctx) {
+            s_clients[i].step = NULL;
+            s_clients[i].ctx = NULL;
+            s_clients[i].name = NULL;
+        }
+    }
+}
+
+void ul_sched_kick(void) {
+    if (s_sched_task) {
+        xTaskNotifyGive(s_sched_task);
+    }
+}
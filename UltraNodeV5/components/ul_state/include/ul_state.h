@@ -2,10 +2,17 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "esp_err.h"
 
 #define UL_STATE_MAX_JSON_LEN 1024
 
+// Bounds for the runtime-configurable flush window (see
+// ul_state_set_flush_delay_ms). The floor keeps command bursts coalescing;
+// the ceiling bounds how much recent state a power cut can lose.
+#define UL_STATE_FLUSH_DELAY_MIN_MS 500
+#define UL_STATE_FLUSH_DELAY_MAX_MS 300000
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +32,14 @@ void ul_state_record_ws(int strip, const char *payload, size_t len);
 void ul_state_record_rgb(int strip, const char *payload, size_t len);
 void ul_state_record_white(int channel, const char *payload, size_t len);
 
+// Records the local motion rule configuration (one blob, no index); same
+// copy-and-defer semantics as the per-channel recorders above.
+void ul_state_record_motion(const char *payload, size_t len);
+
+// Records the cron schedule configuration (one blob, no index); same
+// copy-and-defer semantics as the per-channel recorders above.
+void ul_state_record_cron(const char *payload, size_t len);
+
 // Copies the most recent persisted JSON payload for the requested target into
 // the caller-provided buffer. The copy includes the terminating null byte. The
 // buffer is cleared and false is returned if no payload has been recorded or
@@ -32,6 +47,28 @@ void ul_state_record_white(int channel, const char *payload, size_t len);
 bool ul_state_copy_ws(int strip, char *buffer, size_t buffer_len);
 bool ul_state_copy_rgb(int strip, char *buffer, size_t buffer_len);
 bool ul_state_copy_white(int channel, char *buffer, size_t buffer_len);
+bool ul_state_copy_motion(char *buffer, size_t buffer_len);
+bool ul_state_copy_cron(char *buffer, size_t buffer_len);
+
+// Sets the coalescing window between the last recorded update and the flash
+// flush. Values are clamped to [UL_STATE_FLUSH_DELAY_MIN_MS,
+// UL_STATE_FLUSH_DELAY_MAX_MS] and persisted so the tuning survives reboots:
+// music-reactive rooms run short windows for freshness, bedroom nodes run
+// long ones to spare the flash.
+void ul_state_set_flush_delay_ms(uint32_t ms);
+uint32_t ul_state_get_flush_delay_ms(void);
+
+// Flash write-amplification accounting. All counters are monotonic since
+// boot: writes_issued counts blobs actually programmed, writes_deduped
+// counts updates skipped because the bytes already matched, and
+// writes_coalesced counts updates absorbed into an already-pending flush.
+typedef struct {
+  uint32_t writes_issued;
+  uint32_t writes_deduped;
+  uint32_t writes_coalesced;
+} ul_state_metrics_t;
+
+void ul_state_get_metrics(ul_state_metrics_t *out);
 
 #ifdef __cplusplus
 }
@@ -1,7 +1,10 @@
 #include "ul_state.h"
 
+#include "esp_attr.h"
+#include "esp_crc.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_system.h"
 #include "esp_timer.h"
 #include "nvs.h"
 #include "nvs_flash.h"
@@ -20,8 +23,40 @@
 #define UL_STATE_WHITE_MAX_CHANNELS 4
 
 #define UL_STATE_MAX_PAYLOAD UL_STATE_MAX_JSON_LEN
-#define UL_STATE_FLUSH_DELAY_US (3ULL * 1000000ULL)
+#define UL_STATE_FLUSH_DELAY_DEFAULT_MS 3000
+
+// NVS key holding the configured flush window, alongside the state blobs.
+#define UL_STATE_FLUSH_DELAY_NVS_KEY "flushms"
+
+// ---- RTC RAM mirror ---------------------------------------------------------
+// Most reboots here are soft -- OTA applies and ul_health escalations -- and
+// RTC RAM survives them. The last-applied payload of every entry is mirrored
+// into a checksummed RTC slot on each change, so a soft reboot restores
+// channel state straight from RAM and the NVS reads (and their flash traffic)
+// drop out of the reboot path. Cold power-on finds garbage, fails the magic
+// and CRC checks and falls back to flash as before.
+//
+// Slots are fixed-size so one entry can be rewritten in place; a payload too
+// large for its slot leaves the slot empty and that entry restores from NVS.
+// Bump the magic whenever the slot size or the entry table layout changes.
+#define UL_STATE_RTC_MAGIC 0x554C5331 // "ULS1"
+#define UL_STATE_RTC_SLOT_SIZE 320
 
+typedef struct {
+  uint16_t len; // payload bytes including the NUL; 0 = empty or oversized
+  uint16_t reserved;
+  uint32_t crc; // esp_crc32_le over payload[0..len)
+  char payload[UL_STATE_RTC_SLOT_SIZE];
+} ul_state_rtc_slot_t;
+
+typedef struct {
+  uint32_t magic;
+  ul_state_rtc_slot_t slots[UL_STATE_WS_MAX_STRIPS + UL_STATE_RGB_MAX_STRIPS +
+                            UL_STATE_WHITE_MAX_CHANNELS + 2];
+} ul_state_rtc_mirror_t;
+
+static RTC_NOINIT_ATTR ul_state_rtc_mirror_t s_rtc_mirror;
+static bool s_rtc_restore = false; // mirror survived the reboot intact
 
 static const char *TAG = "ul_state";
 
@@ -29,122 +64,182 @@ typedef enum {
   UL_STATE_TARGET_WS,
   UL_STATE_TARGET_RGB,
   UL_STATE_TARGET_WHITE,
+  UL_STATE_TARGET_MOTION,
+  UL_STATE_TARGET_CRON,
 } ul_state_target_t;
 
 typedef struct {
   ul_state_target_t target;
   int index;
   char key[8];
-  esp_timer_handle_t timer;
   char *payload;
   size_t payload_len;
   bool dirty;
+  // CRC32 of the blob currently in NVS, seeded from flash at init and only
+  // touched by the persistence task afterwards. Lets the task skip the
+  // erase/program cycle when a dirty entry turns out byte-identical to what
+  // is already stored (dashboards restate full strip config constantly).
+  uint32_t stored_crc;
+  bool stored_crc_valid;
 } ul_state_entry_t;
 
+// +2 for the single local motion rule blob and the cron schedule blob.
 static ul_state_entry_t s_entries[UL_STATE_WS_MAX_STRIPS +
                                   UL_STATE_RGB_MAX_STRIPS +
-                                  UL_STATE_WHITE_MAX_CHANNELS];
+                                  UL_STATE_WHITE_MAX_CHANNELS + 2];
 static size_t s_entry_count;
 
-typedef struct {
-  int entry_index;
-} ul_state_msg_t;
+// The queue is a doorbell: any token wakes the task, which drains every
+// dirty entry and issues one nvs_commit for the lot. A scene change dirties
+// most of the table within one flush window; batching turns its ten commits
+// (each a flash barrier) into one.
+typedef uint8_t ul_state_msg_t;
 
 static QueueHandle_t s_queue;
 static TaskHandle_t s_task;
 static nvs_handle_t s_nvs;
+static esp_timer_handle_t s_flush_timer;
 static bool s_ready = false;
 static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_flush_delay_ms = UL_STATE_FLUSH_DELAY_DEFAULT_MS;
+// Write-amplification accounting, guarded by s_lock like the entries.
+static ul_state_metrics_t s_metrics;
 
-static void schedule_flush(size_t entry_index);
+static void schedule_flush(void);
 static bool copy_entry(size_t entry_index, char *buffer, size_t buffer_len);
 static void cleanup_resources(size_t active_entries);
 
 static void ul_state_task(void *arg) {
+  (void)arg;
   ul_state_msg_t msg;
   while (xQueueReceive(s_queue, &msg, portMAX_DELAY) == pdTRUE) {
-    if (msg.entry_index < 0 || msg.entry_index >= (int)s_entry_count)
-      continue;
-    ul_state_entry_t *entry = &s_entries[msg.entry_index];
-
-    char *copy = NULL;
-    size_t len = 0;
-
-    portENTER_CRITICAL(&s_lock);
-    if (entry->dirty && entry->payload && entry->payload_len > 0) {
-      len = entry->payload_len;
-      copy = malloc(len);
-      if (copy) {
-        memcpy(copy, entry->payload, len);
-        entry->dirty = false;
-      }
-    }
-    portEXIT_CRITICAL(&s_lock);
+    bool wrote = false;
+    bool retry = false;
+    uint32_t written_crc[sizeof(s_entries) / sizeof(s_entries[0])];
+    bool written[sizeof(s_entries) / sizeof(s_entries[0])] = {false};
 
-    if (!copy) {
-      schedule_flush(msg.entry_index);
-      continue;
-    }
+    for (size_t i = 0; i < s_entry_count; ++i) {
+      ul_state_entry_t *entry = &s_entries[i];
 
-    esp_err_t err = nvs_set_blob(s_nvs, entry->key, copy, len);
-    if (err == ESP_OK) {
-      err = nvs_commit(s_nvs);
-    }
+      char *copy = NULL;
+      size_t len = 0;
 
-    if (err != ESP_OK) {
-      ESP_LOGE(TAG, "Failed to persist %s: %s", entry->key,
-               esp_err_to_name(err));
       portENTER_CRITICAL(&s_lock);
-      entry->dirty = true;
+      if (entry->dirty && entry->payload && entry->payload_len > 0) {
+        len = entry->payload_len;
+        copy = malloc(len);
+        if (copy) {
+          memcpy(copy, entry->payload, len);
+          entry->dirty = false;
+        }
+      } else {
+        entry = NULL;
+      }
       portEXIT_CRITICAL(&s_lock);
-      schedule_flush(msg.entry_index);
-    } else {
-      ESP_LOGD(TAG, "Persisted %s (%u bytes)", entry->key,
-               (unsigned)len);
+
+      if (!entry)
+        continue;
+      if (!copy) {
+        retry = true;
+        continue;
+      }
+
+      uint32_t crc = esp_crc32_le(0, (const uint8_t *)copy, len);
+      if (entry->stored_crc_valid && crc == entry->stored_crc) {
+        ESP_LOGD(TAG, "Skipping write for %s; blob unchanged", entry->key);
+        portENTER_CRITICAL(&s_lock);
+        s_metrics.writes_deduped++;
+        portEXIT_CRITICAL(&s_lock);
+        free(copy);
+        continue;
+      }
+
+      esp_err_t err = nvs_set_blob(s_nvs, entry->key, copy, len);
+      if (err == ESP_OK) {
+        written[i] = true;
+        written_crc[i] = crc;
+        wrote = true;
+        portENTER_CRITICAL(&s_lock);
+        s_metrics.writes_issued++;
+        portEXIT_CRITICAL(&s_lock);
+        ESP_LOGD(TAG, "Staged %s (%u bytes)", entry->key, (unsigned)len);
+      } else {
+        ESP_LOGE(TAG, "Failed to persist %s: %s", entry->key,
+                 esp_err_to_name(err));
+        portENTER_CRITICAL(&s_lock);
+        entry->dirty = true;
+        portEXIT_CRITICAL(&s_lock);
+        retry = true;
+      }
+      free(copy);
     }
 
-    free(copy);
+    if (wrote) {
+      esp_err_t err = nvs_commit(s_nvs);
+      if (err == ESP_OK) {
+        for (size_t i = 0; i < s_entry_count; ++i) {
+          if (written[i]) {
+            s_entries[i].stored_crc = written_crc[i];
+            s_entries[i].stored_crc_valid = true;
+          }
+        }
+      } else {
+        ESP_LOGE(TAG, "Failed to commit state batch: %s", esp_err_to_name(err));
+        portENTER_CRITICAL(&s_lock);
+        for (size_t i = 0; i < s_entry_count; ++i) {
+          if (written[i])
+            s_entries[i].dirty = true;
+        }
+        portEXIT_CRITICAL(&s_lock);
+        retry = true;
+      }
+    }
+
+    if (retry)
+      schedule_flush();
   }
 }
 
 static void flush_timer_cb(void *arg) {
-  int entry_index = (int)(intptr_t)arg;
+  (void)arg;
   bool dirty = false;
   portENTER_CRITICAL(&s_lock);
-  if (entry_index >= 0 && entry_index < (int)s_entry_count) {
-    dirty = s_entries[entry_index].dirty;
+  for (size_t i = 0; i < s_entry_count; ++i) {
+    if (s_entries[i].dirty) {
+      dirty = true;
+      break;
+    }
   }
   portEXIT_CRITICAL(&s_lock);
   if (!dirty)
     return;
   if (!s_queue)
     return;
-  ul_state_msg_t msg = {.entry_index = entry_index};
+  ul_state_msg_t msg = 0;
   if (xQueueSend(s_queue, &msg, 0) != pdPASS) {
-    ESP_LOGW(TAG, "Persistence queue full; delaying request for %d",
-             entry_index);
-    schedule_flush(entry_index);
+    // A pending wakeup already covers every dirty entry; nothing is lost.
+    ESP_LOGD(TAG, "Persistence queue full; flush already pending");
   }
 }
 
+// Mirror one payload into its RTC slot. Callers either hold s_lock or run
+// before the persistence task exists, so slot writes never interleave. The
+// CRC is computed by the caller outside the critical section.
+static void rtc_mirror_store(size_t entry_index, const char *payload,
+                             size_t payload_len, uint32_t crc) {
+  ul_state_rtc_slot_t *slot = &s_rtc_mirror.slots[entry_index];
+  if (payload_len == 0 || payload_len > UL_STATE_RTC_SLOT_SIZE) {
+    slot->len = 0;
+    return;
+  }
+  memcpy(slot->payload, payload, payload_len);
+  slot->len = (uint16_t)payload_len;
+  slot->crc = crc;
+}
+
 static void cleanup_entry(ul_state_entry_t *entry) {
   if (!entry)
     return;
-  if (entry->timer) {
-    esp_err_t err = esp_timer_stop(entry->timer);
-    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
-      ESP_LOGW(TAG, "Failed to stop timer for %s: %s",
-               entry->key[0] ? entry->key : "entry",
-               esp_err_to_name(err));
-    }
-    err = esp_timer_delete(entry->timer);
-    if (err != ESP_OK) {
-      ESP_LOGW(TAG, "Failed to delete timer for %s: %s",
-               entry->key[0] ? entry->key : "entry",
-               esp_err_to_name(err));
-    }
-    entry->timer = NULL;
-  }
   if (entry->payload) {
     free(entry->payload);
     entry->payload = NULL;
@@ -160,6 +255,17 @@ static void cleanup_resources(size_t active_entries) {
   for (size_t i = 0; i < active_entries; ++i) {
     cleanup_entry(&s_entries[i]);
   }
+  if (s_flush_timer) {
+    esp_err_t err = esp_timer_stop(s_flush_timer);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+      ESP_LOGW(TAG, "Failed to stop flush timer: %s", esp_err_to_name(err));
+    }
+    err = esp_timer_delete(s_flush_timer);
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "Failed to delete flush timer: %s", esp_err_to_name(err));
+    }
+    s_flush_timer = NULL;
+  }
   if (s_queue) {
     vQueueDelete(s_queue);
     s_queue = NULL;
@@ -183,19 +289,61 @@ static esp_err_t init_entry(size_t entry_index, ul_state_target_t target,
   entry->payload = NULL;
   entry->payload_len = 0;
   entry->dirty = false;
-  entry->timer = NULL;
+  entry->stored_crc = 0;
+  entry->stored_crc_valid = false;
+
+  // Soft reboot: restore from the RTC mirror and skip the flash read. The
+  // NVS dedupe CRC stays unseeded -- we never looked at flash -- so the first
+  // genuinely changed write after a soft reboot cannot be skipped;
+  // update_entry()'s byte-compare still absorbs restated config.
+  if (s_rtc_restore) {
+    ul_state_rtc_slot_t *slot = &s_rtc_mirror.slots[entry_index];
+    if (slot->len > 0 && slot->len <= UL_STATE_RTC_SLOT_SIZE &&
+        slot->payload[slot->len - 1] == '\0' &&
+        slot->crc ==
+            esp_crc32_le(0, (const uint8_t *)slot->payload, slot->len)) {
+      char *mirrored = malloc(slot->len);
+      if (mirrored) {
+        memcpy(mirrored, slot->payload, slot->len);
+        entry->payload = mirrored;
+        entry->payload_len = slot->len;
+        return ESP_OK;
+      }
+    }
+  }
 
-  const esp_timer_create_args_t args = {
-      .callback = &flush_timer_cb,
-      .arg = (void *)(intptr_t)entry_index,
-      .name = "ul_state", };
-  esp_err_t err = esp_timer_create(&args, &entry->timer);
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to create persistence timer for %s: %s", entry->key,
-             esp_err_to_name(err));
-    cleanup_resources(entry_index);
-    return err;
+  // Load whatever blob is already in flash: it seeds the dedupe CRC, and
+  // keeping the payload resident lets ul_state_copy_*() serve the persisted
+  // command straight after boot so it can be replayed without a round trip
+  // to the broker.
+  size_t stored_len = 0;
+  if (nvs_get_blob(s_nvs, entry->key, NULL, &stored_len) == ESP_OK &&
+      stored_len > 0 && stored_len <= UL_STATE_MAX_PAYLOAD) {
+    char *stored = malloc(stored_len);
+    if (stored) {
+      if (nvs_get_blob(s_nvs, entry->key, stored, &stored_len) == ESP_OK) {
+        entry->stored_crc =
+            esp_crc32_le(0, (const uint8_t *)stored, stored_len);
+        entry->stored_crc_valid = true;
+        stored[stored_len - 1] = '\0'; // blobs are NUL-terminated JSON
+        entry->payload = stored;
+        entry->payload_len = stored_len;
+        stored = NULL;
+      }
+      free(stored);
+    }
+  }
+
+  // Seed the mirror from whatever flash held (or clear a stale slot) so the
+  // next soft reboot can skip this read too.
+  if (entry->payload) {
+    rtc_mirror_store(entry_index, entry->payload, entry->payload_len,
+                     esp_crc32_le(0, (const uint8_t *)entry->payload,
+                                  entry->payload_len));
+  } else {
+    s_rtc_mirror.slots[entry_index].len = 0;
   }
+
   return ESP_OK;
 }
 
@@ -214,6 +362,17 @@ esp_err_t ul_state_init(void) {
     return err;
   }
 
+  // The flush window itself is persisted so per-deployment tuning survives
+  // reboots. Out-of-range stored values are clamped, not rejected.
+  uint32_t delay_ms = 0;
+  if (nvs_get_u32(s_nvs, UL_STATE_FLUSH_DELAY_NVS_KEY, &delay_ms) == ESP_OK) {
+    if (delay_ms < UL_STATE_FLUSH_DELAY_MIN_MS)
+      delay_ms = UL_STATE_FLUSH_DELAY_MIN_MS;
+    if (delay_ms > UL_STATE_FLUSH_DELAY_MAX_MS)
+      delay_ms = UL_STATE_FLUSH_DELAY_MAX_MS;
+    s_flush_delay_ms = delay_ms;
+  }
+
   s_queue = xQueueCreate(8, sizeof(ul_state_msg_t));
   if (!s_queue) {
     ESP_LOGE(TAG, "Failed to create persistence queue");
@@ -221,6 +380,28 @@ esp_err_t ul_state_init(void) {
     return ESP_ERR_NO_MEM;
   }
 
+  // One trailing-edge timer covers the whole table; see ul_state_task().
+  const esp_timer_create_args_t timer_args = {
+      .callback = &flush_timer_cb,
+      .name = "ul_state", };
+  err = esp_timer_create(&timer_args, &s_flush_timer);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create persistence timer: %s",
+             esp_err_to_name(err));
+    cleanup_resources(0);
+    return err;
+  }
+
+  // Decide once whether the mirror is trustworthy: a matching magic plus a
+  // reset reason that keeps RTC RAM powered. Brownouts are treated like
+  // power-on since the RAM may have sagged with the rail.
+  esp_reset_reason_t reason = esp_reset_reason();
+  s_rtc_restore = s_rtc_mirror.magic == UL_STATE_RTC_MAGIC &&
+                  reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT;
+  if (!s_rtc_restore)
+    memset(&s_rtc_mirror, 0, sizeof(s_rtc_mirror));
+  s_rtc_mirror.magic = UL_STATE_RTC_MAGIC;
+
   const size_t total_entries = sizeof(s_entries) / sizeof(s_entries[0]);
 
   if ((err = init_entry(s_entry_count, UL_STATE_TARGET_WS, 0, "ws0")) !=
@@ -263,6 +444,14 @@ esp_err_t ul_state_init(void) {
       ESP_OK)
     return err;
   s_entry_count++;
+  if ((err = init_entry(s_entry_count, UL_STATE_TARGET_MOTION, 0, "motn")) !=
+      ESP_OK)
+    return err;
+  s_entry_count++;
+  if ((err = init_entry(s_entry_count, UL_STATE_TARGET_CRON, 0, "cron")) !=
+      ESP_OK)
+    return err;
+  s_entry_count++;
 
   if (s_entry_count > total_entries) {
     ESP_LOGE(TAG, "Too many state entries configured");
@@ -270,8 +459,8 @@ esp_err_t ul_state_init(void) {
     return ESP_FAIL;
   }
 
-  if (ul_task_create(ul_state_task, "ul_state", 4096, NULL, 5, &s_task, 0) !=
-      pdPASS) {
+  if (ul_task_create(ul_state_task, "ul_state", 4096, NULL, 5, &s_task,
+                     UL_TASK_CORE_AUTO) != pdPASS) {
     ESP_LOGE(TAG, "Failed to start persistence task");
     cleanup_resources(s_entry_count);
     return ESP_ERR_NO_MEM;
@@ -281,23 +470,47 @@ esp_err_t ul_state_init(void) {
   return ESP_OK;
 }
 
-static void schedule_flush(size_t entry_index) {
+void ul_state_set_flush_delay_ms(uint32_t ms) {
+  if (ms < UL_STATE_FLUSH_DELAY_MIN_MS)
+    ms = UL_STATE_FLUSH_DELAY_MIN_MS;
+  if (ms > UL_STATE_FLUSH_DELAY_MAX_MS)
+    ms = UL_STATE_FLUSH_DELAY_MAX_MS;
+  if (ms == s_flush_delay_ms)
+    return;
+  s_flush_delay_ms = ms;
+  ESP_LOGI(TAG, "Flush window set to %u ms", (unsigned)ms);
   if (!s_ready)
     return;
-  if (entry_index >= s_entry_count)
+  // A config change is rare enough to commit immediately rather than ride
+  // the batching path the state blobs use.
+  esp_err_t err = nvs_set_u32(s_nvs, UL_STATE_FLUSH_DELAY_NVS_KEY, ms);
+  if (err == ESP_OK)
+    err = nvs_commit(s_nvs);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to persist flush window: %s", esp_err_to_name(err));
+  }
+}
+
+uint32_t ul_state_get_flush_delay_ms(void) { return s_flush_delay_ms; }
+
+void ul_state_get_metrics(ul_state_metrics_t *out) {
+  if (!out)
     return;
-  ul_state_entry_t *entry = &s_entries[entry_index];
-  if (!entry->timer)
+  portENTER_CRITICAL(&s_lock);
+  *out = s_metrics;
+  portEXIT_CRITICAL(&s_lock);
+}
+
+static void schedule_flush(void) {
+  if (!s_ready || !s_flush_timer)
     return;
-  esp_err_t err = esp_timer_stop(entry->timer);
+  esp_err_t err = esp_timer_stop(s_flush_timer);
   if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
-    ESP_LOGW(TAG, "Failed to stop timer for %u: %s", (unsigned)entry_index,
-             esp_err_to_name(err));
+    ESP_LOGW(TAG, "Failed to stop flush timer: %s", esp_err_to_name(err));
   }
-  err = esp_timer_start_once(entry->timer, UL_STATE_FLUSH_DELAY_US);
+  err = esp_timer_start_once(s_flush_timer, (uint64_t)s_flush_delay_ms * 1000ULL);
   if (err != ESP_OK) {
-    ESP_LOGW(TAG, "Failed to arm timer for %u: %s", (unsigned)entry_index,
-             esp_err_to_name(err));
+    ESP_LOGW(TAG, "Failed to arm flush timer: %s", esp_err_to_name(err));
   }
 }
 
@@ -318,26 +531,40 @@ static void update_entry(size_t entry_index, const char *payload, size_t len) {
   memcpy(copy, payload, len);
   copy[len] = '\0';
 
+  // RTC slot CRC, computed outside the critical section; oversized payloads
+  // get no CRC because rtc_mirror_store() clears their slot anyway.
+  uint32_t slot_crc = 0;
+  if (len + 1 <= UL_STATE_RTC_SLOT_SIZE)
+    slot_crc = esp_crc32_le(0, (const uint8_t *)copy, len + 1);
+
   ul_state_entry_t *entry = &s_entries[entry_index];
   char *old_payload = NULL;
 
   portENTER_CRITICAL(&s_lock);
   if (entry->payload && entry->payload_len == len + 1 &&
       memcmp(entry->payload, copy, len + 1) == 0) {
+    s_metrics.writes_deduped++;
     portEXIT_CRITICAL(&s_lock);
     free(copy);
     return;
   }
+  if (entry->dirty) {
+    // An older pending payload just got superseded before reaching flash.
+    s_metrics.writes_coalesced++;
+  }
   old_payload = entry->payload;
   entry->payload = copy;
   entry->payload_len = len + 1;
   entry->dirty = true;
+  rtc_mirror_store(entry_index, copy, len + 1, slot_crc);
   portEXIT_CRITICAL(&s_lock);
 
   if (old_payload)
     free(old_payload);
 
-  schedule_flush(entry_index);
+  // Re-armed on every update: entries dirtied within the same window ride
+  // one drain and one commit.
+  schedule_flush();
 }
 
 static bool copy_entry(size_t entry_index, char *buffer, size_t buffer_len) {
@@ -387,6 +614,18 @@ void ul_state_record_white(int channel, const char *payload, size_t len) {
   update_entry(base + channel, payload, len);
 }
 
+void ul_state_record_motion(const char *payload, size_t len) {
+  size_t base = UL_STATE_WS_MAX_STRIPS + UL_STATE_RGB_MAX_STRIPS +
+                UL_STATE_WHITE_MAX_CHANNELS;
+  update_entry(base, payload, len);
+}
+
+void ul_state_record_cron(const char *payload, size_t len) {
+  size_t base = UL_STATE_WS_MAX_STRIPS + UL_STATE_RGB_MAX_STRIPS +
+                UL_STATE_WHITE_MAX_CHANNELS + 1;
+  update_entry(base, payload, len);
+}
+
 bool ul_state_copy_ws(int strip, char *buffer, size_t buffer_len) {
   if (strip < 0 || strip >= UL_STATE_WS_MAX_STRIPS) {
     if (buffer && buffer_len > 0)
@@ -414,3 +653,15 @@ bool ul_state_copy_white(int channel, char *buffer, size_t buffer_len) {
   size_t base = UL_STATE_WS_MAX_STRIPS + UL_STATE_RGB_MAX_STRIPS;
   return copy_entry(base + channel, buffer, buffer_len);
 }
+
+bool ul_state_copy_motion(char *buffer, size_t buffer_len) {
+  size_t base = UL_STATE_WS_MAX_STRIPS + UL_STATE_RGB_MAX_STRIPS +
+                UL_STATE_WHITE_MAX_CHANNELS;
+  return copy_entry(base, buffer, buffer_len);
+}
+
+bool ul_state_copy_cron(char *buffer, size_t buffer_len) {
+  size_t base = UL_STATE_WS_MAX_STRIPS + UL_STATE_RGB_MAX_STRIPS +
+                UL_STATE_WHITE_MAX_CHANNELS + 1;
+  return copy_entry(base, buffer, buffer_len);
+}
@@ -12,6 +12,18 @@ extern uint8_t ul_core_count;
 void ul_task_init(void);
 void ul_set_core_count(uint8_t count);
 
+// Core affinity policy:
+//  - Latency-critical tasks (renderers, the animation scheduler, anything
+//    feeding LED hardware) pin explicitly to core 1 on dual-core parts,
+//    away from the Wi-Fi/lwIP stack that lives on core 0.
+//  - ISR-adjacent tasks pin to the core that services their interrupt.
+//  - Throughput and background tasks (workers, persistence, telemetry,
+//    downloads) pass UL_TASK_CORE_AUTO and are placed on whichever core has
+//    the least committed priority from the registry ledger; ties go to
+//    core 1 because the radio stack's own tasks never enter the ledger.
+// Single-core parts ignore affinity entirely.
+#define UL_TASK_CORE_AUTO ((BaseType_t)-1)
+
 BaseType_t ul_task_create(TaskFunction_t task_func,
                           const char *name,
                           const uint32_t stack_depth,
@@ -20,6 +32,26 @@ BaseType_t ul_task_create(TaskFunction_t task_func,
                           TaskHandle_t *task_handle,
                           BaseType_t core_id);
 
+// One sampled row of the task registry. stack_depth is the size passed to
+// ul_task_create(); stack_hwm_bytes is the least stack ever left unused.
+// Both are in bytes.
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t stack_depth;
+    uint32_t stack_hwm_bytes;
+} ul_task_stack_info_t;
+
+// Fills out with a high-water-mark sample for every registered task and
+// returns the number of rows written.
+size_t ul_task_sample_stacks(ul_task_stack_info_t *out, size_t max_entries);
+
+// Drops a task from the registry. Must be called before deleting any task
+// that was created through ul_task_create(); pass NULL for the calling task.
+void ul_task_forget(TaskHandle_t handle);
+
+// Lifetime count of successful ul_task_create() calls.
+uint32_t ul_task_created_total(void);
+
 #ifdef __cplusplus
 }
 #endif
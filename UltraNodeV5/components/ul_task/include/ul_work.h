@@ -0,0 +1,53 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Shared deferred-work executor: one task absorbing the one-shot and
+// periodic jobs that would otherwise each burn a dedicated stack or poll
+// loop. Jobs are caller-owned structs, so scheduling never allocates; when
+// several jobs are due at once the highest priority runs first.
+//
+// Job callbacks run on the executor task and must not block for long —
+// every other scheduled job waits behind them.
+
+typedef void (*ul_work_fn_t)(void *arg);
+
+typedef struct {
+    ul_work_fn_t fn;
+    void *arg;
+    uint8_t priority; // higher runs first when several jobs are due
+    // Managed by the executor; do not touch after ul_work_job_init().
+    uint64_t due_us;
+    uint32_t period_ms;
+    bool registered;
+} ul_work_job_t;
+
+// Starts the executor task. Call once early in boot, after ul_task_init().
+esp_err_t ul_work_start(void);
+
+void ul_work_job_init(ul_work_job_t *job, ul_work_fn_t fn, void *arg,
+                      uint8_t priority);
+
+// Arms (or re-arms) a one-shot run of the job after delay_ms. Returns
+// ESP_ERR_NO_MEM if the job table is full, ESP_ERR_INVALID_STATE before
+// ul_work_start().
+esp_err_t ul_work_schedule(ul_work_job_t *job, uint32_t delay_ms);
+
+// Arms the job to run every period_ms until cancelled.
+esp_err_t ul_work_schedule_periodic(ul_work_job_t *job, uint32_t period_ms);
+
+// Disarms the job. A callback already mid-run is not interrupted.
+void ul_work_cancel(ul_work_job_t *job);
+
+// pending = jobs currently armed; executed_total = lifetime callback runs.
+void ul_work_get_stats(uint32_t *pending, uint32_t *executed_total);
+
+#ifdef __cplusplus
+}
+#endif
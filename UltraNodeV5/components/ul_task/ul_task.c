@@ -1,9 +1,35 @@
+#include <string.h>
+
 #include "esp_system.h"
 #include "esp_chip_info.h"
 #include "ul_task.h"
 
 uint8_t ul_core_count;
 
+// Registry of every task created through ul_task_create(). Stack depths have
+// historically been sized by folklore; keeping the provisioned depth next to
+// a live uxTaskGetStackHighWaterMark() sample turns shrinking them into a
+// data exercise instead of a guess.
+#define UL_TASK_REGISTRY_MAX 16
+
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t stack_depth;
+    BaseType_t core_id;
+    UBaseType_t priority;
+} ul_task_entry_t;
+
+static ul_task_entry_t s_registry[UL_TASK_REGISTRY_MAX];
+static size_t s_registry_count;
+static uint32_t s_created_total;
+// Committed priority per core: the sum of (priority + 1) for every
+// registered task pinned there. A crude stand-in for load, but the fleet's
+// tasks have stable duty cycles, so relative commitment tracks reality well
+// enough to stop everything auto-placed from piling onto one core.
+static uint32_t s_core_weight[2];
+static portMUX_TYPE s_registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
 void ul_task_init(void) {
     esp_chip_info_t chip_info;
     esp_chip_info(&chip_info);
@@ -14,6 +40,35 @@ void ul_set_core_count(uint8_t count) {
     ul_core_count = count;
 }
 
+static void registry_add(TaskHandle_t handle, const char *name,
+                         uint32_t stack_depth, BaseType_t core_id,
+                         UBaseType_t priority) {
+    portENTER_CRITICAL(&s_registry_lock);
+    s_created_total++;
+    if (s_registry_count < UL_TASK_REGISTRY_MAX) {
+        ul_task_entry_t *entry = &s_registry[s_registry_count++];
+        entry->handle = handle;
+        strlcpy(entry->name, name ? name : "?", sizeof(entry->name));
+        entry->stack_depth = stack_depth;
+        entry->core_id = core_id;
+        entry->priority = priority;
+        if (core_id == 0 || core_id == 1) {
+            s_core_weight[core_id] += (uint32_t)priority + 1;
+        }
+    }
+    portEXIT_CRITICAL(&s_registry_lock);
+}
+
+// Least-committed core for an auto-placed task. Ties go to core 1: the
+// Wi-Fi/lwIP tasks on core 0 never pass through this registry, so an empty
+// ledger still means core 0 is the busier one.
+static BaseType_t pick_core(void) {
+    portENTER_CRITICAL(&s_registry_lock);
+    BaseType_t core = (s_core_weight[0] < s_core_weight[1]) ? 0 : 1;
+    portEXIT_CRITICAL(&s_registry_lock);
+    return core;
+}
+
 BaseType_t ul_task_create(TaskFunction_t task_func,
                           const char *name,
                           const uint32_t stack_depth,
@@ -21,10 +76,70 @@ BaseType_t ul_task_create(TaskFunction_t task_func,
                           UBaseType_t priority,
                           TaskHandle_t *task_handle,
                           BaseType_t core_id) {
+    TaskHandle_t handle = NULL;
+    BaseType_t res;
     if (ul_core_count > 1) {
-        return xTaskCreatePinnedToCore(task_func, name, stack_depth, params,
-                                       priority, task_handle, core_id);
+        if (core_id == UL_TASK_CORE_AUTO) {
+            core_id = pick_core();
+        }
+        res = xTaskCreatePinnedToCore(task_func, name, stack_depth, params,
+                                      priority, &handle, core_id);
+    } else {
+        core_id = 0;
+        res = xTaskCreate(task_func, name, stack_depth, params,
+                          priority, &handle);
+    }
+    if (res == pdPASS) {
+        registry_add(handle, name, stack_depth, core_id, priority);
+    }
+    if (task_handle) {
+        *task_handle = handle;
     }
-    return xTaskCreate(task_func, name, stack_depth, params,
-                       priority, task_handle);
+    return res;
+}
+
+void ul_task_forget(TaskHandle_t handle) {
+    if (!handle) {
+        handle = xTaskGetCurrentTaskHandle();
+    }
+    portENTER_CRITICAL(&s_registry_lock);
+    for (size_t i = 0; i < s_registry_count; ++i) {
+        if (s_registry[i].handle == handle) {
+            BaseType_t core = s_registry[i].core_id;
+            if (core == 0 || core == 1) {
+                s_core_weight[core] -= (uint32_t)s_registry[i].priority + 1;
+            }
+            s_registry[i] = s_registry[--s_registry_count];
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_registry_lock);
+}
+
+size_t ul_task_sample_stacks(ul_task_stack_info_t *out, size_t max_entries) {
+    if (!out || max_entries == 0) {
+        return 0;
+    }
+    size_t count = 0;
+    portENTER_CRITICAL(&s_registry_lock);
+    for (size_t i = 0; i < s_registry_count && count < max_entries; ++i) {
+        ul_task_entry_t *entry = &s_registry[i];
+        strlcpy(out[count].name, entry->name, sizeof(out[count].name));
+        out[count].stack_depth = entry->stack_depth;
+        // Safe under the lock: every delete site calls ul_task_forget()
+        // first, and forget takes this lock, so a registered handle cannot
+        // vanish mid-scan.
+        out[count].stack_hwm_bytes =
+            (uint32_t)uxTaskGetStackHighWaterMark(entry->handle);
+        count++;
+    }
+    portEXIT_CRITICAL(&s_registry_lock);
+    return count;
+}
+
+uint32_t ul_task_created_total(void) {
+    portENTER_CRITICAL(&s_registry_lock);
+    uint32_t total = s_created_total;
+    portEXIT_CRITICAL(&s_registry_lock);
+    return total;
 }
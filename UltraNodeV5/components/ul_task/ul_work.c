@@ -0,0 +1,161 @@
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "ul_task.h"
+#include "ul_work.h"
+
+static const char *TAG = "ul_work";
+
+#define UL_WORK_MAX_JOBS 12
+#define UL_WORK_TASK_STACK 3072
+#define UL_WORK_TASK_PRIORITY 5
+
+static ul_work_job_t *s_jobs[UL_WORK_MAX_JOBS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_task;
+static uint32_t s_executed_total; // written only by the executor task
+
+static void work_task(void *arg) {
+    (void)arg;
+    while (1) {
+        uint64_t now = (uint64_t)esp_timer_get_time();
+        ul_work_job_t *run = NULL;
+        uint64_t next_due = UINT64_MAX;
+
+        portENTER_CRITICAL(&s_lock);
+        for (int i = 0; i < UL_WORK_MAX_JOBS; ++i) {
+            ul_work_job_t *job = s_jobs[i];
+            if (!job || job->due_us == 0)
+                continue;
+            if (job->due_us <= now) {
+                if (!run || job->priority > run->priority ||
+                    (job->priority == run->priority &&
+                     job->due_us < run->due_us)) {
+                    run = job;
+                }
+            } else if (job->due_us < next_due) {
+                next_due = job->due_us;
+            }
+        }
+        if (run) {
+            // Re-arm or disarm before dropping the lock so a cancel or
+            // reschedule from the callback itself behaves naturally.
+            run->due_us = run->period_ms
+                              ? now + (uint64_t)run->period_ms * 1000ULL
+                              : 0;
+        }
+        portEXIT_CRITICAL(&s_lock);
+
+        if (run) {
+            run->fn(run->arg);
+            s_executed_total++;
+            continue; // another job may already be due
+        }
+
+        TickType_t wait = portMAX_DELAY;
+        if (next_due != UINT64_MAX) {
+            now = (uint64_t)esp_timer_get_time();
+            if (next_due <= now)
+                continue;
+            wait = pdMS_TO_TICKS((next_due - now + 999ULL) / 1000ULL);
+            if (wait == 0)
+                wait = 1;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+esp_err_t ul_work_start(void) {
+    if (s_task)
+        return ESP_OK;
+    if (ul_task_create(work_task, "ul_work", UL_WORK_TASK_STACK, NULL,
+                       UL_WORK_TASK_PRIORITY, &s_task,
+                       UL_TASK_CORE_AUTO) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start work executor task");
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void ul_work_job_init(ul_work_job_t *job, ul_work_fn_t fn, void *arg,
+                      uint8_t priority) {
+    memset(job, 0, sizeof(*job));
+    job->fn = fn;
+    job->arg = arg;
+    job->priority = priority;
+}
+
+static esp_err_t work_arm(ul_work_job_t *job, uint32_t delay_ms,
+                          uint32_t period_ms) {
+    if (!job || !job->fn)
+        return ESP_ERR_INVALID_ARG;
+    if (!s_task)
+        return ESP_ERR_INVALID_STATE;
+
+    esp_err_t err = ESP_OK;
+    portENTER_CRITICAL(&s_lock);
+    if (!job->registered) {
+        int slot = -1;
+        for (int i = 0; i < UL_WORK_MAX_JOBS; ++i) {
+            if (!s_jobs[i]) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            err = ESP_ERR_NO_MEM;
+        } else {
+            s_jobs[slot] = job;
+            job->registered = true;
+        }
+    }
+    if (err == ESP_OK) {
+        job->period_ms = period_ms;
+        job->due_us = (uint64_t)esp_timer_get_time() +
+                      (uint64_t)delay_ms * 1000ULL;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (err == ESP_OK)
+        xTaskNotifyGive(s_task);
+    else
+        ESP_LOGE(TAG, "Job table full; raise UL_WORK_MAX_JOBS");
+    return err;
+}
+
+esp_err_t ul_work_schedule(ul_work_job_t *job, uint32_t delay_ms) {
+    return work_arm(job, delay_ms, 0);
+}
+
+esp_err_t ul_work_schedule_periodic(ul_work_job_t *job, uint32_t period_ms) {
+    if (period_ms == 0)
+        return ESP_ERR_INVALID_ARG;
+    return work_arm(job, period_ms, period_ms);
+}
+
+void ul_work_cancel(ul_work_job_t *job) {
+    if (!job)
+        return;
+    portENTER_CRITICAL(&s_lock);
+    job->due_us = 0;
+    job->period_ms = 0;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void ul_work_get_stats(uint32_t *pending, uint32_t *executed_total) {
+    uint32_t armed = 0;
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < UL_WORK_MAX_JOBS; ++i) {
+        if (s_jobs[i] && s_jobs[i]->due_us != 0)
+            armed++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    if (pending)
+        *pending = armed;
+    if (executed_total)
+        *executed_total = s_executed_total;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cJSON cJSON;
+
+// Keyframe timeline playback. One timeline/set message carries a batch of
+// keyframes the node stores and plays back locally, so a choreographed
+// sequence costs one MQTT message instead of one per step:
+//
+//   {"loop": false,
+//    "keyframes": [
+//      {"t_ms": 0,    "ws": [{"strip": 0, "effect": "solid", ...}]},
+//      {"t_ms": 4000, "white": [{"channel": 0, "brightness": 40}]},
+//      ...]}
+//
+// Each keyframe holds per-engine arrays in the exact scene/set entry schema
+// and fires at t_ms after the message arrived. Brightness between consecutive
+// keyframes for the same strip/channel is glided through the engines' ramp
+// primitives, so fades advance at the render frame rate rather than at the
+// keyframe rate.
+
+// Parse and apply a timeline/set payload. Replaces any running timeline; an
+// empty "keyframes" array just stops playback. Returns true when playback
+// (re)started or was stopped by an empty array.
+bool ul_timeline_apply_json(cJSON* root);
+
+// Stop playback and drop the stored keyframes. Direct ws/rgb/white set
+// commands call this so manual control always wins over a running timeline.
+void ul_timeline_stop(void);
+
+// True while keyframes remain scheduled (always true for a looping timeline).
+bool ul_timeline_active(void);
+
+#ifdef __cplusplus
+}
+#endif
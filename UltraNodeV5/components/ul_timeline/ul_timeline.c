@@ -0,0 +1,220 @@
+#include "ul_timeline.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "ul_sched.h"
+#include "ul_ws_engine.h"
+#include "ul_rgb_engine.h"
+#include "ul_white_engine.h"
+
+// Keyframes are applied from the shared animation scheduler, the same task
+// the RGB and white engines step on, so firing a keyframe and the engine
+// reacting to it never race. The step callback reports the next keyframe's
+// deadline as its sleep and portMAX_DELAY once playback is done, so an idle
+// timeline costs nothing.
+
+// Bounds the cJSON copies a single timeline/set can pin in heap; a sunrise
+// at one keyframe per minute still fits a half hour.
+#define UL_TIMELINE_MAX_KEYFRAMES 32
+
+static const char* TAG = "ul_timeline";
+
+typedef struct {
+    uint32_t t_ms;   // offset from timeline start
+    cJSON* actions;  // scene-shaped entry: {"ws":[...],"rgb":[...],"white":[...]}
+} tl_keyframe_t;
+
+static tl_keyframe_t s_kf[UL_TIMELINE_MAX_KEYFRAMES];
+static int s_kf_count = 0;
+static int s_next = 0;               // next keyframe to fire
+static bool s_loop = false;
+static TickType_t s_start_tick = 0;  // t_ms offsets count from here
+static bool s_registered = false;    // sched slot stays claimed once taken
+static SemaphoreHandle_t s_lock = NULL;  // MQTT task vs. scheduler task
+
+static void free_keyframes(void) {
+    for (int i = 0; i < s_kf_count; ++i) {
+        cJSON_Delete(s_kf[i].actions);
+        s_kf[i].actions = NULL;
+    }
+    s_kf_count = 0;
+    s_next = 0;
+}
+
+static int entry_index(cJSON* entry, const char* index_field) {
+    cJSON* jidx = cJSON_GetObjectItem(entry, index_field);
+    return (jidx && cJSON_IsNumber(jidx)) ? jidx->valueint : 0;
+}
+
+// Find the next keyframe after `from_k` that sets a brightness on the same
+// strip/channel, so the gap can be bridged with a ramp. A later keyframe
+// that re-targets the index without a brightness ends the search: its other
+// fields take over and a glide past it would be wrong.
+static bool next_brightness(int from_k, const char* engine,
+                            const char* index_field, int index,
+                            uint8_t* bri, int* gap_ms) {
+    for (int k = from_k + 1; k < s_kf_count; ++k) {
+        cJSON* sec = cJSON_GetObjectItem(s_kf[k].actions, engine);
+        if (!cJSON_IsArray(sec)) continue;
+        cJSON* entry;
+        cJSON_ArrayForEach(entry, sec) {
+            if (!cJSON_IsObject(entry)) continue;
+            if (entry_index(entry, index_field) != index) continue;
+            cJSON* jb = cJSON_GetObjectItem(entry, "brightness");
+            if (!jb || !cJSON_IsNumber(jb)) return false;
+            int b = jb->valueint;
+            if (b < 0) b = 0;
+            if (b > 255) b = 255;
+            *bri = (uint8_t)b;
+            *gap_ms = (int)(s_kf[k].t_ms - s_kf[from_k].t_ms);
+            return *gap_ms > 0;
+        }
+    }
+    return false;
+}
+
+// The three engines' ramp setters differ in return type; uniform wrappers
+// let apply_section() take one via function pointer.
+static void ws_ramp(int idx, uint8_t bri, int ms) {
+    ul_ws_set_brightness_ramp(idx, bri, ms);
+}
+static void rgb_ramp(int idx, uint8_t bri, int ms) {
+    (void)ul_rgb_set_brightness_ramp(idx, bri, ms);
+}
+static void white_ramp(int idx, uint8_t bri, int ms) {
+    (void)ul_white_set_brightness_ramp(idx, bri, ms);
+}
+
+// Apply one engine section of keyframe `k` through the engine's normal JSON
+// applier, then start the glide toward the next keyframe's brightness for
+// each target. apply_json snaps brightness first (cancelling any old ramp),
+// so the glide always departs from the keyframe's own value.
+static void apply_section(int k, const char* engine, const char* index_field,
+                          void (*apply)(cJSON*),
+                          void (*ramp)(int, uint8_t, int)) {
+    cJSON* sec = cJSON_GetObjectItem(s_kf[k].actions, engine);
+    if (!cJSON_IsArray(sec)) return;
+    cJSON* entry;
+    cJSON_ArrayForEach(entry, sec) {
+        if (!cJSON_IsObject(entry)) continue;
+        apply(entry);
+        uint8_t bri;
+        int gap_ms;
+        int idx = entry_index(entry, index_field);
+        if (next_brightness(k, engine, index_field, idx, &bri, &gap_ms)) {
+            ramp(idx, bri, gap_ms);
+        }
+    }
+}
+
+static void apply_keyframe(int k) {
+    apply_section(k, "ws", "strip", ul_ws_apply_json, ws_ramp);
+    apply_section(k, "rgb", "strip", ul_rgb_apply_json, rgb_ramp);
+    apply_section(k, "white", "channel", ul_white_apply_json, white_ramp);
+}
+
+static TickType_t timeline_step(void* ctx) {
+    (void)ctx;
+    TickType_t wait = portMAX_DELAY;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    while (s_next < s_kf_count) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t due = s_start_tick + pdMS_TO_TICKS(s_kf[s_next].t_ms);
+        if ((int32_t)(due - now) > 0) {
+            wait = due - now;
+            break;
+        }
+        apply_keyframe(s_next);
+        ++s_next;
+        if (s_next >= s_kf_count && s_loop) {
+            TickType_t span = pdMS_TO_TICKS(s_kf[s_kf_count - 1].t_ms);
+            if (span == 0) {
+                // A zero-length loop would spin the scheduler; play it once.
+                ESP_LOGW(TAG, "Ignoring loop on zero-length timeline");
+                break;
+            }
+            s_start_tick += span;
+            s_next = 0;
+        }
+    }
+    if (s_next >= s_kf_count) {
+        free_keyframes();  // playback finished; release the heap now
+    }
+    xSemaphoreGive(s_lock);
+    return wait;
+}
+
+bool ul_timeline_apply_json(cJSON* root) {
+    if (!root) return false;
+    cJSON* jkf = cJSON_GetObjectItem(root, "keyframes");
+    if (!cJSON_IsArray(jkf)) return false;
+
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+        if (!s_lock) return false;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    free_keyframes();
+    s_loop = cJSON_IsTrue(cJSON_GetObjectItem(root, "loop"));
+
+    uint32_t prev_t = 0;
+    cJSON* jentry;
+    cJSON_ArrayForEach(jentry, jkf) {
+        if (!cJSON_IsObject(jentry)) continue;
+        cJSON* jt = cJSON_GetObjectItem(jentry, "t_ms");
+        if (!jt || !cJSON_IsNumber(jt) || jt->valuedouble < 0) continue;
+        uint32_t t = (uint32_t)jt->valuedouble;
+        if (s_kf_count > 0 && t < prev_t) {
+            ESP_LOGW(TAG, "Dropping out-of-order keyframe at t_ms=%u",
+                     (unsigned)t);
+            continue;
+        }
+        if (s_kf_count >= UL_TIMELINE_MAX_KEYFRAMES) {
+            ESP_LOGW(TAG, "Keyframe limit (%d) reached; dropping the rest",
+                     UL_TIMELINE_MAX_KEYFRAMES);
+            break;
+        }
+        cJSON* dup = cJSON_Duplicate(jentry, true);
+        if (!dup) {
+            ESP_LOGE(TAG, "Out of memory storing keyframes");
+            break;
+        }
+        s_kf[s_kf_count].t_ms = t;
+        s_kf[s_kf_count].actions = dup;
+        ++s_kf_count;
+        prev_t = t;
+    }
+
+    s_start_tick = xTaskGetTickCount();
+    bool playing = (s_kf_count > 0);
+    xSemaphoreGive(s_lock);
+
+    if (playing && !s_registered) {
+        s_registered = ul_sched_register(timeline_step, NULL, "timeline");
+        if (!s_registered) return false;
+    }
+    // Fire a t_ms=0 keyframe now, or re-plan the sleep after a stop.
+    ul_sched_kick();
+    return true;
+}
+
+void ul_timeline_stop(void) {
+    if (!s_lock) return;  // nothing was ever scheduled
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool was_playing = (s_kf_count > 0);
+    free_keyframes();
+    xSemaphoreGive(s_lock);
+    if (was_playing) ul_sched_kick();
+}
+
+bool ul_timeline_active(void) {
+    if (!s_lock) return false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool active = (s_next < s_kf_count);
+    xSemaphoreGive(s_lock);
+    return active;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Snapshot of the dedicated mbedtls pool. All zeros when the pool is
+// disabled or failed to initialize (in which case every TLS allocation
+// counts as a fallback).
+typedef struct {
+  uint32_t pool_size;     // configured pool size in bytes
+  uint32_t free_bytes;    // currently free in the pool
+  uint32_t min_free_bytes; // low-water mark since boot; sizing headroom
+  uint32_t largest_free_block;
+  uint32_t fallbacks;     // allocations that overflowed to the shared heap
+} ul_tls_pool_stats_t;
+
+// Point mbedtls at the dedicated static pool via its platform allocator
+// hooks. Must run before the first TLS use (MQTT connect, OTA check).
+// TLS record buffers burst ~16 KB on every reconnect; serving them from
+// their own pool keeps that churn from fragmenting the shared heap the
+// render pipeline allocates frame buffers from. Allocations that do not
+// fit fall back to the shared heap and are counted, so an undersized pool
+// degrades to the old behavior instead of breaking TLS.
+esp_err_t ul_tls_pool_init(void);
+
+// Copy the current pool figures (safe before init; reports zeros).
+void ul_tls_pool_get_stats(ul_tls_pool_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
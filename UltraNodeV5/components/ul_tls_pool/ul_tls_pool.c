@@ -0,0 +1,104 @@
+#include "ul_tls_pool.h"
+
+#include "sdkconfig.h"
+
+#if CONFIG_UL_TLS_POOL
+
+#if !defined(CONFIG_MBEDTLS_CUSTOM_MEM_ALLOC)
+#error "UL_TLS_POOL requires MBEDTLS_MEM_ALLOC_MODE set to custom (CONFIG_MBEDTLS_CUSTOM_MEM_ALLOC)"
+#endif
+
+#include "esp_log.h"
+#include "mbedtls/platform.h"
+#include "multi_heap.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ul_tls_pool";
+
+// Static DRAM rather than a boot-time heap allocation: the whole point is
+// that TLS never competes with the render pipeline for the shared heap, so
+// the pool must not itself become a heap block that moves the problem
+// around. multi_heap gives us the allocator (with its own per-heap lock)
+// and free/largest/low-water accounting for free.
+static uint8_t s_pool[CONFIG_UL_TLS_POOL_SIZE] __attribute__((aligned(4)));
+static multi_heap_handle_t s_heap;
+static atomic_uint_fast32_t s_fallbacks;
+
+static bool ptr_in_pool(const void *ptr) {
+  const uint8_t *p = ptr;
+  return p >= s_pool && p < s_pool + sizeof(s_pool);
+}
+
+static void *tls_pool_calloc(size_t n, size_t size) {
+  size_t bytes;
+  if (__builtin_mul_overflow(n, size, &bytes))
+    return NULL;
+  if (s_heap) {
+    void *ptr = multi_heap_malloc(s_heap, bytes);
+    if (ptr) {
+      memset(ptr, 0, bytes);
+      return ptr;
+    }
+  }
+  // Pool exhausted (or never came up): serve from the shared heap and
+  // count it so undersizing shows up in the metrics instead of as a
+  // handshake failure.
+  atomic_fetch_add_explicit(&s_fallbacks, 1, memory_order_relaxed);
+  return calloc(n, size);
+}
+
+static void tls_pool_free(void *ptr) {
+  if (!ptr)
+    return;
+  if (ptr_in_pool(ptr))
+    multi_heap_free(s_heap, ptr);
+  else
+    free(ptr); // fallback allocation, or predates the hook install
+}
+
+esp_err_t ul_tls_pool_init(void) {
+  if (s_heap)
+    return ESP_OK;
+  s_heap = multi_heap_register(s_pool, sizeof(s_pool));
+  if (!s_heap) {
+    ESP_LOGE(TAG, "Failed to register %u byte TLS pool; using shared heap",
+             (unsigned)sizeof(s_pool));
+    return ESP_ERR_NO_MEM;
+  }
+  mbedtls_platform_set_calloc_free(tls_pool_calloc, tls_pool_free);
+  ESP_LOGI(TAG, "mbedtls pool ready (%u bytes)", (unsigned)sizeof(s_pool));
+  return ESP_OK;
+}
+
+void ul_tls_pool_get_stats(ul_tls_pool_stats_t *out) {
+  if (!out)
+    return;
+  memset(out, 0, sizeof(*out));
+  out->fallbacks =
+      (uint32_t)atomic_load_explicit(&s_fallbacks, memory_order_relaxed);
+  if (!s_heap)
+    return;
+  multi_heap_info_t info;
+  multi_heap_get_info(s_heap, &info);
+  out->pool_size = sizeof(s_pool);
+  out->free_bytes = info.total_free_bytes;
+  out->min_free_bytes = info.minimum_free_bytes;
+  out->largest_free_block = info.largest_free_block;
+}
+
+#else // !CONFIG_UL_TLS_POOL
+
+#include <string.h>
+
+esp_err_t ul_tls_pool_init(void) { return ESP_OK; }
+
+void ul_tls_pool_get_stats(ul_tls_pool_stats_t *out) {
+  if (out)
+    memset(out, 0, sizeof(*out));
+}
+
+#endif // CONFIG_UL_TLS_POOL
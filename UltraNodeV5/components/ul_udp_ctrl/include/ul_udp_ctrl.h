@@ -0,0 +1,14 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Start the LAN UDP control listener. No-op unless CONFIG_UL_UDP_CTRL is
+// enabled and CONFIG_UL_UDP_CTRL_KEY is non-empty. Call once after the
+// network is up; commands land in the MQTT dispatch queue.
+void ul_udp_ctrl_start(void);
+
+#ifdef __cplusplus
+}
+#endif
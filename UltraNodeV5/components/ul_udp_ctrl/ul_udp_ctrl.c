@@ -0,0 +1,137 @@
+#include "ul_udp_ctrl.h"
+
+#include "sdkconfig.h"
+
+#if CONFIG_UL_UDP_CTRL
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "mbedtls/md.h"
+#include "ul_mqtt.h"
+#include "ul_task.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Broker-independent control path: authenticated UDP datagrams carrying a
+// command topic suffix plus payload, injected into the MQTT dispatch queue
+// via ul_mqtt_submit_local() so they share routing, coalescing and
+// serialization with broker commands.
+//
+// Datagram layout:
+//   [0]           magic 0x55
+//   [1]           version (1)
+//   [2]           flags (reserved, must be 0)
+//   [3]           path length P
+//   [4..11]       sequence number, le64
+//   [12..12+P)    command path, e.g. "ws/set"
+//   [12+P..L-8)   payload (JSON, or a binary body for the *b commands)
+//   [L-8..L)      HMAC-SHA256 over bytes [0..L-8), truncated to 8 bytes,
+//                 keyed by CONFIG_UL_UDP_CTRL_KEY
+//
+// Replay protection is a strictly-greater sequence check kept in RAM only;
+// senders stamp packets with a wall-clock value (e.g. microseconds since the
+// epoch) so a node reboot never locks a well-behaved sender out.
+
+#define UL_UDP_CTRL_MAGIC 0x55
+#define UL_UDP_CTRL_VERSION 1
+#define UL_UDP_CTRL_HDR_LEN 12
+#define UL_UDP_CTRL_TAG_LEN 8
+#define UL_UDP_CTRL_MAX_DGRAM 1024
+#define UL_UDP_CTRL_MAX_PATH 64
+
+static const char* TAG = "ul_udp_ctrl";
+
+static uint64_t s_last_seq = 0;
+
+static bool tag_valid(const uint8_t* buf, int body_len, const uint8_t* tag) {
+    const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    uint8_t mac[32];
+    if (!md ||
+        mbedtls_md_hmac(md, (const unsigned char*)CONFIG_UL_UDP_CTRL_KEY,
+                        strlen(CONFIG_UL_UDP_CTRL_KEY), buf, (size_t)body_len,
+                        mac) != 0) {
+        return false;
+    }
+    // Constant-time compare so the tag can't be guessed a byte at a time.
+    uint8_t diff = 0;
+    for (int i = 0; i < UL_UDP_CTRL_TAG_LEN; ++i)
+        diff |= mac[i] ^ tag[i];
+    return diff == 0;
+}
+
+static void udp_ctrl_task(void* arg) {
+    int sock = (int)(intptr_t)arg;
+    static uint8_t buf[UL_UDP_CTRL_MAX_DGRAM];
+    char path[UL_UDP_CTRL_MAX_PATH + 1];
+
+    for (;;) {
+        int len = recv(sock, buf, sizeof(buf), 0);
+        if (len < UL_UDP_CTRL_HDR_LEN + UL_UDP_CTRL_TAG_LEN ||
+            len >= (int)sizeof(buf))  // oversized datagrams were truncated
+            continue;
+        if (buf[0] != UL_UDP_CTRL_MAGIC || buf[1] != UL_UDP_CTRL_VERSION ||
+            buf[2] != 0)
+            continue;
+        int path_len = buf[3];
+        int body_len = len - UL_UDP_CTRL_TAG_LEN;
+        if (path_len == 0 || path_len > UL_UDP_CTRL_MAX_PATH ||
+            UL_UDP_CTRL_HDR_LEN + path_len > body_len)
+            continue;
+        // Authenticate before touching the sequence state so a forged packet
+        // can't wind the window forward and lock real senders out.
+        if (!tag_valid(buf, body_len, buf + body_len))
+            continue;
+        uint64_t seq = 0;
+        for (int i = 0; i < 8; ++i)
+            seq |= (uint64_t)buf[4 + i] << (8 * i);
+        if (seq <= s_last_seq)
+            continue;  // replayed or reordered; newer state already applied
+        s_last_seq = seq;
+
+        memcpy(path, buf + UL_UDP_CTRL_HDR_LEN, path_len);
+        path[path_len] = '\0';
+        ul_mqtt_submit_local(path,
+                             (const char*)buf + UL_UDP_CTRL_HDR_LEN + path_len,
+                             body_len - UL_UDP_CTRL_HDR_LEN - path_len);
+    }
+}
+
+void ul_udp_ctrl_start(void) {
+    if (CONFIG_UL_UDP_CTRL_KEY[0] == '\0') {
+        ESP_LOGW(TAG, "No shared key configured; UDP control stays off");
+        return;
+    }
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "socket() failed: errno %d", errno);
+        return;
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_UL_UDP_CTRL_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        ESP_LOGE(TAG, "bind(%d) failed: errno %d", CONFIG_UL_UDP_CTRL_PORT,
+                 errno);
+        close(sock);
+        return;
+    }
+    // Same priority as the MQTT command dispatcher: this task only validates
+    // and enqueues, the dispatcher does the actual work.
+    if (ul_task_create(udp_ctrl_task, "udp_ctrl", 4096,
+                       (void*)(intptr_t)sock, 4, NULL, 0) != pdPASS) {
+        close(sock);
+        return;
+    }
+    ESP_LOGI(TAG, "Listening on UDP port %d", CONFIG_UL_UDP_CTRL_PORT);
+}
+
+#else  // !CONFIG_UL_UDP_CTRL
+
+void ul_udp_ctrl_start(void) {}
+
+#endif
@@ -18,7 +18,7 @@ static int period_frames(void) {
     return frames;
 }
 
-uint8_t white_breathe_render(int frame_idx) {
+static uint8_t breathe_value(int frame_idx) {
     int frames = period_frames();
     float t = (frame_idx % frames) / (float)frames;
     float v = 0.5f * (1.0f - cosf(2.0f * 3.1415926f * t));
@@ -27,6 +27,50 @@ uint8_t white_breathe_render(int frame_idx) {
     return (uint8_t)(v * 255.0f + 0.5f);
 }
 
+uint8_t white_breathe_render(int ch, int frame_idx) {
+    (void)ch;
+    return breathe_value(frame_idx);
+}
+
+// Each half of the cosine is a monotonic ramp, so carve the cycle into a few
+// linear segments the LEDC fade hardware runs on its own; the task wakes at
+// segment boundaries instead of every smooth-rate tick. Eight segments track
+// the curve closely enough that the ease-in/ease-out still reads as a breath.
+#define WHITE_BREATHE_FADE_SEGMENTS 8
+
+bool white_breathe_plan_fade(int ch, int frame_idx, white_fade_segment_t* seg) {
+    (void)ch;
+    if (!seg) return false;
+    int frames = period_frames();
+    int seg_frames = frames / WHITE_BREATHE_FADE_SEGMENTS;
+    if (seg_frames < 1) {
+        return false;  // period too short for segments; step in software
+    }
+    int pos = frame_idx % frames;
+    int boundary = ((pos / seg_frames) + 1) * seg_frames;
+    if (boundary > frames) boundary = frames;
+    seg->target = breathe_value(frame_idx + (boundary - pos));
+    seg->duration_ms = (uint32_t)(((int64_t)(boundary - pos) * 1000) /
+                                  CONFIG_UL_WHITE_SMOOTH_HZ);
+    if (seg->duration_ms == 0) {
+        return false;  // boundary lands inside one tick; step in software
+    }
+    return true;
+}
+
+int64_t white_breathe_next_change_us(int frame_idx) {
+    // The cosine is flat near its peaks, so walk frames forward until the
+    // rendered value actually moves; one full period bounds the scan.
+    int frames = period_frames();
+    uint8_t cur = breathe_value(frame_idx);
+    for (int k = 1; k <= frames; ++k) {
+        if (breathe_value(frame_idx + k) != cur) {
+            return ((int64_t)k * 1000000LL) / CONFIG_UL_WHITE_SMOOTH_HZ;
+        }
+    }
+    return -1;  // degenerate period renders a constant value
+}
+
 void white_breathe_apply_params(int ch, const cJSON* params) {
     (void)ch;
     if (!params || !cJSON_IsArray(params)) return;
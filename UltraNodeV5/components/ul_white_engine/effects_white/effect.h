@@ -1,15 +1,34 @@
 #pragma once
+#include <stdbool.h>
 #include <stdint.h>
 typedef struct cJSON cJSON;
 
+// One linear ramp the LEDC fade engine can run in hardware: reach target
+// after duration_ms. duration_ms == 0 means "jump to target and hold until
+// something changes".
+typedef struct {
+    uint8_t target;
+    uint32_t duration_ms;
+} white_fade_segment_t;
+
 typedef struct {
     const char* name;
     void (*init)(void);
-    // Render a brightness value (0..255) for the given frame index
-    uint8_t (*render)(int frame_idx);
+    // Render a brightness value (0..255) for the given channel and frame
+    // index. Effects with per-channel state index it with ch directly.
+    uint8_t (*render)(int ch, int frame_idx);
     // Optional parameter hook
     void (*apply_params)(int ch, const cJSON* params);
+    // Optional. Describe the effect's output from frame_idx onward as a fade
+    // segment. When this returns true the engine programs the ramp into the
+    // LEDC fade hardware and sleeps until the segment boundary instead of
+    // stepping render() every tick. Return false (or leave NULL) to be
+    // stepped in software.
+    bool (*plan_fade)(int ch, int frame_idx, white_fade_segment_t* seg);
+    // Optional: microseconds from frame_idx until the rendered value next
+    // moves by at least one step. Return -1 when the output is static so the
+    // engine can stop waking for this channel.
+    int64_t (*next_change_us)(int frame_idx);
 } white_effect_t;
 
 const white_effect_t* ul_white_get_effects(int* count);
-int ul_white_effect_current_channel(void);
@@ -5,19 +5,24 @@
 #if CONFIG_UL_WHT0_ENABLED || CONFIG_UL_WHT1_ENABLED || CONFIG_UL_WHT2_ENABLED || CONFIG_UL_WHT3_ENABLED
 
 void white_breathe_init(void);
-uint8_t white_breathe_render(int frame_idx);
+uint8_t white_breathe_render(int ch, int frame_idx);
 void white_breathe_apply_params(int ch, const cJSON* params);
+bool white_breathe_plan_fade(int ch, int frame_idx, white_fade_segment_t* seg);
+int64_t white_breathe_next_change_us(int frame_idx);
 
 void white_solid_init(void);
-uint8_t white_solid_render(int frame_idx);
+uint8_t white_solid_render(int ch, int frame_idx);
+int64_t white_solid_next_change_us(int frame_idx);
 
 void white_swell_init(void);
-uint8_t white_swell_render(int frame_idx);
+uint8_t white_swell_render(int ch, int frame_idx);
+bool white_swell_plan_fade(int ch, int frame_idx, white_fade_segment_t* seg);
+int64_t white_swell_next_change_us(int frame_idx);
 
 static const white_effect_t effects[] = {
-    {"solid", white_solid_init, white_solid_render, NULL},
-    {"breathe", white_breathe_init, white_breathe_render, white_breathe_apply_params},
-    {"swell", white_swell_init, white_swell_render, NULL},
+    {"solid", white_solid_init, white_solid_render, NULL, NULL, white_solid_next_change_us},
+    {"breathe", white_breathe_init, white_breathe_render, white_breathe_apply_params, white_breathe_plan_fade, white_breathe_next_change_us},
+    {"swell", white_swell_init, white_swell_render, NULL, white_swell_plan_fade, white_swell_next_change_us},
 };
 
 const white_effect_t* ul_white_get_effects(int* count) {
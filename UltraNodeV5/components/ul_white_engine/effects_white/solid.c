@@ -8,10 +8,16 @@ void white_solid_init(void) {
     // no initialization needed
 }
 
-uint8_t white_solid_render(int frame_idx) {
+uint8_t white_solid_render(int ch, int frame_idx) {
+    (void)ch;
     (void)frame_idx;
     return 255;
 }
 
+int64_t white_solid_next_change_us(int frame_idx) {
+    (void)frame_idx;
+    return -1;  // constant output, never needs another frame
+}
+
 #endif
 
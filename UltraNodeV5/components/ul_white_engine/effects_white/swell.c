@@ -32,9 +32,48 @@ void white_swell_init(void) {
     // No per-channel state is required; the frame index drives the swell.
 }
 
-uint8_t white_swell_render(int frame_idx) {
+uint8_t white_swell_render(int ch, int frame_idx) {
+    (void)ch;
     return compute_brightness_for_frame(frame_idx);
 }
 
+// The whole swell is one linear ramp from black to full over 255 steps, then
+// a hold -- exactly what the LEDC fade hardware runs on its own. Report the
+// remainder of the ramp (or the hold) as a single segment so the engine never
+// has to step us in software.
+bool white_swell_plan_fade(int ch, int frame_idx, white_fade_segment_t* seg) {
+    (void)ch;
+    if (!seg) return false;
+    seg->target = 255;
+
+    int refresh_hz = CONFIG_UL_WHITE_SMOOTH_HZ;
+    if (refresh_hz <= 0) {
+        seg->duration_ms = 0;
+        return true;
+    }
+    int64_t elapsed_us = frame_idx > 0
+        ? ((int64_t)frame_idx * 1000000LL) / refresh_hz : 0;
+    int64_t total_us = 255LL * WHITE_SWELL_STEP_INTERVAL_US;
+    seg->duration_ms = elapsed_us >= total_us
+        ? 0 : (uint32_t)((total_us - elapsed_us) / 1000);
+    return true;
+}
+
+int64_t white_swell_next_change_us(int frame_idx) {
+    int refresh_hz = CONFIG_UL_WHITE_SMOOTH_HZ;
+    if (refresh_hz <= 0) {
+        return -1;
+    }
+    int64_t elapsed_us = 0;
+    if (frame_idx > 0) {
+        elapsed_us = ((int64_t)frame_idx * 1000000LL) / refresh_hz;
+    }
+    int64_t steps = elapsed_us / WHITE_SWELL_STEP_INTERVAL_US;
+    if (steps >= 255) {
+        return -1;  // ramp finished; output holds at full
+    }
+    return (steps + 1) * WHITE_SWELL_STEP_INTERVAL_US - elapsed_us;
+}
+
 #endif
 
@@ -12,7 +12,8 @@ void ul_white_apply_json(cJSON* root);
 
 // Channels 0..3 (enabled by Kconfig flags). Returns false if channel not enabled.
 bool ul_white_set_effect(int ch, const char* name);
-bool ul_white_set_brightness(int ch, uint8_t bri);
+bool ul_white_set_brightness(int ch, uint8_t bri); // cancels a running ramp
+bool ul_white_set_brightness_ramp(int ch, uint8_t target, int duration_ms);
 
 // Status API
 typedef struct {
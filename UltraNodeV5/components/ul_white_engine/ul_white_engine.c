@@ -6,8 +6,6 @@
 #include <stdbool.h>
 #include <string.h>
 
-int ul_white_effect_current_channel(void) { return -1; }
-
 bool ul_white_engine_start(void) { return true; }
 
 void ul_white_engine_stop(void) {}
@@ -26,6 +24,13 @@ bool ul_white_set_brightness(int ch, uint8_t bri) {
     return false;
 }
 
+bool ul_white_set_brightness_ramp(int ch, uint8_t target, int duration_ms) {
+    (void)ch;
+    (void)target;
+    (void)duration_ms;
+    return false;
+}
+
 int ul_white_get_channel_count(void) { return 0; }
 
 bool ul_white_get_status(int ch, ul_white_ch_status_t* out) {
@@ -40,13 +45,16 @@ bool ul_white_get_status(int ch, ul_white_ch_status_t* out) {
 #include "freertos/task.h"
 #include "driver/ledc.h"
 #include "driver/gpio.h"
-#include "ul_task.h"
+#include "ul_sched.h"
 #include "ul_health.h"
 #include "esp_timer.h"
 #include "esp_log.h"
 #include "string.h"
 #include "effects_white/effect.h"
+#include "ul_common_effects.h"
+#include "ul_state.h"
 #include "cJSON.h"
+#include <stdlib.h>
 
 #if CONFIG_UL_IS_ESP32C3
 #define UL_LEDC_SPEED_MODE LEDC_LOW_SPEED_MODE
@@ -66,12 +74,31 @@ typedef struct {
     uint8_t brightness;
     const white_effect_t* eff;
     int frame_idx;
+    uint8_t dither_err;  // fractional duty carried between frames
+    bool fade_active;    // LEDC hardware fade running towards fade_end_tick
+    bool hold;           // output latched; no wakeups until state changes
+    TickType_t fade_end_tick;
+    // Brightness ramp: while active, brightness is re-derived from wall
+    // time each pass and the channel renders at the smooth rate (no hold)
+    // until the target lands.
+    bool bri_ramp_active;
+    uint8_t bri_ramp_from;
+    uint8_t bri_ramp_target;
+    int64_t bri_ramp_start_us;
+    int bri_ramp_duration_ms;
 } white_ch_t;
 
 static white_ch_t s_ch[4];
 static int s_count = 0;
-static TaskHandle_t s_white_task = NULL;
-static int s_current_ch_idx = -1;
+static bool s_white_registered = false;
+static bool s_fade_installed = false;
+
+// Drop any fade segment or hold so the next scheduler pass re-plans from
+// current state.
+static void invalidate_fade(white_ch_t* c) {
+    c->fade_active = false;
+    c->hold = false;
+}
 
 static void pull_channel_low(const white_ch_t* ch) {
     if (!ch || !ch->enabled) {
@@ -86,7 +113,6 @@ static void pull_channel_low(const white_ch_t* ch) {
 static void reset_channels_state(void) {
     memset(s_ch, 0, sizeof(s_ch));
     s_count = 0;
-    s_current_ch_idx = -1;
 }
 
 static const white_effect_t* find_eff(const char* name) {
@@ -117,8 +143,6 @@ static void setup_ledc_channel(int ch, int gpio, int freq_hz)
     ledc_channel_config(&ccfg);
 }
 
-int ul_white_effect_current_channel(void) { return s_current_ch_idx; }
-
 static void ch_init(int idx, bool enabled, int gpio, int ledc_ch, int pwm_hz) {
     s_ch[idx].enabled = enabled;
     s_ch[idx].gpio = gpio;
@@ -134,37 +158,165 @@ static void ch_init(int idx, bool enabled, int gpio, int ledc_ch, int pwm_hz) {
     if (enabled) s_count++;
 }
 
-static void white_task(void*)
+// One scheduler pass. Deadline-driven: effects that can describe their
+// output as a linear ramp hand it to the LEDC fade hardware and we sleep
+// until the segment boundary; everything else reports how long its output
+// stays put and we hand the soonest deadline back to the shared dispatcher.
+// Static channels latch entirely and a state change kicks the scheduler
+// awake.
+static TickType_t white_step(void* ctx)
 {
-    // Use the dedicated smoothing rate for periodic updates. If the
-    // configured rate is faster than the system tick, fall back to 1 tick
-    // so the task still yields and avoids assertion failures.
-    TickType_t period_ticks = pdMS_TO_TICKS(1000) / CONFIG_UL_WHITE_SMOOTH_HZ;
-    if (period_ticks == 0) {
-        period_ticks = 1;
-    }
-    TickType_t last_wake = xTaskGetTickCount();
-    int n = 0; ul_white_get_effects(&n); // ensure linked
-    while (1) {
-        for (int i=0;i<4;i++) {
-            if (!s_ch[i].enabled) continue;
-            uint8_t v = 0;
-            s_current_ch_idx = i;
-            if (s_ch[i].eff && s_ch[i].eff->render) {
-                v = s_ch[i].eff->render(s_ch[i].frame_idx++);
+    (void)ctx;
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = portMAX_DELAY;
+    for (int i=0;i<4;i++) {
+        if (!s_ch[i].enabled) continue;
+        // Advance an active brightness ramp from wall time.
+        bool ramping = false;
+        if (s_ch[i].bri_ramp_active) {
+            int64_t elapsed = esp_timer_get_time() - s_ch[i].bri_ramp_start_us;
+            int64_t dur_us = (int64_t)s_ch[i].bri_ramp_duration_ms * 1000;
+            if (elapsed >= dur_us) {
+                s_ch[i].brightness = s_ch[i].bri_ramp_target;
+                s_ch[i].bri_ramp_active = false;
+            } else {
+                int delta = (int)s_ch[i].bri_ramp_target - (int)s_ch[i].bri_ramp_from;
+                s_ch[i].brightness = (uint8_t)((int)s_ch[i].bri_ramp_from +
+                                               (delta * elapsed) / dur_us);
+                ramping = true;
+            }
+        }
+        if (s_ch[i].fade_active) {
+            TickType_t remaining = s_ch[i].fade_end_tick - now;
+            if ((int32_t)remaining > 0) {
+                // Hardware is still ramping; check back at the boundary.
+                if (remaining < wait) wait = remaining;
+                continue;
             }
-            v = (v * s_ch[i].brightness) / 255;
-            int duty = (v * ((1<<12)-1)) / 255;
-            ledc_set_duty(UL_LEDC_SPEED_MODE, s_ch[i].ledc_ch, duty);
-            ledc_update_duty(UL_LEDC_SPEED_MODE, s_ch[i].ledc_ch);
+            s_ch[i].fade_active = false;
+        }
+
+        white_fade_segment_t seg;
+        if (!s_ch[i].hold && !ramping && s_ch[i].eff && s_ch[i].eff->plan_fade &&
+            s_ch[i].eff->plan_fade(i, s_ch[i].frame_idx, &seg)) {
+            // Scale the segment endpoint exactly like a rendered frame. The
+            // fade engine interpolates duty linearly in between, which is
+            // visually close enough over the slow ramps the effects emit.
+#if CONFIG_UL_GAMMA_ENABLE
+            uint32_t duty_q8 = (uint32_t)ul_gamma12(seg.target) << 8;
+#else
+            uint32_t duty_q8 = ((uint32_t)seg.target * 4095u * 256u) / 255u;
+#endif
+            duty_q8 = (uint32_t)(((uint64_t)duty_q8 * s_ch[i].brightness) / 255u);
+            uint32_t duty = (duty_q8 + 128u) >> 8;
+            if (duty > 4095u) duty = 4095u;
+            s_ch[i].dither_err = 0;
+            if (seg.duration_ms > 0) {
+                ledc_set_fade_with_time(UL_LEDC_SPEED_MODE, s_ch[i].ledc_ch,
+                                        (int)duty, (int)seg.duration_ms);
+                ledc_fade_start(UL_LEDC_SPEED_MODE, s_ch[i].ledc_ch,
+                                LEDC_FADE_NO_WAIT);
+                TickType_t fade_ticks = pdMS_TO_TICKS(seg.duration_ms);
+                if (fade_ticks == 0) fade_ticks = 1;
+                s_ch[i].fade_active = true;
+                s_ch[i].fade_end_tick = now + fade_ticks;
+                // Keep frame_idx tracking wall time so re-planning after
+                // the boundary resumes from the right spot.
+                s_ch[i].frame_idx += (int)(((int64_t)seg.duration_ms *
+                                            CONFIG_UL_WHITE_SMOOTH_HZ) / 1000);
+                if (fade_ticks < wait) wait = fade_ticks;
+            } else {
+                // Static hold: the duty is latched in hardware and only
+                // an external state change can move it.
+                ledc_set_duty(UL_LEDC_SPEED_MODE, s_ch[i].ledc_ch, (int)duty);
+                ledc_update_duty(UL_LEDC_SPEED_MODE, s_ch[i].ledc_ch);
+                s_ch[i].hold = true;
+            }
+            continue;
+        }
+        if (s_ch[i].hold) continue;
+
+        uint8_t v = 0;
+        int frame = s_ch[i].frame_idx++;
+        if (s_ch[i].eff && s_ch[i].eff->render) {
+            v = s_ch[i].eff->render(i, frame);
+        }
+        // Q12.8 duty: gamma straight into the 12-bit domain, brightness
+        // applied with the fraction kept, then the bottom eight bits
+        // temporally dithered so dim ramps move in sub-duty steps
+        // instead of visible 16-duty jumps.
+#if CONFIG_UL_GAMMA_ENABLE
+        uint32_t duty_q8 = (uint32_t)ul_gamma12(v) << 8;
+#else
+        uint32_t duty_q8 = ((uint32_t)v * 4095u * 256u) / 255u;
+#endif
+        duty_q8 = (uint32_t)(((uint64_t)duty_q8 * s_ch[i].brightness) / 255u);
+        int64_t next_us = -1;
+        if (s_ch[i].eff && s_ch[i].eff->next_change_us) {
+            next_us = s_ch[i].eff->next_change_us(frame);
+        }
+        // A ramp keeps the channel at the smooth rate regardless of how
+        // quiet the effect claims to be, until the target lands.
+        if (ramping) {
+            int64_t frame_us = 1000000LL / CONFIG_UL_WHITE_SMOOTH_HZ;
+            if (next_us < 0 || next_us > frame_us) next_us = frame_us;
+        }
+        uint32_t duty;
+        if (next_us < 0) {
+            // Output is static from here: commit a rounded duty instead
+            // of a dithered one and stop waking for this channel.
+            duty = (duty_q8 + 128u) >> 8;
+            s_ch[i].dither_err = 0;
+            s_ch[i].hold = true;
+        } else {
+            uint32_t acc = duty_q8 + s_ch[i].dither_err;
+            duty = acc >> 8;
+            s_ch[i].dither_err = (uint8_t)(acc & 0xFFu);
+            // Skip the frames the sleep covers so the effect phase keeps
+            // tracking wall time.
+            int skip = (int)((next_us * CONFIG_UL_WHITE_SMOOTH_HZ) / 1000000LL);
+            if (skip > 1) s_ch[i].frame_idx = frame + skip;
+            TickType_t t = pdMS_TO_TICKS((uint32_t)(next_us / 1000));
+            if (t == 0) t = 1;
+            if (t < wait) wait = t;
+        }
+        if (duty > 4095u) duty = 4095u;
+        ledc_set_duty(UL_LEDC_SPEED_MODE, s_ch[i].ledc_ch, (int)duty);
+        ledc_update_duty(UL_LEDC_SPEED_MODE, s_ch[i].ledc_ch);
+    }
+    return wait;
+}
+
+// Replay the last persisted command for each enabled channel so brightness
+// levels resume where they were before the power cycle. ul_state_init()
+// prefetched the payloads into RAM, so only the JSON parses land on the boot
+// path. The "channel" field is pinned to the slot index because the original
+// command may have carried the index only in the topic path.
+static void white_restore_saved_state(void)
+{
+    char* payload = malloc(UL_STATE_MAX_JSON_LEN);
+    if (!payload) return;
+    for (int i = 0; i < 4; ++i) {
+        if (!s_ch[i].enabled) continue;
+        if (!ul_state_copy_white(i, payload, UL_STATE_MAX_JSON_LEN)) continue;
+        cJSON* root = cJSON_Parse(payload);
+        if (!root) continue;
+        cJSON* jch = cJSON_GetObjectItem(root, "channel");
+        if (!jch) {
+            cJSON_AddNumberToObject(root, "channel", i);
+        } else {
+            jch->valueint = i;
+            jch->valuedouble = (double)i;
         }
-        vTaskDelayUntil(&last_wake, period_ticks);
+        ul_white_apply_json(root);
+        cJSON_Delete(root);
     }
+    free(payload);
 }
 
 bool ul_white_engine_start(void)
 {
-    if (s_white_task) {
+    if (s_white_registered) {
         ESP_LOGW(TAG, "White engine already running");
         return true;
     }
@@ -184,18 +336,20 @@ bool ul_white_engine_start(void)
 #if CONFIG_UL_WHT3_ENABLED
     ch_init(3, true, CONFIG_UL_WHT3_GPIO, CONFIG_UL_WHT3_LEDC_CH, CONFIG_UL_WHT3_PWM_HZ);
 #endif
-    // Run at slightly lower priority than the pixel refresh task; on
-    // multi-core targets this pins to core 1 so core 0 can handle network
-    // traffic.
     if (s_count == 0) {
         ul_health_notify_white_engine_ok();
         return true;
     }
 
-    BaseType_t rc = ul_task_create(white_task, "white200hz", 4096, NULL, 23, &s_white_task, 1);
-    if (rc != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create white smoothing task (%ld)", (long)rc);
-        s_white_task = NULL;
+    if (!s_fade_installed) {
+        // One-time fade service for the hardware ramps; survives engine
+        // restarts.
+        ledc_fade_func_install(0);
+        s_fade_installed = true;
+    }
+
+    if (!ul_sched_register(white_step, NULL, "white")) {
+        ESP_LOGE(TAG, "Failed to register white engine with scheduler");
         ul_health_notify_white_engine_failure();
         for (int i = 0; i < 4; ++i) {
             pull_channel_low(&s_ch[i]);
@@ -203,16 +357,18 @@ bool ul_white_engine_start(void)
         reset_channels_state();
         return false;
     }
+    s_white_registered = true;
 
     ul_health_notify_white_engine_ok();
+    white_restore_saved_state();
     return true;
 }
 
 void ul_white_engine_stop(void)
 {
-    if (s_white_task) {
-        vTaskDelete(s_white_task);
-        s_white_task = NULL;
+    if (s_white_registered) {
+        ul_sched_unregister(white_step, NULL);
+        s_white_registered = false;
     }
     for (int i = 0; i < 4; ++i) {
         pull_channel_low(&s_ch[i]);
@@ -234,13 +390,34 @@ bool ul_white_set_effect(int ch, const char* name) {
     c->eff = e;
     c->frame_idx = 0;
     if (c->eff->init) c->eff->init();
+    invalidate_fade(c);
+    ul_sched_kick();
     return true;
 }
 
 bool ul_white_set_brightness(int ch, uint8_t bri) {
     white_ch_t* c = get_ch(ch);
     if (!c) return false;
+    c->bri_ramp_active = false;
     c->brightness = bri;
+    invalidate_fade(c);
+    ul_sched_kick();
+    return true;
+}
+
+bool ul_white_set_brightness_ramp(int ch, uint8_t target, int duration_ms) {
+    white_ch_t* c = get_ch(ch);
+    if (!c) return false;
+    if (duration_ms <= 0 || c->brightness == target) {
+        return ul_white_set_brightness(ch, target);
+    }
+    c->bri_ramp_from = c->brightness;
+    c->bri_ramp_target = target;
+    c->bri_ramp_start_us = esp_timer_get_time();
+    c->bri_ramp_duration_ms = duration_ms;
+    c->bri_ramp_active = true;
+    invalidate_fade(c);
+    ul_sched_kick();
     return true;
 }
 
@@ -273,6 +450,8 @@ void ul_white_apply_json(cJSON* root) {
         white_ch_t* c = get_ch(ch);
         if (c && c->eff && c->eff->apply_params) {
             c->eff->apply_params(ch, jparams);
+            invalidate_fade(c);
+            ul_sched_kick();
         }
     }
 }
@@ -37,10 +37,23 @@ typedef struct {
 #endif
 } ul_wifi_credentials_t;
 
+// Last association cache: the BSSID and channel of the AP the node most
+// recently held an association with. Lets a reconnect attempt a directed
+// join (no scan) before falling back to the normal full-scan path. Saving
+// new credentials invalidates the cache.
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t channel;
+} ul_wifi_ap_cache_t;
+
 bool ul_wifi_credentials_load(ul_wifi_credentials_t *out);
 esp_err_t ul_wifi_credentials_save(const ul_wifi_credentials_t *creds);
 esp_err_t ul_wifi_credentials_clear(void);
 
+bool ul_wifi_ap_cache_load(ul_wifi_ap_cache_t *out);
+esp_err_t ul_wifi_ap_cache_save(const ul_wifi_ap_cache_t *cache);
+esp_err_t ul_wifi_ap_cache_clear(void);
+
 #ifdef __cplusplus
 }
 #endif
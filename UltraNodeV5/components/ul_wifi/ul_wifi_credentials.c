@@ -1,33 +1,61 @@
 #include "ul_wifi_credentials.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "nvs.h"
 #include "nvs_flash.h"
+#include <stdlib.h>
 #include <string.h>
 
 #define UL_WIFI_NAMESPACE "ulwifi"
 
 static const char *TAG = "ul_wifi_credentials";
 
+// RAM cache over the NVS records. The reconnect and fast-join paths read
+// credentials and the AP cache during time-critical recovery; serving them
+// from RAM keeps flash reads (and the NVS locks shared with ul_state's
+// persistence traffic) off that path. The cache fills on first load and is
+// refreshed or invalidated by save/clear, which are rare and not latency
+// sensitive. The credential record is heap-allocated on first use so
+// never-provisioned nodes don't pay for the cert-sized struct.
+static ul_wifi_credentials_t *s_cred_cache;
+static bool s_cred_cache_have_ssid;
+static ul_wifi_ap_cache_t s_ap_cache;
+static bool s_ap_cache_known; // RAM copy reflects NVS, even when empty
+static bool s_ap_cache_have;
+static SemaphoreHandle_t s_cache_lock;
+
+// First callers run from app_main before any concurrent user exists, so
+// lazy creation here is race-free.
+static SemaphoreHandle_t cache_lock(void) {
+  if (!s_cache_lock)
+    s_cache_lock = xSemaphoreCreateMutex();
+  return s_cache_lock;
+}
+
 static esp_err_t ul_wifi_open_namespace(nvs_open_mode_t mode, nvs_handle_t *out_handle) {
   if (!out_handle)
     return ESP_ERR_INVALID_ARG;
   return nvs_open(UL_WIFI_NAMESPACE, mode, out_handle);
 }
 
-bool ul_wifi_credentials_load(ul_wifi_credentials_t *out) {
-  if (!out)
-    return false;
+// Reads the credential record from NVS. Returns false on read errors (which
+// must not be cached); a missing namespace or missing keys read as empty
+// credentials and return true.
+static bool credentials_load_from_nvs(ul_wifi_credentials_t *out,
+                                      bool *have_ssid) {
   memset(out, 0, sizeof(*out));
+  *have_ssid = false;
   nvs_handle_t handle;
   esp_err_t err = ul_wifi_open_namespace(NVS_READONLY, &handle);
+  if (err == ESP_ERR_NVS_NOT_FOUND) {
+    return true; // never provisioned; cacheable as empty
+  }
   if (err != ESP_OK) {
-    if (err != ESP_ERR_NVS_NOT_FOUND) {
-      ESP_LOGW(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
-    }
+    ESP_LOGW(TAG, "Failed to open NVS namespace: %s", esp_err_to_name(err));
     return false;
   }
 
-  bool have_ssid = false;
   size_t ssid_len = sizeof(out->ssid);
   err = nvs_get_str(handle, "ssid", out->ssid, &ssid_len);
   if (err == ESP_ERR_NVS_NOT_FOUND) {
@@ -40,7 +68,7 @@ bool ul_wifi_credentials_load(ul_wifi_credentials_t *out) {
     return false;
   }
   if (out->ssid[0] != '\0') {
-    have_ssid = true;
+    *have_ssid = true;
   }
 
   size_t pass_len = sizeof(out->password);
@@ -125,9 +153,70 @@ bool ul_wifi_credentials_load(ul_wifi_credentials_t *out) {
 #endif
 
   nvs_close(handle);
+  return true;
+}
+
+bool ul_wifi_credentials_load(ul_wifi_credentials_t *out) {
+  if (!out)
+    return false;
+  SemaphoreHandle_t lock = cache_lock();
+  if (lock)
+    xSemaphoreTake(lock, portMAX_DELAY);
+
+  if (s_cred_cache) {
+    memcpy(out, s_cred_cache, sizeof(*out));
+    bool have_ssid = s_cred_cache_have_ssid;
+    if (lock)
+      xSemaphoreGive(lock);
+    return have_ssid;
+  }
+
+  bool have_ssid = false;
+  if (!credentials_load_from_nvs(out, &have_ssid)) {
+    if (lock)
+      xSemaphoreGive(lock);
+    return false;
+  }
+  s_cred_cache = malloc(sizeof(*s_cred_cache));
+  if (s_cred_cache) {
+    memcpy(s_cred_cache, out, sizeof(*s_cred_cache));
+    s_cred_cache_have_ssid = have_ssid;
+  }
+  if (lock)
+    xSemaphoreGive(lock);
   return have_ssid;
 }
 
+// Refresh the RAM copy after a successful save so the next load (often the
+// reconnect that follows provisioning) never touches flash.
+static void cred_cache_store(const ul_wifi_credentials_t *creds) {
+  SemaphoreHandle_t lock = cache_lock();
+  if (lock)
+    xSemaphoreTake(lock, portMAX_DELAY);
+  if (!s_cred_cache)
+    s_cred_cache = malloc(sizeof(*s_cred_cache));
+  if (s_cred_cache) {
+    memcpy(s_cred_cache, creds, sizeof(*s_cred_cache));
+    s_cred_cache_have_ssid = (creds->ssid[0] != '\0');
+  }
+  // Saving credentials erases the AP association cache in NVS.
+  s_ap_cache_known = true;
+  s_ap_cache_have = false;
+  if (lock)
+    xSemaphoreGive(lock);
+}
+
+static void cred_cache_invalidate(void) {
+  SemaphoreHandle_t lock = cache_lock();
+  if (lock)
+    xSemaphoreTake(lock, portMAX_DELAY);
+  free(s_cred_cache);
+  s_cred_cache = NULL;
+  s_ap_cache_known = false;
+  if (lock)
+    xSemaphoreGive(lock);
+}
+
 esp_err_t ul_wifi_credentials_save(const ul_wifi_credentials_t *creds) {
   if (!creds)
     return ESP_ERR_INVALID_ARG;
@@ -216,6 +305,19 @@ esp_err_t ul_wifi_credentials_save(const ul_wifi_credentials_t *creds) {
   }
 #endif
 
+  // New credentials may point at a different network; the cached AP is no
+  // longer trustworthy for a directed join.
+  esp_err_t erase_cache = nvs_erase_key(handle, "ap_bssid");
+  if (erase_cache != ESP_OK && erase_cache != ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGW(TAG, "Failed to erase AP BSSID key: %s",
+             esp_err_to_name(erase_cache));
+  }
+  erase_cache = nvs_erase_key(handle, "ap_chan");
+  if (erase_cache != ESP_OK && erase_cache != ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGW(TAG, "Failed to erase AP channel key: %s",
+             esp_err_to_name(erase_cache));
+  }
+
   // Remove legacy key if it exists so future reads use the new name.
   esp_err_t erase_legacy = nvs_erase_key(handle, "secret");
   if (erase_legacy != ESP_OK && erase_legacy != ESP_ERR_NVS_NOT_FOUND) {
@@ -226,11 +328,149 @@ esp_err_t ul_wifi_credentials_save(const ul_wifi_credentials_t *creds) {
   err = nvs_commit(handle);
   if (err != ESP_OK) {
     ESP_LOGE(TAG, "Failed to commit credentials: %s", esp_err_to_name(err));
+    cred_cache_invalidate(); // RAM may no longer match flash
+  } else {
+    cred_cache_store(creds);
   }
   nvs_close(handle);
   return err;
 }
 
+bool ul_wifi_ap_cache_load(ul_wifi_ap_cache_t *out) {
+  if (!out)
+    return false;
+  SemaphoreHandle_t lock = cache_lock();
+  if (lock)
+    xSemaphoreTake(lock, portMAX_DELAY);
+  if (s_ap_cache_known) {
+    memcpy(out, &s_ap_cache, sizeof(*out));
+    bool have = s_ap_cache_have;
+    if (lock)
+      xSemaphoreGive(lock);
+    return have;
+  }
+  if (lock)
+    xSemaphoreGive(lock);
+
+  memset(out, 0, sizeof(*out));
+  nvs_handle_t handle;
+  esp_err_t err = ul_wifi_open_namespace(NVS_READONLY, &handle);
+  if (err == ESP_ERR_NVS_NOT_FOUND) {
+    err = ESP_OK; // namespace absent reads as an empty cache
+  } else if (err != ESP_OK) {
+    return false;
+  } else {
+    size_t bssid_len = sizeof(out->bssid);
+    err = nvs_get_blob(handle, "ap_bssid", out->bssid, &bssid_len);
+    if (err == ESP_OK && bssid_len == sizeof(out->bssid)) {
+      err = nvs_get_u8(handle, "ap_chan", &out->channel);
+    } else if (err == ESP_OK) {
+      err = ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    nvs_close(handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+      memset(out, 0, sizeof(*out));
+      err = ESP_OK;
+    }
+  }
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to read AP cache: %s", esp_err_to_name(err));
+    memset(out, 0, sizeof(*out));
+    return false;
+  }
+
+  bool have = (out->channel != 0);
+  if (lock)
+    xSemaphoreTake(lock, portMAX_DELAY);
+  memcpy(&s_ap_cache, out, sizeof(s_ap_cache));
+  s_ap_cache_known = true;
+  s_ap_cache_have = have;
+  if (lock)
+    xSemaphoreGive(lock);
+  return have;
+}
+
+esp_err_t ul_wifi_ap_cache_save(const ul_wifi_ap_cache_t *cache) {
+  if (!cache)
+    return ESP_ERR_INVALID_ARG;
+  nvs_handle_t handle;
+  esp_err_t err = ul_wifi_open_namespace(NVS_READWRITE, &handle);
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to open NVS namespace for AP cache: %s",
+             esp_err_to_name(err));
+    return err;
+  }
+  err = nvs_set_blob(handle, "ap_bssid", cache->bssid, sizeof(cache->bssid));
+  if (err == ESP_OK) {
+    err = nvs_set_u8(handle, "ap_chan", cache->channel);
+  }
+  if (err == ESP_OK) {
+    err = nvs_commit(handle);
+  }
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to save AP cache: %s", esp_err_to_name(err));
+  }
+  nvs_close(handle);
+
+  SemaphoreHandle_t lock = cache_lock();
+  if (lock)
+    xSemaphoreTake(lock, portMAX_DELAY);
+  if (err == ESP_OK) {
+    memcpy(&s_ap_cache, cache, sizeof(s_ap_cache));
+    s_ap_cache_known = true;
+    s_ap_cache_have = (cache->channel != 0);
+  } else {
+    s_ap_cache_known = false; // RAM may no longer match flash
+  }
+  if (lock)
+    xSemaphoreGive(lock);
+  return err;
+}
+
+static void ap_cache_mark_empty(void) {
+  SemaphoreHandle_t lock = cache_lock();
+  if (lock)
+    xSemaphoreTake(lock, portMAX_DELAY);
+  memset(&s_ap_cache, 0, sizeof(s_ap_cache));
+  s_ap_cache_known = true;
+  s_ap_cache_have = false;
+  if (lock)
+    xSemaphoreGive(lock);
+}
+
+esp_err_t ul_wifi_ap_cache_clear(void) {
+  nvs_handle_t handle;
+  esp_err_t err = ul_wifi_open_namespace(NVS_READWRITE, &handle);
+  if (err == ESP_ERR_NVS_NOT_FOUND) {
+    ap_cache_mark_empty();
+    return ESP_OK;
+  }
+  if (err != ESP_OK) {
+    return err;
+  }
+  esp_err_t erase_err = nvs_erase_key(handle, "ap_bssid");
+  if (erase_err != ESP_OK && erase_err != ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGW(TAG, "Failed to erase AP BSSID key: %s", esp_err_to_name(erase_err));
+  }
+  erase_err = nvs_erase_key(handle, "ap_chan");
+  if (erase_err != ESP_OK && erase_err != ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGW(TAG, "Failed to erase AP channel key: %s", esp_err_to_name(erase_err));
+  }
+  err = nvs_commit(handle);
+  nvs_close(handle);
+  if (err == ESP_OK) {
+    ap_cache_mark_empty();
+  } else {
+    SemaphoreHandle_t lock = cache_lock();
+    if (lock)
+      xSemaphoreTake(lock, portMAX_DELAY);
+    s_ap_cache_known = false; // RAM may no longer match flash
+    if (lock)
+      xSemaphoreGive(lock);
+  }
+  return err;
+}
+
 esp_err_t ul_wifi_credentials_clear(void) {
   nvs_handle_t handle;
   esp_err_t err = ul_wifi_open_namespace(NVS_READWRITE, &handle);
@@ -278,6 +518,14 @@ esp_err_t ul_wifi_credentials_clear(void) {
     ESP_LOGW(TAG, "Failed to erase MQTT client key: %s",
              esp_err_to_name(erase_err));
   }
+  erase_err = nvs_erase_key(handle, "ap_bssid");
+  if (erase_err != ESP_OK && erase_err != ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGW(TAG, "Failed to erase AP BSSID key: %s", esp_err_to_name(erase_err));
+  }
+  erase_err = nvs_erase_key(handle, "ap_chan");
+  if (erase_err != ESP_OK && erase_err != ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGW(TAG, "Failed to erase AP channel key: %s", esp_err_to_name(erase_err));
+  }
   erase_err = nvs_erase_key(handle, "secret");
   if (erase_err != ESP_OK && erase_err != ESP_ERR_NVS_NOT_FOUND) {
     ESP_LOGW(TAG, "Failed to erase legacy secret key: %s",
@@ -288,5 +536,8 @@ esp_err_t ul_wifi_credentials_clear(void) {
     ESP_LOGW(TAG, "Failed to commit credential erase: %s", esp_err_to_name(err));
   }
   nvs_close(handle);
+  // Drop the RAM copies whether or not the commit landed; a re-read after a
+  // failed erase just costs one flash pass.
+  cred_cache_invalidate();
   return err;
 }
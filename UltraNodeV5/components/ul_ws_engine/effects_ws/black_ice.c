@@ -3,7 +3,9 @@
 #if CONFIG_UL_WS0_ENABLED || CONFIG_UL_WS1_ENABLED
 
 #include "effect.h"
+#include "psram_arena.h"
 #include "ul_ws_engine.h"
+#include "ul_common_effects.h"
 #include "cJSON.h"
 #include "esp_heap_caps.h"
 #include <math.h>
@@ -16,35 +18,100 @@
 #define BLACK_ICE_LAYER_STEP 32
 #define BLACK_ICE_DEFAULT_SHIMMER 1.0f
 
+// Layer governor: memory failures set the ceiling (ensure_capacity below),
+// measured frame time decides how much of it the node can actually afford.
+// Layers shed when the smoothed render time eats more than the high fraction
+// of the frame period and come back below the low one. The gap is sized so
+// one step up – at worst a 1.5x cost jump at BLACK_ICE_MIN_LAYERS – cannot
+// land straight above the high mark and oscillate.
+#define BLACK_ICE_GOVERNOR_FRAMES 32 // sim frames between layer adjustments
+#define BLACK_ICE_LOAD_HIGH_PCT 70
+#define BLACK_ICE_LOAD_LOW_PCT 45
+
+// Q8.8 fixed point: 256 represents 1.0. Fracture saturates at 1.6 and
+// sparkle at 1.5 just like the old float fields did.
+#define BLACK_ICE_ONE 256
+#define BLACK_ICE_FRACTURE_MAX 410
+#define BLACK_ICE_SPARKLE_MAX 384
+
 // Black Ice – shimmering crystalline frost with bright crackle highlights.
 // This effect keeps multiple high-resolution layers of fracture intensity and
-// sparkle energy in PSRAM to create a deep, animated texture. The engine will
-// gracefully reduce the number of layers if memory is scarce so the effect can
-// still render instead of failing and producing a black frame.
+// sparkle energy in PSRAM to create a deep, animated texture. The layer count
+// degrades gracefully on two independent signals: allocation failures cap how
+// many layers fit in memory, and the frame-time governor below trims the
+// active count until the measured render time fits the frame period – so a
+// 900-pixel strip sheds depth it cannot afford instead of overrunning
+// ws_task(), while short strips keep the full texture.
+//
+// The fields used to be three separate float arrays walked in lockstep, which
+// thrashed PSRAM cache lines – and PSRAM bandwidth, not arithmetic, is what
+// limits this effect. Each cell's fracture and sparkle now sit next to each
+// other as Q8.8 uint16 in one interleaved buffer (double buffered for the
+// simulation step), halving the footprint and pulling both values of a cell
+// in with a single cache line fill.
+//
+// The fields only advance on every second frame. The per-column layer sums
+// are linear in the cell values, so interpolating the sums of the two most
+// recent field states is identical to interpolating the fields themselves;
+// in-between frames just lerp those sums, halving the dominant cost of the
+// effect while the display still updates at the full frame rate.
 
 typedef struct {
-    float shimmer;            // how active the crystalline shimmer is
-    float base[3];            // base ice colour
-    float fracture_colour[3]; // crack highlight colour
-    float sparkle_colour[3];  // diamond sparkle colour
-    float* fracture;          // layers * capacity fracture energy field
-    float* scratch;           // scratch buffer for fracture simulation
-    float* sparkle;           // sparkle persistence per cell
+    float shimmer;            // how active the crystalline shimmer is (raw param)
+    // Scalars baked from shimmer when params change so neither the step nor
+    // the colour pass converts floats.
+    int decay_q;              // Q8.8 base decay per step
+    uint32_t inject_base;     // 24-bit burst probability before depth scaling
+    uint32_t spark_base;      // 24-bit sparkle probability before depth scaling
+    uint32_t drip_thresh;     // 24-bit stray glimmer probability
+    int frost_gain_q;         // Q8.8 brightness gain from fracture
+    int glint_gain_q;         // Q8.8 brightness gain from sparkle
+    int bright_mult_q;        // Q8.8 overall brightness multiplier
+    uint8_t base[3];          // base ice colour
+    uint8_t fracture_colour[3]; // crack highlight colour
+    uint8_t sparkle_colour[3];  // diamond sparkle colour
+    uint16_t* cells;          // interleaved fracture+sparkle, layers * capacity * 2
+    uint16_t* cells_next;     // scratch buffer for the simulation step (same size)
+    uint16_t* col_fracture;   // prev + current per-column fracture sums (2 * capacity)
+    uint16_t* col_sparkle;    // prev + current per-column sparkle sums (2 * capacity)
     int layers;               // active simulation layers
+    int alloc_layers;         // layer depth the buffers were sized for (governor ceiling)
     int capacity;             // allocated columns in the buffers
+    uint32_t load_ema_us;     // smoothed sim-frame render time, Q0 microseconds
+    uint16_t governor_frames; // sim frames since the last layer adjustment
+    bool from_arena;          // field buffers borrowed from the PSRAM arena
     bool params_set;          // whether custom params were supplied
     bool seeded;              // whether the fields have been initialised
+    uint8_t sim_phase;        // 0 = advance the fields on this frame
     uint32_t rng;             // PRNG state
 } black_ice_state_t;
 
 static black_ice_state_t s_black_ice[BLACK_ICE_MAX_STRIPS];
 
+// crack^1.25 and shimmer^0.95 mapped through Q8.8 tables over 0..256, built
+// once so the colour pass needs no powf.
+static uint16_t s_frost_lut[BLACK_ICE_ONE + 1];
+static uint16_t s_glint_lut[BLACK_ICE_ONE + 1];
+static bool s_lut_ready = false;
+
 static inline float clampf(float v, float lo, float hi) {
     if (v < lo) return lo;
     if (v > hi) return hi;
     return v;
 }
 
+static inline int clamp_fracture(int v) {
+    if (v < 0) return 0;
+    if (v > BLACK_ICE_FRACTURE_MAX) return BLACK_ICE_FRACTURE_MAX;
+    return v;
+}
+
+static inline int clamp_sparkle(int v) {
+    if (v < 0) return 0;
+    if (v > BLACK_ICE_SPARKLE_MAX) return BLACK_ICE_SPARKLE_MAX;
+    return v;
+}
+
 static uint32_t xorshift32(uint32_t* state) {
     uint32_t x = *state;
     if (x == 0) x = 0x12345678u;
@@ -55,30 +122,37 @@ static uint32_t xorshift32(uint32_t* state) {
     return x;
 }
 
-static float frand(uint32_t* state) {
-    return (xorshift32(state) >> 8) * (1.0f / 16777216.0f);
+// Centered Q8.8 noise in [-256, 255], i.e. roughly [-1.0, 1.0).
+static inline int noiseq(uint32_t* state) {
+    return (int)(xorshift32(state) & 0x1FF) - 256;
 }
 
-static float* black_ice_alloc_cells(size_t cells) {
-    float* ptr = heap_caps_calloc(cells, sizeof(float), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+static uint16_t* black_ice_alloc_cells(size_t count) {
+    uint16_t* ptr = heap_caps_calloc(count, sizeof(uint16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
     if (!ptr) {
-        ptr = heap_caps_calloc(cells, sizeof(float), MALLOC_CAP_8BIT);
+        ptr = heap_caps_calloc(count, sizeof(uint16_t), MALLOC_CAP_8BIT);
     }
     return ptr;
 }
 
 static void free_fields(black_ice_state_t* st) {
-    if (st->fracture) {
-        heap_caps_free(st->fracture);
-        st->fracture = NULL;
+    // Arena borrows are reclaimed by the next claim, never freed.
+    if (st->cells && !st->from_arena) {
+        heap_caps_free(st->cells);
     }
-    if (st->scratch) {
-        heap_caps_free(st->scratch);
-        st->scratch = NULL;
+    st->cells = NULL;
+    if (st->cells_next && !st->from_arena) {
+        heap_caps_free(st->cells_next);
     }
-    if (st->sparkle) {
-        heap_caps_free(st->sparkle);
-        st->sparkle = NULL;
+    st->cells_next = NULL;
+    st->from_arena = false;
+    if (st->col_fracture) {
+        heap_caps_free(st->col_fracture);
+        st->col_fracture = NULL;
+    }
+    if (st->col_sparkle) {
+        heap_caps_free(st->col_sparkle);
+        st->col_sparkle = NULL;
     }
     st->capacity = 0;
     st->seeded = false;
@@ -91,34 +165,85 @@ static bool ensure_capacity(black_ice_state_t* st, int width) {
     if (st->layers <= 0) {
         st->layers = BLACK_ICE_DEFAULT_LAYERS;
     }
-    if (width <= st->capacity && st->fracture && st->scratch && st->sparkle) {
+    int strip = (int)(st - s_black_ice);
+    if (width <= st->capacity && st->cells && st->cells_next &&
+        (!st->from_arena || ul_ws_psram_arena_owned(strip, st))) {
         return true;
     }
 
+    if (st->from_arena && !ul_ws_psram_arena_owned(strip, st)) {
+        // Another effect claimed the region; the cached pointers are stale.
+        st->cells = NULL;
+        st->cells_next = NULL;
+        st->from_arena = false;
+    }
     free_fields(st);
 
-    int attempt_layers = st->layers;
+    // Size from the last memory-derived ceiling, not st->layers: the frame
+    // time governor may have pulled layers down on the old width, and a new
+    // width deserves the full depth until it is measured again.
+    int attempt_layers = st->alloc_layers > 0 ? st->alloc_layers : st->layers;
     if (attempt_layers <= 0 || attempt_layers > BLACK_ICE_DEFAULT_LAYERS) {
         attempt_layers = BLACK_ICE_DEFAULT_LAYERS;
     }
 
+    // Field buffers come from the shared PSRAM arena first, sized for the
+    // full layer count; the layer-degradation loop below only matters on the
+    // heap fallback path.
+    {
+        size_t count = (size_t)width * (size_t)attempt_layers * 2;
+        ul_ws_psram_arena_claim(strip, st);
+        uint16_t* cells = ul_ws_psram_arena_take(strip, st, count * sizeof(uint16_t));
+        uint16_t* cells_next = cells
+            ? ul_ws_psram_arena_take(strip, st, count * sizeof(uint16_t)) : NULL;
+        if (cells && cells_next) {
+            uint16_t* col_fracture = heap_caps_calloc((size_t)width * 2, sizeof(uint16_t), MALLOC_CAP_8BIT);
+            uint16_t* col_sparkle = heap_caps_calloc((size_t)width * 2, sizeof(uint16_t), MALLOC_CAP_8BIT);
+            if (col_fracture && col_sparkle) {
+                st->cells = cells;
+                st->cells_next = cells_next;
+                st->col_fracture = col_fracture;
+                st->col_sparkle = col_sparkle;
+                st->capacity = width;
+                st->layers = attempt_layers;
+                st->alloc_layers = attempt_layers;
+                st->load_ema_us = 0;
+                st->governor_frames = 0;
+                st->from_arena = true;
+                st->seeded = false;
+                st->sim_phase = 0;
+                return true;
+            }
+            if (col_fracture) heap_caps_free(col_fracture);
+            if (col_sparkle) heap_caps_free(col_sparkle);
+        }
+    }
+
     while (attempt_layers >= BLACK_ICE_MIN_LAYERS) {
-        size_t cells = (size_t)width * (size_t)attempt_layers;
-        float* fracture = black_ice_alloc_cells(cells);
-        float* scratch = black_ice_alloc_cells(cells);
-        float* sparkle = black_ice_alloc_cells(cells);
-        if (fracture && scratch && sparkle) {
-            st->fracture = fracture;
-            st->scratch = scratch;
-            st->sparkle = sparkle;
+        size_t count = (size_t)width * (size_t)attempt_layers * 2;
+        uint16_t* cells = black_ice_alloc_cells(count);
+        uint16_t* cells_next = black_ice_alloc_cells(count);
+        // Column snapshots are tiny and read every frame – keep them internal.
+        uint16_t* col_fracture = heap_caps_calloc((size_t)width * 2, sizeof(uint16_t), MALLOC_CAP_8BIT);
+        uint16_t* col_sparkle = heap_caps_calloc((size_t)width * 2, sizeof(uint16_t), MALLOC_CAP_8BIT);
+        if (cells && cells_next && col_fracture && col_sparkle) {
+            st->cells = cells;
+            st->cells_next = cells_next;
+            st->col_fracture = col_fracture;
+            st->col_sparkle = col_sparkle;
             st->capacity = width;
             st->layers = attempt_layers;
+            st->alloc_layers = attempt_layers;
+            st->load_ema_us = 0;
+            st->governor_frames = 0;
             st->seeded = false;
+            st->sim_phase = 0;
             return true;
         }
-        if (fracture) heap_caps_free(fracture);
-        if (scratch) heap_caps_free(scratch);
-        if (sparkle) heap_caps_free(sparkle);
+        if (cells) heap_caps_free(cells);
+        if (cells_next) heap_caps_free(cells_next);
+        if (col_fracture) heap_caps_free(col_fracture);
+        if (col_sparkle) heap_caps_free(col_sparkle);
 
         if (attempt_layers == BLACK_ICE_MIN_LAYERS) {
             break;
@@ -130,52 +255,123 @@ static bool ensure_capacity(black_ice_state_t* st, int width) {
     }
 
     st->layers = 0;
+    st->alloc_layers = 0;
     return false;
 }
 
+// Step the active layer count against the engine's frame-time instrumentation.
+// Called at the top of the frame after a sim frame, when the probe's last
+// render time covers a full field step – the expensive half of the cadence,
+// and the one that has to fit the period. Off frames cost roughly half and
+// never bind first. The sums the colour pass reads are normalised by layer
+// count, so a step changes texture depth, not brightness.
+static void govern_layers(black_ice_state_t* st, int strip) {
+    uint32_t render_us = 0, period_us = 0;
+    if (!ul_ws_get_frame_load(strip, &render_us, &period_us) || period_us == 0) {
+        return; // probe idle (host harnesses, first frame); keep the depth
+    }
+    st->load_ema_us += ((int32_t)render_us - (int32_t)st->load_ema_us) / 8;
+
+    if (++st->governor_frames < BLACK_ICE_GOVERNOR_FRAMES) {
+        return;
+    }
+    st->governor_frames = 0;
+
+    uint32_t load_pct = (uint32_t)((uint64_t)st->load_ema_us * 100u / period_us);
+    if (load_pct > BLACK_ICE_LOAD_HIGH_PCT && st->layers > BLACK_ICE_MIN_LAYERS) {
+        st->layers -= BLACK_ICE_LAYER_STEP;
+        if (st->layers < BLACK_ICE_MIN_LAYERS) {
+            st->layers = BLACK_ICE_MIN_LAYERS;
+        }
+    } else if (load_pct < BLACK_ICE_LOAD_LOW_PCT &&
+               st->layers + BLACK_ICE_LAYER_STEP <= st->alloc_layers) {
+        // Re-exposed rows still hold the field from before the shed; they
+        // relax back into the texture over the next few steps.
+        st->layers += BLACK_ICE_LAYER_STEP;
+    }
+}
+
+// Fold the float shimmer into the fixed-point scalars the step and colour
+// pass consume.
+static void bake_params(black_ice_state_t* st) {
+    float shimmer = st->shimmer;
+    st->decay_q = (int)((0.0032f + 0.0008f * shimmer) * (float)BLACK_ICE_ONE + 0.5f);
+    // Probabilities compared against 24-bit random draws.
+    st->inject_base = (uint32_t)((0.0006f + 0.0018f * shimmer) * 16777216.0f);
+    st->spark_base = (uint32_t)((0.012f + 0.020f * shimmer) * 16777216.0f);
+    st->drip_thresh = (uint32_t)(0.0008f * shimmer * 16777216.0f);
+    st->frost_gain_q = (int)((0.45f + 0.25f * shimmer) * (float)BLACK_ICE_ONE + 0.5f);
+    st->glint_gain_q = (int)((0.35f + 0.40f * shimmer) * (float)BLACK_ICE_ONE + 0.5f);
+    st->bright_mult_q = (int)((0.85f + 0.15f * shimmer) * (float)BLACK_ICE_ONE + 0.5f);
+}
+
 static void set_default_palette(black_ice_state_t* st) {
     // Deep midnight blue ice with pale cyan cracks and white sparkles.
     st->shimmer = BLACK_ICE_DEFAULT_SHIMMER;
-    st->base[0] = 0.015f; st->base[1] = 0.070f; st->base[2] = 0.160f;   // #04122a
-    st->fracture_colour[0] = 0.400f; st->fracture_colour[1] = 0.780f; st->fracture_colour[2] = 0.980f; // #66c7fa
-    st->sparkle_colour[0] = 0.980f; st->sparkle_colour[1] = 0.995f; st->sparkle_colour[2] = 1.000f;   // #fbfeff
+    st->base[0] = 4;   st->base[1] = 18;  st->base[2] = 42;             // #04122a
+    st->fracture_colour[0] = 102; st->fracture_colour[1] = 199; st->fracture_colour[2] = 250; // #66c7fa
+    st->sparkle_colour[0] = 251; st->sparkle_colour[1] = 254; st->sparkle_colour[2] = 255;    // #fbfeff
     st->params_set = false;
+    bake_params(st);
 }
 
 static void seed_fields(black_ice_state_t* st) {
-    if (!st->fracture || !st->scratch || !st->sparkle || st->capacity <= 0 || st->layers <= 0) {
+    if (!st->cells || !st->cells_next || st->capacity <= 0 || st->layers <= 0) {
         return;
     }
-    size_t stride = (size_t)st->capacity;
+    int stride = st->capacity;
     int layers = st->layers;
-    size_t cells = stride * (size_t)layers;
-    for (size_t i = 0; i < cells; ++i) {
-        float n = frand(&st->rng);
-        st->fracture[i] = n * n * 0.45f;
-        st->sparkle[i] = frand(&st->rng) * 0.10f;
+    size_t cell_count = (size_t)stride * (size_t)layers;
+    for (size_t i = 0; i < cell_count; ++i) {
+        int n = (int)(xorshift32(&st->rng) >> 24);
+        // n^2 * 0.45 and a sparkle floor of up to 0.10, in Q8.8.
+        st->cells[2 * i + 0] = (uint16_t)((((n * n) >> 8) * 115) >> 8);
+        st->cells[2 * i + 1] = (uint16_t)(((int)(xorshift32(&st->rng) >> 24) * 26) >> 8);
     }
-    // Relax the initial field a little to form softly connected fracture veins.
+    // Relax the initial field a little to form softly connected fracture
+    // veins, ping-ponging the fracture slots between the two buffers.
+    uint16_t* src = st->cells;
+    uint16_t* dst = st->cells_next;
     for (int iter = 0; iter < 12; ++iter) {
         for (int y = 0; y < layers; ++y) {
-            int row = y * (int)stride;
-            int above = (y == 0 ? (layers - 1) : y - 1) * (int)stride;
-            int below = (y == layers - 1 ? 0 : y + 1) * (int)stride;
-            for (int x = 0; x < (int)stride; ++x) {
-                int left = (x == 0) ? (int)stride - 1 : x - 1;
-                int right = (x == (int)stride - 1) ? 0 : x + 1;
-                float v = st->fracture[row + x];
-                float avg = (v * 2.0f + st->fracture[row + left] + st->fracture[row + right] +
-                             st->fracture[above + x] + st->fracture[below + x]) * (1.0f / 6.0f);
-                st->scratch[row + x] = avg;
+            int row = y * stride;
+            int above = (y == 0 ? (layers - 1) : y - 1) * stride;
+            int below = (y == layers - 1 ? 0 : y + 1) * stride;
+            for (int x = 0; x < stride; ++x) {
+                int left = (x == 0) ? stride - 1 : x - 1;
+                int right = (x == stride - 1) ? 0 : x + 1;
+                int sum = (int)src[2 * (row + x)] * 2 +
+                          (int)src[2 * (row + left)] + (int)src[2 * (row + right)] +
+                          (int)src[2 * (above + x)] + (int)src[2 * (below + x)];
+                dst[2 * (row + x)] = (uint16_t)(sum / 6);
             }
         }
-        memcpy(st->fracture, st->scratch, cells * sizeof(float));
+        uint16_t* tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    // 12 iterations, so the relaxed fracture ended up back in st->cells and
+    // the seeded sparkle slots there were never touched.
+    memset(st->cells_next, 0, cell_count * 2 * sizeof(uint16_t));
+    if (st->col_fracture) {
+        memset(st->col_fracture, 0, (size_t)stride * 2 * sizeof(uint16_t));
+    }
+    if (st->col_sparkle) {
+        memset(st->col_sparkle, 0, (size_t)stride * 2 * sizeof(uint16_t));
     }
-    memset(st->scratch, 0, cells * sizeof(float));
+    st->sim_phase = 0;
     st->seeded = true;
 }
 
 void black_ice_init(void) {
+    if (!s_lut_ready) {
+        for (int i = 0; i <= BLACK_ICE_ONE; ++i) {
+            float f = (float)i / (float)BLACK_ICE_ONE;
+            s_frost_lut[i] = (uint16_t)(powf(f, 1.25f) * (float)BLACK_ICE_ONE + 0.5f);
+            s_glint_lut[i] = (uint16_t)(powf(f, 0.95f) * (float)BLACK_ICE_ONE + 0.5f);
+        }
+        s_lut_ready = true;
+    }
     for (int i = 0; i < BLACK_ICE_MAX_STRIPS; ++i) {
         black_ice_state_t* st = &s_black_ice[i];
         if (!st->params_set) {
@@ -187,25 +383,43 @@ void black_ice_init(void) {
         if (st->layers <= 0) {
             st->layers = BLACK_ICE_DEFAULT_LAYERS;
         }
-        size_t cells = (size_t)st->capacity * (size_t)st->layers;
-        if (st->fracture && cells > 0) {
-            memset(st->fracture, 0, cells * sizeof(float));
+        if (st->from_arena && !ul_ws_psram_arena_owned(i, st)) {
+            // Another effect claimed the arena region since we last ran;
+            // the cached pointers are stale. render() re-borrows.
+            st->cells = NULL;
+            st->cells_next = NULL;
+            st->capacity = 0;
+            st->from_arena = false;
+            st->seeded = false;
+        }
+        size_t count = (size_t)st->capacity * (size_t)st->layers * 2;
+        if (st->cells && count > 0) {
+            memset(st->cells, 0, count * sizeof(uint16_t));
+        }
+        if (st->cells_next && count > 0) {
+            memset(st->cells_next, 0, count * sizeof(uint16_t));
         }
-        if (st->scratch && cells > 0) {
-            memset(st->scratch, 0, cells * sizeof(float));
+        if (st->col_fracture && st->capacity > 0) {
+            memset(st->col_fracture, 0, (size_t)st->capacity * 2 * sizeof(uint16_t));
         }
-        if (st->sparkle && cells > 0) {
-            memset(st->sparkle, 0, cells * sizeof(float));
+        if (st->col_sparkle && st->capacity > 0) {
+            memset(st->col_sparkle, 0, (size_t)st->capacity * 2 * sizeof(uint16_t));
         }
+        st->sim_phase = 0;
         st->seeded = false;
+        st->load_ema_us = 0;
+        st->governor_frames = 0;
     }
 }
 
-static void apply_colour_params(float dest[3], const cJSON* params, int start_idx) {
+static void apply_colour_params(uint8_t dest[3], const cJSON* params, int start_idx) {
     for (int i = 0; i < 3; ++i) {
         const cJSON* item = cJSON_GetArrayItem(params, start_idx + i);
         if (item && cJSON_IsNumber(item)) {
-            dest[i] = clampf((float)item->valuedouble / 255.0f, 0.0f, 1.0f);
+            int v = item->valueint;
+            if (v < 0) v = 0;
+            if (v > 255) v = 255;
+            dest[i] = (uint8_t)v;
         }
     }
 }
@@ -230,44 +444,50 @@ void black_ice_apply_params(int strip, const cJSON* params) {
     apply_colour_params(st->fracture_colour, params, 4);
     apply_colour_params(st->sparkle_colour, params, 7);
     st->params_set = true;
+    bake_params(st);
 }
 
-void black_ice_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
-    if (pixels <= 0) return;
-    int strip = ul_ws_effect_current_strip();
-    if (strip < 0 || strip >= BLACK_ICE_MAX_STRIPS) return;
-
-    black_ice_state_t* st = &s_black_ice[strip];
-    if (!ensure_capacity(st, pixels)) return;
-
+// Advance the fracture and sparkle fields one step and refresh the per-column
+// layer sums that the colour pass interpolates between. Everything here is
+// integer Q8.8 – the shimmer-derived scalars were baked at param time and the
+// swirl and ridge waves come from the shared ul_sin16 table via 16-bit phase
+// accumulation.
+static void WS_RENDER_ATTR black_ice_step(black_ice_state_t* st, int pixels, int frame_idx) {
+    uint16_t* cur = st->cells;
+    uint16_t* nxt = st->cells_next;
+    int stride = st->capacity;
     int layers = st->layers;
-    if (layers <= 0) return;
 
-    if (!st->params_set) {
-        set_default_palette(st);
-    }
+    int decay_q = st->decay_q;
+    uint32_t inject_base = st->inject_base;
+    uint32_t spark_base = st->spark_base;
+    uint32_t drip_thresh = st->drip_thresh;
 
-    if (!st->seeded) {
-        seed_fields(st);
-    }
-
-    float* current = st->fracture;
-    float* next = st->scratch;
-    float* sparkle = st->sparkle;
-    int stride = st->capacity;
-    float shimmer = st->shimmer;
-
-    const float decay_base = 0.0032f + 0.0008f * shimmer;
+    // The old radian phases as 16-bit turns (rad * 65536 / 2pi): swirl was
+    // frame * 0.0065 + y * 0.19, ridges x * 0.045 + y * 0.09 + frame * 0.0045.
+    uint16_t swirl_base = (uint16_t)((uint32_t)frame_idx * 68u);
+    uint16_t ridge_base = (uint16_t)((uint32_t)frame_idx * 47u);
 
     for (int y = 0; y < layers; ++y) {
         int row = y * stride;
         int above = (y == 0 ? (layers - 1) : y - 1) * stride;
         int below = (y == layers - 1 ? 0 : y + 1) * stride;
-        float depth_factor = 1.0f - (float)y / (float)layers;
-        float swirl = sinf((float)frame_idx * 0.0065f + (float)y * 0.19f);
-        int shift = (int)lroundf(swirl * 4.0f);
+        int depth_q = BLACK_ICE_ONE - (y * BLACK_ICE_ONE) / layers;
+        int swirl = ul_sin16((uint16_t)(swirl_base + (uint32_t)y * 1982u));
+        int shift = (swirl * 4 + 16384) >> 15;
         if (shift > pixels - 1) shift = pixels - 1;
         if (shift < -(pixels - 1)) shift = -(pixels - 1);
+
+        // Per-row Q8.8 factors of the old float expressions in depth_factor.
+        int ridge_scale = (20 * depth_q) >> 8;                          // 0.08 * depth
+        int decay_row = (decay_q * (179 + ((77 * depth_q) >> 8))) >> 8; // * (0.7 + 0.3 * depth)
+        if (decay_row < 1) decay_row = 1;
+        uint32_t inject_thresh = (inject_base * (uint32_t)(90 + ((166 * depth_q) >> 8))) >> 8;
+        uint32_t spark_thresh = (spark_base * (uint32_t)(115 + ((141 * depth_q) >> 8))) >> 8;
+        int glimmer_mult = 184 + ((59 * depth_q) >> 8);                 // 0.72 + 0.23 * depth
+        int burst_scale = 102 + ((154 * depth_q) >> 8);                 // 0.4 + 0.6 * depth
+        uint16_t ridge_phase = (uint16_t)(ridge_base + (uint32_t)y * 939u);
+
         for (int x = 0; x < pixels; ++x) {
             int left = (x == 0) ? pixels - 1 : x - 1;
             int right = (x == pixels - 1) ? 0 : x + 1;
@@ -275,81 +495,136 @@ void black_ice_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
             if (flow < 0) flow += pixels;
             else if (flow >= pixels) flow -= pixels;
 
-            float v = current[row + x];
-            float blend = current[row + left] + current[row + right];
-            float cross = current[above + flow] + current[below + flow];
-            float local = current[row + flow];
-            float target = v * 0.52f + blend * 0.16f + cross * 0.10f + local * 0.12f;
-            float ridges = sinf((float)x * 0.045f + (float)y * 0.09f + (float)frame_idx * 0.0045f);
-            float perturb = (frand(&st->rng) - 0.5f) * 0.10f + ridges * 0.08f * depth_factor;
-            float next_val = target + perturb;
-            next_val -= decay_base * (0.7f + 0.3f * depth_factor);
-
-            float injection_prob = (0.0006f + 0.0018f * shimmer) * (0.35f + depth_factor * 0.65f);
-            if (frand(&st->rng) < injection_prob) {
-                float burst = 0.45f + 0.75f * frand(&st->rng);
-                next_val += burst * (0.4f + depth_factor * 0.6f);
+            int v = (int)cur[2 * (row + x)];
+            int blend = (int)cur[2 * (row + left)] + (int)cur[2 * (row + right)];
+            int cross = (int)cur[2 * (above + flow)] + (int)cur[2 * (below + flow)];
+            int local = (int)cur[2 * (row + flow)];
+            // The 0.52 / 0.16 / 0.10 / 0.12 float kernel in Q8.8.
+            int target = (v * 133 + blend * 41 + cross * 26 + local * 31) >> 8;
+            int ridges_q = (int)ul_sin16((uint16_t)(ridge_phase + (uint32_t)x * 469u)) >> 7;
+            int perturb = (noiseq(&st->rng) * 13) >> 8; // +/- 0.05
+            perturb += (ridges_q * ridge_scale) >> 8;
+            int next_val = target + perturb - decay_row;
+
+            if ((xorshift32(&st->rng) >> 8) < inject_thresh) {
+                // 0.45 + 0.75 * rand, scaled by the depth burst factor.
+                int burst = 115 + (((int)(xorshift32(&st->rng) >> 24) * 192) >> 8);
+                next_val += (burst * burst_scale) >> 8;
             }
 
-            next_val = clampf(next_val, 0.0f, 1.6f);
-            next[row + x] = next_val;
-
-            float glimmer = sparkle[row + x];
-            glimmer *= 0.72f + depth_factor * 0.23f;
-            if (glimmer < 0.0f) glimmer = 0.0f;
-            float sparkle_prob = (0.012f + 0.020f * shimmer) * (0.45f + depth_factor * 0.55f);
-            if (next_val > 0.62f && frand(&st->rng) < sparkle_prob) {
-                glimmer = 1.0f + frand(&st->rng) * 0.6f;
-            } else if (frand(&st->rng) < 0.0008f * shimmer) {
-                glimmer += frand(&st->rng) * 0.3f;
+            next_val = clamp_fracture(next_val);
+            nxt[2 * (row + x)] = (uint16_t)next_val;
+
+            int glimmer = (int)cur[2 * (row + x) + 1];
+            glimmer = (glimmer * glimmer_mult) >> 8;
+            if (next_val > 159 && (xorshift32(&st->rng) >> 8) < spark_thresh) {
+                // Fracture above 0.62 lights a fresh 1.0-1.6 sparkle.
+                glimmer = BLACK_ICE_ONE + (((int)(xorshift32(&st->rng) >> 24) * 154) >> 8);
+            } else if ((xorshift32(&st->rng) >> 8) < drip_thresh) {
+                glimmer += ((int)(xorshift32(&st->rng) >> 24) * 77) >> 8;
             }
-            sparkle[row + x] = clampf(glimmer, 0.0f, 1.5f);
+            nxt[2 * (row + x) + 1] = (uint16_t)clamp_sparkle(glimmer);
         }
         if (pixels < stride) {
-            memset(&next[row + pixels], 0, (size_t)(stride - pixels) * sizeof(float));
-            memset(&sparkle[row + pixels], 0, (size_t)(stride - pixels) * sizeof(float));
+            memset(&nxt[2 * (row + pixels)], 0, (size_t)(stride - pixels) * 2 * sizeof(uint16_t));
         }
     }
 
-    st->scratch = current;
-    st->fracture = next;
-    current = st->fracture;
-
-    const float weight_norm = 2.0f / (float)(layers * (layers + 1));
-
+    st->cells = nxt;
+    st->cells_next = cur;
+    cur = st->cells;
+
+    // Roll the column sums forward: the previous reduction becomes the lerp
+    // source and the fresh field is reduced into the current slot. The
+    // weighted sums stay well inside a uint32 (410 * 256 * 257 / 2).
+    uint16_t* frac_prev = st->col_fracture;
+    uint16_t* frac_cur = st->col_fracture + stride;
+    uint16_t* spark_prev = st->col_sparkle;
+    uint16_t* spark_cur = st->col_sparkle + stride;
+    memcpy(frac_prev, frac_cur, (size_t)pixels * sizeof(uint16_t));
+    memcpy(spark_prev, spark_cur, (size_t)pixels * sizeof(uint16_t));
+
+    const uint32_t weight_denom = (uint32_t)layers * (uint32_t)(layers + 1) / 2;
     for (int x = 0; x < pixels; ++x) {
-        float fracture_sum = 0.0f;
-        float sparkle_sum = 0.0f;
+        uint32_t fracture_sum = 0;
+        uint32_t sparkle_sum = 0;
         for (int y = 0; y < layers; ++y) {
-            float weight = (float)(y + 1);
-            fracture_sum += current[y * stride + x] * weight;
-            sparkle_sum += st->sparkle[y * stride + x] * weight;
+            uint32_t weight = (uint32_t)(y + 1);
+            int idx = 2 * (y * stride + x);
+            fracture_sum += (uint32_t)cur[idx] * weight;
+            sparkle_sum += (uint32_t)cur[idx + 1] * weight;
         }
-        float crack_strength = clampf(fracture_sum * weight_norm * 1.45f, 0.0f, 1.0f);
-        float shimmer_strength = clampf(sparkle_sum * weight_norm * 1.20f, 0.0f, 1.0f);
+        frac_cur[x] = (uint16_t)(fracture_sum / weight_denom);
+        spark_cur[x] = (uint16_t)(sparkle_sum / weight_denom);
+    }
+}
 
-        float frost = clampf(powf(crack_strength, 1.25f), 0.0f, 1.0f);
-        float glint = clampf(powf(shimmer_strength, 0.95f), 0.0f, 1.0f);
+void WS_RENDER_ATTR black_ice_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
+    if (pixels <= 0) return;
+    if (strip < 0 || strip >= BLACK_ICE_MAX_STRIPS) return;
+
+    black_ice_state_t* st = &s_black_ice[strip];
+    if (!ensure_capacity(st, pixels)) return;
+
+    if (st->layers <= 0) return;
+
+    if (!st->params_set) {
+        set_default_palette(st);
+    }
 
-        float r = st->base[0] + (st->fracture_colour[0] - st->base[0]) * frost;
-        float g = st->base[1] + (st->fracture_colour[1] - st->base[1]) * frost;
-        float b = st->base[2] + (st->fracture_colour[2] - st->base[2]) * frost;
+    if (!st->seeded) {
+        seed_fields(st);
+    }
 
-        r += (st->sparkle_colour[0] - r) * glint;
-        g += (st->sparkle_colour[1] - g) * glint;
-        b += (st->sparkle_colour[2] - b) * glint;
+    bool sim_frame = (st->sim_phase == 0);
+    st->sim_phase ^= 1;
+    if (sim_frame) {
+        black_ice_step(st, pixels, frame_idx);
+    } else {
+        // The frame just timed by the engine ran the field step above.
+        govern_layers(st, strip);
+    }
 
-        float pulse = sinf((float)frame_idx * 0.007f + (float)x * 0.021f);
-        float brightness = 0.22f + frost * (0.45f + 0.25f * shimmer) +
-                           glint * (0.35f + 0.40f * shimmer) + pulse * 0.04f;
-        brightness *= 0.85f + 0.15f * shimmer;
-        brightness = clampf(brightness, 0.06f, 1.25f);
+    // Sim frames show the midpoint of the last two field states, off frames
+    // the newest one, so the texture advances in even half-steps. Q8.8
+    // throughout – the shimmer gains were baked at param time and the frost/
+    // glint curves come from the power tables.
+    const uint16_t* frac_prev = st->col_fracture;
+    const uint16_t* frac_cur = st->col_fracture + st->capacity;
+    const uint16_t* spark_prev = st->col_sparkle;
+    const uint16_t* spark_cur = st->col_sparkle + st->capacity;
+    int alpha = sim_frame ? 128 : 256;
+    // frame * 0.007 + x * 0.021 radians as 16-bit turns.
+    uint16_t pulse_base = (uint16_t)((uint32_t)frame_idx * 73u);
 
-        frame_rgb[3 * x + 0] = (uint8_t)(clampf(r * brightness, 0.0f, 1.0f) * 255.0f + 0.5f);
-        frame_rgb[3 * x + 1] = (uint8_t)(clampf(g * brightness, 0.0f, 1.0f) * 255.0f + 0.5f);
-        frame_rgb[3 * x + 2] = (uint8_t)(clampf(b * brightness, 0.0f, 1.0f) * 255.0f + 0.5f);
+    for (int x = 0; x < pixels; ++x) {
+        int frac_q = (int)frac_prev[x] + ((((int)frac_cur[x] - (int)frac_prev[x]) * alpha) >> 8);
+        int spark_q = (int)spark_prev[x] + ((((int)spark_cur[x] - (int)spark_prev[x]) * alpha) >> 8);
+        int crack = (frac_q * 371) >> 8;  // * 1.45
+        if (crack > BLACK_ICE_ONE) crack = BLACK_ICE_ONE;
+        int shimmer_q = (spark_q * 307) >> 8;  // * 1.20
+        if (shimmer_q > BLACK_ICE_ONE) shimmer_q = BLACK_ICE_ONE;
+
+        int frost = s_frost_lut[crack];
+        int glint = s_glint_lut[shimmer_q];
+
+        int pulse = (int)ul_sin16((uint16_t)(pulse_base + (uint32_t)x * 219u)) >> 7; // +/- 256
+        // 0.22 base, pulse * 0.04, clamped to the old 0.06..1.25 window.
+        int brightness = 56 + ((frost * st->frost_gain_q) >> 8) +
+                         ((glint * st->glint_gain_q) >> 8) + ((pulse * 10) >> 8);
+        brightness = (brightness * st->bright_mult_q) >> 8;
+        if (brightness < 15) brightness = 15;
+        if (brightness > 320) brightness = 320;
+
+        for (int c = 0; c < 3; ++c) {
+            int v = st->base[c] + ((((int)st->fracture_colour[c] - (int)st->base[c]) * frost) >> 8);
+            v += (((int)st->sparkle_colour[c] - v) * glint) >> 8;
+            v = (v * brightness) >> 8;
+            if (v < 0) v = 0;
+            if (v > 255) v = 255;
+            frame_rgb[3 * x + c] = (uint8_t)v;
+        }
     }
 }
 
 #endif
-
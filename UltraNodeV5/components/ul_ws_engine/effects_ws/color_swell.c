@@ -72,9 +72,8 @@ void color_swell_apply_params(int strip, const cJSON* params) {
     s_color[strip][2] = read_color_component(cJSON_GetArrayItem(params, 2), s_color[strip][2]);
 }
 
-void color_swell_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
+void WS_RENDER_ATTR color_swell_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
     ensure_initialized();
-    int strip = ul_ws_effect_current_strip();
     if (!valid_strip(strip)) return;
 
     int value = compute_brightness_for_frame(frame_idx);
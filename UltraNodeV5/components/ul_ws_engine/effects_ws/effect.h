@@ -1,5 +1,17 @@
 #pragma once
+#include <stdbool.h>
 #include <stdint.h>
+#include "sdkconfig.h"
+
+// Render code runs every frame between RMT transmissions; a flash-cache miss
+// there stalls the pixel clock. CONFIG_UL_WS_RENDER_IRAM pins the hot render
+// paths in IRAM so they never fault against concurrent flash access.
+#if CONFIG_UL_WS_RENDER_IRAM
+#include "esp_attr.h"
+#define WS_RENDER_ATTR IRAM_ATTR
+#else
+#define WS_RENDER_ATTR
+#endif
 
 typedef struct cJSON cJSON;
 
@@ -12,9 +24,29 @@ typedef struct {
     const char* name;
     ws_effect_tier_t tier;
     void (*init)(void);
-    void (*render)(uint8_t* frame_rgb, int pixels, int frame_idx);
+    // strip is the rendering strip's index; effects address their per-strip
+    // state with it directly, so concurrent renders of different strips
+    // never share anything.
+    void (*render)(int strip, uint8_t* frame_rgb, int pixels, int frame_idx);
+    // Decode the cJSON array once into per-strip packed state (colours as
+    // bytes or premultiplied fixed-point, speeds as phase increments).
+    // render() consumes that state directly and must never touch cJSON or
+    // convert floats in its hot path.
     void (*apply_params)(int strip, const cJSON* params);
+    // Frames per full cycle when the effect is a strictly periodic function
+    // of frame_idx (lets the engine bake one cycle and replay it). NULL for
+    // aperiodic or stateful effects.
+    int (*period)(int strip);
+    // Optional. Frames after frame_idx until the rendered output can next
+    // differ. Duty-cycled and slow effects report their quiet gaps here so
+    // the engine holds the last frame and skips the renders and refreshes in
+    // between. Return 1 (or leave NULL) to render every frame.
+    int (*next_change)(int strip, int frame_idx);
+    // Effects whose look lives in single-pixel features (sparkles, embers)
+    // set this to opt out of the strip's render scale; the engine then always
+    // hands them the full pixel count. Gradient-dominated effects leave it
+    // false and survive a 2x/4x upsample with no visible change.
+    bool full_res;
 } ws_effect_t;
 
 const ws_effect_t* ul_ws_get_effects(int* count);
-int ul_ws_effect_current_strip(void);
@@ -3,6 +3,7 @@
 #if CONFIG_UL_WS0_ENABLED || CONFIG_UL_WS1_ENABLED
 
 #include "effect.h"
+#include "psram_arena.h"
 #include "ul_ws_engine.h"
 #include "cJSON.h"
 #include "esp_heap_caps.h"
@@ -14,32 +15,65 @@
 #define FIRE_LAYERS 64
 #define FIRE_DEFAULT_INTENSITY 1.2f
 
+// Q8.8 fixed point: 256 represents a heat of 1.0. The simulation used to run
+// on float fields, which doubled the memory footprint and leaned on the FPU
+// (powf per pixel) — unusable on the S2/C3 targets with weak or no hardware
+// float. All inner loops below are integer-only; float survives only in the
+// once-per-frame scalar setup and the one-time pow LUT build.
+#define FIRE_ONE 256
+
 // Two-colour fire simulation backed by a large 2D heat field stored in PSRAM.
-// Each strip keeps a FIRE_LAYERS x pixels grid of floating-point heat values
-// which are advected upwards every frame.  The dense grid smooths the
-// animation and creates the appearance of embers drifting through the flame.
-// The ESP32's external PSRAM allows us to keep this state for up to two strips
-// without exhausting internal memory.
+// Each strip keeps a FIRE_LAYERS x pixels grid of Q8.8 heat values which are
+// advected upwards every frame.  The dense grid smooths the animation and
+// creates the appearance of embers drifting through the flame.  The ESP32's
+// external PSRAM allows us to keep this state for up to two strips without
+// exhausting internal memory.
+//
+// The field is only advected on every second frame. The layer-weighted column
+// reduction is linear in the cell values, so interpolating the per-column
+// sums of the two most recent field states is identical to interpolating the
+// fields themselves; frames in between just lerp those sums, which halves the
+// dominant cost (advection + reduction) at the full display rate.
 
 typedef struct {
-    float intensity;           // overall flame energy multiplier
-    float primary[3];          // hot colour (1.0 = full channel)
-    float secondary[3];        // cool colour
-    float* grid;               // current heat field (FIRE_LAYERS * capacity)
-    float* scratch;            // next heat field (same size)
+    float intensity;           // overall flame energy multiplier (raw param)
+    // Q8.8 scalars baked from intensity when params change so the render
+    // path never converts floats.
+    int intensity_q;
+    int intensity_norm_q;
+    int cooling_q;
+    int jitter_q;
+    uint8_t primary[3];        // hot colour (255 = full channel)
+    uint8_t secondary[3];      // cool colour
+    uint16_t* grid;            // current heat field (FIRE_LAYERS * capacity)
+    uint16_t* scratch;         // next heat field (same size)
+    uint16_t* col_heat;        // prev + current per-column heat (2 * capacity)
+    uint16_t* col_tip;         // prev + current top-row heat (2 * capacity)
     int capacity;              // number of columns allocated in the field
+    bool from_arena;           // fields borrowed from the PSRAM arena
     bool params_set;           // whether custom parameters have been applied
+    uint8_t sim_phase;         // 0 = advance the field on this frame
     uint32_t rng;              // per-strip random generator state
 } fire_state_t;
 
 static fire_state_t s_fire[FIRE_MAX_STRIPS];
 
+// powf(heat, 0.85) mapped through a 256-entry Q8.8 table, built once.
+static uint16_t s_pow_lut[256];
+static bool s_pow_lut_ready = false;
+
 static inline float clampf(float v, float lo, float hi) {
     if (v < lo) return lo;
     if (v > hi) return hi;
     return v;
 }
 
+static inline int clampq(int v) {
+    if (v < 0) return 0;
+    if (v > FIRE_ONE) return FIRE_ONE;
+    return v;
+}
+
 static uint32_t xorshift32(uint32_t* state) {
     uint32_t x = *state;
     if (x == 0) x = 0x12345678u;  // avoid the zero lock-up state
@@ -50,14 +84,15 @@ static uint32_t xorshift32(uint32_t* state) {
     return x;
 }
 
-static float frand(uint32_t* state) {
-    return (xorshift32(state) >> 8) * (1.0f / 16777216.0f);
+// Centered Q8.8 noise in [-256, 255], i.e. roughly [-1.0, 1.0).
+static inline int noiseq(uint32_t* state) {
+    return (int)(xorshift32(state) & 0x1FF) - 256;
 }
 
-static float* fire_alloc_cells(size_t cells) {
-    float* ptr = heap_caps_calloc(cells, sizeof(float), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+static uint16_t* fire_alloc_cells(size_t cells) {
+    uint16_t* ptr = heap_caps_calloc(cells, sizeof(uint16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
     if (!ptr) {
-        ptr = heap_caps_calloc(cells, sizeof(float), MALLOC_CAP_8BIT);
+        ptr = heap_caps_calloc(cells, sizeof(uint16_t), MALLOC_CAP_8BIT);
     }
     return ptr;
 }
@@ -66,34 +101,79 @@ static bool ensure_capacity(fire_state_t* st, int width) {
     if (width <= 0) {
         return false;
     }
-    if (width <= st->capacity && st->grid && st->scratch) {
+    int strip = (int)(st - s_fire);
+    if (width <= st->capacity && st->grid && st->scratch &&
+        (!st->from_arena || ul_ws_psram_arena_owned(strip, st))) {
         return true;
     }
     size_t cells = (size_t)width * FIRE_LAYERS;
-    float* new_grid = fire_alloc_cells(cells);
-    float* new_scratch = fire_alloc_cells(cells);
-    if (!new_grid || !new_scratch) {
-        if (new_grid) heap_caps_free(new_grid);
-        if (new_scratch) heap_caps_free(new_scratch);
+    // Field buffers come from the shared PSRAM arena so restarts and effect
+    // switches are allocation-free; the heap is only a fallback when no
+    // region was reserved.
+    ul_ws_psram_arena_claim(strip, st);
+    uint16_t* new_grid = ul_ws_psram_arena_take(strip, st, cells * sizeof(uint16_t));
+    uint16_t* new_scratch = new_grid
+        ? ul_ws_psram_arena_take(strip, st, cells * sizeof(uint16_t)) : NULL;
+    bool from_arena = (new_grid && new_scratch);
+    if (!from_arena) {
+        new_grid = fire_alloc_cells(cells);
+        new_scratch = fire_alloc_cells(cells);
+    }
+    // Per-column snapshots are tiny and read every frame – keep them internal.
+    uint16_t* new_heat = heap_caps_calloc((size_t)width * 2, sizeof(uint16_t), MALLOC_CAP_8BIT);
+    uint16_t* new_tip = heap_caps_calloc((size_t)width * 2, sizeof(uint16_t), MALLOC_CAP_8BIT);
+    if (!new_grid || !new_scratch || !new_heat || !new_tip) {
+        if (!from_arena) {
+            if (new_grid) heap_caps_free(new_grid);
+            if (new_scratch) heap_caps_free(new_scratch);
+        }
+        if (new_heat) heap_caps_free(new_heat);
+        if (new_tip) heap_caps_free(new_tip);
         return false;
     }
-    if (st->grid) heap_caps_free(st->grid);
-    if (st->scratch) heap_caps_free(st->scratch);
+    if (!st->from_arena) {
+        if (st->grid) heap_caps_free(st->grid);
+        if (st->scratch) heap_caps_free(st->scratch);
+    }
+    if (st->col_heat) heap_caps_free(st->col_heat);
+    if (st->col_tip) heap_caps_free(st->col_tip);
     st->grid = new_grid;
     st->scratch = new_scratch;
+    st->col_heat = new_heat;
+    st->col_tip = new_tip;
     st->capacity = width;
+    st->from_arena = from_arena;
+    st->sim_phase = 0;
     return true;
 }
 
+// Fold the float intensity into the Q8.8 scalars the simulation consumes.
+static void bake_params(fire_state_t* st) {
+    float intensity = st->intensity;
+    if (intensity < 0.0f) intensity = 0.0f;
+    float intensity_norm = clampf(intensity, 0.0f, 4.0f);
+    st->intensity_q = (int)(intensity * (float)FIRE_ONE + 0.5f);
+    st->intensity_norm_q = (int)(intensity_norm * (float)FIRE_ONE + 0.5f);
+    st->cooling_q = (int)((0.010f + 0.035f / (1.0f + intensity_norm * 1.6f)) * (float)FIRE_ONE + 0.5f);
+    st->jitter_q = (int)((0.018f + 0.010f / (1.0f + intensity_norm)) * (float)FIRE_ONE + 0.5f);
+}
+
 static void set_default_palette(fire_state_t* st) {
     // Warm default reminiscent of a camp fire – deep red core fading to amber.
     st->intensity = FIRE_DEFAULT_INTENSITY;
-    st->primary[0] = 1.0f;   st->primary[1] = 0.25f; st->primary[2] = 0.0f;   // #ff4000
-    st->secondary[0] = 1.0f; st->secondary[1] = 0.85f; st->secondary[2] = 0.4f; // #ffd966
+    st->primary[0] = 255; st->primary[1] = 64;  st->primary[2] = 0;     // #ff4000
+    st->secondary[0] = 255; st->secondary[1] = 217; st->secondary[2] = 102; // #ffd966
     st->params_set = false;
+    bake_params(st);
 }
 
 void fire_init(void) {
+    if (!s_pow_lut_ready) {
+        for (int i = 0; i < 256; ++i) {
+            s_pow_lut[i] = (uint16_t)(powf((float)i / 255.0f, 0.85f) * (float)FIRE_ONE + 0.5f);
+        }
+        s_pow_lut_ready = true;
+    }
     for (int i = 0; i < FIRE_MAX_STRIPS; ++i) {
         fire_state_t* st = &s_fire[i];
         if (!st->params_set) {
@@ -102,20 +182,38 @@ void fire_init(void) {
         if (st->rng == 0) {
             st->rng = 0x9E3779B9u * (uint32_t)(i + 1);
         }
+        if (st->from_arena && !ul_ws_psram_arena_owned(i, st)) {
+            // Another effect claimed the arena region since we last ran;
+            // the cached pointers are stale. render() re-borrows.
+            st->grid = NULL;
+            st->scratch = NULL;
+            st->capacity = 0;
+            st->from_arena = false;
+        }
         if (st->grid && st->capacity > 0) {
-            memset(st->grid, 0, (size_t)st->capacity * FIRE_LAYERS * sizeof(float));
+            memset(st->grid, 0, (size_t)st->capacity * FIRE_LAYERS * sizeof(uint16_t));
         }
         if (st->scratch && st->capacity > 0) {
-            memset(st->scratch, 0, (size_t)st->capacity * FIRE_LAYERS * sizeof(float));
+            memset(st->scratch, 0, (size_t)st->capacity * FIRE_LAYERS * sizeof(uint16_t));
+        }
+        if (st->col_heat && st->capacity > 0) {
+            memset(st->col_heat, 0, (size_t)st->capacity * 2 * sizeof(uint16_t));
+        }
+        if (st->col_tip && st->capacity > 0) {
+            memset(st->col_tip, 0, (size_t)st->capacity * 2 * sizeof(uint16_t));
         }
+        st->sim_phase = 0;
     }
 }
 
-static void apply_colour_params(float dest[3], const cJSON* params, int start_idx) {
+static void apply_colour_params(uint8_t dest[3], const cJSON* params, int start_idx) {
     for (int i = 0; i < 3; ++i) {
         const cJSON* item = cJSON_GetArrayItem(params, start_idx + i);
         if (item && cJSON_IsNumber(item)) {
-            dest[i] = clampf((float)item->valuedouble / 255.0f, 0.0f, 1.0f);
+            int v = item->valueint;
+            if (v < 0) v = 0;
+            if (v > 255) v = 255;
+            dest[i] = (uint8_t)v;
         }
     }
 }
@@ -140,95 +238,125 @@ void fire_apply_params(int strip, const cJSON* params) {
     apply_colour_params(st->primary, params, 1);
     apply_colour_params(st->secondary, params, 4);
     st->params_set = true;
+    bake_params(st);
 }
 
-void fire_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
+void WS_RENDER_ATTR fire_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
     (void)frame_idx;
-    int strip = ul_ws_effect_current_strip();
     if (strip < 0 || strip >= FIRE_MAX_STRIPS) return;
 
     fire_state_t* st = &s_fire[strip];
     if (!ensure_capacity(st, pixels)) return;
 
-    float* current = st->grid;
-    float* next = st->scratch;
     int stride = st->capacity;
+    // Q8.8 scalars baked at param time; the loops below never touch float.
+    int intensity_q = st->intensity_q;
+    int intensity_norm_q = st->intensity_norm_q;
+
+    bool sim_frame = (st->sim_phase == 0);
+    st->sim_phase ^= 1;
+
+    if (sim_frame) {
+        uint16_t* current = st->grid;
+        uint16_t* next = st->scratch;
+
+        // Cool existing heat slightly each step with a random perturbation.
+        int cooling_q = st->cooling_q;
+        int jitter_q = st->jitter_q;
+        size_t active_cells = (size_t)pixels * FIRE_LAYERS;
+        for (size_t i = 0; i < active_cells; ++i) {
+            int offset = (noiseq(&st->rng) * jitter_q) >> 8;
+            int cooled = (int)current[i] - cooling_q - offset;
+            current[i] = (uint16_t)(cooled > 0 ? cooled : 0);
+        }
 
-    float intensity = st->intensity;
-    if (intensity < 0.0f) intensity = 0.0f;
-    float intensity_norm = clampf(intensity, 0.0f, 4.0f);
-
-    // Cool existing heat slightly each frame with a random perturbation.
-    float cooling = 0.010f + 0.035f / (1.0f + intensity_norm * 1.6f);
-    float jitter = 0.018f + 0.010f / (1.0f + intensity_norm);
-    size_t active_cells = (size_t)pixels * FIRE_LAYERS;
-    for (size_t i = 0; i < active_cells; ++i) {
-        float offset = (frand(&st->rng) - 0.5f) * jitter;
-        float cooled = current[i] - (cooling + offset);
-        current[i] = cooled > 0.0f ? cooled : 0.0f;
-    }
-
-    // Seed new heat at the base with flickering bursts.
-    for (int x = 0; x < pixels; ++x) {
-        float spark = frand(&st->rng);
-        float spark_energy = intensity * (0.55f + 0.45f * powf(spark, 3.0f));
-        float base = current[x] * 0.25f + spark_energy;
-        next[x] = clampf(base, 0.0f, 1.0f);
-    }
-
-    // Advect heat upwards with mild horizontal diffusion and turbulence.
-    for (int y = 1; y < FIRE_LAYERS; ++y) {
-        int row = y * stride;
-        int below = (y - 1) * stride;
-        int below2 = (y >= 2 ? (y - 2) * stride : below);
+        // Seed new heat at the base with flickering bursts.
         for (int x = 0; x < pixels; ++x) {
-            int left = (x == 0) ? pixels - 1 : x - 1;
-            int right = (x == pixels - 1) ? 0 : x + 1;
-            float advect = current[below + x] * 0.54f;
-            advect += (current[below + left] + current[below + right]) * 0.22f;
-            advect += current[below2 + x] * 0.08f;
-            advect += (frand(&st->rng) - 0.5f) * 0.06f;
-            next[row + x] = clampf(advect, 0.0f, 1.0f);
+            int spark = (int)(xorshift32(&st->rng) >> 24); // Q8.8 fraction, 0..255
+            int spark3 = (((spark * spark) >> 8) * spark) >> 8;
+            // 0.55 + 0.45 * spark^3, scaled by intensity.
+            int spark_energy = (intensity_q * (141 + ((115 * spark3) >> 8))) >> 8;
+            int base = ((int)current[x] >> 2) + spark_energy;
+            next[x] = (uint16_t)clampq(base);
+        }
+
+        // Advect heat upwards with mild horizontal diffusion and turbulence.
+        for (int y = 1; y < FIRE_LAYERS; ++y) {
+            int row = y * stride;
+            int below = (y - 1) * stride;
+            int below2 = (y >= 2 ? (y - 2) * stride : below);
+            for (int x = 0; x < pixels; ++x) {
+                int left = (x == 0) ? pixels - 1 : x - 1;
+                int right = (x == pixels - 1) ? 0 : x + 1;
+                // The 0.54 / 0.22 / 0.08 float kernel in Q8.8: 138, 56, 20.
+                int advect = (int)current[below + x] * 138;
+                advect += ((int)current[below + left] + (int)current[below + right]) * 56;
+                advect += (int)current[below2 + x] * 20;
+                advect >>= 8;
+                advect += (noiseq(&st->rng) * 15) >> 8; // +/- 0.06 turbulence
+                next[row + x] = (uint16_t)clampq(advect);
+            }
+            if (pixels < stride) {
+                memset(&next[row + pixels], 0, (size_t)(stride - pixels) * sizeof(uint16_t));
+            }
         }
+
+        // Zero any unused columns in the bottom row as well.
         if (pixels < stride) {
-            memset(&next[row + pixels], 0, (size_t)(stride - pixels) * sizeof(float));
+            memset(&next[pixels], 0, (size_t)(stride - pixels) * sizeof(uint16_t));
         }
-    }
 
-    // Zero any unused columns in the bottom row as well.
-    if (pixels < stride) {
-        memset(&next[pixels], 0, (size_t)(stride - pixels) * sizeof(float));
+        // Swap buffers – next becomes current for the next step.
+        st->scratch = current;
+        st->grid = next;
+        current = st->grid;
+
+        // Reduce the new field into per-column sums, keeping the previous
+        // reduction around so in-between frames can interpolate. The
+        // layer-weighted sum stays well inside a uint32 (256 * 64 * 65 / 2).
+        uint16_t* heat_prev = st->col_heat;
+        uint16_t* heat_cur = st->col_heat + stride;
+        uint16_t* tip_prev = st->col_tip;
+        uint16_t* tip_cur = st->col_tip + stride;
+        memcpy(heat_prev, heat_cur, (size_t)pixels * sizeof(uint16_t));
+        memcpy(tip_prev, tip_cur, (size_t)pixels * sizeof(uint16_t));
+        const int top_row = (FIRE_LAYERS - 1) * stride;
+        const int weight_denom = FIRE_LAYERS * (FIRE_LAYERS + 1) / 2;
+        for (int x = 0; x < pixels; ++x) {
+            uint32_t weighted = 0;
+            for (int y = 0; y < FIRE_LAYERS; ++y) {
+                weighted += (uint32_t)current[y * stride + x] * (uint32_t)(y + 1);
+            }
+            heat_cur[x] = (uint16_t)clampq((int)(weighted / (uint32_t)weight_denom));
+            tip_cur[x] = current[top_row + x];
+        }
     }
 
-    // Swap buffers – next becomes current for the next frame.
-    st->scratch = current;
-    st->grid = next;
-    current = st->grid;
-
-    // Convert heat map into colours for each LED.
-    const float weight_norm = 2.0f / (float)(FIRE_LAYERS * (FIRE_LAYERS + 1));
-    const int top_row = (FIRE_LAYERS - 1) * stride;
+    // Convert the column sums into colours for each LED. Sim frames show the
+    // midpoint of the last two field states, off frames the newest one, so the
+    // display advances in even half-steps at the full frame rate.
+    const uint16_t* heat_prev = st->col_heat;
+    const uint16_t* heat_cur = st->col_heat + stride;
+    const uint16_t* tip_prev = st->col_tip;
+    const uint16_t* tip_cur = st->col_tip + stride;
+    int alpha = sim_frame ? 128 : 256;
     for (int x = 0; x < pixels; ++x) {
-        float weighted = 0.0f;
-        for (int y = 0; y < FIRE_LAYERS; ++y) {
-            weighted += current[y * stride + x] * (float)(y + 1);
-        }
-        float heat = clampf(weighted * weight_norm, 0.0f, 1.0f);
-        float tip = current[top_row + x];
-        float brightness = clampf(heat * (0.65f + 0.25f * intensity_norm) + tip * 0.30f, 0.0f, 1.0f);
-        float mix = clampf(powf(heat, 0.85f), 0.0f, 1.0f);
-
-        float r = st->secondary[0] + (st->primary[0] - st->secondary[0]) * mix;
-        float g = st->secondary[1] + (st->primary[1] - st->secondary[1]) * mix;
-        float b = st->secondary[2] + (st->primary[2] - st->secondary[2]) * mix;
-
-        r = clampf(r * brightness, 0.0f, 1.0f);
-        g = clampf(g * brightness, 0.0f, 1.0f);
-        b = clampf(b * brightness, 0.0f, 1.0f);
-
-        frame_rgb[3 * x + 0] = (uint8_t)(r * 255.0f + 0.5f);
-        frame_rgb[3 * x + 1] = (uint8_t)(g * 255.0f + 0.5f);
-        frame_rgb[3 * x + 2] = (uint8_t)(b * 255.0f + 0.5f);
+        int heat_q = (int)heat_prev[x] + ((((int)heat_cur[x] - (int)heat_prev[x]) * alpha) >> 8);
+        int tip_q = (int)tip_prev[x] + ((((int)tip_cur[x] - (int)tip_prev[x]) * alpha) >> 8);
+        // Brightness: heat * (0.65 + 0.25 * intensity_norm) + 0.30 * tip.
+        int brightness_q = (heat_q * (166 + ((64 * intensity_norm_q) >> 8))) >> 8;
+        brightness_q = clampq(brightness_q + ((tip_q * 77) >> 8));
+        int mix_q = s_pow_lut[heat_q > 255 ? 255 : heat_q];
+
+        for (int c = 0; c < 3; ++c) {
+            int prim = st->primary[c];
+            int sec = st->secondary[c];
+            int v = sec + (((prim - sec) * mix_q) >> 8);
+            v = (v * brightness_q) >> 8;
+            if (v < 0) v = 0;
+            if (v > 255) v = 255;
+            frame_rgb[3 * x + c] = (uint8_t)v;
+        }
     }
 }
 
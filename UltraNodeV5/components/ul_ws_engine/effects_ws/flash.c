@@ -20,8 +20,14 @@ void flash_apply_params(int strip, const cJSON* params) {
     }
 }
 
-void flash_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
-    int strip = ul_ws_effect_current_strip();
+// The colour only flips every 10 frames; report the remainder of the current
+// phase so the engine holds the frame and skips the renders in between.
+int flash_next_change(int strip, int frame_idx) {
+    (void)strip;
+    return 10 - (frame_idx % 10);
+}
+
+void WS_RENDER_ATTR flash_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
     uint8_t* c = ((frame_idx / 10) % 2) ? s_color2[strip] : s_color1[strip];
     for (int i = 0; i < pixels; ++i) {
         frame_rgb[3*i+0] = c[0];
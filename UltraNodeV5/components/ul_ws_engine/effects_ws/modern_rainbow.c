@@ -4,37 +4,28 @@
 
 #include "effect.h"
 #include "ul_ws_engine.h"
+#include "ul_common_effects.h"
 
-static void hsv_to_rgb(uint8_t h, uint8_t *r, uint8_t *g, uint8_t *b) {
-    uint8_t region = h / 43;
-    uint8_t remainder = (h - region * 43) * 6;
-
-    uint8_t v = 255;
-    uint8_t p = 0;
-    uint8_t q = (uint8_t)(255 - ((uint16_t)remainder * 255 >> 8));
-    uint8_t t = (uint8_t)((uint16_t)remainder * 255 >> 8);
+void modern_rainbow_init(void) { }
 
-    switch (region) {
-        case 0: *r = v; *g = t; *b = p; break;
-        case 1: *r = q; *g = v; *b = p; break;
-        case 2: *r = p; *g = v; *b = t; break;
-        case 3: *r = p; *g = q; *b = v; break;
-        case 4: *r = t; *g = p; *b = v; break;
-        default: *r = v; *g = p; *b = q; break;
-    }
+// hue advances one step per frame and wraps at 256, so the animation repeats
+// every 256 frames regardless of pixel count.
+int modern_rainbow_period(int strip) {
+    (void)strip;
+    return 256;
 }
 
-void modern_rainbow_init(void) { }
-
-void modern_rainbow_render(uint8_t *frame_rgb, int pixels, int frame_idx) {
+void WS_RENDER_ATTR modern_rainbow_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
+    (void)strip;
     const int cycle = 80;
     for (int i = 0; i < pixels; ++i) {
         uint8_t hue = (uint8_t)((i * 256 / cycle + frame_idx) & 0xFF);
-        uint8_t r, g, b;
-        hsv_to_rgb(hue, &r, &g, &b);
-        frame_rgb[3 * i + 0] = r;
-        frame_rgb[3 * i + 1] = g;
-        frame_rgb[3 * i + 2] = b;
+        // Shared baked HSV sweep: per-pixel work is the phase addition plus
+        // one table read.
+        const uint8_t* c = ul_hsv8(hue);
+        frame_rgb[3 * i + 0] = c[0];
+        frame_rgb[3 * i + 1] = c[1];
+        frame_rgb[3 * i + 2] = c[2];
     }
 }
 
@@ -0,0 +1,108 @@
+#include "sdkconfig.h"
+
+#if CONFIG_UL_WS0_ENABLED || CONFIG_UL_WS1_ENABLED
+
+#include "psram_arena.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <stdint.h>
+#include <string.h>
+
+static const char* TAG = "ul_ws";
+
+#define ARENA_STRIPS 2
+
+// Worst-case field bytes per pixel for each PSRAM-tier effect: two field
+// buffers of `layers` cells per column. Keep in sync with the layer and
+// buffer layout constants in fire.c (FIRE_LAYERS) and black_ice.c
+// (BLACK_ICE_DEFAULT_LAYERS, interleaved fracture+sparkle pairs).
+#if CONFIG_UL_WS_EFFECT_FIRE
+#define ARENA_FIRE_BYTES_PER_PIXEL (2 * 64 * sizeof(uint16_t))
+#else
+#define ARENA_FIRE_BYTES_PER_PIXEL 0
+#endif
+#if CONFIG_UL_WS_EFFECT_BLACK_ICE
+#define ARENA_BLACK_ICE_BYTES_PER_PIXEL (2 * 256 * 2 * sizeof(uint16_t))
+#else
+#define ARENA_BLACK_ICE_BYTES_PER_PIXEL 0
+#endif
+
+#define ARENA_BYTES_PER_PIXEL \
+    (ARENA_FIRE_BYTES_PER_PIXEL > ARENA_BLACK_ICE_BYTES_PER_PIXEL \
+         ? ARENA_FIRE_BYTES_PER_PIXEL : ARENA_BLACK_ICE_BYTES_PER_PIXEL)
+
+typedef struct {
+    uint8_t* base;      // NULL when no region was reserved
+    size_t size;
+    size_t used;
+    const void* owner;  // effect state currently borrowing from the region
+} arena_region_t;
+
+static arena_region_t s_regions[ARENA_STRIPS];
+
+static size_t region_bytes(int strip) {
+    int pixels = 0;
+#if CONFIG_UL_WS0_ENABLED
+    if (strip == 0) pixels = CONFIG_UL_WS0_PIXELS;
+#endif
+#if !CONFIG_UL_IS_ESP32C3 && CONFIG_UL_WS1_ENABLED
+    if (strip == 1) pixels = CONFIG_UL_WS1_PIXELS;
+#endif
+    return (size_t)pixels * ARENA_BYTES_PER_PIXEL;
+}
+
+void ul_ws_psram_arena_reserve(void) {
+    for (int i = 0; i < ARENA_STRIPS; ++i) {
+        arena_region_t* region = &s_regions[i];
+        if (region->base) continue;  // engine restart; keep the reservation
+        size_t bytes = region_bytes(i);
+        if (bytes == 0) continue;
+        region->base = heap_caps_calloc(bytes, 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!region->base) {
+            // Effects fall back to their own heap allocations.
+            ESP_LOGW(TAG, "No PSRAM for strip %d effect arena (%u bytes)",
+                     i, (unsigned)bytes);
+            continue;
+        }
+        region->size = bytes;
+        region->used = 0;
+        region->owner = NULL;
+    }
+}
+
+void ul_ws_psram_arena_release(void) {
+    for (int i = 0; i < ARENA_STRIPS; ++i) {
+        arena_region_t* region = &s_regions[i];
+        if (region->base) {
+            heap_caps_free(region->base);
+        }
+        memset(region, 0, sizeof(*region));
+    }
+}
+
+void ul_ws_psram_arena_claim(int strip, const void* owner) {
+    if (strip < 0 || strip >= ARENA_STRIPS) return;
+    arena_region_t* region = &s_regions[strip];
+    region->owner = owner;
+    region->used = 0;
+}
+
+void* ul_ws_psram_arena_take(int strip, const void* owner, size_t bytes) {
+    if (strip < 0 || strip >= ARENA_STRIPS) return NULL;
+    arena_region_t* region = &s_regions[strip];
+    if (!region->base || region->owner != owner) return NULL;
+    bytes = (bytes + 3) & ~(size_t)3;
+    if (bytes > region->size - region->used) return NULL;
+    uint8_t* ptr = region->base + region->used;
+    region->used += bytes;
+    memset(ptr, 0, bytes);
+    return ptr;
+}
+
+bool ul_ws_psram_arena_owned(int strip, const void* owner) {
+    if (strip < 0 || strip >= ARENA_STRIPS) return false;
+    const arena_region_t* region = &s_regions[strip];
+    return region->base && region->owner == owner;
+}
+
+#endif
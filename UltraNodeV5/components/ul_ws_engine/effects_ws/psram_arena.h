@@ -0,0 +1,39 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+// Fixed per-strip PSRAM arena for the PSRAM-tier effects (fire, black_ice).
+//
+// The effects used to heap_caps_calloc/free their field buffers whenever the
+// strip width changed or the effect restarted. Over weeks of uptime those
+// churn cycles fragment the PSRAM heap badly enough that a large calloc can
+// fail with plenty of total free PSRAM. The arena is reserved once at engine
+// start, sized for the worst-case field footprint of the largest enabled
+// PSRAM-tier effect at each strip's configured pixel count, and effects
+// borrow from it instead — effect switches never touch the heap again.
+//
+// Only strips 0 and 1 get a region; the RMT expansion strips never run
+// PSRAM-tier effects. If the reservation fails (or PSRAM is absent) every
+// call degrades to a no-op and the effects fall back to their old per-effect
+// heap allocations.
+
+// Reserve the arena regions. Called once from ul_ws_engine_start(); failure
+// is logged but non-fatal.
+void ul_ws_psram_arena_reserve(void);
+
+// Return the regions to the heap on engine shutdown.
+void ul_ws_psram_arena_release(void);
+
+// Claim the strip's region for `owner` (an effect's per-strip state pointer),
+// dropping any borrows the previous owner held.
+void ul_ws_psram_arena_claim(int strip, const void* owner);
+
+// Borrow `bytes` (zero-filled) from the strip's region. Returns NULL if the
+// arena is absent, the region is not currently owned by `owner`, or the
+// region is exhausted — callers then fall back to the heap.
+void* ul_ws_psram_arena_take(int strip, const void* owner, size_t bytes);
+
+// Whether `owner` still holds the strip's region. Effects check this before
+// reusing cached buffer pointers: another effect claiming the region
+// invalidates them without any callback.
+bool ul_ws_psram_arena_owned(int strip, const void* owner);
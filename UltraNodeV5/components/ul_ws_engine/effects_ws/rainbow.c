@@ -4,29 +4,11 @@
 
 #include "effect.h"
 #include "ul_ws_engine.h"
+#include "ul_common_effects.h"
 #include "cJSON.h"
 
 static int s_wavelength[2] = {32, 32};
 
-static void hue_to_rgb(uint8_t h, uint8_t* r, uint8_t* g, uint8_t* b) {
-    h = 255 - h;
-    if (h < 85) {
-        *r = 255 - h * 3;
-        *g = 0;
-        *b = h * 3;
-    } else if (h < 170) {
-        h -= 85;
-        *r = 0;
-        *g = h * 3;
-        *b = 255 - h * 3;
-    } else {
-        h -= 170;
-        *r = h * 3;
-        *g = 255 - h * 3;
-        *b = 0;
-    }
-}
-
 void rainbow_init(void) { }
 
 void rainbow_apply_params(int strip, const cJSON* params) {
@@ -37,18 +19,26 @@ void rainbow_apply_params(int strip, const cJSON* params) {
     s_wavelength[strip] = w;
 }
 
-void rainbow_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
-    int strip = ul_ws_effect_current_strip();
+// The pattern repeats every `wavelength` frames (frame_idx enters only via
+// `(i + frame_idx) % w`), so one wavelength's worth of frames is a full cycle.
+int rainbow_period(int strip) {
+    if (strip < 0 || strip > 1) return 0;
+    int w = s_wavelength[strip];
+    return w > 0 ? w : 1;
+}
+
+void WS_RENDER_ATTR rainbow_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
     int w = s_wavelength[strip];
     if (w <= 0) w = 1;
     for (int i = 0; i < pixels; ++i) {
         int pos = (i + frame_idx) % w;
         uint8_t hue = (uint8_t)((pos * 255) / w);
-        uint8_t r, g, b;
-        hue_to_rgb(hue, &r, &g, &b);
-        frame_rgb[3*i+0] = r;
-        frame_rgb[3*i+1] = g;
-        frame_rgb[3*i+2] = b;
+        // Shared baked wheel (the table folds in the historical phase
+        // inversion), so the per-pixel cost is the phase math plus one read.
+        const uint8_t* c = ul_wheel8(hue);
+        frame_rgb[3*i+0] = c[0];
+        frame_rgb[3*i+1] = c[1];
+        frame_rgb[3*i+2] = c[2];
     }
 }
 
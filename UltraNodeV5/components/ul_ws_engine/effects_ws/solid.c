@@ -19,9 +19,8 @@ void solid_apply_params(int strip, const cJSON* params) {
     ul_ws_set_solid_rgb(strip, r, g, b);
 }
 
-void solid_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
+void WS_RENDER_ATTR solid_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
     (void)frame_idx;
-    int strip = ul_ws_effect_current_strip();
     uint8_t r, g, b;
     ul_ws_get_solid_rgb(strip, &r, &g, &b);
     for (int i = 0; i < pixels; ++i) {
@@ -8,12 +8,8 @@
 #if CONFIG_UL_WS0_ENABLED || CONFIG_UL_WS1_ENABLED
 
 #include "effect.h"
+#include "ul_common_effects.h"
 #include "cJSON.h"
-#include <math.h>
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
 
 #define MAX_STRIPS 2
 #define NUM_WAVES 3
@@ -49,28 +45,33 @@ void spacewaves_apply_params(int strip, const cJSON* params) {
     }
 }
 
-void spacewaves_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
-    // Predefined wavelengths and temporal frequencies for each wave.
-    static const float wavelengths[NUM_WAVES] = {30.f, 45.f, 60.f};
-    static const float freqs[NUM_WAVES] = {0.20f, 0.15f, 0.10f};
+void WS_RENDER_ATTR spacewaves_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
+    // Predefined 30/45/60 pixel wavelengths and 0.20/0.15/0.10 cycles-per-
+    // frame speeds as 16-bit phase steps (65536 counts per period), so the
+    // pixel loop is ul_sin16() lookups and integer adds only.
+    static const uint16_t steps[NUM_WAVES] = {2185, 1456, 1092};
+    static const uint16_t freqs_q16[NUM_WAVES] = {13107, 9830, 6554};
 
-    int strip = ul_ws_effect_current_strip();
     if (strip < 0 || strip >= MAX_STRIPS) return;
 
+    uint16_t phase[NUM_WAVES];
+    for (int w = 0; w < NUM_WAVES; ++w) {
+        phase[w] = (uint16_t)((uint32_t)freqs_q16[w] * (uint32_t)frame_idx);
+    }
+
     for (int i = 0; i < pixels; ++i) {
-        float r = 0.f, g = 0.f, b = 0.f;
+        int r = 0, g = 0, b = 0;
         for (int w = 0; w < NUM_WAVES; ++w) {
             wave_cfg_t* cfg = &s_waves[strip][w];
-            float pos = (float)i / wavelengths[w];
-            float phase = 2.f * (float)M_PI * (pos + frame_idx * freqs[w]);
-            float intensity = (sinf(phase) + 1.f) * 0.5f; // 0..1
-            r += intensity * cfg->r;
-            g += intensity * cfg->g;
-            b += intensity * cfg->b;
+            uint32_t intensity = (uint32_t)((int)ul_sin16(phase[w]) + 32768); // 1..65535
+            r += (int)((intensity * cfg->r) >> 16);
+            g += (int)((intensity * cfg->g) >> 16);
+            b += (int)((intensity * cfg->b) >> 16);
+            phase[w] += steps[w];
         }
-        if (r > 255.f) r = 255.f;
-        if (g > 255.f) g = 255.f;
-        if (b > 255.f) b = 255.f;
+        if (r > 255) r = 255;
+        if (g > 255) g = 255;
+        if (b > 255) b = 255;
         frame_rgb[3*i + 0] = (uint8_t)r;
         frame_rgb[3*i + 1] = (uint8_t)g;
         frame_rgb[3*i + 2] = (uint8_t)b;
@@ -3,21 +3,22 @@
 #if CONFIG_UL_WS0_ENABLED || CONFIG_UL_WS1_ENABLED
 
 #include "effect.h"
+#include "ul_common_effects.h"
 #include "cJSON.h"
 #include <math.h>
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#include <stdbool.h>
 
 #define NUM_STRIPS 2
 
 #define NUM_WAVES 3
 
+// Params decoded once into phase increments (65536 counts per period) so the
+// render path is integer only.
 typedef struct {
     uint8_t r, g, b;
-    float wavelength;
-    float freq;
+    bool active;
+    uint16_t step;      // phase advance per pixel
+    uint32_t freq_q16;  // phase advance per frame
 } wave_cfg_t;
 
 static wave_cfg_t s_waves[NUM_STRIPS][NUM_WAVES];
@@ -31,32 +32,42 @@ void triple_wave_apply_params(int strip, const cJSON* params) {
     if (strip < 0 || strip >= NUM_STRIPS) return;
     if (!params || !cJSON_IsArray(params) || cJSON_GetArraySize(params) < NUM_WAVES * 5) return;
     for (int w = 0; w < NUM_WAVES; ++w) {
-        s_waves[strip][w].r = (uint8_t)cJSON_GetArrayItem(params, w*5 + 0)->valueint;
-        s_waves[strip][w].g = (uint8_t)cJSON_GetArrayItem(params, w*5 + 1)->valueint;
-        s_waves[strip][w].b = (uint8_t)cJSON_GetArrayItem(params, w*5 + 2)->valueint;
-        s_waves[strip][w].wavelength = (float)cJSON_GetArrayItem(params, w*5 + 3)->valuedouble;
-        s_waves[strip][w].freq = (float)cJSON_GetArrayItem(params, w*5 + 4)->valuedouble;
+        wave_cfg_t* cfg = &s_waves[strip][w];
+        cfg->r = (uint8_t)cJSON_GetArrayItem(params, w*5 + 0)->valueint;
+        cfg->g = (uint8_t)cJSON_GetArrayItem(params, w*5 + 1)->valueint;
+        cfg->b = (uint8_t)cJSON_GetArrayItem(params, w*5 + 2)->valueint;
+        float wavelength = (float)cJSON_GetArrayItem(params, w*5 + 3)->valuedouble;
+        float freq = (float)cJSON_GetArrayItem(params, w*5 + 4)->valuedouble;
+        cfg->active = wavelength > 0.0f;
+        cfg->step = cfg->active ? (uint16_t)(uint32_t)lroundf(65536.0f / wavelength) : 0;
+        cfg->freq_q16 = (uint32_t)(int32_t)lroundf(freq * 65536.0f);
     }
 }
 
-void triple_wave_render(uint8_t* frame_rgb, int pixels, int frame_idx) {
-    int strip = ul_ws_effect_current_strip();
+void WS_RENDER_ATTR triple_wave_render(int strip, uint8_t* frame_rgb, int pixels, int frame_idx) {
     if (strip < 0 || strip >= NUM_STRIPS) return;
+
+    // The per-pixel loop is ul_sin16() lookups and integer adds only; the
+    // phase increments were decoded from the params up front.
+    uint16_t phase[NUM_WAVES];
+    for (int w = 0; w < NUM_WAVES; ++w) {
+        phase[w] = (uint16_t)(s_waves[strip][w].freq_q16 * (uint32_t)frame_idx);
+    }
+
     for (int i = 0; i < pixels; ++i) {
-        float r = 0.0f, g = 0.0f, b = 0.0f;
+        int r = 0, g = 0, b = 0;
         for (int w = 0; w < NUM_WAVES; ++w) {
             wave_cfg_t* cfg = &s_waves[strip][w];
-            if (cfg->wavelength <= 0.0f) continue;
-            float pos = (float)i / cfg->wavelength;
-            float phase = 2.0f * (float)M_PI * (pos + frame_idx * cfg->freq);
-            float intensity = (sinf(phase) + 1.0f) * 0.5f; // 0..1
-            r += intensity * cfg->r;
-            g += intensity * cfg->g;
-            b += intensity * cfg->b;
+            if (!cfg->active) continue;
+            uint32_t intensity = (uint32_t)((int)ul_sin16(phase[w]) + 32768); // 1..65535
+            r += (int)((intensity * cfg->r) >> 16);
+            g += (int)((intensity * cfg->g) >> 16);
+            b += (int)((intensity * cfg->b) >> 16);
+            phase[w] += cfg->step;
         }
-        if (r > 255.0f) r = 255.0f;
-        if (g > 255.0f) g = 255.0f;
-        if (b > 255.0f) b = 255.0f;
+        if (r > 255) r = 255;
+        if (g > 255) g = 255;
+        if (b > 255) b = 255;
         frame_rgb[3*i]   = (uint8_t)r;
         frame_rgb[3*i+1] = (uint8_t)g;
         frame_rgb[3*i+2] = (uint8_t)b;
@@ -14,7 +14,14 @@ void ul_ws_apply_json(cJSON* root);
 bool ul_ws_set_effect(int strip, const char* name);     // returns true if found
 void ul_ws_set_solid_rgb(int strip, uint8_t r, uint8_t g, uint8_t b);
 void ul_ws_get_solid_rgb(int strip, uint8_t* r, uint8_t* g, uint8_t* b);
-void ul_ws_set_brightness(int strip, uint8_t bri);      // 0..255
+void ul_ws_set_brightness(int strip, uint8_t bri);      // 0..255; cancels a running ramp
+void ul_ws_set_brightness_ramp(int strip, uint8_t target, int duration_ms);
+void ul_ws_set_fps(int strip, int fps);                 // clamped; adaptive pacing may lower it
+// Change the live strip length in place (1..boot-time pixel count). Buffers
+// and the driver device are retained, so the change allocates nothing and
+// the strip never goes dark; shrinking blanks the abandoned tail. Returns
+// false for a disabled strip or an out-of-range length.
+bool ul_ws_set_pixels(int strip, int pixels);
 
 // Utility: convert "#RRGGBB" string to RGB components
 bool ul_ws_hex_to_rgb(const char* hex, uint8_t* r, uint8_t* g, uint8_t* b);
@@ -28,7 +35,42 @@ typedef struct {
     int gpio;
     int fps;
     uint8_t color[3]; // for solid
+    // Frame-time instrumentation since the current effect was selected
+    uint32_t render_us_min;
+    uint32_t render_us_avg;
+    uint32_t render_us_max;
+    uint32_t tx_us; // last transmit (driver push + refresh) duration
+    uint32_t overruns; // frames late by a full period since the effect started
+    uint32_t power_clamps; // frames scaled down by the power budget limiter
+    bool frames_internal; // frame buffers landed in internal DMA-capable RAM
+    int segments; // active segment count; 0 = whole strip runs one effect
+    uint8_t render_scale; // 1 = native; 2/4 = effects render at 1/N width
+    int max_pixels; // boot-time buffer size; upper bound for live "pixels" changes
+    bool mapped; // a logical->physical pixel map (ws/set "map") is active
+    bool rgbw; // SK6812 4-channel strip; white extracted in the LUT pass
 } ul_ws_strip_status_t;
 
 int ul_ws_get_strip_count(void);
 bool ul_ws_get_status(int strip, ul_ws_strip_status_t* out);
+
+// Render-load probe for effects that trade visual depth for frame time: the
+// strip's last measured render duration and the frame period it had to fit,
+// both in microseconds. Returns false for a disabled strip or before the
+// current effect's first frame has been timed.
+bool ul_ws_get_frame_load(int strip, uint32_t* render_us, uint32_t* period_us);
+
+// Per-effect result from ul_ws_benchmark()
+typedef struct {
+    char name[24];
+    uint32_t avg_us; // mean render time per frame
+    uint32_t max_us; // worst frame
+} ul_ws_benchmark_result_t;
+
+// Render every registered effect `frames` times into a scratch buffer at the
+// first enabled strip's real pixel count and time it, plus one timed
+// gamma/brightness pass (*lut_us). Runs on the caller's task; effects that
+// keep global state get re-init'd, so an effect live on a strip restarts
+// visually. Returns the number of results written, 0 when no strip is
+// enabled or the scratch buffer could not be allocated.
+int ul_ws_benchmark(int frames, ul_ws_benchmark_result_t* out, int max_results,
+                    int* pixels_out, uint32_t* lut_us_out);
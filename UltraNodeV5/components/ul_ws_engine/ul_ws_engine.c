@@ -7,8 +7,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-int ul_ws_effect_current_strip(void) { return -1; }
-
 bool ul_ws_engine_start(void) { return true; }
 
 void ul_ws_engine_stop(void) {}
@@ -40,6 +38,23 @@ void ul_ws_set_brightness(int strip, uint8_t bri) {
     (void)bri;
 }
 
+void ul_ws_set_brightness_ramp(int strip, uint8_t target, int duration_ms) {
+    (void)strip;
+    (void)target;
+    (void)duration_ms;
+}
+
+void ul_ws_set_fps(int strip, int fps) {
+    (void)strip;
+    (void)fps;
+}
+
+bool ul_ws_set_pixels(int strip, int pixels) {
+    (void)strip;
+    (void)pixels;
+    return false;
+}
+
 bool ul_ws_hex_to_rgb(const char* hex, uint8_t* r, uint8_t* g, uint8_t* b) {
     if (!hex || !r || !g || !b) return false;
     if (hex[0] == '#') hex++;
@@ -63,47 +78,278 @@ bool ul_ws_get_status(int strip, ul_ws_strip_status_t* out) {
     return false;
 }
 
+int ul_ws_benchmark(int frames, ul_ws_benchmark_result_t* out, int max_results,
+                    int* pixels_out, uint32_t* lut_us_out) {
+    (void)frames;
+    (void)out;
+    (void)max_results;
+    if (pixels_out) *pixels_out = 0;
+    if (lut_us_out) *lut_us_out = 0;
+    return 0;
+}
+
 #else
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
 #include "ul_task.h"
 #include "ul_core.h"
+#include "ul_health.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "led_strip.h"
 #include "led_strip_spi.h"
+#if CONFIG_UL_WS_RMT_EXPANSION
+#include "led_strip_rmt.h"
+#endif
 #include "led_strip_types.h"
 #include "driver/spi_master.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#if CONFIG_UL_WS_PHASE_LOCK
+#include <sys/time.h>
+#endif
+#if CONFIG_UL_WS_STREAM
+#include "lwip/sockets.h"
+#endif
 #include "cJSON.h"
 #include "effects_ws/effect.h"
+#include "effects_ws/psram_arena.h"
 #include "ul_common_effects.h"
+#include "ul_state.h"
 
 static const char* TAG = "ul_ws";
 
+// One physical strip can span several zones; segments render independent
+// effects into slices of the shared frame, so multi-zone runs keep a single
+// frame buffer, gamma pass and transmit.
+#define UL_WS_MAX_SEGMENTS 8
+
+typedef struct {
+    int offset;  // first pixel of the slice
+    int length;  // pixels in the slice
+    const ws_effect_t* eff;
+    uint8_t brightness; // scales the slice before the strip-wide LUT pass
+} ws_segment_t;
+
 typedef struct {
     const ws_effect_t* eff;
     uint8_t solid_r, solid_g, solid_b;
     uint8_t brightness; // 0..255
-    uint32_t frame_idx;
+    float frame_pos;
+    // pixels is the live strip length; buffers and the driver device are
+    // sized once to max_pixels (the Kconfig value), so ul_ws_set_pixels()
+    // re-bounds the render and transmit paths with no teardown, no
+    // allocation and no dark flash — commissioning tools can probe lengths
+    // interactively.
     int pixels;
+    int max_pixels;
+    // SK6812 RGBW strip: the driver runs a 4-component format and frame
+    // buffers hold 4 bytes per pixel. Effects still render packed RGB into
+    // the head of the frame; the gamma/brightness pass expands it in place,
+    // moving the shared min(r,g,b) to the white die (see apply_lut_rgbw).
+    bool rgbw;
+    // Render scale (1, 2 or 4): effects draw pixels/scale into the head of
+    // the frame and upsample_frame() expands them to the full strip, so long
+    // runs pay a fraction of the per-pixel effect math. Effects flagged
+    // full_res, and segment renders, stay at native resolution.
+    uint8_t render_scale;
     led_strip_handle_t handle;
-    uint8_t* frame; // rgb * pixels
+    // Double buffer: the render task fills `frame` (== frames[render_buf])
+    // while the previously completed frame is queued on the SPI driver, so
+    // rendering overlaps DMA transmission.
+    uint8_t* frames[2]; // rgb * pixels each
+    bool frames_internal; // both buffers sit in internal DMA-capable RAM
+    uint8_t* frame;     // current render target
+    int render_buf;
+    uint8_t* volatile tx_frame;   // completed frame awaiting transmit
+    volatile bool tx_pending;     // tx_frame queued; cleared by the completion callback
+    uint32_t last_tx_hash;        // hash of the last frame actually transmitted
+    bool last_tx_valid;
+    // Fused gamma+brightness table, rebuilt only when brightness changes, so
+    // the post-render pass is a single lookup per byte.
+    uint8_t lut[256];
+    // Pacing: target_fps is what was asked for (ws/set "fps" or the build
+    // default); current_fps backs off when frames overrun the transmit path
+    // and creeps back up once the strip keeps up again.
+    int target_fps;
+    int current_fps;
+    TickType_t next_due;
+    int clean_frames; // consecutive frames delivered without a drop
+    int skip_frames;  // effect-declared quiet gap after the rendered frame
+    // Frame-time instrumentation, reset whenever the effect changes, so the
+    // fleet dashboard can spot effects that blow the frame budget.
+    uint32_t render_us_min;
+    uint32_t render_us_max;
+    uint64_t render_us_sum;
+    uint32_t render_frames;
+    uint32_t render_us_last; // most recent frame; ul_ws_get_frame_load() reads it
+    uint32_t tx_us_last;
+    int64_t tx_start_us; // queue timestamp; the completion callback derives tx_us_last
+    uint32_t overruns; // wakeups missed by a full frame period or more
+    // Power budget: frames estimated to draw more than this are scaled down
+    // before transmit; 0 disables the limiter for the strip.
+    int power_budget_ma;
+    uint32_t power_clamps; // frames the limiter had to scale
+    // Baked frame-cycle ring (PSRAM builds): strictly periodic effects render
+    // their first full cycle once, after which per-frame work is a memcpy.
+    uint8_t* cycle_cache;
+    int cycle_period;
+    int cycle_filled;
+    bool cycle_ready;
+    // Segment table; segment_count == 0 means the whole strip runs s->eff.
+    ws_segment_t segments[UL_WS_MAX_SEGMENTS];
+    int segment_count;
+    // Installation geometry: strips mounted backwards, serpentine runs and
+    // dead ranges mean wire order rarely matches render order. pixel_map[i]
+    // is the physical index of logical pixel i; effects, segments and
+    // streamed frames all render logically and the frame-push step does one
+    // indexed copy into map_buf. NULL means identity -- no copy.
+    uint16_t* pixel_map;
+    int map_tx_pixels;  // physical extent to transmit (covers skipped gaps)
+    uint8_t* map_buf;   // physical-order staging buffer, max_pixels * 3
+    // Crossfade: on effect switch the outgoing effect keeps rendering into
+    // fade_buf and is mixed under the incoming frame with a fixed-point
+    // alpha ramp, so switches blend instead of popping.
+    const ws_effect_t* fade_eff;
+    float fade_pos;
+    int fade_frames_left;
+    int fade_frames_total;
+    uint8_t* fade_buf;
+    // Brightness ramp: while active, brightness is re-derived from wall time
+    // at the top of each render, so ramps are as smooth as the frame rate
+    // with no external stepping.
+    bool bri_ramp_active;
+    uint8_t bri_ramp_from;
+    uint8_t bri_ramp_target;
+    int64_t bri_ramp_start_us;
+    int bri_ramp_duration_ms;
+#if CONFIG_UL_WS_STREAM
+    // Raw frame streaming: while active the UDP listener task owns the
+    // strip's double buffer and the render task leaves the strip alone.
+    volatile bool stream_active;
+    volatile bool stream_stop;
+    TaskHandle_t stream_task;
+    int stream_sock;
+    uint16_t stream_seq;
+    bool stream_seq_valid;
+#endif
 } ws_strip_t;
 
-static ws_strip_t s_strips[2];
-static int s_current_strip_idx = 0;
-static SemaphoreHandle_t s_refresh_sem;
-static TaskHandle_t s_refresh_task = NULL;
-static TaskHandle_t s_ws_task = NULL;
+#define WS_FPS_MIN 5
+#define WS_FPS_MAX 120
+// Frames delivered without a drop before current_fps is raised again.
+#define WS_FPS_RECOVERY_FRAMES 120
+// Upper bound on an effect-declared quiet gap, so a control change (ws/set)
+// never waits longer than this for the next render to pick it up.
+#define WS_MAX_SKIP_MS 250
 
-int ul_ws_effect_current_strip(void) { return s_current_strip_idx; }
+// Strips 0/1 ride the two general-purpose SPI hosts; strips 2+ each get their
+// own hardware-timed RMT channel when UL_WS_RMT_EXPANSION is enabled, so a
+// single node can feed multi-zone rooms without deploying extra hardware.
+#if CONFIG_UL_WS_RMT_EXPANSION
+#define UL_WS_MAX_STRIPS 8
+#else
+#define UL_WS_MAX_STRIPS 2
+#endif
+#define UL_WS_SPI_STRIPS 2
+
+// Kconfig bools are absent from sdkconfig.h when disabled; normalize the
+// per-strip RGBW flags so they can sit in C expressions.
+#ifndef CONFIG_UL_WS0_RGBW
+#define CONFIG_UL_WS0_RGBW 0
+#endif
+#ifndef CONFIG_UL_WS1_RGBW
+#define CONFIG_UL_WS1_RGBW 0
+#endif
+#ifndef CONFIG_UL_WS2_RGBW
+#define CONFIG_UL_WS2_RGBW 0
+#endif
+#ifndef CONFIG_UL_WS3_RGBW
+#define CONFIG_UL_WS3_RGBW 0
+#endif
+#ifndef CONFIG_UL_WS4_RGBW
+#define CONFIG_UL_WS4_RGBW 0
+#endif
+#ifndef CONFIG_UL_WS5_RGBW
+#define CONFIG_UL_WS5_RGBW 0
+#endif
+#ifndef CONFIG_UL_WS6_RGBW
+#define CONFIG_UL_WS6_RGBW 0
+#endif
+#ifndef CONFIG_UL_WS7_RGBW
+#define CONFIG_UL_WS7_RGBW 0
+#endif
+
+static ws_strip_t s_strips[UL_WS_MAX_STRIPS];
+static TaskHandle_t s_ws_tasks[UL_WS_MAX_STRIPS]; // [1..] used only in per-strip mode
 
 static ws_strip_t* get_strip(int idx);
 static void deinit_strip(int idx);
+static void rebuild_lut(ws_strip_t* s);
+static bool ws_stream_set(int strip, bool enable);
+static void apply_segments(int strip, cJSON* jsegs);
+static void apply_pixel_map(int strip, cJSON* jmap);
+
+// Bytes per pixel on the transmit side of the pipeline. The render side
+// (effects, segments, crossfade, cycle cache, streaming datagrams) is always
+// packed 3-byte RGB; RGBW strips expand to 4 bytes during the LUT pass.
+static inline int strip_bpp(const ws_strip_t* s) { return s->rgbw ? 4 : 3; }
+
+// Bulk driver push in the strip's wire format.
+static esp_err_t ws_push_pixels(ws_strip_t* s, uint32_t start, uint32_t count,
+                                const uint8_t* buf) {
+    return s->rgbw ? led_strip_set_pixels_rgbw(s->handle, start, count, buf)
+                   : led_strip_set_pixels(s->handle, start, count, buf);
+}
+
+#if CONFIG_UL_WS_CYCLE_CACHE
+static void cycle_cache_release(ws_strip_t* s) {
+    s->cycle_ready = false;
+    s->cycle_period = 0;
+    s->cycle_filled = 0;
+    if (s->cycle_cache) {
+        free(s->cycle_cache);
+        s->cycle_cache = NULL;
+    }
+}
+
+// (Re)size the bake ring for the strip's current effect. Called from the
+// control path whenever the effect or its params change; the render task only
+// consumes the ring once cycle_ready is set, so a stale ring is simply
+// rebuilt over the next cycle.
+static void cycle_cache_setup(ws_strip_t* s, int idx) {
+    cycle_cache_release(s);
+    if (!s->eff || !s->eff->period || s->pixels <= 0) return;
+    int period = s->eff->period(idx);
+    if (period <= 1) return; // static frames are handled by hash elision
+    size_t bytes = (size_t)period * s->pixels * 3;
+    if (bytes > CONFIG_UL_WS_CYCLE_CACHE_MAX_BYTES) return;
+    s->cycle_cache = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (!s->cycle_cache) {
+        ESP_LOGW(TAG, "No PSRAM for %s cycle cache on strip %d (%u bytes)",
+                 s->eff->name, idx, (unsigned)bytes);
+        return;
+    }
+    s->cycle_period = period;
+}
+#else
+static void cycle_cache_release(ws_strip_t* s) { (void)s; }
+static void cycle_cache_setup(ws_strip_t* s, int idx) { (void)s; (void)idx; }
+#endif
+
+static void reset_frame_stats(ws_strip_t* s) {
+    s->render_us_min = UINT32_MAX;
+    s->render_us_max = 0;
+    s->render_us_sum = 0;
+    s->render_frames = 0;
+    s->render_us_last = 0;
+    s->tx_us_last = 0;
+    s->overruns = 0;
+    s->power_clamps = 0;
+}
 
 void ul_ws_apply_json(cJSON* root) {
     if (!root) return;
@@ -119,11 +365,54 @@ void ul_ws_apply_json(cJSON* root) {
         ul_ws_set_brightness(strip, (uint8_t)bri);
     }
 
+    cJSON* jfps = cJSON_GetObjectItem(root, "fps");
+    if (jfps && cJSON_IsNumber(jfps)) {
+        ul_ws_set_fps(strip, jfps->valueint);
+    }
+
+    // Live strip length: "pixels":N re-bounds the render and transmit paths
+    // up to the boot-time (Kconfig) allocation -- no teardown, no
+    // reallocation, no dark flash.
+    cJSON* jpix = cJSON_GetObjectItem(root, "pixels");
+    if (jpix && cJSON_IsNumber(jpix)) {
+        ws_strip_t* s = get_strip(strip);
+        if (s && !ul_ws_set_pixels(strip, jpix->valueint)) {
+            ESP_LOGW(TAG, "Ignoring pixels=%d for strip %d (valid range 1..%d)",
+                     jpix->valueint, strip, s->max_pixels);
+        }
+    }
+
+    // Optional render scale for long strips: "scale":2 (or 4) has effects
+    // draw a half/quarter-width frame that a fixed-point linear upsample
+    // expands to the full strip, cutting per-frame effect math by the same
+    // factor. Effects flagged full_res ignore it.
+    cJSON* jscale = cJSON_GetObjectItem(root, "scale");
+    if (jscale && cJSON_IsNumber(jscale)) {
+        int scale = jscale->valueint;
+        ws_strip_t* s = get_strip(strip);
+        if (s && (scale == 1 || scale == 2 || scale == 4) &&
+            scale != s->render_scale) {
+            s->render_scale = (uint8_t)scale;
+            // Baked cycle frames and the transmit hash reflect the old
+            // scale; rebuild both.
+            cycle_cache_setup(s, strip);
+            s->last_tx_valid = false;
+        }
+    }
+
+    // Installation geometry: "map":{...} builds the logical->physical pixel
+    // map (reversed mounts, serpentine folds, dead ranges) applied at the
+    // frame-push step, so effects keep rendering in logical order.
+    cJSON* jmap = cJSON_GetObjectItem(root, "map");
+    if (jmap) {
+        apply_pixel_map(strip, jmap);
+    }
+
     const char* effect = NULL;
     cJSON* jeffect = cJSON_GetObjectItem(root, "effect");
     if (jeffect && cJSON_IsString(jeffect)) {
         effect = jeffect->valuestring;
-        if (strip < 0 || strip > 1 || s_strips[strip].pixels <= 0) {
+        if (strip < 0 || strip >= UL_WS_MAX_STRIPS || s_strips[strip].pixels <= 0) {
             ESP_LOGW(TAG, "Effect %s requested on disabled strip %d", effect, strip);
             effect = NULL;
         } else if (!ul_ws_set_effect(strip, effect)) {
@@ -137,8 +426,27 @@ void ul_ws_apply_json(cJSON* root) {
         const ws_effect_t* eff = s_strips[strip].eff;
         if (eff && eff->apply_params) {
             eff->apply_params(strip, jparams);
+            // Params can change the cycle content or length; rebake.
+            cycle_cache_setup(&s_strips[strip], strip);
         }
     }
+
+    cJSON* jsegs = cJSON_GetObjectItem(root, "segments");
+    if (!effect && jsegs && cJSON_IsArray(jsegs)) {
+        apply_segments(strip, jsegs);
+    }
+
+    // Raw streaming handoff: "stream":true parks the effect renderer and
+    // lets the UDP listener drive the strip; "stream":false -- or a payload
+    // that picks an effect without mentioning stream -- hands it back. The
+    // brightness and fps fields above still apply; brightness feeds the LUT
+    // pass that runs on streamed frames too.
+    cJSON* jstream = cJSON_GetObjectItem(root, "stream");
+    if (jstream && cJSON_IsBool(jstream)) {
+        ws_stream_set(strip, cJSON_IsTrue(jstream));
+    } else if (effect) {
+        ws_stream_set(strip, false);
+    }
 }
 
 static const ws_effect_t* find_effect_by_name(const char* name) {
@@ -150,7 +458,204 @@ static const ws_effect_t* find_effect_by_name(const char* name) {
     return NULL;
 }
 
-static bool init_strip(int idx, int gpio, int pixels, bool enabled) {
+// Replace the strip's segment table from a ws/set "segments" array. Entries
+// look like {"start":0,"length":30,"effect":"rainbow","brightness":200,
+// "params":[...]}; slices are clamped to the strip and invalid entries are
+// skipped. An empty array (or a later whole-strip "effect") returns the strip
+// to single-effect mode.
+static void apply_segments(int strip, cJSON* jsegs) {
+    ws_strip_t* s = get_strip(strip);
+    if (!s) return;
+    cycle_cache_release(s);
+    s->segment_count = 0;
+    int n = cJSON_GetArraySize(jsegs);
+    for (int i = 0; i < n && s->segment_count < UL_WS_MAX_SEGMENTS; ++i) {
+        cJSON* jseg = cJSON_GetArrayItem(jsegs, i);
+        if (!jseg || !cJSON_IsObject(jseg)) continue;
+        cJSON* jstart = cJSON_GetObjectItem(jseg, "start");
+        cJSON* jlen = cJSON_GetObjectItem(jseg, "length");
+        cJSON* jeff = cJSON_GetObjectItem(jseg, "effect");
+        if (!jstart || !cJSON_IsNumber(jstart) ||
+            !jlen || !cJSON_IsNumber(jlen) ||
+            !jeff || !cJSON_IsString(jeff)) continue;
+        const ws_effect_t* e = find_effect_by_name(jeff->valuestring);
+        if (!e) {
+            ESP_LOGW(TAG, "Unknown segment effect: %s", jeff->valuestring);
+            continue;
+        }
+        int start = jstart->valueint;
+        int len = jlen->valueint;
+        if (start < 0 || len <= 0 || start >= s->pixels) continue;
+        if (start + len > s->pixels) len = s->pixels - start;
+        ws_segment_t* seg = &s->segments[s->segment_count];
+        seg->offset = start;
+        seg->length = len;
+        seg->eff = e;
+        seg->brightness = 255;
+        cJSON* jbri = cJSON_GetObjectItem(jseg, "brightness");
+        if (jbri && cJSON_IsNumber(jbri)) {
+            int bri = jbri->valueint;
+            if (bri < 0) bri = 0;
+            if (bri > 255) bri = 255;
+            seg->brightness = (uint8_t)bri;
+        }
+        if (e->init) e->init();
+        cJSON* jparams = cJSON_GetObjectItem(jseg, "params");
+        if (jparams && cJSON_IsArray(jparams) && e->apply_params) {
+            // Effect params are tracked per strip, so segments running the
+            // same effect on one strip share params; last entry wins.
+            e->apply_params(strip, jparams);
+        }
+        s->segment_count++;
+    }
+    s->frame_pos = 0.0f;
+    s->fade_frames_left = 0; // segments take over immediately; no crossfade
+    s->fade_eff = NULL;
+    s->last_tx_valid = false;
+    reset_frame_stats(s);
+}
+
+// Drop the strip's pixel map and return it to straight-through pushes. The
+// old map may have parked lit pixels anywhere in the physical extent, so the
+// whole boot-time range is blanked once. Pointer is cleared before the free,
+// same as cycle_cache_release: the render task re-reads it every push.
+static void pixel_map_drop(ws_strip_t* s) {
+    if (!s->pixel_map) return;
+    uint16_t* old = s->pixel_map;
+    s->pixel_map = NULL;
+    s->map_tx_pixels = 0;
+    free(old);
+    if (s->map_buf && s->handle) {
+        memset(s->map_buf, 0, (size_t)s->max_pixels * strip_bpp(s));
+        ws_push_pixels(s, 0, s->max_pixels, s->map_buf);
+    }
+    s->last_tx_valid = false;
+}
+
+// Build the strip's logical->physical pixel map from a ws/set "map" object:
+//   {"reverse":true, "folds":[150,300], "skips":[[10,4],[200,2]]}
+// Skips are [physical_start, length] ranges the wire jumps over (dead or
+// unpopulated LEDs); later pixels shift up by the skipped total, so the
+// physical extent grows and must still fit the boot-time buffers. Folds are
+// ascending logical positions where a serpentine run doubles back; the slice
+// between consecutive folds keeps its physical span but runs it in the
+// opposite direction. "reverse" flips the finished map end to end. A
+// non-object value, or a map that reduces to the identity, drops the table.
+static void apply_pixel_map(int strip, cJSON* jmap) {
+    ws_strip_t* s = get_strip(strip);
+    if (!s || s->pixels <= 0) return;
+    if (!cJSON_IsObject(jmap)) {
+        pixel_map_drop(s);
+        return;
+    }
+    int n = s->pixels;
+    bool reverse = cJSON_IsTrue(cJSON_GetObjectItem(jmap, "reverse"));
+    cJSON* jfolds = cJSON_GetObjectItem(jmap, "folds");
+    cJSON* jskips = cJSON_GetObjectItem(jmap, "skips");
+
+    uint16_t* map = (uint16_t*)heap_caps_malloc((size_t)n * sizeof(uint16_t),
+                                                MALLOC_CAP_8BIT);
+    if (!map) {
+        ESP_LOGE(TAG, "Failed to allocate pixel map for strip %d", strip);
+        return;
+    }
+
+    // Wire-order physical positions, jumping the skip ranges.
+    int nskips = (jskips && cJSON_IsArray(jskips))
+        ? cJSON_GetArraySize(jskips) : 0;
+    int phys = 0;
+    for (int i = 0; i < n; ++i) {
+        for (bool moved = true; moved;) {
+            moved = false;
+            for (int k = 0; k < nskips; ++k) {
+                cJSON* jskip = cJSON_GetArrayItem(jskips, k);
+                if (!jskip || !cJSON_IsArray(jskip) ||
+                    cJSON_GetArraySize(jskip) != 2) continue;
+                cJSON* jstart = cJSON_GetArrayItem(jskip, 0);
+                cJSON* jlen = cJSON_GetArrayItem(jskip, 1);
+                if (!cJSON_IsNumber(jstart) || !cJSON_IsNumber(jlen)) continue;
+                int start = jstart->valueint;
+                int len = jlen->valueint;
+                if (len > 0 && phys >= start && phys < start + len) {
+                    phys = start + len;
+                    moved = true;
+                }
+            }
+        }
+        if (phys >= s->max_pixels) {
+            ESP_LOGW(TAG,
+                     "Pixel map for strip %d needs %d physical pixels; "
+                     "buffers hold %d", strip, phys + 1, s->max_pixels);
+            free(map);
+            return;
+        }
+        map[i] = (uint16_t)phys++;
+    }
+    int extent = phys;
+
+    // Serpentine folds: reverse the physical span of every other slice.
+    if (jfolds && cJSON_IsArray(jfolds)) {
+        int nfolds = cJSON_GetArraySize(jfolds);
+        int a = 0, slice = 0;
+        for (int k = 0; k <= nfolds; ++k) {
+            int b = n;
+            if (k < nfolds) {
+                cJSON* jf = cJSON_GetArrayItem(jfolds, k);
+                if (!jf || !cJSON_IsNumber(jf)) continue;
+                b = jf->valueint;
+                if (b <= a || b > n) continue; // out of order or range
+            }
+            if (slice & 1) {
+                for (int lo = a, hi = b - 1; lo < hi; ++lo, --hi) {
+                    uint16_t t = map[lo]; map[lo] = map[hi]; map[hi] = t;
+                }
+            }
+            a = b;
+            slice++;
+        }
+    }
+
+    if (reverse) {
+        for (int lo = 0, hi = n - 1; lo < hi; ++lo, --hi) {
+            uint16_t t = map[lo]; map[lo] = map[hi]; map[hi] = t;
+        }
+    }
+
+    bool identity = (extent == n);
+    for (int i = 0; identity && i < n; ++i) identity = (map[i] == i);
+    if (identity) {
+        free(map);
+        pixel_map_drop(s);
+        return;
+    }
+
+    if (!s->map_buf) {
+        s->map_buf = (uint8_t*)heap_caps_malloc(
+            (size_t)s->max_pixels * strip_bpp(s), MALLOC_CAP_8BIT);
+        if (!s->map_buf) {
+            ESP_LOGE(TAG, "Failed to allocate map staging buffer for strip %d",
+                     strip);
+            free(map);
+            return;
+        }
+    }
+    // Skipped physical pixels never get written again; blank the whole range
+    // once so they (and anything a previous map lit) go dark.
+    memset(s->map_buf, 0, (size_t)s->max_pixels * strip_bpp(s));
+    if (s->handle) {
+        ws_push_pixels(s, 0, s->max_pixels, s->map_buf);
+    }
+    uint16_t* old = s->pixel_map;
+    s->map_tx_pixels = extent;
+    s->pixel_map = map;
+    if (old) free(old);
+    s->last_tx_valid = false;
+    ESP_LOGI(TAG, "Strip %d pixel map: %d logical over %d physical%s",
+             strip, n, extent, reverse ? ", reversed" : "");
+}
+
+static bool init_strip(int idx, int gpio, int pixels, int power_budget_ma, bool rgbw,
+                       bool enabled) {
     if (idx < 0 || idx >= (int)(sizeof(s_strips) / sizeof(s_strips[0]))) {
         return false;
     }
@@ -162,26 +667,52 @@ static bool init_strip(int idx, int gpio, int pixels, bool enabled) {
         return true;
     }
 
+    int bpp = rgbw ? 4 : 3;
     led_strip_config_t strip_config = {
         .strip_gpio_num = gpio,
         .max_leds = pixels,
-        .led_model = LED_MODEL_WS2812,
+        .led_model = rgbw ? LED_MODEL_SK6812 : LED_MODEL_WS2812,
         .flags.invert_out = false
     };
-    led_strip_spi_config_t spi_config = {
-        .clk_src = SPI_CLK_SRC_DEFAULT,
-        .spi_bus =
+    if (rgbw) {
+        strip_config.color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRBW;
+    }
+
+    esp_err_t err;
+    if (idx < UL_WS_SPI_STRIPS) {
+        led_strip_spi_config_t spi_config = {
+            .clk_src = SPI_CLK_SRC_DEFAULT,
+            .spi_bus =
 #if CONFIG_UL_IS_ESP32C3
-            SPI2_HOST,
+                SPI2_HOST,
 #else
-            (idx == 0 ? SPI2_HOST : SPI3_HOST),
+                (idx == 0 ? SPI2_HOST : SPI3_HOST),
 #endif
-        .flags = {
-            .with_dma = true,
-        },
-    };
-
-    esp_err_t err = led_strip_new_spi_device(&strip_config, &spi_config, &strip->handle);
+            .flags = {
+                .with_dma = true,
+            },
+        };
+        err = led_strip_new_spi_device(&strip_config, &spi_config, &strip->handle);
+    } else {
+#if CONFIG_UL_WS_RMT_EXPANSION
+        led_strip_rmt_config_t rmt_config = {
+            .clk_src = RMT_CLK_SRC_DEFAULT,
+            .resolution_hz = 10 * 1000 * 1000,
+            .mem_block_symbols = CONFIG_UL_WS_RMT_MEM_BLOCK_SYMBOLS,
+#if CONFIG_UL_WS_RMT_WITH_DMA
+            .flags = {
+                // The RMT peripheral has one DMA channel; give it to the
+                // first RMT strip so at least one long run is immune to
+                // refill-interrupt jitter from Wi-Fi activity.
+                .with_dma = (idx == UL_WS_SPI_STRIPS),
+            },
+#endif
+        };
+        err = led_strip_new_rmt_device(&strip_config, &rmt_config, &strip->handle);
+#else
+        err = ESP_ERR_NOT_SUPPORTED;
+#endif
+    }
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize LED strip %d (err=%d)", idx, (int)err);
         strip->handle = NULL;
@@ -195,15 +726,43 @@ static bool init_strip(int idx, int gpio, int pixels, bool enabled) {
 
     led_strip_clear(strip->handle);
 
-    strip->frame = (uint8_t*)heap_caps_malloc(pixels * 3, MALLOC_CAP_8BIT);
-    if (!strip->frame) {
-        ESP_LOGE(TAG, "Failed to allocate frame buffer for strip %d", idx);
-        deinit_strip(idx);
-        return false;
+    // Frame buffers feed SPI DMA; on PSRAM builds MALLOC_CAP_8BIT may land
+    // them in PSRAM and force the driver into bounce-buffer copies. Prefer
+    // internal DMA-capable RAM up to the configured size limit and fall back
+    // to the default heap when that fails.
+    strip->frames_internal = (pixels * bpp) <= CONFIG_UL_WS_FRAME_DMA_MAX_BYTES;
+    for (int i = 0; i < 2; ++i) {
+        if (strip->frames_internal) {
+            strip->frames[i] = (uint8_t*)heap_caps_malloc(
+                pixels * bpp, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            if (!strip->frames[i]) {
+                ESP_LOGW(TAG,
+                         "No internal DMA memory for strip %d frame buffer;"
+                         " falling back to default heap", idx);
+                strip->frames_internal = false;
+            }
+        }
+        if (!strip->frames[i]) {
+            strip->frames[i] = (uint8_t*)heap_caps_malloc(pixels * bpp, MALLOC_CAP_8BIT);
+        }
+        if (!strip->frames[i]) {
+            ESP_LOGE(TAG, "Failed to allocate frame buffer for strip %d", idx);
+            deinit_strip(idx);
+            return false;
+        }
+        memset(strip->frames[i], 0, pixels * bpp);
     }
+    strip->render_buf = 0;
+    strip->frame = strip->frames[0];
+    strip->tx_frame = NULL;
+    strip->tx_pending = false;
+    strip->last_tx_hash = 0;
+    strip->last_tx_valid = false;
 
     strip->pixels = pixels;
-    memset(strip->frame, 0, pixels * 3);
+    strip->max_pixels = pixels;
+    strip->rgbw = rgbw;
+    strip->render_scale = 1;
 
     int n = 0;
     const ws_effect_t* tbl = ul_ws_get_effects(&n);
@@ -213,6 +772,15 @@ static bool init_strip(int idx, int gpio, int pixels, bool enabled) {
     strip->solid_b = 0;
     strip->brightness = 255;
     strip->frame_pos = 0.0f;
+    strip->target_fps = CONFIG_UL_WS2812_FPS;
+    strip->current_fps = CONFIG_UL_WS2812_FPS;
+    strip->next_due = 0;
+    strip->clean_frames = 0;
+    strip->skip_frames = 1;
+    strip->power_budget_ma = power_budget_ma;
+    reset_frame_stats(strip);
+    cycle_cache_setup(strip, idx);
+    rebuild_lut(strip);
 
     return true;
 }
@@ -220,16 +788,51 @@ static bool init_strip(int idx, int gpio, int pixels, bool enabled) {
 static void deinit_strip(int idx) {
     if (idx < 0 || idx >= (int)(sizeof(s_strips) / sizeof(s_strips[0]))) return;
     ws_strip_t* strip = &s_strips[idx];
+    cycle_cache_release(strip);
     if (strip->handle) {
         led_strip_del(strip->handle);
         strip->handle = NULL;
     }
-    if (strip->frame) {
-        free(strip->frame);
-        strip->frame = NULL;
+    for (int i = 0; i < 2; ++i) {
+        if (strip->frames[i]) {
+            free(strip->frames[i]);
+            strip->frames[i] = NULL;
+        }
     }
+    strip->frame = NULL;
+    strip->render_buf = 0;
+    strip->tx_frame = NULL;
+    strip->tx_pending = false;
+    strip->last_tx_hash = 0;
+    strip->last_tx_valid = false;
+    strip->target_fps = 0;
+    strip->current_fps = 0;
+    strip->next_due = 0;
+    strip->clean_frames = 0;
+    strip->skip_frames = 0;
+    strip->power_budget_ma = 0;
     strip->pixels = 0;
+    strip->max_pixels = 0;
+    strip->rgbw = false;
     strip->eff = NULL;
+    strip->segment_count = 0;
+    strip->fade_eff = NULL;
+    strip->fade_pos = 0.0f;
+    strip->fade_frames_left = 0;
+    strip->fade_frames_total = 0;
+    if (strip->fade_buf) {
+        free(strip->fade_buf);
+        strip->fade_buf = NULL;
+    }
+    if (strip->pixel_map) {
+        free(strip->pixel_map);
+        strip->pixel_map = NULL;
+    }
+    strip->map_tx_pixels = 0;
+    if (strip->map_buf) {
+        free(strip->map_buf);
+        strip->map_buf = NULL;
+    }
     strip->solid_r = 0;
     strip->solid_g = 0;
     strip->solid_b = 0;
@@ -237,105 +840,718 @@ static void deinit_strip(int idx) {
     strip->frame_pos = 0.0f;
 }
 
-static void apply_brightness(uint8_t* f, int count, uint8_t bri) {
-    if (bri == 255) return;
-    for (int i=0;i<count;i++) {
-        int v = (f[i] * bri) / 255;
-        f[i] = (uint8_t)v;
+static void rebuild_lut(ws_strip_t* s) {
+    for (int v = 0; v < 256; ++v) {
+#if CONFIG_UL_GAMMA_ENABLE
+        int out = ul_gamma8((uint8_t)v);
+#else
+        int out = v;
+#endif
+        s->lut[v] = (uint8_t)((out * s->brightness) / 255);
+    }
+}
+
+// Single fused gamma+brightness pass over the frame, four bytes per iteration.
+static void WS_RENDER_ATTR apply_lut(uint8_t* f, int count, const uint8_t* lut) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        f[i+0] = lut[f[i+0]];
+        f[i+1] = lut[f[i+1]];
+        f[i+2] = lut[f[i+2]];
+        f[i+3] = lut[f[i+3]];
+    }
+    for (; i < count; ++i) {
+        f[i] = lut[f[i]];
+    }
+}
+
+// Fused white extraction + gamma/brightness for RGBW strips: expand the
+// 3-byte rendered pixels at the head of the frame to 4-byte RGBW in place,
+// moving the shared min(r,g,b) to the white die. Walking backwards makes the
+// in-place expansion safe (x*4 only overlaps sources at or below x, which
+// are read into locals first), so full RGBW costs the same single frame walk
+// as the plain LUT pass -- no separate extraction sweep.
+static void WS_RENDER_ATTR apply_lut_rgbw(uint8_t* f, int pixels, const uint8_t* lut) {
+    for (int x = pixels - 1; x >= 0; --x) {
+        uint8_t r = f[x * 3 + 0];
+        uint8_t g = f[x * 3 + 1];
+        uint8_t b = f[x * 3 + 2];
+        uint8_t w = r < g ? (r < b ? r : b) : (g < b ? g : b);
+        uint8_t* d = &f[x * 4];
+        d[0] = lut[(uint8_t)(r - w)];
+        d[1] = lut[(uint8_t)(g - w)];
+        d[2] = lut[(uint8_t)(b - w)];
+        d[3] = lut[w];
+    }
+}
+
+// Gamma/brightness entry point: plain in-place LUT for RGB strips, the fused
+// extraction pass above for RGBW ones. After this call the frame is in wire
+// format (strip_bpp bytes per pixel); hashing, the power limiter and the
+// driver push all run on those bytes.
+static void WS_RENDER_ATTR finish_frame(ws_strip_t* s, uint8_t* f) {
+    if (s->rgbw) {
+        apply_lut_rgbw(f, s->pixels, s->lut);
+    } else {
+        apply_lut(f, s->pixels * 3, s->lut);
+    }
+}
+
+// Resolve the scale an effect actually renders at: 1 when scaling is off,
+// the effect insists on full resolution, or the strip is too short to leave
+// the interpolator at least two source pixels.
+static int effect_render_scale(const ws_strip_t* s, const ws_effect_t* eff) {
+    int scale = s->render_scale;
+    if (scale <= 1 || !eff || eff->full_res) return 1;
+    if (s->pixels / scale < 2) return 1;
+    return scale;
+}
+
+// Expand the pixels/scale rendered pixels at the head of the frame to the
+// full strip with Q8 fixed-point linear interpolation, in place. Walking
+// backwards makes that safe: output pixel x only reads source pixels at or
+// below x, which have not been overwritten yet. The mapping pins the last
+// output pixel to the last source pixel, so the strip end never extrapolates.
+static void WS_RENDER_ATTR upsample_frame(uint8_t* f, int pixels, int scale) {
+    int src_pixels = pixels / scale;
+    if (src_pixels < 2 || src_pixels >= pixels) return;
+    uint32_t step_q8 = ((uint32_t)(src_pixels - 1) << 8) / (uint32_t)(pixels - 1);
+    for (int x = pixels - 1; x >= 0; --x) {
+        uint32_t pos_q8 = (uint32_t)x * step_q8;
+        uint32_t i = pos_q8 >> 8;
+        uint32_t frac = pos_q8 & 0xFF;
+        const uint8_t* a = &f[i * 3];
+        const uint8_t* b = (i + 1 < (uint32_t)src_pixels) ? a + 3 : a;
+        uint8_t* d = &f[x * 3];
+        d[0] = (uint8_t)((a[0] * (256 - frac) + b[0] * frac) >> 8);
+        d[1] = (uint8_t)((a[1] * (256 - frac) + b[1] * frac) >> 8);
+        d[2] = (uint8_t)((a[2] * (256 - frac) + b[2] * frac) >> 8);
+    }
+}
+
+#if CONFIG_UL_WS_CROSSFADE_FRAMES > 0
+// Fixed-point blend of the outgoing frame under the incoming one:
+// new = (new*alpha + old*(256-alpha)) >> 8, unrolled like apply_lut.
+static void WS_RENDER_ATTR mix_frames(uint8_t* new_frame, const uint8_t* old_frame,
+                                      int count, int alpha) {
+    int inv = 256 - alpha;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        new_frame[i+0] = (uint8_t)((new_frame[i+0]*alpha + old_frame[i+0]*inv) >> 8);
+        new_frame[i+1] = (uint8_t)((new_frame[i+1]*alpha + old_frame[i+1]*inv) >> 8);
+        new_frame[i+2] = (uint8_t)((new_frame[i+2]*alpha + old_frame[i+2]*inv) >> 8);
+        new_frame[i+3] = (uint8_t)((new_frame[i+3]*alpha + old_frame[i+3]*inv) >> 8);
+    }
+    for (; i < count; ++i) {
+        new_frame[i] = (uint8_t)((new_frame[i]*alpha + old_frame[i]*inv) >> 8);
+    }
+}
+#endif
+
+// FNV-1a over the finished frame; cheap enough to run every frame and lets us
+// skip the driver push and SPI transmit entirely when nothing changed (a strip
+// sitting on a solid color renders identical frames forever).
+static uint32_t WS_RENDER_ATTR frame_hash(const uint8_t* f, int count) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < count; ++i) {
+        h = (h ^ f[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Power limiter. Estimated supply current is integer-only: each colour
+// channel draws roughly in proportion to its (post-gamma) byte, topping out
+// at CONFIG_UL_WS_MA_PER_CHANNEL, plus a quiescent draw per pixel even when
+// dark. Frames whose estimate exceeds the strip's budget are scaled down so
+// dim scenes keep full brightness and only genuinely hot frames clamp.
+
+#define WS_POWER_IDLE_UA_PER_PIXEL 700
+
+static uint16_t s_power_lut[256]; // microamps per channel level
+
+static void build_power_lut(void) {
+    for (int v = 0; v < 256; ++v) {
+        s_power_lut[v] = (uint16_t)(((uint32_t)v * CONFIG_UL_WS_MA_PER_CHANNEL * 1000u) / 255u);
+    }
+}
+
+// Word-wide accumulation, unrolled like apply_lut.
+static uint32_t WS_RENDER_ATTR estimate_frame_ua(const uint8_t* f, int count) {
+    uint32_t ua = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        ua += (uint32_t)s_power_lut[f[i+0]] + s_power_lut[f[i+1]] +
+              s_power_lut[f[i+2]] + s_power_lut[f[i+3]];
+    }
+    for (; i < count; ++i) {
+        ua += s_power_lut[f[i]];
+    }
+    return ua;
+}
+
+static void WS_RENDER_ATTR scale_frame(uint8_t* f, int count, uint32_t scale_q8) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        f[i+0] = (uint8_t)((f[i+0] * scale_q8) >> 8);
+        f[i+1] = (uint8_t)((f[i+1] * scale_q8) >> 8);
+        f[i+2] = (uint8_t)((f[i+2] * scale_q8) >> 8);
+        f[i+3] = (uint8_t)((f[i+3] * scale_q8) >> 8);
+    }
+    for (; i < count; ++i) {
+        f[i] = (uint8_t)((f[i] * scale_q8) >> 8);
+    }
+}
+
+static void WS_RENDER_ATTR limit_frame_power(ws_strip_t* s) {
+    if (s->power_budget_ma <= 0) return;
+    // W draws like a colour channel, so RGBW frames integrate all 4 bytes.
+    uint32_t led_ua = estimate_frame_ua(s->frame, s->pixels * strip_bpp(s));
+    uint32_t idle_ua = (uint32_t)s->pixels * WS_POWER_IDLE_UA_PER_PIXEL;
+    uint32_t budget_ua = (uint32_t)s->power_budget_ma * 1000u;
+    if (led_ua + idle_ua <= budget_ua) return;
+    // The quiescent draw doesn't scale with the frame, so what's left of the
+    // budget after it goes to the LED portion.
+    uint32_t headroom_ua = budget_ua > idle_ua ? budget_ua - idle_ua : 0;
+    uint32_t scale_q8 = (uint32_t)(((uint64_t)headroom_ua << 8) / led_ua);
+    scale_frame(s->frame, s->pixels * strip_bpp(s), scale_q8);
+    s->power_clamps++;
+}
+
+// Renders one frame and hands it to the refresh task. Returns false when the
+// frame had to be dropped because the previous one was still transmitting.
+static void record_render_time(ws_strip_t* s, int64_t start_us) {
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (us < s->render_us_min) s->render_us_min = us;
+    if (us > s->render_us_max) s->render_us_max = us;
+    s->render_us_sum += us;
+    s->render_us_last = us;
+    s->render_frames++;
+}
+
+// Advance an active brightness ramp from wall time, re-baking the LUT when
+// the level moved. The frame hash below keeps unchanged steps off the wire.
+static void step_brightness_ramp(ws_strip_t* s, int64_t now_us) {
+    if (!s->bri_ramp_active) return;
+    int64_t elapsed = now_us - s->bri_ramp_start_us;
+    int64_t dur_us = (int64_t)s->bri_ramp_duration_ms * 1000;
+    uint8_t bri;
+    if (elapsed >= dur_us) {
+        bri = s->bri_ramp_target;
+        s->bri_ramp_active = false;
+    } else {
+        int delta = (int)s->bri_ramp_target - (int)s->bri_ramp_from;
+        bri = (uint8_t)((int)s->bri_ramp_from + (delta * elapsed) / dur_us);
+    }
+    if (bri != s->brightness) {
+        s->brightness = bri;
+        rebuild_lut(s);
+    }
+}
+
+// Effect-declared quiet gap from the just-rendered frame: when every effect
+// feeding the strip can name the frame where its output next differs, the
+// render task holds the transmitted frame and sleeps through the gap instead
+// of re-rendering identical frames (a 10% duty-cycle flash costs ~10% of
+// continuous render CPU). Crossfades and brightness ramps animate every
+// frame, so they pin the gap to 1.
+static int frames_until_change(const ws_strip_t* s, int idx, int frame_idx) {
+    if (s->bri_ramp_active) return 1;
+#if CONFIG_UL_WS_CROSSFADE_FRAMES > 0
+    if (s->fade_frames_left > 0) return 1;
+#endif
+    if (s->segment_count > 0) {
+        int quiet = 0;
+        for (int si = 0; si < s->segment_count; ++si) {
+            const ws_effect_t* e = s->segments[si].eff;
+            if (!e || !e->next_change) return 1;
+            int n = e->next_change(idx, frame_idx);
+            if (n <= 1) return 1;
+            if (quiet == 0 || n < quiet) quiet = n;
+        }
+        return quiet;
+    }
+    if (s->eff && s->eff->next_change) {
+        int n = s->eff->next_change(idx, frame_idx);
+        if (n > 1) return n;
     }
+    return 1;
 }
 
-static void render_one(ws_strip_t* s, int idx) {
-    if (!s->pixels || !s->handle || !s->frame) return;
-    s_current_strip_idx = idx;
+#if CONFIG_UL_WS_PHASE_LOCK
+// Pre-sync clocks sit near the epoch; stay free-running until SNTP lands.
+#define WS_PHASE_LOCK_MIN_EPOCH 1600000000
+
+// Frame index derived from synchronized wall time, wrapped at the UTC day
+// so it stays exactly representable in frame_pos (86400 * WS_FPS_MAX fits
+// a float's 24-bit mantissa). Every node computes the same index from the
+// same clock, so equal-FPS strips running the same effect land on the same
+// frame with no per-frame network traffic. target_fps (not the adaptively
+// paced rate) keeps the mapping stable when one node backs off.
+static bool phase_locked_pos(const ws_strip_t* s, float* pos) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec < WS_PHASE_LOCK_MIN_EPOCH) return false;
+    int64_t us_in_day = ((int64_t)tv.tv_sec % 86400) * 1000000 + tv.tv_usec;
+    *pos = (float)((us_in_day * s->target_fps) / 1000000);
+    return true;
+}
+#endif
+
+static void advance_frame_pos(ws_strip_t* s) {
+#if CONFIG_UL_WS_PHASE_LOCK
+    if (phase_locked_pos(s, &s->frame_pos)) return;
+#endif
+    s->frame_pos += 1.0f;
+}
+
+static bool render_one(ws_strip_t* s, int idx) {
+    if (!s->pixels || !s->handle || !s->frame) return true;
+    int64_t t0 = esp_timer_get_time();
+    step_brightness_ramp(s, t0);
     // Produce frame
-    memset(s->frame, 0, s->pixels*3);
-    if (s->eff && s->eff->render) {
-        s->frame_pos += 1.0f;
+    if (s->segment_count > 0) {
+        advance_frame_pos(s);
         int frame_idx = (int)s->frame_pos;
-        s->eff->render(s->frame, s->pixels, frame_idx);
+        memset(s->frame, 0, s->pixels*3);
+        for (int si = 0; si < s->segment_count; ++si) {
+            const ws_segment_t* seg = &s->segments[si];
+            if (!seg->eff || !seg->eff->render) continue;
+            seg->eff->render(idx, s->frame + seg->offset*3, seg->length, frame_idx);
+            if (seg->brightness != 255) {
+                uint8_t* p = s->frame + seg->offset*3;
+                for (int b = 0; b < seg->length*3; ++b) {
+                    p[b] = (uint8_t)((p[b] * seg->brightness) / 255);
+                }
+            }
+        }
+    } else if (s->eff && s->eff->render) {
+        advance_frame_pos(s);
+        int frame_idx = (int)s->frame_pos;
+        int scale = effect_render_scale(s, s->eff);
+#if CONFIG_UL_WS_CYCLE_CACHE
+        if (s->cycle_ready) {
+            // Whole cycle is baked; steady-state render is a copy (the LUT
+            // pass below still runs, so brightness stays live).
+            memcpy(s->frame,
+                   s->cycle_cache + (size_t)(frame_idx % s->cycle_period) * s->pixels * 3,
+                   s->pixels * 3);
+        } else {
+            memset(s->frame, 0, s->pixels*3);
+            s->eff->render(idx, s->frame, s->pixels / scale, frame_idx);
+            if (scale > 1) upsample_frame(s->frame, s->pixels, scale);
+            // The ring stores the upsampled frames, so replay above is
+            // scale-agnostic.
+            if (s->cycle_cache) {
+                // frame_idx advances by one per render, so `period` renders
+                // fill every slot of the ring exactly once.
+                memcpy(s->cycle_cache + (size_t)(frame_idx % s->cycle_period) * s->pixels * 3,
+                       s->frame, s->pixels * 3);
+                if (++s->cycle_filled >= s->cycle_period) s->cycle_ready = true;
+            }
+        }
+#else
+        memset(s->frame, 0, s->pixels*3);
+        s->eff->render(idx, s->frame, s->pixels / scale, frame_idx);
+        if (scale > 1) upsample_frame(s->frame, s->pixels, scale);
+#endif
+    } else {
+        memset(s->frame, 0, s->pixels*3);
     }
-#if CONFIG_UL_GAMMA_ENABLE
-    for (int i=0;i<s->pixels;i++) {
-        s->frame[3*i+0] = ul_gamma8(s->frame[3*i+0]);
-        s->frame[3*i+1] = ul_gamma8(s->frame[3*i+1]);
-        s->frame[3*i+2] = ul_gamma8(s->frame[3*i+2]);
+#if CONFIG_UL_WS_CROSSFADE_FRAMES > 0
+    if (s->fade_frames_left > 0 && s->fade_eff && s->fade_buf &&
+        s->segment_count == 0) {
+        s->fade_pos += 1.0f;
+        memset(s->fade_buf, 0, s->pixels*3);
+        if (s->fade_eff->render) {
+            int fscale = effect_render_scale(s, s->fade_eff);
+            s->fade_eff->render(idx, s->fade_buf, s->pixels / fscale,
+                                (int)s->fade_pos);
+            if (fscale > 1) upsample_frame(s->fade_buf, s->pixels, fscale);
+        }
+        // Incoming weight ramps 0 -> 256 over the fade duration.
+        int alpha = (256 * (s->fade_frames_total - s->fade_frames_left)) /
+                    s->fade_frames_total;
+        mix_frames(s->frame, s->fade_buf, s->pixels*3, alpha);
+        if (--s->fade_frames_left == 0) s->fade_eff = NULL;
     }
 #endif
-    apply_brightness(s->frame, s->pixels*3, s->brightness);
-    // Push to device
-    for (int i=0;i<s->pixels;i++) {
-        led_strip_set_pixel(s->handle, i, s->frame[3*i+0], s->frame[3*i+1], s->frame[3*i+2]);
+    s->skip_frames = frames_until_change(s, idx, (int)s->frame_pos);
+    finish_frame(s, s->frame);
+    limit_frame_power(s); // runs on the post-gamma bytes the LEDs will see
+    // Unchanged frame: the LEDs already show it, skip push and transmit.
+    uint32_t hash = frame_hash(s->frame, s->pixels * strip_bpp(s));
+    if (s->last_tx_valid && hash == s->last_tx_hash) {
+        record_render_time(s, t0);
+        return true;
     }
+    // Hand the finished frame to the transmit step and flip to the other
+    // buffer. If the previous frame is still on the wire, drop this one
+    // rather than tearing it.
+    if (s->tx_pending) {
+        record_render_time(s, t0);
+        return false;
+    }
+    s->last_tx_hash = hash;
+    s->last_tx_valid = true;
+    s->tx_frame = s->frame;
+    s->tx_pending = true;
+    s->render_buf ^= 1;
+    s->frame = s->frames[s->render_buf];
+    record_render_time(s, t0);
+    return true;
 }
 
-static void ws_task(void*)
-{
-    const TickType_t period_ticks = pdMS_TO_TICKS(1000 / CONFIG_UL_WS2812_FPS);
-    TickType_t last_wake = xTaskGetTickCount();
+// Adaptive pacing: a dropped frame means render+transmit exceeded the frame
+// period, so back the rate off instead of silently slipping; a long run of
+// clean frames lets the rate creep back toward target_fps.
+static void pace_strip(ws_strip_t* s, bool delivered) {
+    if (!delivered) {
+        s->clean_frames = 0;
+        int lowered = (s->current_fps * 3) / 4;
+        if (lowered < WS_FPS_MIN) lowered = WS_FPS_MIN;
+        if (lowered < s->current_fps) {
+            ESP_LOGW(TAG, "Frame overrun; lowering rate to %d FPS", lowered);
+            s->current_fps = lowered;
+        }
+        return;
+    }
+    if (s->current_fps < s->target_fps &&
+        ++s->clean_frames >= WS_FPS_RECOVERY_FRAMES) {
+        s->clean_frames = 0;
+        s->current_fps++;
+    }
+}
 
-    while (1) {
-#if CONFIG_UL_WS0_ENABLED
-        render_one(&s_strips[0], 0);
-#endif
-#if CONFIG_UL_WS1_ENABLED
-        render_one(&s_strips[1], 1);
+// Transmit completion, called by the led_strip driver once the frame has been
+// clocked out -- possibly from the SPI ISR, so only flag updates happen here.
+static void ws_tx_done_cb(led_strip_handle_t handle, void *user_ctx) {
+    (void)handle;
+    ws_strip_t* s = (ws_strip_t*)user_ctx;
+    s->tx_us_last = (uint32_t)(esp_timer_get_time() - s->tx_start_us);
+    s->tx_pending = false;
+}
+
+// Frame push: installs whose wire order differs from render order get the
+// finished frame rewritten into physical order here -- one indexed copy per
+// transmit. Identity strips hand the render buffer to the driver untouched.
+static const uint8_t* map_tx_frame(ws_strip_t* s, const uint8_t* frame,
+                                   int* tx_pixels) {
+    const uint16_t* map = s->pixel_map;
+    if (!map) {
+        *tx_pixels = s->pixels;
+        return frame;
+    }
+    size_t bpp = (size_t)strip_bpp(s);
+    for (int i = 0; i < s->pixels; ++i) {
+        memcpy(s->map_buf + map[i] * bpp, frame + (size_t)i * bpp, bpp);
+    }
+    *tx_pixels = s->map_tx_pixels;
+    return s->map_buf;
+}
+
+// Submit completed frames to the driver and queue their transmission. The
+// async refresh returns as soon as the DMA transaction is queued, so both
+// strips go on the wire back-to-back and the next render overlaps them.
+// tx_pending stays set until the completion callback fires, which keeps
+// render_one() from touching the in-flight buffer.
+static void refresh_strips(void) {
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+        ws_strip_t* s = &s_strips[i];
+        if (!s->handle || !s->tx_pending || !s->tx_frame) continue;
+#if CONFIG_UL_WS_STREAM
+        if (s->stream_active) continue; // the stream task submits its own frames
 #endif
-        if (s_refresh_sem) xSemaphoreGive(s_refresh_sem);
-        vTaskDelayUntil(&last_wake, period_ticks);
+        int tx_pixels;
+        const uint8_t* out = map_tx_frame(s, s->tx_frame, &tx_pixels);
+        ws_push_pixels(s, 0, tx_pixels, out);
+        s->tx_start_us = esp_timer_get_time();
+        esp_err_t err = led_strip_refresh_async(s->handle, ws_tx_done_cb, s);
+        if (err != ESP_OK) {
+            // Queue rejected the frame (should not happen once tx_pending has
+            // cleared); leave tx_pending set so the next pass retries it.
+            ESP_LOGW(TAG, "Async refresh failed for strip %d (%d)", i, (int)err);
+        }
     }
 }
 
-static void led_refresh_task(void *arg) {
-    while (1) {
-        if (!s_refresh_sem) {
-            vTaskDelay(pdMS_TO_TICKS(10));
-            continue;
+#if CONFIG_UL_WS_STREAM
+// ---------------------------------------------------------------------------
+// Raw frame streaming
+//
+// Music-reactive and video-mapped installs need the server to drive pixels
+// directly; JSON through the command path tops out at a few frames per
+// second. While a strip streams, a UDP listener owns its double buffer: each
+// datagram is a 4-byte header {0x55, flags, seq_lo, seq_hi} followed by
+// packed RGB for the whole strip, received with recvmsg() straight into the
+// idle render buffer -- the same buffer led_strip_set_pixels() hands to the
+// driver, so nothing is copied between the socket and DMA submission.
+// Frames are last-write-wins: stale sequence numbers, and frames arriving
+// while the previous one is still clocking out, are dropped with no
+// retransmit. The gamma/brightness LUT and the power limiter still run (in
+// place), so ws/set brightness and the configured power budget keep
+// working. Strip i listens on CONFIG_UL_WS_STREAM_PORT + i.
+
+#define UL_WS_STREAM_MAGIC 0x55
+#define UL_WS_STREAM_HDR_LEN 4
+// Receive timeout; how often the listener re-checks its stop flag.
+#define UL_WS_STREAM_POLL_MS 200
+
+static void ws_stream_task(void* arg) {
+    ws_strip_t* s = (ws_strip_t*)arg;
+    uint8_t hdr[UL_WS_STREAM_HDR_LEN];
+    while (!s->stream_stop) {
+        struct iovec iov[2] = {
+            { .iov_base = hdr, .iov_len = sizeof(hdr) },
+            { .iov_base = s->frame, .iov_len = (size_t)s->pixels * 3 },
+        };
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 2 };
+        int n = recvmsg(s->stream_sock, &msg, 0);
+        if (n < 0) continue; // timeout or transient error; re-check stop
+        if (n != UL_WS_STREAM_HDR_LEN + s->pixels * 3 ||
+            hdr[0] != UL_WS_STREAM_MAGIC) {
+            continue; // wrong pixel count or foreign datagram
         }
-        if (xSemaphoreTake(s_refresh_sem, portMAX_DELAY) != pdTRUE) {
-            continue;
+        uint16_t seq = (uint16_t)(hdr[2] | ((uint16_t)hdr[3] << 8));
+        if (s->stream_seq_valid && (int16_t)(seq - s->stream_seq) <= 0) {
+            continue; // reordered; a newer frame is already showing
         }
-#if CONFIG_UL_WS0_ENABLED
-        if (s_strips[0].handle) led_strip_refresh(s_strips[0].handle);
-#endif
-#if CONFIG_UL_WS1_ENABLED
-        if (s_strips[1].handle) led_strip_refresh(s_strips[1].handle);
+        s->stream_seq = seq;
+        s->stream_seq_valid = true;
+        if (s->tx_pending) continue; // previous frame still on the wire
+        finish_frame(s, s->frame);
+        limit_frame_power(s);
+        s->tx_frame = s->frame;
+        s->tx_pending = true;
+        s->render_buf ^= 1;
+        s->frame = s->frames[s->render_buf];
+        int tx_pixels;
+        const uint8_t* out = map_tx_frame(s, s->tx_frame, &tx_pixels);
+        ws_push_pixels(s, 0, tx_pixels, out);
+        s->tx_start_us = esp_timer_get_time();
+        esp_err_t err = led_strip_refresh_async(s->handle, ws_tx_done_cb, s);
+        if (err != ESP_OK) {
+            // Unlike the render loop there is no later retry pass; release
+            // the buffer so the next frame can go out.
+            ESP_LOGW(TAG, "Stream refresh failed (%d)", (int)err);
+            s->tx_pending = false;
+        }
+    }
+    close(s->stream_sock);
+    s->stream_sock = -1;
+    s->stream_task = NULL;
+    s->stream_active = false; // hands the strip back to the render task
+    ul_task_forget(NULL);
+    vTaskDelete(NULL);
+}
+
+static bool ws_stream_set(int strip, bool enable) {
+    ws_strip_t* s = get_strip(strip);
+    if (!s) return false;
+    if (!enable) {
+        if (!s->stream_active) return true;
+        s->stream_stop = true;
+        // The listener wakes within its receive timeout and exits; wait for
+        // the buffer handoff before the render task takes over again.
+        while (s->stream_active) vTaskDelay(1);
+        s->last_tx_valid = false; // force the first effect frame onto the wire
+        s->next_due = 0;
+        return true;
+    }
+    if (s->stream_active) return true;
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (sock < 0) {
+        ESP_LOGW(TAG, "Failed to create stream socket for strip %d", strip);
+        return false;
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_UL_WS_STREAM_PORT + strip),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        ESP_LOGW(TAG, "Failed to bind stream port %d",
+                 CONFIG_UL_WS_STREAM_PORT + strip);
+        close(sock);
+        return false;
+    }
+    struct timeval tv = { .tv_sec = 0, .tv_usec = UL_WS_STREAM_POLL_MS * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    s->stream_sock = sock;
+    s->stream_stop = false;
+    s->stream_seq_valid = false;
+    s->stream_active = true;
+    // The render task stops touching the strip once it sees the flag; give
+    // a render_one() already in flight time to finish before the listener
+    // starts writing into the buffers.
+    vTaskDelay(pdMS_TO_TICKS(20));
+    char name[16];
+    snprintf(name, sizeof(name), "ws_stream%d", strip);
+    // Core 0 with the rest of networking; the per-frame work is one LUT
+    // pass, so it does not fight the renderers on core 1.
+    if (ul_task_create(ws_stream_task, name, 3072, s, 18, &s->stream_task,
+                       0) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create stream task for strip %d", strip);
+        close(sock);
+        s->stream_sock = -1;
+        s->stream_active = false;
+        return false;
+    }
+    ESP_LOGI(TAG, "Strip %d streaming on UDP port %d", strip,
+             CONFIG_UL_WS_STREAM_PORT + strip);
+    return true;
+}
+#else
+static bool ws_stream_set(int strip, bool enable) {
+    (void)strip;
+    (void)enable;
+    return false;
+}
+#endif // CONFIG_UL_WS_STREAM
+
+static TickType_t strip_period_ticks(const ws_strip_t* s) {
+    TickType_t period = pdMS_TO_TICKS(1000 / s->current_fps);
+    return period > 0 ? period : 1;
+}
+
+// arg is the single ws_strip_t to service (per-strip render tasks) or NULL to
+// service every enabled strip from one task.
+static void ws_task(void* arg)
+{
+    ws_strip_t* only = (ws_strip_t*)arg;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t next_wake = now + pdMS_TO_TICKS(1000);
+        bool rendered = false;
+        for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+            ws_strip_t* s = &s_strips[i];
+            if (only && s != only) continue;
+            if (!s->handle || s->pixels <= 0) continue;
+#if CONFIG_UL_WS_STREAM
+            if (s->stream_active) continue; // the UDP listener owns this strip
 #endif
+            if ((int32_t)(now - s->next_due) >= 0) {
+                TickType_t period = strip_period_ticks(s);
+                // Late by a full period or more: the frame budget was blown
+                // (slow effect, busy core). Count it for fleet monitoring;
+                // scheduling from `now` below drops the missed frames
+                // instead of replaying them.
+                if (s->next_due != 0 &&
+                    (int32_t)(now - s->next_due) >= (int32_t)period) {
+                    s->overruns++;
+                }
+                bool delivered = render_one(s, i);
+                pace_strip(s, delivered);
+                rendered = true;
+                TickType_t step = period;
+                if (delivered && s->skip_frames > 1) {
+                    // Hold the frame through the effect's quiet gap. A
+                    // dropped frame is excluded: the LEDs still show the
+                    // previous one, so the retry must not be deferred.
+                    int max_skip = (s->current_fps * WS_MAX_SKIP_MS) / 1000;
+                    if (max_skip < 1) max_skip = 1;
+                    int skip = s->skip_frames;
+                    if (skip > max_skip) skip = max_skip;
+                    // Advance the phase past the skipped frames so the
+                    // effect resumes where continuous rendering would be.
+                    s->frame_pos += (float)(skip - 1);
+                    step = period * (TickType_t)skip;
+                }
+                s->next_due = now + step;
+            }
+            if ((int32_t)(s->next_due - next_wake) < 0) next_wake = s->next_due;
+        }
+        if (rendered) refresh_strips();
+        TickType_t delay = next_wake - now;
+        if (delay == 0) delay = 1;
+        // When the loop body overran the scheduled wakeup, vTaskDelayUntil()
+        // would fire the missed wakeups back-to-back and starve lower
+        // priority tasks; resynchronize the wake reference instead.
+        TickType_t after = xTaskGetTickCount();
+        if ((int32_t)(after - (last_wake + delay)) > 0) {
+            last_wake = after;
+            vTaskDelay(1);
+        } else {
+            vTaskDelayUntil(&last_wake, delay);
+        }
     }
 }
 
 static void ws_engine_shutdown(void) {
-    if (s_refresh_task) {
-        vTaskDelete(s_refresh_task);
-        s_refresh_task = NULL;
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+        ws_stream_set(i, false);
     }
-    if (s_ws_task) {
-        vTaskDelete(s_ws_task);
-        s_ws_task = NULL;
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+        if (s_ws_tasks[i]) {
+            ul_task_forget(s_ws_tasks[i]);
+            vTaskDelete(s_ws_tasks[i]);
+            s_ws_tasks[i] = NULL;
+        }
     }
-    for (int i = 0; i < 2; ++i) {
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
         deinit_strip(i);
     }
-    if (s_refresh_sem) {
-        vSemaphoreDelete(s_refresh_sem);
-        s_refresh_sem = NULL;
+    ul_ws_psram_arena_release();
+}
+
+// Replay the last persisted command for each configured strip so the pixels
+// come back at their pre-power-cycle state as soon as the render tasks spin
+// up. The payloads were prefetched into RAM by ul_state_init(), so this is a
+// parse per strip with no flash reads on the boot path. The "strip" field is
+// pinned to the slot index because the original command may have carried the
+// index only in the topic path.
+static void ws_restore_saved_state(void)
+{
+    char *payload = malloc(UL_STATE_MAX_JSON_LEN);
+    if (!payload) return;
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+        if (s_strips[i].pixels <= 0) continue;
+        if (!ul_state_copy_ws(i, payload, UL_STATE_MAX_JSON_LEN)) continue;
+        cJSON* root = cJSON_Parse(payload);
+        if (!root) continue;
+        cJSON* jstrip = cJSON_GetObjectItem(root, "strip");
+        if (!jstrip) {
+            cJSON_AddNumberToObject(root, "strip", i);
+        } else {
+            jstrip->valueint = i;
+            jstrip->valuedouble = (double)i;
+        }
+        ul_ws_apply_json(root);
+        cJSON_Delete(root);
     }
+    free(payload);
 }
 
-bool ul_ws_engine_start(void)
+// Health provider, polled once per health monitor period. Summed across
+// strips so a single stuttering strip flags the node; current_fps below
+// target means adaptive pacing had to back off.
+static void ws_render_stats(uint32_t *overruns, uint32_t *degraded)
 {
-    if (!ul_core_is_connected()) {
-        ESP_LOGW(TAG, "Network not connected; WS engine not started");
-        return false;
+    uint32_t total = 0;
+    uint32_t below = 0;
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+        ws_strip_t* s = &s_strips[i];
+        if (!s->handle || s->pixels <= 0) continue;
+        total += s->overruns;
+        if (s->current_fps < s->target_fps) below++;
     }
+    *overruns = total;
+    *degraded = below;
+}
+
+bool ul_ws_engine_start(void)
+{
+    build_power_lut();
 
     bool strip0_requested = false;
     bool strip0_ok = true;
 #if CONFIG_UL_WS0_ENABLED
     strip0_requested = true;
-    strip0_ok = init_strip(0, CONFIG_UL_WS0_GPIO, CONFIG_UL_WS0_PIXELS, true);
+    strip0_ok = init_strip(0, CONFIG_UL_WS0_GPIO, CONFIG_UL_WS0_PIXELS,
+                           CONFIG_UL_WS0_POWER_BUDGET_MA, CONFIG_UL_WS0_RGBW, true);
 #else
-    strip0_ok = init_strip(0, 0, 0, false);
+    strip0_ok = init_strip(0, 0, 0, 0, false, false);
 #endif
 
     bool strip1_requested = false;
@@ -343,50 +1559,101 @@ bool ul_ws_engine_start(void)
 #if !CONFIG_UL_IS_ESP32C3
 #if CONFIG_UL_WS1_ENABLED
     strip1_requested = true;
-    strip1_ok = init_strip(1, CONFIG_UL_WS1_GPIO, CONFIG_UL_WS1_PIXELS, true);
+    strip1_ok = init_strip(1, CONFIG_UL_WS1_GPIO, CONFIG_UL_WS1_PIXELS,
+                           CONFIG_UL_WS1_POWER_BUDGET_MA, CONFIG_UL_WS1_RGBW, true);
 #else
-    strip1_ok = init_strip(1, 0, 0, false);
+    strip1_ok = init_strip(1, 0, 0, 0, false, false);
 #endif
 #else
-    strip1_ok = init_strip(1, 0, 0, false);
+    strip1_ok = init_strip(1, 0, 0, 0, false, false);
 #endif
 
     bool strip_failure = (strip0_requested && !strip0_ok) ||
                          (strip1_requested && !strip1_ok);
+
+#if CONFIG_UL_WS_RMT_EXPANSION
+    static const struct { bool enabled; int gpio; int pixels; int budget_ma; bool rgbw; } ext_cfg[] = {
+#if CONFIG_UL_WS2_ENABLED
+        { true, CONFIG_UL_WS2_GPIO, CONFIG_UL_WS2_PIXELS, CONFIG_UL_WS2_POWER_BUDGET_MA, CONFIG_UL_WS2_RGBW },
+#else
+        { false, 0, 0, 0, false },
+#endif
+#if CONFIG_UL_WS3_ENABLED
+        { true, CONFIG_UL_WS3_GPIO, CONFIG_UL_WS3_PIXELS, CONFIG_UL_WS3_POWER_BUDGET_MA, CONFIG_UL_WS3_RGBW },
+#else
+        { false, 0, 0, 0, false },
+#endif
+#if CONFIG_UL_WS4_ENABLED
+        { true, CONFIG_UL_WS4_GPIO, CONFIG_UL_WS4_PIXELS, CONFIG_UL_WS4_POWER_BUDGET_MA, CONFIG_UL_WS4_RGBW },
+#else
+        { false, 0, 0, 0, false },
+#endif
+#if CONFIG_UL_WS5_ENABLED
+        { true, CONFIG_UL_WS5_GPIO, CONFIG_UL_WS5_PIXELS, CONFIG_UL_WS5_POWER_BUDGET_MA, CONFIG_UL_WS5_RGBW },
+#else
+        { false, 0, 0, 0, false },
+#endif
+#if CONFIG_UL_WS6_ENABLED
+        { true, CONFIG_UL_WS6_GPIO, CONFIG_UL_WS6_PIXELS, CONFIG_UL_WS6_POWER_BUDGET_MA, CONFIG_UL_WS6_RGBW },
+#else
+        { false, 0, 0, 0, false },
+#endif
+#if CONFIG_UL_WS7_ENABLED
+        { true, CONFIG_UL_WS7_GPIO, CONFIG_UL_WS7_PIXELS, CONFIG_UL_WS7_POWER_BUDGET_MA, CONFIG_UL_WS7_RGBW },
+#else
+        { false, 0, 0, 0, false },
+#endif
+    };
+    for (int i = 0; i < (int)(sizeof(ext_cfg) / sizeof(ext_cfg[0])); ++i) {
+        bool ok = init_strip(UL_WS_SPI_STRIPS + i, ext_cfg[i].gpio,
+                             ext_cfg[i].pixels, ext_cfg[i].budget_ma,
+                             ext_cfg[i].rgbw, ext_cfg[i].enabled);
+        strip_failure = strip_failure || (ext_cfg[i].enabled && !ok);
+    }
+#endif
+
     if (strip_failure) {
         ESP_LOGE(TAG, "WS engine failed to initialize strips; keeping engine offline");
         ws_engine_shutdown();
         return false;
     }
 
-    s_refresh_sem = xSemaphoreCreateBinary();
-    if (!s_refresh_sem) {
-        ESP_LOGE(TAG, "Failed to create WS refresh semaphore");
-        ws_engine_shutdown();
-        return false;
-    }
-    // Pixel refresh tasks pin to core 1 on multi-core targets to free core 0
-    // for networking and other work.
-    BaseType_t rc = ul_task_create(led_refresh_task, "ws_refresh", 2048, NULL, 24,
-                                   &s_refresh_task, 1);
-    if (rc != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create WS refresh task (%ld)", (long)rc);
-        s_refresh_task = NULL;
-        ws_engine_shutdown();
-        return false;
+    // Worst-case field buffers for the PSRAM-tier effects, reserved once so
+    // effect switches never fragment the PSRAM heap. Failure is non-fatal:
+    // the effects fall back to per-switch heap allocations.
+    ul_ws_psram_arena_reserve();
+
+    // Render tasks pin to core 1 on multi-core targets to free core 0 for
+    // networking and other work. Transmission is queued on the SPI driver
+    // from the render loop, so no dedicated refresh task is needed.
+    BaseType_t rc;
+#if CONFIG_UL_WS_RENDER_TASK_PER_STRIP
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+        if (s_strips[i].pixels <= 0) continue;
+        char name[16];
+        snprintf(name, sizeof(name), "ws_rend%d", i);
+        // Strips after the first go to core 0 so renders overlap; networking
+        // shares core 0 but renders are short compared to transmit.
+        rc = ul_task_create(ws_task, name, 6144,
+                            &s_strips[i], 23, &s_ws_tasks[i], i == 0 ? 1 : 0);
+        if (rc != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create WS render task %d (%ld)", i, (long)rc);
+            s_ws_tasks[i] = NULL;
+            ws_engine_shutdown();
+            return false;
+        }
     }
-    rc = ul_task_create(ws_task, "ws60fps", 6144, NULL, 23, &s_ws_task, 1);
+#else
+    rc = ul_task_create(ws_task, "ws60fps", 6144, NULL, 23, &s_ws_tasks[0], 1);
     if (rc != pdPASS) {
         ESP_LOGE(TAG, "Failed to create WS render task (%ld)", (long)rc);
-        if (s_refresh_task) {
-            vTaskDelete(s_refresh_task);
-            s_refresh_task = NULL;
-        }
-        s_ws_task = NULL;
+        s_ws_tasks[0] = NULL;
         ws_engine_shutdown();
         return false;
     }
-    if (s_refresh_sem) xSemaphoreGive(s_refresh_sem);
+#endif
+    ul_health_register_render_stats(ws_render_stats);
+    ws_restore_saved_state();
     return true;
 }
 
@@ -414,7 +1681,7 @@ bool ul_ws_hex_to_rgb(const char* hex, uint8_t* r, uint8_t* g, uint8_t* b) {
 // ---- Control & Status API ----
 
 static ws_strip_t* get_strip(int idx) {
-    if (idx < 0 || idx > 1) return NULL;
+    if (idx < 0 || idx >= UL_WS_MAX_STRIPS) return NULL;
     if (s_strips[idx].pixels <= 0) return NULL;
     return &s_strips[idx];
 }
@@ -424,9 +1691,32 @@ bool ul_ws_set_effect(int strip, const char* name) {
     if (!s) return false;
     const ws_effect_t* e = find_effect_by_name(name);
     if (!e) return false;
+    s->segment_count = 0; // whole-strip effect replaces any segment table
+    const ws_effect_t* prev = s->eff;
+#if CONFIG_UL_WS_CROSSFADE_FRAMES > 0
+    // Blend away from the outgoing effect instead of popping. Skipped when
+    // the fade buffer cannot be allocated or the effect is unchanged.
+    if (prev && prev != e && prev->render) {
+        if (!s->fade_buf) {
+            // Sized to max_pixels so a later ul_ws_set_pixels() growth never
+            // outruns an already-allocated crossfade buffer.
+            s->fade_buf = (uint8_t*)heap_caps_malloc(s->max_pixels * 3, MALLOC_CAP_8BIT);
+        }
+        if (s->fade_buf) {
+            s->fade_eff = prev;
+            s->fade_pos = s->frame_pos; // old effect continues from where it was
+            s->fade_frames_total = CONFIG_UL_WS_CROSSFADE_FRAMES;
+            s->fade_frames_left = CONFIG_UL_WS_CROSSFADE_FRAMES;
+        }
+    }
+#else
+    (void)prev;
+#endif
     s->eff = e;
     s->frame_pos = 0.0f;
+    reset_frame_stats(s);
     if (s->eff->init) s->eff->init();
+    cycle_cache_setup(s, strip);
     return true;
 }
 
@@ -445,17 +1735,86 @@ void ul_ws_get_solid_rgb(int strip, uint8_t* r, uint8_t* g, uint8_t* b) {
 void ul_ws_set_brightness(int strip, uint8_t bri) {
     ws_strip_t* s = get_strip(strip);
     if (!s) return;
-    s->brightness = bri;
+    s->bri_ramp_active = false;
+    if (s->brightness != bri) {
+        s->brightness = bri;
+        rebuild_lut(s);
+    }
+}
+
+void ul_ws_set_brightness_ramp(int strip, uint8_t target, int duration_ms) {
+    ws_strip_t* s = get_strip(strip);
+    if (!s) return;
+    if (duration_ms <= 0 || s->brightness == target) {
+        ul_ws_set_brightness(strip, target);
+        return;
+    }
+    s->bri_ramp_from = s->brightness;
+    s->bri_ramp_target = target;
+    s->bri_ramp_start_us = esp_timer_get_time();
+    s->bri_ramp_duration_ms = duration_ms;
+    s->bri_ramp_active = true;
+}
+
+void ul_ws_set_fps(int strip, int fps) {
+    ws_strip_t* s = get_strip(strip);
+    if (!s) return;
+    if (fps < WS_FPS_MIN) fps = WS_FPS_MIN;
+    if (fps > WS_FPS_MAX) fps = WS_FPS_MAX;
+    s->target_fps = fps;
+    s->current_fps = fps; // adaptive pacing re-lowers it if the strip can't keep up
+    s->clean_frames = 0;
+    s->next_due = 0;
+}
+
+// Live strip length for the segment compositor and commissioning tools that
+// probe lengths interactively. Buffers and the driver device keep their
+// boot-time (Kconfig) size; only the bound moves, so the change allocates
+// nothing and the strip never drops dark. Returns false for a disabled strip
+// or a length the boot-time buffers cannot hold.
+bool ul_ws_set_pixels(int strip, int pixels) {
+    ws_strip_t* s = get_strip(strip);
+    if (!s || !s->handle) return false;
+    if (pixels < 1 || pixels > s->max_pixels) return false;
+    int old_pixels = s->pixels;
+    if (pixels == old_pixels) return true;
+    s->pixels = pixels;
+    if (s->pixel_map) {
+        // The map was built for the old length; resend the geometry after a
+        // length change.
+        ESP_LOGW(TAG, "Length change dropped the pixel map on strip %d", strip);
+        pixel_map_drop(s);
+    }
+    if (pixels < old_pixels) {
+        // Steady-state transmit only pushes the first `pixels` LEDs, which
+        // would leave the abandoned tail frozen at its last colors; scrub it
+        // once in both render buffers and the driver's buffer.
+        int bpp = strip_bpp(s);
+        memset(s->frames[0] + pixels * bpp, 0, (size_t)(old_pixels - pixels) * bpp);
+        memset(s->frames[1] + pixels * bpp, 0, (size_t)(old_pixels - pixels) * bpp);
+        ws_push_pixels(s, pixels, old_pixels - pixels, s->frames[0] + pixels * bpp);
+        // Clamp segment slices to the new bound; emptied slices drop out.
+        int kept = 0;
+        for (int i = 0; i < s->segment_count; ++i) {
+            ws_segment_t seg = s->segments[i];
+            if (seg.offset >= pixels) continue;
+            if (seg.offset + seg.length > pixels) seg.length = pixels - seg.offset;
+            s->segments[kept++] = seg;
+        }
+        s->segment_count = kept;
+    }
+    // Baked cycle frames and the transmit hash reflect the old length.
+    cycle_cache_setup(s, strip);
+    s->last_tx_valid = false;
+    reset_frame_stats(s);
+    return true;
 }
 
 int ul_ws_get_strip_count(void) {
     int n=0;
-#if CONFIG_UL_WS0_ENABLED
-    if (s_strips[0].pixels>0) n++;
-#endif
-#if CONFIG_UL_WS1_ENABLED
-    if (s_strips[1].pixels>0) n++;
-#endif
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+        if (s_strips[i].pixels>0) n++;
+    }
     return n;
 }
 
@@ -466,12 +1825,101 @@ bool ul_ws_get_status(int idx, ul_ws_strip_status_t* out) {
     out->enabled = true;
     out->brightness = s->brightness;
     out->pixels = s->pixels;
+    out->max_pixels = s->max_pixels;
     out->gpio = 0; // not tracked in led_strip
-    out->fps = CONFIG_UL_WS2812_FPS;
-    strncpy(out->effect, s->eff ? s->eff->name : "unknown", sizeof(out->effect)-1);
+    out->fps = s->current_fps;
+    out->render_us_min = (s->render_frames > 0) ? s->render_us_min : 0;
+    out->render_us_max = s->render_us_max;
+    out->render_us_avg = (s->render_frames > 0)
+        ? (uint32_t)(s->render_us_sum / s->render_frames) : 0;
+    out->tx_us = s->tx_us_last;
+    out->overruns = s->overruns;
+    out->power_clamps = s->power_clamps;
+    out->frames_internal = s->frames_internal;
+    out->segments = s->segment_count;
+    out->render_scale = s->render_scale ? s->render_scale : 1;
+    out->mapped = s->pixel_map != NULL;
+    out->rgbw = s->rgbw;
+    const char* shown = s->segment_count > 0
+        ? "segments"
+        : (s->eff ? s->eff->name : "unknown");
+#if CONFIG_UL_WS_STREAM
+    if (s->stream_active) shown = "stream";
+#endif
+    strncpy(out->effect, shown, sizeof(out->effect)-1);
     out->effect[sizeof(out->effect)-1]=0;
     out->color[0]=s->solid_r; out->color[1]=s->solid_g; out->color[2]=s->solid_b;
     return true;
 }
 
+bool ul_ws_get_frame_load(int strip, uint32_t* render_us, uint32_t* period_us) {
+    ws_strip_t* s = get_strip(strip);
+    if (!s || s->render_frames == 0 || s->current_fps <= 0) return false;
+    if (render_us) *render_us = s->render_us_last;
+    if (period_us) *period_us = 1000000u / (uint32_t)s->current_fps;
+    return true;
+}
+
+// On-device microbenchmark: host runs can't reproduce PSRAM latency, flash
+// cache pressure or the FPU gap across the deployed ESP32/S2/C3 mix, so this
+// times each registered effect on the node itself, at its real pixel count.
+// Renders go to a scratch buffer; the live strips keep animating around it.
+int ul_ws_benchmark(int frames, ul_ws_benchmark_result_t* out, int max_results,
+                    int* pixels_out, uint32_t* lut_us_out) {
+    if (pixels_out) *pixels_out = 0;
+    if (lut_us_out) *lut_us_out = 0;
+    if (frames <= 0 || !out || max_results <= 0) return 0;
+
+    ws_strip_t* ref = NULL;
+    int ref_idx = 0;
+    for (int i = 0; i < UL_WS_MAX_STRIPS; ++i) {
+        if (s_strips[i].handle && s_strips[i].pixels > 0) { ref = &s_strips[i]; ref_idx = i; break; }
+    }
+    if (!ref) return 0;
+    int pixels = ref->pixels;
+    if (pixels_out) *pixels_out = pixels;
+
+    uint8_t* scratch = (uint8_t*)malloc((size_t)pixels * 3);
+    if (!scratch) return 0;
+
+    int eff_count = 0;
+    const ws_effect_t* effects = ul_ws_get_effects(&eff_count);
+    int written = 0;
+    for (int e = 0; e < eff_count && written < max_results; ++e) {
+        const ws_effect_t* eff = &effects[e];
+        if (!eff->render) continue;
+        // Re-init so stateful effects render from a defined state instead of
+        // whatever a live strip left behind; a strip running this effect
+        // restarts its animation, which is acceptable for a diagnostic.
+        if (eff->init) eff->init();
+        uint64_t sum = 0;
+        uint32_t worst = 0;
+        for (int k = 0; k < frames; ++k) {
+            int64_t t0 = esp_timer_get_time();
+            eff->render(ref_idx, scratch, pixels, k);
+            uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+            sum += dt;
+            if (dt > worst) worst = dt;
+        }
+        ul_ws_benchmark_result_t* r = &out[written++];
+        strncpy(r->name, eff->name, sizeof(r->name) - 1);
+        r->name[sizeof(r->name) - 1] = 0;
+        r->avg_us = (uint32_t)(sum / (uint32_t)frames);
+        r->max_us = worst;
+    }
+
+    // Gamma/brightness pass, averaged over the same frame count for stable
+    // sub-microsecond-per-byte resolution.
+    if (lut_us_out) {
+        int64_t t0 = esp_timer_get_time();
+        for (int k = 0; k < frames; ++k) {
+            apply_lut(scratch, pixels * 3, ref->lut);
+        }
+        *lut_us_out = (uint32_t)((esp_timer_get_time() - t0) / frames);
+    }
+
+    free(scratch);
+    return written;
+}
+
 #endif  // any WS strips enabled
@@ -19,19 +19,25 @@
 #include "ul_state.h"
 #include "ul_mqtt.h"
 #include "ul_task.h"
+#include "ul_work.h"
 #include "ul_health.h"
 #include "ul_provisioning.h"
+#include "ul_tls_pool.h"
 #include "ul_white_engine.h"
 #include "ul_ws_engine.h"
 #include "ul_rgb_engine.h"
+#include "ul_cron.h"
+#include "ul_ota.h"
+#include "ul_udp_ctrl.h"
 #include "ul_wifi_credentials.h"
+#include "boot_timing.h"
 #if CONFIG_UL_PIR_ENABLED
 #include "ul_pir.h"
 #endif
 
 static const char *TAG = "app";
 
-static bool s_services_running = false;
+static bool s_mqtt_running = false;
 
 typedef enum {
   SERVICE_MSG_CONNECTIVITY,
@@ -53,47 +59,46 @@ static service_context_t s_service_ctx = {0};
 static bool s_wifi_connected = false;
 
 #if CONFIG_UL_WIFI_RESET_BUTTON_ENABLE
-static void wifi_reset_button_task(void *arg) {
+// Runs on the shared work executor instead of a dedicated 2 KB polling task.
+static void wifi_reset_button_poll(void *arg) {
   (void)arg;
-  const TickType_t poll_delay = pdMS_TO_TICKS(CONFIG_UL_WIFI_RESET_BUTTON_POLL_MS);
+  static int64_t press_start_us = 0;
   const int64_t hold_time_us = (int64_t)CONFIG_UL_WIFI_RESET_BUTTON_HOLD_MS * 1000;
-  int64_t press_start_us = 0;
 
-  while (true) {
-    int level = gpio_get_level((gpio_num_t)CONFIG_UL_WIFI_RESET_BUTTON_GPIO);
-    if (level == 0) { // boot button held low
-      int64_t now_us = esp_timer_get_time();
-      if (press_start_us == 0) {
-        press_start_us = now_us;
-        ESP_LOGW(TAG,
-                 "Boot button pressed; hold for %d ms to clear Wi-Fi credentials",
-                 CONFIG_UL_WIFI_RESET_BUTTON_HOLD_MS);
-      } else if (now_us - press_start_us >= hold_time_us) {
-        ESP_LOGW(TAG,
-                 "Boot button held for %d ms; clearing Wi-Fi credentials and restarting",
-                 CONFIG_UL_WIFI_RESET_BUTTON_HOLD_MS);
-        esp_err_t err = ul_wifi_credentials_clear();
-        if (err != ESP_OK) {
-          ESP_LOGE(TAG, "Failed to clear Wi-Fi credentials: %s", esp_err_to_name(err));
-        } else {
-          ESP_LOGI(TAG, "Stored Wi-Fi credentials cleared");
-        }
-        vTaskDelay(pdMS_TO_TICKS(250));
-        esp_restart();
-      }
-    } else if (press_start_us != 0) {
-      int64_t held_ms = (esp_timer_get_time() - press_start_us) / 1000;
-      if (held_ms < CONFIG_UL_WIFI_RESET_BUTTON_HOLD_MS) {
-        ESP_LOGI(TAG,
-                 "Boot button released after %lld ms; Wi-Fi credentials unchanged",
-                 (long long)held_ms);
+  int level = gpio_get_level((gpio_num_t)CONFIG_UL_WIFI_RESET_BUTTON_GPIO);
+  if (level == 0) { // boot button held low
+    int64_t now_us = esp_timer_get_time();
+    if (press_start_us == 0) {
+      press_start_us = now_us;
+      ESP_LOGW(TAG,
+               "Boot button pressed; hold for %d ms to clear Wi-Fi credentials",
+               CONFIG_UL_WIFI_RESET_BUTTON_HOLD_MS);
+    } else if (now_us - press_start_us >= hold_time_us) {
+      ESP_LOGW(TAG,
+               "Boot button held for %d ms; clearing Wi-Fi credentials and restarting",
+               CONFIG_UL_WIFI_RESET_BUTTON_HOLD_MS);
+      esp_err_t err = ul_wifi_credentials_clear();
+      if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to clear Wi-Fi credentials: %s", esp_err_to_name(err));
+      } else {
+        ESP_LOGI(TAG, "Stored Wi-Fi credentials cleared");
       }
-      press_start_us = 0;
+      vTaskDelay(pdMS_TO_TICKS(250));
+      esp_restart();
+    }
+  } else if (press_start_us != 0) {
+    int64_t held_ms = (esp_timer_get_time() - press_start_us) / 1000;
+    if (held_ms < CONFIG_UL_WIFI_RESET_BUTTON_HOLD_MS) {
+      ESP_LOGI(TAG,
+               "Boot button released after %lld ms; Wi-Fi credentials unchanged",
+               (long long)held_ms);
     }
-    vTaskDelay(poll_delay);
+    press_start_us = 0;
   }
 }
 
+static ul_work_job_t s_wifi_reset_button_job;
+
 static void start_wifi_reset_button_monitor(void) {
   gpio_config_t cfg = {
       .pin_bit_mask = 1ULL << CONFIG_UL_WIFI_RESET_BUTTON_GPIO,
@@ -109,9 +114,10 @@ static void start_wifi_reset_button_monitor(void) {
     return;
   }
 
-  if (xTaskCreate(wifi_reset_button_task, "wifi_reset_btn", 2048, NULL, 3,
-                  NULL) != pdPASS) {
-    ESP_LOGE(TAG, "Failed to start Wi-Fi reset button task");
+  ul_work_job_init(&s_wifi_reset_button_job, wifi_reset_button_poll, NULL, 1);
+  if (ul_work_schedule_periodic(&s_wifi_reset_button_job,
+                                CONFIG_UL_WIFI_RESET_BUTTON_POLL_MS) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to schedule Wi-Fi reset button poll");
   } else {
     ESP_LOGI(TAG, "Wi-Fi reset button monitor started on GPIO%d",
              CONFIG_UL_WIFI_RESET_BUTTON_GPIO);
@@ -125,48 +131,32 @@ static void service_manager_task(void *ctx) {
   while (xQueueReceive(s_service_queue, &msg, portMAX_DELAY) == pdTRUE) {
     switch (msg.type) {
     case SERVICE_MSG_CONNECTIVITY: {
+      // The light engines run from boot regardless of connectivity; only
+      // MQTT follows the network up and down.
       bool connected = msg.connected;
       if (connected) {
         if (!s_wifi_connected) {
           s_wifi_connected = true;
           ESP_LOGI(TAG, "Network connected");
         }
-        if (!s_services_running) {
+        if (!s_mqtt_running) {
           ul_mqtt_start();
-          bool ws_started = ul_ws_engine_start();    // 60 FPS LED engine
-          if (!ws_started) {
-            ESP_LOGE(TAG, "WS engine failed to start; running without it");
-          }
-          ul_rgb_engine_start();   // RGB PWM engine
-          bool white_started = ul_white_engine_start(); // 200 Hz smoothing
-          if (!white_started) {
-            ESP_LOGE(TAG, "White engine failed to start; running without it");
-          }
-#if CONFIG_UL_PIR_ENABLED
-          ul_pir_start();
-#endif
-          s_services_running = true;
+          s_mqtt_running = true;
         }
       } else {
         if (s_wifi_connected) {
           s_wifi_connected = false;
           ESP_LOGW(TAG, "Network disconnected");
         }
-        if (s_services_running) {
+        if (s_mqtt_running) {
           ul_mqtt_stop();
-          ul_ws_engine_stop();
-          ul_rgb_engine_stop();
-          ul_white_engine_stop();
-#if CONFIG_UL_PIR_ENABLED
-          ul_pir_stop();
-#endif
-          s_services_running = false;
+          s_mqtt_running = false;
         }
       }
       break;
     }
     case SERVICE_MSG_RESTART_MQTT:
-      if (!s_services_running) {
+      if (!s_mqtt_running) {
         ESP_LOGW(TAG, "MQTT restart requested while services are stopped");
       } else {
         ESP_LOGW(TAG, "Health monitor requesting MQTT restart");
@@ -216,6 +206,11 @@ static void request_mqtt_recovery(void *ctx) {
   }
 }
 
+static void publish_metrics(void *ctx) {
+  (void)ctx;
+  ul_mqtt_publish_metrics();
+}
+
 static void connectivity_cb(bool connected, void *ctx) {
   (void)ctx;
   ul_health_notify_connectivity(connected);
@@ -229,6 +224,15 @@ void app_main(void) {
   ESP_LOGI(TAG, "UltraLights boot");
 
   ESP_ERROR_CHECK(nvs_flash_init());
+  boot_timing_mark("nvs");
+#if CONFIG_UL_TLS_POOL
+  // Before any TLS use so every mbedtls allocation lands in the pool.
+  ul_tls_pool_init();
+#endif
+  ul_task_init();
+  if (ul_work_start() != ESP_OK) {
+    ESP_LOGE(TAG, "Deferred-work executor unavailable");
+  }
 #if CONFIG_UL_WIFI_RESET_BUTTON_ENABLE
   start_wifi_reset_button_monitor();
 #endif
@@ -237,6 +241,7 @@ void app_main(void) {
     ESP_LOGE(TAG, "State persistence disabled: %s",
              esp_err_to_name(state_err));
   }
+  boot_timing_mark("state");
   ESP_ERROR_CHECK(esp_netif_init());
   ESP_ERROR_CHECK(esp_event_loop_create_default());
 
@@ -302,8 +307,7 @@ void app_main(void) {
 
   // FREE THE CREDENTIALS MEMORY NOW THAT WE ARE DONE LOADING THEM
   free(creds);
-
-  ul_task_init();
+  boot_timing_mark("creds");
 
   s_service_queue = xQueueCreate(16, sizeof(service_msg_t));
   if (!s_service_queue) {
@@ -321,17 +325,44 @@ void app_main(void) {
   ul_health_config_t health_cfg = {
       .request_wifi_recovery = request_wifi_recovery,
       .request_mqtt_recovery = request_mqtt_recovery,
+      .publish_metrics = publish_metrics,
       .ctx = &s_service_ctx,
   };
   ul_health_start(&health_cfg);
 
+  // Light up before touching the network: the engines restore their last
+  // state from NVS, so after a power outage time-to-light is bounded by
+  // engine init, not by Wi-Fi association and DHCP.
+  bool ws_started = ul_ws_engine_start();    // 60 FPS LED engine
+  if (!ws_started) {
+    ESP_LOGE(TAG, "WS engine failed to start; running without it");
+  }
+  ul_rgb_engine_start();   // RGB PWM engine
+  bool white_started = ul_white_engine_start(); // 200 Hz smoothing
+  if (!white_started) {
+    ESP_LOGE(TAG, "White engine failed to start; running without it");
+  }
+#if CONFIG_UL_PIR_ENABLED
+  ul_pir_start();
+#endif
+  // The schedule loads now but entries only fire once SNTP has set the clock.
+  ul_cron_start();
+  // Serve the last completed update to LAN peers; the MQTT announcement
+  // follows once the broker connection is up.
+  ul_ota_seed_start();
+  boot_timing_mark("engines");
+  boot_timing_light_ready();
+
   ul_core_wifi_start();
   ul_core_register_connectivity_cb(connectivity_cb, NULL);
   bool connected = ul_core_wait_for_ip(portMAX_DELAY);
   if (!connected) {
     ESP_LOGE(TAG, "Failed to obtain IP address");
   }
+  boot_timing_mark("ip");
   ul_core_sntp_start();
+  // LAN command path; works with or without the broker.
+  ul_udp_ctrl_start();
 
   const TickType_t status_interval = pdMS_TO_TICKS(30 * 1000);
   const TickType_t wait_interval = pdMS_TO_TICKS(5000);
@@ -356,6 +387,15 @@ void app_main(void) {
         mqtt_ready = true;
         mqtt_wait_logged = false;
         ESP_LOGI(TAG, "MQTT connected; starting status heartbeat");
+        static bool boot_report_sent = false;
+        if (!boot_report_sent) {
+          boot_report_sent = true;
+          boot_timing_mark("mqtt");
+          char report[320];
+          if (boot_timing_report_json(report, sizeof(report)) > 0) {
+            ul_mqtt_publish_boot_report(report);
+          }
+        }
       } else {
         if (!mqtt_wait_logged) {
           ESP_LOGI(TAG, "Waiting for MQTT connection before publishing status");
@@ -0,0 +1,102 @@
+#include "boot_timing.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "boot_timing";
+
+#define BOOT_TIMING_MAX_STAGES 8
+#define BOOT_TIMING_RTC_MAGIC 0x544c4f42 // "BOLT"
+
+typedef struct {
+  const char *name; // stage names are string literals; no copy needed
+  uint32_t ms;      // cumulative milliseconds since reset
+} boot_stage_t;
+
+static boot_stage_t s_stages[BOOT_TIMING_MAX_STAGES];
+static int s_stage_count;
+static uint32_t s_light_ms;
+
+// Survives a software reset but not power loss, so a boot that crashes or
+// never reaches MQTT still gets its time-to-light reported by the next one.
+typedef struct {
+  uint32_t magic;
+  uint32_t light_ms;
+} boot_rtc_record_t;
+
+static RTC_NOINIT_ATTR boot_rtc_record_t s_rtc_record;
+
+static uint32_t s_prev_light_ms;
+static bool s_prev_valid;
+static bool s_prev_captured;
+
+static void capture_prev_record(void) {
+  if (s_prev_captured)
+    return;
+  s_prev_captured = true;
+  if (s_rtc_record.magic == BOOT_TIMING_RTC_MAGIC) {
+    s_prev_light_ms = s_rtc_record.light_ms;
+    s_prev_valid = true;
+  }
+}
+
+void boot_timing_mark(const char *stage) {
+  capture_prev_record();
+  uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+  if (s_stage_count < BOOT_TIMING_MAX_STAGES) {
+    s_stages[s_stage_count].name = stage;
+    s_stages[s_stage_count].ms = now_ms;
+    s_stage_count++;
+  }
+  ESP_LOGI(TAG, "stage %s at %u ms", stage, (unsigned)now_ms);
+}
+
+void boot_timing_light_ready(void) {
+  capture_prev_record();
+  s_light_ms = (uint32_t)(esp_timer_get_time() / 1000);
+  s_rtc_record.light_ms = s_light_ms;
+  s_rtc_record.magic = BOOT_TIMING_RTC_MAGIC;
+  if (s_light_ms > CONFIG_UL_BOOT_LIGHT_BUDGET_MS) {
+    ESP_LOGE(TAG, "Time-to-light %u ms exceeds %u ms budget",
+             (unsigned)s_light_ms, (unsigned)CONFIG_UL_BOOT_LIGHT_BUDGET_MS);
+  } else {
+    ESP_LOGI(TAG, "Time-to-light %u ms (budget %u ms)", (unsigned)s_light_ms,
+             (unsigned)CONFIG_UL_BOOT_LIGHT_BUDGET_MS);
+  }
+}
+
+size_t boot_timing_report_json(char *buf, size_t len) {
+  size_t pos = 0;
+  int n = snprintf(buf + pos, len - pos, "{\"event\":\"boot\",\"stages\":{");
+  if (n < 0 || (size_t)n >= len - pos)
+    return 0;
+  pos += (size_t)n;
+  for (int i = 0; i < s_stage_count; ++i) {
+    n = snprintf(buf + pos, len - pos, "%s\"%s\":%u", i ? "," : "",
+                 s_stages[i].name, (unsigned)s_stages[i].ms);
+    if (n < 0 || (size_t)n >= len - pos)
+      return 0;
+    pos += (size_t)n;
+  }
+  n = snprintf(buf + pos, len - pos,
+               "},\"time_to_light_ms\":%u,\"budget_ms\":%u",
+               (unsigned)s_light_ms, (unsigned)CONFIG_UL_BOOT_LIGHT_BUDGET_MS);
+  if (n < 0 || (size_t)n >= len - pos)
+    return 0;
+  pos += (size_t)n;
+  if (s_prev_valid) {
+    n = snprintf(buf + pos, len - pos, ",\"prev_time_to_light_ms\":%u",
+                 (unsigned)s_prev_light_ms);
+    if (n < 0 || (size_t)n >= len - pos)
+      return 0;
+    pos += (size_t)n;
+  }
+  n = snprintf(buf + pos, len - pos, "}");
+  if (n < 0 || (size_t)n >= len - pos)
+    return 0;
+  pos += (size_t)n;
+  return pos;
+}
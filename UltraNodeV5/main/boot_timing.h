@@ -0,0 +1,29 @@
+#pragma once
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Boot-stage instrumentation. app_main drops a mark as each boot stage
+// completes; the stamps are esp_timer microseconds since reset, so each
+// mark is the cumulative time to reach that point. The collected report is
+// published once after the first MQTT connect.
+
+// Record that the named stage just finished. Stages beyond the small fixed
+// table are counted but silently dropped from the report.
+void boot_timing_mark(const char *stage);
+
+// Call once when the light path is up (engines started, state restored).
+// Checks the elapsed time against CONFIG_UL_BOOT_LIGHT_BUDGET_MS, logs an
+// error on overrun, and stows the value in RTC RAM so the next boot's
+// report can carry it even if this boot never reaches MQTT.
+void boot_timing_light_ready(void);
+
+// Render the report as a JSON object into buf. Returns the number of
+// characters written (0 if buf is too small).
+size_t boot_timing_report_json(char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -32,7 +32,18 @@ typedef struct {
 #define LEDC_INTR_DISABLE 0
 #define LEDC_AUTO_CLK 0
 
+typedef enum {
+    LEDC_FADE_NO_WAIT = 0,
+    LEDC_FADE_WAIT_DONE = 1,
+} ledc_fade_mode_t;
+
 esp_err_t ledc_timer_config(const ledc_timer_config_t* config);
 esp_err_t ledc_channel_config(const ledc_channel_config_t* config);
 esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, int duty);
 esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel);
+esp_err_t ledc_fade_func_install(int intr_alloc_flags);
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel,
+                                  int target_duty, int max_fade_time_ms);
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel,
+                          ledc_fade_mode_t fade_mode);
+esp_err_t ledc_stop(ledc_mode_t mode, ledc_channel_t channel, uint32_t idle_level);
@@ -7,7 +7,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/ledc.h"
-#include "ul_task.h"
+#include "ul_sched.h"
 #include "ul_common_effects.h"
 #include "effects_rgb/effect.h"
 #include "ul_health.h"
@@ -21,8 +21,10 @@ static int g_ledc_update_duty_calls;
 
 static TickType_t g_fake_tick;
 
-static int g_task_create_calls;
-static bool g_task_create_should_fail;
+static int g_sched_register_calls;
+static bool g_sched_register_should_fail;
+static int g_sched_unregister_calls;
+static int g_sched_kick_calls;
 
 static int g_rgb_failure_reports;
 static int g_rgb_ok_reports;
@@ -59,44 +61,48 @@ esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel) {
     return ESP_OK;
 }
 
-TickType_t xTaskGetTickCount(void) { return g_fake_tick++; }
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+    (void)intr_alloc_flags;
+    return ESP_OK;
+}
 
-void vTaskDelayUntil(TickType_t* const pxPreviousWakeTime, TickType_t xTimeIncrement) {
-    if (pxPreviousWakeTime) {
-        *pxPreviousWakeTime += xTimeIncrement;
-    }
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel,
+                                  int target_duty, int max_fade_time_ms) {
+    (void)mode;
+    (void)channel;
+    (void)target_duty;
+    (void)max_fade_time_ms;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel,
+                          ledc_fade_mode_t fade_mode) {
+    (void)mode;
+    (void)channel;
+    (void)fade_mode;
+    return ESP_OK;
 }
 
-void vTaskDelay(TickType_t ticks) { (void)ticks; }
+TickType_t xTaskGetTickCount(void) { return g_fake_tick++; }
 
-void vTaskDelete(TaskHandle_t task) { (void)task; }
+int64_t esp_timer_get_time(void) { return 0; }
 
-BaseType_t ul_task_create(TaskFunction_t task_func,
-                          const char* name,
-                          const uint32_t stack_depth,
-                          void* params,
-                          UBaseType_t priority,
-                          TaskHandle_t* task_handle,
-                          BaseType_t core_id) {
-    (void)task_func;
+bool ul_sched_register(ul_sched_step_fn step, void* ctx, const char* name) {
+    (void)step;
+    (void)ctx;
     (void)name;
-    (void)stack_depth;
-    (void)params;
-    (void)priority;
-    (void)core_id;
-    g_task_create_calls++;
-    if (g_task_create_should_fail) {
-        if (task_handle) {
-            *task_handle = NULL;
-        }
-        return pdFAIL;
-    }
-    if (task_handle) {
-        *task_handle = (TaskHandle_t)0x1;
-    }
-    return pdPASS;
+    g_sched_register_calls++;
+    return !g_sched_register_should_fail;
+}
+
+void ul_sched_unregister(ul_sched_step_fn step, void* ctx) {
+    (void)step;
+    (void)ctx;
+    g_sched_unregister_calls++;
 }
 
+void ul_sched_kick(void) { g_sched_kick_calls++; }
+
 uint8_t ul_gamma8(uint8_t x) { return x; }
 
 static void test_effect_init(void) { g_effect_init_calls++; }
@@ -140,15 +146,16 @@ static void reset_test_state(void) {
     ul_rgb_engine_stop();
     memset(s_strips, 0, sizeof(s_strips));
     s_strip_count = 0;
-    s_rgb_task = NULL;
-    s_current_strip = 0;
+    s_rgb_registered = false;
     g_ledc_timer_config_calls = 0;
     g_ledc_channel_config_calls = 0;
     g_ledc_set_duty_calls = 0;
     g_ledc_update_duty_calls = 0;
     g_fake_tick = 0;
-    g_task_create_calls = 0;
-    g_task_create_should_fail = false;
+    g_sched_register_calls = 0;
+    g_sched_register_should_fail = false;
+    g_sched_unregister_calls = 0;
+    g_sched_kick_calls = 0;
     g_rgb_failure_reports = 0;
     g_rgb_ok_reports = 0;
     g_effect_init_calls = 0;
@@ -165,37 +172,39 @@ static void assert_strip_disabled(int idx) {
 
 // ---- Tests ------------------------------------------------------------------
 
-static void test_rgb_task_create_failure_unwinds(void) {
+static void test_rgb_sched_register_failure_unwinds(void) {
     reset_test_state();
-    g_task_create_should_fail = true;
+    g_sched_register_should_fail = true;
 
     ul_rgb_engine_start();
 
-    assert(g_task_create_calls == 1);
-    assert(s_rgb_task == NULL);
+    assert(g_sched_register_calls == 1);
+    assert(!s_rgb_registered);
     assert(s_strip_count == 0);
     assert_strip_disabled(0);
     assert(g_rgb_failure_reports == 1);
     assert(g_rgb_ok_reports == 0);
 
-    g_task_create_should_fail = false;
-    g_task_create_calls = 0;
+    g_sched_register_should_fail = false;
+    g_sched_register_calls = 0;
+    g_sched_unregister_calls = 0;
 
     ul_rgb_engine_start();
 
-    assert(g_task_create_calls == 1);
-    assert(s_rgb_task != NULL);
+    assert(g_sched_register_calls == 1);
+    assert(s_rgb_registered);
     assert(s_strip_count == 1);
     assert(s_strips[0].enabled);
     assert(g_rgb_ok_reports == 1);
 
     ul_rgb_engine_stop();
-    assert(s_rgb_task == NULL);
+    assert(!s_rgb_registered);
+    assert(g_sched_unregister_calls == 1);
     assert(s_strip_count == 0);
 }
 
 int main(void) {
-    test_rgb_task_create_failure_unwinds();
+    test_rgb_sched_register_failure_unwinds();
     printf("All tests passed\n");
     return 0;
 }
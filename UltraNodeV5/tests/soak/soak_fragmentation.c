@@ -0,0 +1,363 @@
+// Host-side heap fragmentation soak. The worst field failures are multi-week
+// fragmentation deaths — total free looks fine while the largest block decays
+// until a frame buffer or TLS allocation fails — and the short sequences in
+// tests/ws_engine and ul_mqtt/test never reproduce them. This harness drives
+// millions of iterations of the realistic interleaved churn (effect switches
+// through the registry including fire/black_ice ensure_capacity growth, MQTT
+// command payload bursts, ul_state rewrite cycles, cJSON parse/delete bursts)
+// against an instrumented first-fit arena allocator and fails when the
+// largest free block ever sinks below the same 8 KB floor the on-node health
+// monitor treats as fragmentation (UL_HEALTH_FRAG_MIN_BLOCK), or when any
+// allocation fails outright.
+//
+// The effects run for real through caps-aware heap_caps_* stubs: SPIRAM
+// requests go to a separate plentiful pool (PSRAM fragmentation is the
+// arena's job, already covered by its own design), and the PSRAM effect
+// arena is reserved up front exactly as ul_ws_engine_start() does, so the
+// instrumented arena stands in for the internal heap alone — per-column
+// snapshot buffers, command payloads, state copies, parse nodes. MQTT and
+// ul_state churn is modeled with the production size distributions and
+// lifetimes (bounded command ring of heap payload copies; twelve long-lived
+// JSON slots replaced free-then-alloc) rather than linking
+// ul_mqtt.c/ul_state.c, whose host stub worlds cannot share a translation
+// unit with the effect stubs.
+//
+// Build (from UltraNodeV5/, one line):
+//   gcc -O2 -std=c11 -Wall -Wextra -Werror
+//       -I tests/ws_engine/stubs -I components/ul_ws_engine
+//       -I components/ul_ws_engine/include -I components/ul_common_effects/include
+//       -o build-tests/soak_fragmentation tests/soak/soak_fragmentation.c
+//       components/ul_ws_engine/effects_ws/*.c components/ul_common_effects/sine.c
+//       components/ul_common_effects/wheel.c -lm
+//
+// Usage:
+//   soak_fragmentation [iterations] [seed]     default 2000000 iterations
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+
+#include "effects_ws/effect.h"
+#include "effects_ws/psram_arena.h"
+#include "ul_ws_engine.h"
+
+// ---- Engine stubs the effects link against --------------------------------
+
+static uint8_t g_solid[2][3] = {{255, 96, 32}, {255, 96, 32}};
+
+void ul_ws_set_solid_rgb(int strip, uint8_t r, uint8_t g, uint8_t b) {
+    if (strip < 0 || strip > 1) return;
+    g_solid[strip][0] = r;
+    g_solid[strip][1] = g;
+    g_solid[strip][2] = b;
+}
+
+void ul_ws_get_solid_rgb(int strip, uint8_t* r, uint8_t* g, uint8_t* b) {
+    if (strip < 0 || strip > 1) strip = 0;
+    if (r) *r = g_solid[strip][0];
+    if (g) *g = g_solid[strip][1];
+    if (b) *b = g_solid[strip][2];
+}
+
+// No frame pacing here, so self-tuning effects keep their allocation-derived
+// depth; that also keeps the allocation sizes deterministic per seed.
+bool ul_ws_get_frame_load(int strip, uint32_t* render_us, uint32_t* period_us) {
+    (void)strip;
+    (void)render_us;
+    (void)period_us;
+    return false;
+}
+
+// ---- Instrumented arena allocator -----------------------------------------
+// First-fit with boundary-tag coalescing over a fixed arena sized like the
+// internal heap budget the firmware actually has to live in. Everything the
+// workload (and the effects, via heap_caps_*) allocates lands here, so the
+// free-total/largest-block curve is the experiment's output, not an estimate.
+
+#define SOAK_ARENA_BYTES (192 * 1024)
+// Fragmentation floor: the on-node health monitor reboots after five checks
+// with the largest internal block under 8 KB (UL_HEALTH_FRAG_MIN_BLOCK), so
+// sinking below it even once is a failed soak.
+#define SOAK_MIN_LARGEST (8 * 1024)
+
+typedef struct {
+    uint32_t size;      // payload bytes, multiple of 8
+    uint32_t prev_size; // payload bytes of the preceding block; 0 at the start
+    uint8_t free;
+    uint8_t pad[7];     // keeps payloads 8-aligned (header is 16 bytes)
+} blk_t;
+
+#define BLK_HDR ((uint32_t)sizeof(blk_t))
+
+static uint8_t s_arena[SOAK_ARENA_BYTES] __attribute__((aligned(16)));
+static uint64_t s_alloc_failures = 0;
+
+static blk_t* blk_first(void) { return (blk_t*)s_arena; }
+
+static blk_t* blk_next(blk_t* b) {
+    uint8_t* n = (uint8_t*)b + BLK_HDR + b->size;
+    return (n < s_arena + SOAK_ARENA_BYTES) ? (blk_t*)n : NULL;
+}
+
+static blk_t* blk_prev(blk_t* b) {
+    if ((uint8_t*)b == s_arena) return NULL;
+    return (blk_t*)((uint8_t*)b - BLK_HDR - b->prev_size);
+}
+
+static void arena_init(void) {
+    blk_t* b = blk_first();
+    b->size = SOAK_ARENA_BYTES - BLK_HDR;
+    b->prev_size = 0;
+    b->free = 1;
+}
+
+static void* arena_alloc(size_t size) {
+    if (size == 0) size = 1;
+    uint32_t need = (uint32_t)((size + 7u) & ~7u);
+    for (blk_t* b = blk_first(); b; b = blk_next(b)) {
+        if (!b->free || b->size < need) continue;
+        if (b->size >= need + BLK_HDR + 8) { // split off the remainder
+            blk_t* rest = (blk_t*)((uint8_t*)b + BLK_HDR + need);
+            rest->size = b->size - need - BLK_HDR;
+            rest->prev_size = need;
+            rest->free = 1;
+            blk_t* after = blk_next(rest);
+            if (after) after->prev_size = rest->size;
+            b->size = need;
+        }
+        b->free = 0;
+        return (uint8_t*)b + BLK_HDR;
+    }
+    s_alloc_failures++;
+    return NULL;
+}
+
+static void arena_free(void* ptr) {
+    if (!ptr) return;
+    blk_t* b = (blk_t*)((uint8_t*)ptr - BLK_HDR);
+    b->free = 1;
+    blk_t* n = blk_next(b);
+    if (n && n->free) {
+        b->size += BLK_HDR + n->size;
+        blk_t* after = blk_next(b);
+        if (after) after->prev_size = b->size;
+    }
+    blk_t* p = blk_prev(b);
+    if (p && p->free) {
+        p->size += BLK_HDR + b->size;
+        blk_t* after = blk_next(p);
+        if (after) after->prev_size = p->size;
+    }
+}
+
+static void arena_stats(uint32_t* free_total, uint32_t* largest, uint32_t* blocks) {
+    uint32_t total = 0, big = 0, count = 0;
+    for (blk_t* b = blk_first(); b; b = blk_next(b)) {
+        count++;
+        if (!b->free) continue;
+        total += b->size;
+        if (b->size > big) big = b->size;
+    }
+    *free_total = total;
+    *largest = big;
+    *blocks = count;
+}
+
+// The effects' allocator hooks, declared in the stub esp_heap_caps.h.
+// SPIRAM-capable requests (the fire/black_ice field grids and the effect
+// arena reservation) are served from libc: PSRAM is a separate, far larger
+// heap on the node and its fragmentation story is the PSRAM arena's job.
+// Everything else is internal heap and lands in the instrumented arena.
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    if (caps & MALLOC_CAP_SPIRAM) return malloc(size);
+    return arena_alloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    if (caps & MALLOC_CAP_SPIRAM) return calloc(n, size);
+    void* ptr = arena_alloc(n * size);
+    if (ptr) memset(ptr, 0, n * size);
+    return ptr;
+}
+
+static bool ptr_in_arena(const void* ptr) {
+    const uint8_t* p = ptr;
+    return p >= s_arena && p < s_arena + SOAK_ARENA_BYTES;
+}
+
+void heap_caps_free(void* ptr) {
+    if (ptr && !ptr_in_arena(ptr)) {
+        free(ptr);
+        return;
+    }
+    arena_free(ptr);
+}
+
+// ---- Workload -------------------------------------------------------------
+
+static uint32_t s_rng = 0x5eed1234;
+
+static uint32_t rnd(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+#define SOAK_MAX_PIXELS 900
+#define SOAK_CMD_RING 24    // dispatch queue depth (both lanes)
+#define SOAK_STATE_SLOTS 12 // ul_state entry table
+#define SOAK_JSON_BURST 16
+
+static const int k_widths[] = {60, 150, 300, 450, 900};
+
+static void* s_cmds[SOAK_CMD_RING];
+static int s_cmd_head = 0; // oldest
+static int s_cmd_count = 0;
+static void* s_state_slots[SOAK_STATE_SLOTS];
+static uint8_t s_frame[SOAK_MAX_PIXELS * 3];
+
+// MQTT burst: a payload copy enters the ring; the dispatcher drains zero to
+// two of the oldest, so bursts transiently deepen the queue like a scene
+// push fanning out 8-12 commands.
+static void step_mqtt(void) {
+    if (s_cmd_count == SOAK_CMD_RING) {
+        arena_free(s_cmds[s_cmd_head]);
+        s_cmd_head = (s_cmd_head + 1) % SOAK_CMD_RING;
+        s_cmd_count--;
+    }
+    size_t len = 60 + rnd() % 840;
+    void* payload = arena_alloc(len);
+    if (payload) {
+        s_cmds[(s_cmd_head + s_cmd_count) % SOAK_CMD_RING] = payload;
+        s_cmd_count++;
+    }
+    int drain = (int)(rnd() % 3);
+    while (drain-- > 0 && s_cmd_count > 0) {
+        arena_free(s_cmds[s_cmd_head]);
+        s_cmd_head = (s_cmd_head + 1) % SOAK_CMD_RING;
+        s_cmd_count--;
+    }
+}
+
+// State rewrite: ul_state frees the slot's old JSON copy and allocates the
+// new one, so every persisted command is a free-then-alloc on a long-lived
+// slot — the classic interleaver against short-lived traffic.
+static void step_state(void) {
+    int slot = (int)(rnd() % SOAK_STATE_SLOTS);
+    arena_free(s_state_slots[slot]);
+    s_state_slots[slot] = arena_alloc(120 + rnd() % 904);
+}
+
+// Parse burst: cJSON builds a tree of small nodes and frees the whole tree,
+// the shape of every command dispatch.
+static void step_json(void) {
+    void* nodes[SOAK_JSON_BURST];
+    int n = 4 + (int)(rnd() % (SOAK_JSON_BURST - 4));
+    for (int i = 0; i < n; ++i)
+        nodes[i] = arena_alloc(48 + rnd() % 48);
+    for (int i = n - 1; i >= 0; --i)
+        arena_free(nodes[i]);
+}
+
+// Effect switch at a random width: fire/black_ice rebuild their per-column
+// snapshot buffers through ensure_capacity (the field grids come from the
+// PSRAM arena), the rest re-init cheaply; two renders make lazy allocation
+// actually happen.
+static void step_effect(const ws_effect_t* tbl, int count) {
+    const ws_effect_t* eff = &tbl[rnd() % (uint32_t)count];
+    int width = k_widths[rnd() % (sizeof(k_widths) / sizeof(k_widths[0]))];
+    if (eff->init) eff->init();
+    if (eff->render) {
+        eff->render(0, s_frame, width, 0);
+        eff->render(0, s_frame, width, 1);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint64_t iterations = 2000000;
+    if (argc > 1) iterations = strtoull(argv[1], NULL, 10);
+    if (argc > 2) s_rng = (uint32_t)strtoul(argv[2], NULL, 10);
+    if (iterations < 64) iterations = 64;
+
+    arena_init();
+
+    // Boot-time residents: two strips' double frame buffers plus the initial
+    // state table, pinned for the whole run like they are on the node.
+    for (int i = 0; i < 4; ++i) {
+        if (!arena_alloc(SOAK_MAX_PIXELS * 3)) {
+            fprintf(stderr, "FAIL: arena too small for boot residents\n");
+            return 1;
+        }
+    }
+    for (int i = 0; i < SOAK_STATE_SLOTS; ++i)
+        s_state_slots[i] = arena_alloc(120 + rnd() % 904);
+
+    // As on the node: field grids come out of the (host-modeled) PSRAM
+    // arena, leaving only the small internal allocations to churn the heap.
+    ul_ws_psram_arena_reserve();
+
+    int effect_count = 0;
+    const ws_effect_t* effects = ul_ws_get_effects(&effect_count);
+    if (!effects || effect_count == 0) {
+        fprintf(stderr, "FAIL: empty effect registry\n");
+        return 1;
+    }
+
+    uint32_t free_total, largest, blocks;
+    arena_stats(&free_total, &largest, &blocks);
+    uint32_t min_largest = largest;
+
+    printf("# arena=%u boot_free=%u effects=%d iterations=%llu\n",
+           (unsigned)SOAK_ARENA_BYTES, (unsigned)free_total, effect_count,
+           (unsigned long long)iterations);
+    printf("%12s %10s %10s %8s %7s\n", "iteration", "free", "largest",
+           "blocks", "frag%");
+
+    uint64_t sample_every = iterations / 32;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        uint32_t r = rnd() % 100;
+        if (r < 40)
+            step_mqtt();
+        else if (r < 65)
+            step_state();
+        else if (r < 85)
+            step_json();
+        else
+            step_effect(effects, effect_count);
+
+        if (i % sample_every == 0 || i == iterations - 1) {
+            arena_stats(&free_total, &largest, &blocks);
+            if (largest < min_largest) min_largest = largest;
+            double frag = free_total
+                              ? 100.0 * (1.0 - (double)largest / free_total)
+                              : 0.0;
+            printf("%12llu %10u %10u %8u %6.1f%%\n", (unsigned long long)i,
+                   (unsigned)free_total, (unsigned)largest, (unsigned)blocks,
+                   frag);
+        }
+    }
+
+    printf("# min_largest=%u alloc_failures=%llu\n", (unsigned)min_largest,
+           (unsigned long long)s_alloc_failures);
+
+    bool ok = true;
+    if (s_alloc_failures > 0) {
+        fprintf(stderr, "FAIL: %llu allocation failures during soak\n",
+                (unsigned long long)s_alloc_failures);
+        ok = false;
+    }
+    if (min_largest < SOAK_MIN_LARGEST) {
+        fprintf(stderr,
+                "FAIL: largest free block decayed to %u (floor %u) — the node"
+                " would hit the health monitor's fragmentation reboot\n",
+                (unsigned)min_largest, (unsigned)SOAK_MIN_LARGEST);
+        ok = false;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// On the host the RTC mirror is ordinary static storage.
+#define RTC_NOINIT_ATTR
@@ -1,6 +1,7 @@
 #pragma once
 
 #define CONFIG_UL_WHITE_SMOOTH_HZ 200
+#define CONFIG_UL_GAMMA_ENABLE 0
 
 #define CONFIG_UL_WHT0_ENABLED 1
 #define CONFIG_UL_WHT0_GPIO 1
@@ -7,7 +7,8 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/ledc.h"
-#include "ul_task.h"
+#include "driver/gpio.h"
+#include "ul_sched.h"
 #include "esp_err.h"
 #include "effects_white/effect.h"
 #include "ul_health.h"
@@ -19,10 +20,10 @@ static int g_ledc_channel_config_calls;
 static int g_ledc_set_duty_calls;
 static int g_ledc_update_duty_calls;
 
-static TickType_t g_fake_tick;
-
-static int g_task_create_calls;
-static bool g_task_create_should_fail;
+static int g_sched_register_calls;
+static bool g_sched_register_should_fail;
+static int g_sched_unregister_calls;
+static int g_sched_kick_calls;
 
 static int g_white_failure_reports;
 static int g_white_ok_reports;
@@ -59,47 +60,77 @@ esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel) {
     return ESP_OK;
 }
 
-TickType_t xTaskGetTickCount(void) { return g_fake_tick++; }
+esp_err_t ledc_stop(ledc_mode_t mode, ledc_channel_t channel, uint32_t idle_level) {
+    (void)mode;
+    (void)channel;
+    (void)idle_level;
+    return ESP_OK;
+}
 
-void vTaskDelayUntil(TickType_t* const pxPreviousWakeTime, TickType_t xTimeIncrement) {
-    if (pxPreviousWakeTime) {
-        *pxPreviousWakeTime += xTimeIncrement;
-    }
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+    (void)intr_alloc_flags;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel,
+                                  int target_duty, int max_fade_time_ms) {
+    (void)mode;
+    (void)channel;
+    (void)target_duty;
+    (void)max_fade_time_ms;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel,
+                          ledc_fade_mode_t fade_mode) {
+    (void)mode;
+    (void)channel;
+    (void)fade_mode;
+    return ESP_OK;
+}
+
+TickType_t xTaskGetTickCount(void) { return 0; }
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) {
+    (void)gpio;
+    (void)mode;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio, int level) {
+    (void)gpio;
+    (void)level;
+    return ESP_OK;
 }
 
-void vTaskDelay(TickType_t ticks) { (void)ticks; }
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio, gpio_pull_mode_t pull) {
+    (void)gpio;
+    (void)pull;
+    return ESP_OK;
+}
 
-void vTaskDelete(TaskHandle_t task) { (void)task; }
+int64_t esp_timer_get_time(void) { return 0; }
 
-BaseType_t ul_task_create(TaskFunction_t task_func,
-                          const char* name,
-                          const uint32_t stack_depth,
-                          void* params,
-                          UBaseType_t priority,
-                          TaskHandle_t* task_handle,
-                          BaseType_t core_id) {
-    (void)task_func;
+bool ul_sched_register(ul_sched_step_fn step, void* ctx, const char* name) {
+    (void)step;
+    (void)ctx;
     (void)name;
-    (void)stack_depth;
-    (void)params;
-    (void)priority;
-    (void)core_id;
-    g_task_create_calls++;
-    if (g_task_create_should_fail) {
-        if (task_handle) {
-            *task_handle = NULL;
-        }
-        return pdFAIL;
-    }
-    if (task_handle) {
-        *task_handle = (TaskHandle_t)0x1;
-    }
-    return pdPASS;
+    g_sched_register_calls++;
+    return !g_sched_register_should_fail;
+}
+
+void ul_sched_unregister(ul_sched_step_fn step, void* ctx) {
+    (void)step;
+    (void)ctx;
+    g_sched_unregister_calls++;
 }
 
+void ul_sched_kick(void) { g_sched_kick_calls++; }
+
 static void test_effect_init(void) { g_effect_init_calls++; }
 
-static uint8_t test_effect_render(int frame_idx) {
+static uint8_t test_effect_render(int ch, int frame_idx) {
+    (void)ch;
     (void)frame_idx;
     g_effect_render_calls++;
     return 42;
@@ -138,16 +169,16 @@ void ul_health_notify_rgb_engine_failure(void) {}
 static void reset_test_state(void) {
     ul_white_engine_stop();
     memset(s_ch, 0, sizeof(s_ch));
-    s_white_task = NULL;
+    s_white_registered = false;
     s_count = 0;
-    s_current_ch_idx = -1;
     g_ledc_timer_config_calls = 0;
     g_ledc_channel_config_calls = 0;
     g_ledc_set_duty_calls = 0;
     g_ledc_update_duty_calls = 0;
-    g_fake_tick = 0;
-    g_task_create_calls = 0;
-    g_task_create_should_fail = false;
+    g_sched_register_calls = 0;
+    g_sched_register_should_fail = false;
+    g_sched_unregister_calls = 0;
+    g_sched_kick_calls = 0;
     g_white_failure_reports = 0;
     g_white_ok_reports = 0;
     g_effect_init_calls = 0;
@@ -162,15 +193,15 @@ static void assert_channel_disabled(int idx) {
 
 // ---- Tests ------------------------------------------------------------------
 
-static void test_white_task_create_failure_unwinds(void) {
+static void test_white_sched_register_failure_unwinds(void) {
     reset_test_state();
-    g_task_create_should_fail = true;
+    g_sched_register_should_fail = true;
 
     bool started = ul_white_engine_start();
 
     assert(!started);
-    assert(g_task_create_calls == 1);
-    assert(s_white_task == NULL);
+    assert(g_sched_register_calls == 1);
+    assert(!s_white_registered);
     assert(s_count == 0);
     assert_channel_disabled(0);
     assert(g_white_failure_reports == 1);
@@ -178,15 +209,16 @@ static void test_white_task_create_failure_unwinds(void) {
     assert(g_ledc_timer_config_calls == 1);
     assert(g_ledc_channel_config_calls == 1);
 
-    g_task_create_should_fail = false;
-    g_task_create_calls = 0;
+    g_sched_register_should_fail = false;
+    g_sched_register_calls = 0;
+    g_sched_unregister_calls = 0;
     g_white_failure_reports = 0;
 
     started = ul_white_engine_start();
 
     assert(started);
-    assert(g_task_create_calls == 1);
-    assert(s_white_task != NULL);
+    assert(g_sched_register_calls == 1);
+    assert(s_white_registered);
     assert(s_count == 1);
     assert(s_ch[0].enabled);
     assert(g_white_ok_reports == 1);
@@ -195,13 +227,14 @@ static void test_white_task_create_failure_unwinds(void) {
     assert(g_ledc_channel_config_calls == 2);
 
     ul_white_engine_stop();
-    assert(s_white_task == NULL);
+    assert(!s_white_registered);
+    assert(g_sched_unregister_calls == 1);
     assert(s_count == 0);
     assert_channel_disabled(0);
 }
 
 int main(void) {
-    test_white_task_create_failure_unwinds();
+    test_white_sched_register_failure_unwinds();
     printf("All tests passed\n");
     return 0;
 }
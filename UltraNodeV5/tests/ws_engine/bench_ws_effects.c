@@ -0,0 +1,253 @@
+// Host-side benchmark for the WS effect registry. Every effect is run over
+// 60/300/900 pixel strips and a configurable frame count, reporting ns/frame
+// and bytes allocated through heap_caps_*. Host numbers are not on-target
+// numbers, but relative regressions show up the same way, so CI can catch a
+// render-cost regression before it reaches a 60 FPS deployment.
+//
+// Absolute timings vary between machines, so the checked-in baseline stores
+// ratios relative to a reference workload (rainbow at 300 pixels) measured in
+// the same process. --check fails if any ratio exceeds its baseline entry by
+// more than BENCH_TOLERANCE.
+//
+// Build (from UltraNodeV5/, one line):
+//   gcc -O2 -std=c11 -Wall -Wextra -Werror
+//       -I tests/ws_engine/stubs -I components/ul_ws_engine
+//       -I components/ul_ws_engine/include -I components/ul_common_effects/include
+//       -o build-tests/bench_ws_effects tests/ws_engine/bench_ws_effects.c
+//       components/ul_ws_engine/effects_ws/*.c components/ul_common_effects/sine.c
+//       components/ul_common_effects/wheel.c -lm
+//
+// Usage:
+//   bench_ws_effects [frames]                      report only
+//   bench_ws_effects --print-baseline [frames]     emit baseline lines
+//   bench_ws_effects --check <baseline> [frames]   exit 1 on regression
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "effects_ws/effect.h"
+#include "ul_ws_engine.h"
+
+#define BENCH_DEFAULT_FRAMES 400
+#define BENCH_WARMUP_FRAMES 8
+#define BENCH_MAX_PIXELS 900
+#define BENCH_MAX_RESULTS 64
+#define BENCH_TOLERANCE 2.0
+#define BENCH_REF_EFFECT "rainbow"
+#define BENCH_REF_PIXELS 300
+
+static const int k_pixel_counts[] = {60, 300, 900};
+
+// ---- Engine stubs the effects link against --------------------------------
+
+static uint8_t g_solid[2][3] = {{255, 96, 32}, {255, 96, 32}};
+
+void ul_ws_set_solid_rgb(int strip, uint8_t r, uint8_t g, uint8_t b) {
+    if (strip < 0 || strip > 1) return;
+    g_solid[strip][0] = r;
+    g_solid[strip][1] = g;
+    g_solid[strip][2] = b;
+}
+
+void ul_ws_get_solid_rgb(int strip, uint8_t* r, uint8_t* g, uint8_t* b) {
+    if (strip < 0 || strip > 1) strip = 0;
+    if (r) *r = g_solid[strip][0];
+    if (g) *g = g_solid[strip][1];
+    if (b) *b = g_solid[strip][2];
+}
+
+// Keep self-tuning effects at their full depth: bench times are only
+// comparable against the baseline when nothing adapts mid-run.
+bool ul_ws_get_frame_load(int strip, uint32_t* render_us, uint32_t* period_us) {
+    (void)strip;
+    (void)render_us;
+    (void)period_us;
+    return false;
+}
+
+// ---- Tracking allocator ---------------------------------------------------
+
+static size_t g_alloc_bytes = 0;
+static int g_alloc_calls = 0;
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    g_alloc_bytes += size;
+    g_alloc_calls++;
+    return malloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    (void)caps;
+    g_alloc_bytes += n * size;
+    g_alloc_calls++;
+    return calloc(n, size);
+}
+
+void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
+// ---- Benchmark ------------------------------------------------------------
+
+typedef struct {
+    const char* effect;
+    int pixels;
+    double ns_frame;
+    size_t alloc_bytes;
+    int alloc_calls;
+} bench_result_t;
+
+static bench_result_t g_results[BENCH_MAX_RESULTS];
+static int g_result_count = 0;
+
+static uint8_t g_frame[BENCH_MAX_PIXELS * 3];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void bench_effect(const ws_effect_t* eff, int pixels, int frames) {
+    if (eff->init) eff->init();
+    g_alloc_bytes = 0;
+    g_alloc_calls = 0;
+
+    // Warmup covers lazy allocation (fire/black_ice ensure_capacity) and
+    // one-time LUT builds so the timed loop measures steady state.
+    for (int f = 0; f < BENCH_WARMUP_FRAMES; ++f) {
+        eff->render(0, g_frame, pixels, f);
+    }
+
+    double t0 = now_ns();
+    for (int f = 0; f < frames; ++f) {
+        eff->render(0, g_frame, pixels, BENCH_WARMUP_FRAMES + f);
+    }
+    double t1 = now_ns();
+
+    bench_result_t* res = &g_results[g_result_count++];
+    res->effect = eff->name;
+    res->pixels = pixels;
+    res->ns_frame = (t1 - t0) / (double)frames;
+    res->alloc_bytes = g_alloc_bytes;
+    res->alloc_calls = g_alloc_calls;
+}
+
+static const bench_result_t* find_result(const char* effect, int pixels) {
+    for (int i = 0; i < g_result_count; ++i) {
+        if (g_results[i].pixels == pixels && strcmp(g_results[i].effect, effect) == 0) {
+            return &g_results[i];
+        }
+    }
+    return NULL;
+}
+
+static double reference_ns(void) {
+    const bench_result_t* ref = find_result(BENCH_REF_EFFECT, BENCH_REF_PIXELS);
+    return (ref && ref->ns_frame > 0.0) ? ref->ns_frame : 1.0;
+}
+
+static int check_baseline(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "bench: cannot open baseline %s\n", path);
+        return 1;
+    }
+    double ref = reference_ns();
+    int failures = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        char effect[32];
+        int pixels;
+        double baseline_ratio;
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "%31s %d %lf", effect, &pixels, &baseline_ratio) != 3) continue;
+        const bench_result_t* res = find_result(effect, pixels);
+        if (!res) {
+            printf("MISSING %-14s %4d px (in baseline but not measured)\n", effect, pixels);
+            failures++;
+            continue;
+        }
+        double ratio = res->ns_frame / ref;
+        if (ratio > baseline_ratio * BENCH_TOLERANCE) {
+            printf("FAIL    %-14s %4d px ratio %8.3f exceeds baseline %8.3f x%.1f\n",
+                   effect, pixels, ratio, baseline_ratio, BENCH_TOLERANCE);
+            failures++;
+        }
+    }
+    fclose(f);
+    if (failures == 0) {
+        printf("baseline check passed (%d results, tolerance x%.1f)\n",
+               g_result_count, BENCH_TOLERANCE);
+    }
+    return failures ? 1 : 0;
+}
+
+static void print_report(void) {
+    double ref = reference_ns();
+    printf("%-14s %6s %12s %10s %12s %7s\n",
+           "effect", "pixels", "ns/frame", "ratio", "alloc_bytes", "allocs");
+    for (int i = 0; i < g_result_count; ++i) {
+        const bench_result_t* r = &g_results[i];
+        printf("%-14s %6d %12.0f %10.3f %12zu %7d\n",
+               r->effect, r->pixels, r->ns_frame, r->ns_frame / ref,
+               r->alloc_bytes, r->alloc_calls);
+    }
+}
+
+static void print_baseline(void) {
+    double ref = reference_ns();
+    printf("# effect pixels ratio (ns/frame relative to %s at %d px)\n",
+           BENCH_REF_EFFECT, BENCH_REF_PIXELS);
+    for (int i = 0; i < g_result_count; ++i) {
+        const bench_result_t* r = &g_results[i];
+        printf("%s %d %.3f\n", r->effect, r->pixels, r->ns_frame / ref);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* baseline_path = NULL;
+    int emit_baseline = 0;
+    int frames = BENCH_DEFAULT_FRAMES;
+
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "--print-baseline") == 0) {
+        emit_baseline = 1;
+        arg++;
+    } else if (arg < argc && strcmp(argv[arg], "--check") == 0) {
+        if (arg + 1 >= argc) {
+            fprintf(stderr, "bench: --check needs a baseline file\n");
+            return 1;
+        }
+        baseline_path = argv[arg + 1];
+        arg += 2;
+    }
+    if (arg < argc) {
+        frames = atoi(argv[arg]);
+        if (frames <= 0) frames = BENCH_DEFAULT_FRAMES;
+    }
+
+    int count = 0;
+    const ws_effect_t* effects = ul_ws_get_effects(&count);
+    for (int e = 0; e < count; ++e) {
+        for (size_t p = 0; p < sizeof(k_pixel_counts) / sizeof(k_pixel_counts[0]); ++p) {
+            bench_effect(&effects[e], k_pixel_counts[p], frames);
+        }
+    }
+
+    if (emit_baseline) {
+        print_baseline();
+        return 0;
+    }
+    print_report();
+    if (baseline_path) {
+        return check_baseline(baseline_path);
+    }
+    return 0;
+}
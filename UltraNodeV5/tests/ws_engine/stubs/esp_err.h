@@ -3,5 +3,6 @@
 typedef int esp_err_t;
 
 #define ESP_OK 0
+#define ESP_ERR_NOT_SUPPORTED 0x106
 
 const char *esp_err_to_name(esp_err_t err);
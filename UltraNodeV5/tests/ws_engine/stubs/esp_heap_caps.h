@@ -0,0 +1,13 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// MALLOC_CAP_8BIT / _DMA / _INTERNAL live in the stub sdkconfig.h; only the
+// SPIRAM capability used by the PSRAM-tier effects is defined here.
+#ifndef MALLOC_CAP_SPIRAM
+#define MALLOC_CAP_SPIRAM 4
+#endif
+
+void* heap_caps_malloc(size_t size, uint32_t caps);
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void heap_caps_free(void* ptr);
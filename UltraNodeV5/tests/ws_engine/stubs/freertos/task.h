@@ -11,6 +11,8 @@ TickType_t xTaskGetTickCount(void);
 void vTaskDelayUntil(TickType_t* const pxPreviousWakeTime, TickType_t xTimeIncrement);
 void vTaskDelay(TickType_t ticks);
 void vTaskDelete(TaskHandle_t task);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
 
 #ifdef __cplusplus
 }
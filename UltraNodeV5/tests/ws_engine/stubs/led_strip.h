@@ -10,15 +10,19 @@ typedef struct led_strip_stub {
     bool cleared;
     bool deleted;
     int set_pixel_calls;
+    int set_pixels_calls;
     int refresh_calls;
 } led_strip_stub_t;
 
 typedef led_strip_stub_t* led_strip_handle_t;
 
+typedef void (*led_strip_refresh_done_cb_t)(led_strip_handle_t strip, void *user_ctx);
+
 typedef struct {
     int strip_gpio_num;
     int max_leds;
     led_model_t led_model;
+    led_color_component_format_t color_component_format;
     struct {
         bool invert_out;
     } flags;
@@ -29,5 +33,8 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t* config,
                                    led_strip_handle_t* out_handle);
 esp_err_t led_strip_clear(led_strip_handle_t handle);
 esp_err_t led_strip_set_pixel(led_strip_handle_t handle, int index, uint32_t red, uint32_t green, uint32_t blue);
+esp_err_t led_strip_set_pixels(led_strip_handle_t handle, uint32_t start, uint32_t count, const uint8_t* pixels);
+esp_err_t led_strip_set_pixels_rgbw(led_strip_handle_t handle, uint32_t start, uint32_t count, const uint8_t* pixels);
 esp_err_t led_strip_refresh(led_strip_handle_t handle);
+esp_err_t led_strip_refresh_async(led_strip_handle_t handle, led_strip_refresh_done_cb_t done_cb, void* user_ctx);
 esp_err_t led_strip_del(led_strip_handle_t handle);
@@ -2,4 +2,22 @@
 
 typedef enum {
     LED_MODEL_WS2812 = 0,
+    LED_MODEL_SK6812,
 } led_model_t;
+
+typedef union {
+    struct {
+        unsigned r_pos : 2;
+        unsigned g_pos : 2;
+        unsigned b_pos : 2;
+        unsigned w_pos : 2;
+        unsigned reserved : 21;
+        unsigned num_components : 3;
+    } format;
+    unsigned format_id;
+} led_color_component_format_t;
+
+#define LED_STRIP_COLOR_COMPONENT_FMT_GRB \
+    (led_color_component_format_t){.format = {.r_pos = 1, .g_pos = 0, .b_pos = 2, .w_pos = 3, .reserved = 0, .num_components = 3}}
+#define LED_STRIP_COLOR_COMPONENT_FMT_GRBW \
+    (led_color_component_format_t){.format = {.r_pos = 1, .g_pos = 0, .b_pos = 2, .w_pos = 3, .reserved = 0, .num_components = 4}}
@@ -6,10 +6,15 @@
 #define CONFIG_UL_WS1_GPIO 2
 #define CONFIG_UL_WS0_PIXELS 5
 #define CONFIG_UL_WS1_PIXELS 6
+#define CONFIG_UL_WS0_POWER_BUDGET_MA 0
+#define CONFIG_UL_WS1_POWER_BUDGET_MA 0
 #define CONFIG_UL_WS2812_FPS 60
+#define CONFIG_UL_WS_MA_PER_CHANNEL 20
 #define CONFIG_UL_GAMMA_ENABLE 0
 #define CONFIG_UL_IS_ESP32C3 0
-#define CONFIG_UL_HAS_PSRAM 0
+// PSRAM-tier effects (fire, black_ice) stay in the registry so the host
+// benchmark can exercise them; the host heap stands in for PSRAM.
+#define CONFIG_UL_HAS_PSRAM 1
 #define CONFIG_UL_NODE_ID "test-node"
 #define CONFIG_UL_WIFI_STATIC_CREDENTIALS 0
 #define CONFIG_UL_WIFI_SSID "test-ssid"
@@ -18,3 +23,22 @@
 #define CONFIG_UL_TIMEZONE "UTC"
 
 #define MALLOC_CAP_8BIT 0
+#define MALLOC_CAP_DMA 1
+#define MALLOC_CAP_INTERNAL 2
+#define CONFIG_UL_WS_RENDER_TASK_PER_STRIP 0
+#define CONFIG_UL_WS_RMT_EXPANSION 0
+#define CONFIG_UL_WS_CYCLE_CACHE 0
+#define CONFIG_UL_WS_PHASE_LOCK 0
+#define CONFIG_UL_WS_STREAM 0
+#define CONFIG_UL_WS_CROSSFADE_FRAMES 4
+#define CONFIG_UL_WS_FRAME_DMA_MAX_BYTES 4096
+#define CONFIG_UL_WS_RENDER_IRAM 0
+// Every effect enabled so the benchmark covers the full registry.
+#define CONFIG_UL_WS_EFFECT_COLOR_SWELL 1
+#define CONFIG_UL_WS_EFFECT_RAINBOW 1
+#define CONFIG_UL_WS_EFFECT_MODERN_RAINBOW 1
+#define CONFIG_UL_WS_EFFECT_TRIPLE_WAVE 1
+#define CONFIG_UL_WS_EFFECT_FLASH 1
+#define CONFIG_UL_WS_EFFECT_SPACEWAVES 1
+#define CONFIG_UL_WS_EFFECT_FIRE 1
+#define CONFIG_UL_WS_EFFECT_BLACK_ICE 1
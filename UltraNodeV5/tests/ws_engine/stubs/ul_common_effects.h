@@ -2,3 +2,7 @@
 #include <stdint.h>
 
 uint8_t ul_gamma8(uint8_t x);
+uint16_t ul_gamma12(uint8_t x);
+int16_t ul_sin16(uint16_t phase);
+const uint8_t* ul_wheel8(uint8_t phase);
+const uint8_t* ul_hsv8(uint8_t phase);
@@ -0,0 +1,8 @@
+#pragma once
+#include <stdint.h>
+
+typedef void (*ul_health_render_stats_fn)(uint32_t *overruns, uint32_t *degraded);
+
+static inline void ul_health_register_render_stats(ul_health_render_stats_fn fn) {
+    (void)fn;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+#define UL_STATE_MAX_JSON_LEN 1024
+
+// No persisted payloads in the host harness: the engines skip their restore
+// loops and start from defaults, matching a first boot.
+static inline bool ul_state_copy_ws(int strip, char *buffer, size_t buffer_len) {
+    (void)strip;
+    if (buffer && buffer_len > 0)
+        buffer[0] = '\0';
+    return false;
+}
+
+static inline bool ul_state_copy_rgb(int strip, char *buffer, size_t buffer_len) {
+    (void)strip;
+    if (buffer && buffer_len > 0)
+        buffer[0] = '\0';
+    return false;
+}
+
+static inline bool ul_state_copy_white(int channel, char *buffer, size_t buffer_len) {
+    (void)channel;
+    if (buffer && buffer_len > 0)
+        buffer[0] = '\0';
+    return false;
+}
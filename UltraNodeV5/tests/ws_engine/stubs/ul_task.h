@@ -2,6 +2,8 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#define UL_TASK_CORE_AUTO ((BaseType_t)-1)
+
 BaseType_t ul_task_create(TaskFunction_t task_func,
                           const char *name,
                           const uint32_t stack_depth,
@@ -9,3 +11,7 @@ BaseType_t ul_task_create(TaskFunction_t task_func,
                           UBaseType_t priority,
                           TaskHandle_t *task_handle,
                           BaseType_t core_id);
+
+static inline void ul_task_forget(TaskHandle_t handle) {
+    (void)handle;
+}